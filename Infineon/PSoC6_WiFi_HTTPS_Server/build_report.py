@@ -0,0 +1,280 @@
+#!/usr/bin/env python3
+#
+# Flash, RAM and latency report of a build, for comparing the build profiles
+# (BUILD_PROFILE in the Makefile). The Makefile runs it with "make report".
+#
+# From the linked .elf file it prints the size of each allocated section and
+# the flash and RAM totals. From the linker map it prints the static flash
+# (.text, .rodata, .data init) and RAM (.data, .bss) of each module: the
+# application sources by name and the libraries by their mtb_shared
+# directory. With LTO the application code is merged into the ltrans
+# objects, shown as "(lto)".
+#
+# With --url it also reads the results of the on-device benchmark (/bench,
+# BENCH in the Makefile), after a new run with --bench-run, and the boot,
+# memory and HTTP latency reports of the running board (/stats/boot,
+# /stats/mem, /stats/http), as far as the build has them.
+#
+#   python3 build_report.py --elf build/<target>/Custom/<app>.elf
+#   python3 build_report.py --elf <elf> --map <map> \
+#       --url https://mysecurehttpserver.local:50007 --bench-run
+#
+# Only standard Python 3 modules are used.
+
+import argparse
+import http.client
+import json
+import os
+import re
+import ssl
+import struct
+import sys
+import time
+import urllib.parse
+
+# section flags (ELF)
+SHF_WRITE = 0x1
+SHF_ALLOC = 0x2
+SHT_NOBITS = 8
+
+# modules listed by name, the rest are summed as "other"
+TOP_MODULES = 25
+
+# a benchmark run takes several seconds
+BENCH_TIMEOUT_S = 120.0
+
+TIMEOUT_S = 10.0
+
+
+def elf_sections(path):
+    """(name, size, flash, ram) of the allocated sections of an ELF32 file"""
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:4] != b"\x7fELF" or data[4] != 1:
+        raise ValueError("%s is not an ELF32 file" % path)
+    end = "<" if data[5] == 1 else ">"
+    shoff, = struct.unpack_from(end + "I", data, 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from(end + "HHH", data, 0x2E)
+
+    hdrs = []
+    for i in range(shnum):
+        (name, stype, flags, addr, offset, size, _, _, _,
+            _) = struct.unpack_from(end + "10I", data, shoff + i * shentsize)
+        hdrs.append((name, stype, flags, size, offset))
+    strtab = hdrs[shstrndx][4]
+
+    sections = []
+    for name, stype, flags, size, _ in hdrs:
+        if not (flags & SHF_ALLOC) or size == 0:
+            continue
+        name = data[strtab + name:data.index(b"\0", strtab + name)].decode()
+        loaded = (stype != SHT_NOBITS)
+        writable = bool(flags & SHF_WRITE)
+        # initialized data is stored in flash and copied to RAM
+        sections.append((name, size, size if loaded else 0,
+                         size if writable else 0))
+    return sections
+
+
+def module_name(obj):
+    """Groups an input file of the linker map by source or library"""
+    obj = obj.replace("\\", "/")
+    if "ltrans" in obj:
+        return "(lto)"
+    m = re.search(r"mtb_shared/([^/]+)/", obj)
+    if m:
+        return m.group(1)
+    m = re.match(r"(.*/)?([^/(]+)\.a\(", obj)
+    if m:
+        return m.group(2)
+    return os.path.splitext(os.path.basename(obj))[0]
+
+
+def map_modules(path):
+    """{module: [flash, ram]} from the input sections of a GNU ld map"""
+    modules = {}
+    pending = None
+    started = False
+    line_re = re.compile(r"^ (\.\S+|COMMON)?\s+0x([0-9a-fA-F]+)\s+"
+                         r"0x([0-9a-fA-F]+)\s+(\S.*)$")
+    with open(path, errors="replace") as f:
+        for line in f:
+            if not started:
+                # the discarded input sections are listed before this
+                started = line.startswith("Linker script and memory map")
+                continue
+            line = line.rstrip("\n")
+            if re.match(r"^ (\.\S+|COMMON)$", line):
+                # long section name, the address follows on the next line
+                pending = line.strip()
+                continue
+            m = line_re.match(line)
+            if not m:
+                pending = None
+                continue
+            name = m.group(1) or pending
+            pending = None
+            if name is None:
+                continue
+            size = int(m.group(3), 16)
+            obj = m.group(4).strip()
+            if size == 0 or obj.startswith("*") or "linker stubs" in obj:
+                continue
+            flash = ram = 0
+            if name.startswith((".text", ".rodata", ".ARM", ".init",
+                                ".fini", ".cy_")):
+                flash = size
+            elif name.startswith(".data") or name.startswith(".ramfunc"):
+                flash = ram = size
+            elif name.startswith((".bss", ".noinit", ".heap",
+                                  ".stack")) or name == "COMMON":
+                ram = size
+            else:
+                continue
+            entry = modules.setdefault(module_name(obj), [0, 0])
+            entry[0] += flash
+            entry[1] += ram
+    return modules
+
+
+def print_sections(elf):
+    sections = elf_sections(elf)
+    print("Sections of %s" % elf)
+    print("  %-28s %10s %10s %10s" % ("section", "size", "flash", "RAM"))
+    for name, size, flash, ram in sections:
+        print("  %-28s %10d %10d %10d" % (name, size, flash, ram))
+    print("  %-28s %10s %10d %10d" % ("total", "",
+        sum(s[2] for s in sections), sum(s[3] for s in sections)))
+    print()
+
+
+def print_modules(mapfile):
+    modules = map_modules(mapfile)
+    if not modules:
+        print("No input sections in %s" % mapfile)
+        return
+    rows = sorted(modules.items(), key=lambda kv: (-kv[1][1], -kv[1][0]))
+    print("Static flash and RAM per module (%s)" % mapfile)
+    print("  %-28s %10s %10s" % ("module", "flash", "RAM"))
+    for name, (flash, ram) in rows[:TOP_MODULES]:
+        print("  %-28s %10d %10d" % (name, flash, ram))
+    rest = rows[TOP_MODULES:]
+    if rest:
+        print("  %-28s %10d %10d" % ("other (%d)" % len(rest),
+            sum(r[1][0] for r in rest), sum(r[1][1] for r in rest)))
+    print("  %-28s %10d %10d" % ("total", sum(r[1][0] for r in rows),
+        sum(r[1][1] for r in rows)))
+    print()
+
+
+class Board:
+    def __init__(self, args):
+        url = urllib.parse.urlsplit(args.url)
+        self.https = (url.scheme == "https")
+        self.host = url.hostname
+        self.port = url.port or (443 if self.https else 80)
+        self.ctx = None
+        if self.https:
+            self.ctx = ssl.create_default_context(cafile=args.cacert)
+            self.ctx.load_cert_chain(args.cert, args.key)
+            # the example certificates are issued for the mDNS name
+            self.ctx.check_hostname = not args.insecure_name
+
+    def get(self, path):
+        """The body of a GET request, or None if it is not served"""
+        if self.https:
+            conn = http.client.HTTPSConnection(self.host, self.port,
+                timeout=TIMEOUT_S, context=self.ctx)
+        else:
+            conn = http.client.HTTPConnection(self.host, self.port,
+                timeout=TIMEOUT_S)
+        try:
+            conn.request("GET", path)
+            resp = conn.getresponse()
+            body = resp.read().decode(errors="replace")
+        finally:
+            conn.close()
+        return body if resp.status == 200 else None
+
+
+def print_device(args):
+    board = Board(args)
+
+    bench = None
+    try:
+        if args.bench_run:
+            board.get("/bench?run")
+            deadline = time.monotonic() + BENCH_TIMEOUT_S
+            while time.monotonic() < deadline:
+                time.sleep(2)
+                bench = board.get("/bench")
+                if bench is None or json.loads(bench).get("state") != \
+                        "running":
+                    break
+        else:
+            bench = board.get("/bench")
+    except (OSError, http.client.HTTPException, ValueError) as e:
+        print("Benchmark not read: %s" % e)
+    if bench is not None:
+        print("Benchmark (/bench)")
+        try:
+            for name, value in json.loads(bench).items():
+                print("  %-28s %s" % (name, "-" if value is None else value))
+        except ValueError:
+            print(bench)
+        print()
+    else:
+        print("No benchmark results, build with BENCH")
+        print()
+
+    for path in ("/stats/boot", "/stats/mem", "/stats/http"):
+        try:
+            text = board.get(path)
+        except (OSError, http.client.HTTPException) as e:
+            text = None
+            print("%s not read: %s" % (path, e))
+        if text is not None:
+            print("%s" % path)
+            for line in text.strip().splitlines():
+                print("  " + line)
+            print()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Flash, RAM and latency "
+        "report of a build")
+    parser.add_argument("--elf", required=True, help="linked .elf file")
+    parser.add_argument("--map", help="linker map (default: the .elf file "
+        "with .map)")
+    parser.add_argument("--profile", default="",
+        help="build profile, for the title")
+    parser.add_argument("--url", help="server URL of the board running the "
+        "build, for example https://mysecurehttpserver.local:50007")
+    parser.add_argument("--bench-run", action="store_true",
+        help="start a benchmark run and wait for its results")
+    parser.add_argument("--cacert", default="root_ca.crt")
+    parser.add_argument("--cert", default="mysecurehttpclient.crt")
+    parser.add_argument("--key", default="mysecurehttpclient.key")
+    parser.add_argument("--insecure-name", action="store_true",
+        help="do not check the certificate name, to use an IP address")
+    args = parser.parse_args()
+
+    mapfile = args.map or os.path.splitext(args.elf)[0] + ".map"
+    if not os.path.isfile(args.elf):
+        parser.error("%s not found, build first" % args.elf)
+
+    print("Build profile: %s" % (args.profile or "custom"))
+    print()
+    print_sections(args.elf)
+    if os.path.isfile(mapfile):
+        print_modules(mapfile)
+    else:
+        print("No linker map %s, no per module sizes" % mapfile)
+        print()
+    if args.url:
+        print_device(args)
+    sys.stdout.flush()
+
+
+if __name__ == "__main__":
+    main()
@@ -62,7 +62,12 @@
 #include "cycfg_system.h"
 
 #define configUSE_PREEMPTION                    1
+#ifdef BUILD_PROFILE_MAX_THROUGHPUT
+/* next task from the ready priorities with CLZ (max 32 priorities) */
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION 1
+#else
 #define configUSE_PORT_OPTIMISED_TASK_SELECTION 0
+#endif
 #define configCPU_CLOCK_HZ                      SystemCoreClock
 #define configTICK_RATE_HZ                      1000u
 #define configMAX_PRIORITIES                    7
@@ -74,7 +79,12 @@
 #define configUSE_MUTEXES                       1
 #define configUSE_RECURSIVE_MUTEXES             1
 #define configUSE_COUNTING_SEMAPHORES           1
+#ifdef BUILD_PROFILE_MIN_RAM
+/* queue names for a kernel aware debugger only */
+#define configQUEUE_REGISTRY_SIZE               0
+#else
 #define configQUEUE_REGISTRY_SIZE               10
+#endif
 #define configUSE_QUEUE_SETS                    0
 #define configUSE_TIME_SLICING                  1
 #define configENABLE_BACKWARD_COMPATIBILITY     1
@@ -95,7 +105,19 @@
 #define configUSE_DAEMON_TASK_STARTUP_HOOK      0
 
 /* Run time and task stats gathering related definitions. */
+#ifdef CPU_STATS
+/* Profiling build: run time counter from the DWT cycle counter and context
+ * switch counts, see source/cpu_stats.c */
+#define configGENERATE_RUN_TIME_STATS           1
+extern void cpu_stats_timer_init( void );
+extern uint32_t cpu_stats_counter( void );
+extern void cpu_stats_switched_in( uint32_t taskNumber );
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() cpu_stats_timer_init()
+#define portGET_RUN_TIME_COUNTER_VALUE()        cpu_stats_counter()
+#define traceTASK_SWITCHED_IN()                 cpu_stats_switched_in( pxCurrentTCB->uxTCBNumber )
+#else
 #define configGENERATE_RUN_TIME_STATS           0
+#endif
 #define configUSE_TRACE_FACILITY                1
 #define configUSE_STATS_FORMATTING_FUNCTIONS    0
 
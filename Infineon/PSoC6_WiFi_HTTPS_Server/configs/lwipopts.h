@@ -124,6 +124,71 @@
 //
 #define TCP_MSS                         (WHD_PAYLOAD_MTU)
 
+//
+// Memory profile. The TCP buffers, the pbuf pool and the TCP PCBs are
+// derived from the knobs below, selected with LWIP_PROFILE in the Makefile:
+//   default       the sizes of the original example
+//   low-mem       fewest buffers, 3 connections
+//   throughput    a receive window of 4 full TLS records (window scaling) for
+//                 one bulk upload, like the firmware POST
+//   many-clients  10 connections with small windows (the Makefile also
+//                 raises HTTPS_CONN_BUDGET_SZ so MAX_SOCKETS follows)
+// Each knob can also be set on its own in DEFINES.
+//
+// LWIP_PROFILE_TCP_CONNS: TCP connections of the HTTPS server, MAX_SOCKETS
+//     is at most this (see HTTPS_CONN_PCB_RESERVE in secure_http_server.h)
+// LWIP_PROFILE_RX_SEGS: receive window of a connection, in segments
+// LWIP_PROFILE_TX_SEGS: send buffer of a connection, in segments
+// LWIP_PROFILE_RX_CONNS: connections that can fill their receive window at
+//     the same time, the others are given 2 pbufs each in the pool
+//
+// Largest TLS record from a client, HTTPS_CONN_TLS_IN_SZ in
+// secure_http_server.h
+#define LWIP_PROFILE_TLS_RECORD_SZ      (16 * 1024 + 512)
+
+#if defined(LWIP_PROFILE_LOW_MEM)
+    #define LWIP_PROFILE_DEF_CONNS      (3)
+    #define LWIP_PROFILE_DEF_RX_SEGS    (2)
+    #define LWIP_PROFILE_DEF_TX_SEGS    (2)
+    #define LWIP_PROFILE_DEF_RX_CONNS   (2)
+#elif defined(LWIP_PROFILE_THROUGHPUT)
+    #define LWIP_PROFILE_DEF_CONNS      (4)
+    #define LWIP_PROFILE_DEF_RX_SEGS    \
+        ((4 * LWIP_PROFILE_TLS_RECORD_SZ + TCP_MSS - 1) / TCP_MSS)
+    #define LWIP_PROFILE_DEF_TX_SEGS    (8)
+    #define LWIP_PROFILE_DEF_RX_CONNS   (1)
+#elif defined(LWIP_PROFILE_MANY_CLIENTS)
+    #define LWIP_PROFILE_DEF_CONNS      (10)
+    #define LWIP_PROFILE_DEF_RX_SEGS    (3)
+    #define LWIP_PROFILE_DEF_TX_SEGS    (3)
+    #define LWIP_PROFILE_DEF_RX_CONNS   (10)
+#else
+    #define LWIP_PROFILE_DEF_CONNS      (6)
+    #define LWIP_PROFILE_DEF_RX_SEGS    (4)
+    #define LWIP_PROFILE_DEF_TX_SEGS    (4)
+    #define LWIP_PROFILE_DEF_RX_CONNS   (6)
+#endif
+
+#ifndef LWIP_PROFILE_TCP_CONNS
+#define LWIP_PROFILE_TCP_CONNS          LWIP_PROFILE_DEF_CONNS
+#endif
+#ifndef LWIP_PROFILE_RX_SEGS
+#define LWIP_PROFILE_RX_SEGS            LWIP_PROFILE_DEF_RX_SEGS
+#endif
+#ifndef LWIP_PROFILE_TX_SEGS
+#define LWIP_PROFILE_TX_SEGS            LWIP_PROFILE_DEF_TX_SEGS
+#endif
+#ifndef LWIP_PROFILE_RX_CONNS
+#define LWIP_PROFILE_RX_CONNS           LWIP_PROFILE_DEF_RX_CONNS
+#endif
+
+#if LWIP_PROFILE_RX_SEGS < 2 || LWIP_PROFILE_TX_SEGS < 2
+#error "LWIP_PROFILE_RX_SEGS and LWIP_PROFILE_TX_SEGS must be at least 2"
+#endif
+#if LWIP_PROFILE_RX_CONNS > LWIP_PROFILE_TCP_CONNS
+#error "LWIP_PROFILE_RX_CONNS is larger than LWIP_PROFILE_TCP_CONNS"
+#endif
+
 #define     LWIP_CHECKSUM_CTRL_PER_NETIF   1
 #define     CHECKSUM_GEN_IP   1
 #define     CHECKSUM_GEN_UDP   1
@@ -146,7 +211,7 @@
  * TCP_SND_BUF: TCP sender buffer space (bytes).
  * To achieve good performance, this should be at least 2 * TCP_MSS.
  */
-#define TCP_SND_BUF                     (4 * TCP_MSS)
+#define TCP_SND_BUF                     (LWIP_PROFILE_TX_SEGS * TCP_MSS)
 
 /**
  * TCP_SND_QUEUELEN: TCP sender buffer space (pbufs). This must be at least
@@ -154,6 +219,28 @@
  */
 #define TCP_SND_QUEUELEN                ((6 * (TCP_SND_BUF) + (TCP_MSS - 1))/(TCP_MSS))
 
+/**
+ * TCP_WND: The size of a TCP window. A window larger than 64 KB is
+ * announced with window scaling (RFC 7323), in units of 2 bytes.
+ */
+#define TCP_WND                         (LWIP_PROFILE_RX_SEGS * TCP_MSS)
+#if TCP_WND > 0xffff
+#define LWIP_WND_SCALE                  (1)
+#define TCP_RCV_SCALE                   (1)
+#endif
+
+/**
+ * LWIP_TCP_SACK_OUT: with a window of many segments (a firmware upload on
+ * the throughput profile), out of order segments are reported with
+ * selective acknowledgements (RFC 2018), so a frame lost on Wi-Fi costs
+ * one retransmission and not the rest of the window. Out of order segments
+ * are queued (TCP_QUEUE_OOSEQ) up to one receive window of pbufs.
+ */
+#if LWIP_PROFILE_RX_SEGS > 8
+#define LWIP_TCP_SACK_OUT               (1)
+#define TCP_OOSEQ_MAX_PBUFS             (LWIP_PROFILE_RX_SEGS)
+#endif
+
 
 //
 // Taken from WICED to speed things up
@@ -170,7 +257,12 @@
 
 #define LWIP_SOCKET                     (1)
 #define LWIP_NETCONN                    (1)
+/* a received segment per entry at least, a full mbox stops the window */
+#if LWIP_PROFILE_RX_SEGS > 12
+#define DEFAULT_TCP_RECVMBOX_SIZE       (LWIP_PROFILE_RX_SEGS)
+#else
 #define DEFAULT_TCP_RECVMBOX_SIZE       (12)
+#endif
 #define TCPIP_MBOX_SIZE                 (16)
 #define TCPIP_THREAD_STACKSIZE          (4*1024)
 #define TCPIP_THREAD_PRIO               (4)
@@ -188,8 +280,9 @@
 /**
  * MEMP_NUM_TCP_PCB: the number of simultaneously active TCP connections.
  * (requires the LWIP_TCP option)
+ * The server connections, plus 2 for the connections closing.
  */
-#define MEMP_NUM_TCP_PCB                8
+#define MEMP_NUM_TCP_PCB                (LWIP_PROFILE_TCP_CONNS + 2)
 
 /**
  * MEMP_NUM_TCP_PCB_LISTEN: the number of listening TCP connections.
@@ -200,8 +293,10 @@
 /**
  * MEMP_NUM_TCP_SEG: the number of simultaneously queued TCP segments.
  * (requires the LWIP_TCP option)
+ * The send queue of a connection, plus the out of sequence segments of a
+ * receive window.
  */
-#define MEMP_NUM_TCP_SEG                27
+#define MEMP_NUM_TCP_SEG                (TCP_SND_QUEUELEN + LWIP_PROFILE_RX_SEGS - 1)
 
 /**
  * MEMP_NUM_SYS_TIMEOUT: the number of simultaneously active timeouts.
@@ -210,8 +305,11 @@
 
 /**
  * PBUF_POOL_SIZE: the number of buffers in the pbuf pool.
+ * The receive windows of LWIP_PROFILE_RX_CONNS connections, and 2 buffers
+ * for each of the other connections.
  */
-#define PBUF_POOL_SIZE                  24
+#define PBUF_POOL_SIZE                  (LWIP_PROFILE_RX_SEGS * LWIP_PROFILE_RX_CONNS + \
+                                         2 * (LWIP_PROFILE_TCP_CONNS - LWIP_PROFILE_RX_CONNS))
 
 /**
  * MEMP_NUM_NETBUF: the number of struct netbufs.
@@ -226,12 +324,15 @@
 #define MEMP_NUM_NETCONN                16
 
 
-/* Turn off LWIP_STATS in Release build */
+/* Turn off LWIP_STATS in Release build, unless set in the Makefile. The
+ * counters (drops, pool use) are on /stats/mem with MEM_STATS. */
+#ifndef LWIP_STATS
 #ifdef DEBUG
 #define LWIP_STATS 1
 #else
 #define LWIP_STATS 0
 #endif
+#endif
 
 /**
  * LWIP_TCPIP_CORE_LOCKING
@@ -30,6 +30,17 @@
 extern "C" {
 #endif
 
+/* Build profile, BUILD_PROFILE in the Makefile */
+#if defined(BUILD_PROFILE_MIN_RAM)
+    #define BUILD_PROFILE_NAME "min-ram"
+#elif defined(BUILD_PROFILE_BALANCED)
+    #define BUILD_PROFILE_NAME "balanced"
+#elif defined(BUILD_PROFILE_MAX_THROUGHPUT)
+    #define BUILD_PROFILE_NAME "max-throughput"
+#else
+    #define BUILD_PROFILE_NAME "custom"
+#endif
+
 /* Platform / Porting */
 #define FREERTOS
 #define NO_FILESYSTEM /* File system disable */
@@ -39,13 +50,26 @@ extern "C" {
 #define NO_MAIN_DRIVER
 #define WOLFSSL_IGNORE_FILE_WARN /* ignore file include warnings */
 #define WOLFSSL_SMALL_STACK /* limit stack usage */
+#ifdef BUILD_PROFILE_MAX_THROUGHPUT
+    /* keep the small stack buffers of SHA-2 in the hash object instead
+     * of allocating them for each block */
+    #define WOLFSSL_SMALL_STACK_CACHE
+#endif
 #define BENCH_EMBEDDED
 
 #include <stdint.h>
 extern void Cy_SysLib_Delay(uint32_t milliseconds);
 extern void Cy_SysLib_DelayUs(uint16_t microseconds);
+#ifdef TPM_WAIT_RTOS
+/* yield to other tasks while waiting on the TPM (source/tpm_wait.c) */
+extern void tpm_wait(void);
+extern void tpm_sleep_ms(uint32_t ms);
+#define XSLEEP_MS(ms) tpm_sleep_ms(ms)
+#define XTPM_WAIT()   tpm_wait()
+#else
 #define XSLEEP_MS(ms) Cy_SysLib_Delay(ms)
 #define XTPM_WAIT()   XSLEEP_MS(1)
+#endif
 
 /* Infineon TPM 2.0 - SLB9673 (I2C) */
 #if 1 /* I2C */
@@ -76,6 +100,9 @@ extern void Cy_SysLib_DelayUs(uint16_t microseconds);
 #define HAVE_SUPPORTED_CURVES
 #define HAVE_SERVER_RENEGOTIATION_INFO
 #define HAVE_ENCRYPT_THEN_MAC
+/* max_fragment_length: a client may ask for records that fit its (and the
+ * server's) buffers, wolfSSL then limits the records both ways */
+#define HAVE_MAX_FRAGMENT
 
 #ifdef WOLFSSL_TLS13
     #define HAVE_HKDF
@@ -85,6 +112,11 @@ extern void Cy_SysLib_DelayUs(uint16_t microseconds);
 
 /* Enable crypto callbacks - for TPM offloading */
 #define WOLF_CRYPTO_CB
+#if defined(TLS_SESSION_STATS) || defined(TLS_KEY_POLICY)
+    /* offer operations on software keys to the crypto callback too, used
+     * to count the TLS handshakes and sign with the TPM (tls_crypto.c) */
+    #define WOLF_CRYPTO_CB_FIND
+#endif
 
 /* Enable SP math all (sp_int.c) with multi-precision support */
 #define WOLFSSL_SP_MATH_ALL
@@ -93,9 +125,13 @@ extern void Cy_SysLib_DelayUs(uint16_t microseconds);
     /* Single Precision math for ECC 256 and RSA 2048 */
     #define WOLFSSL_HAVE_SP_RSA
     #define WOLFSSL_HAVE_SP_ECC
-    #define WOLFSSL_SP_SMALL
 
-    #if 0 /* ARM assembly speedups */
+    /* CRYPTO_PROFILE=fast (Makefile): Cortex-M4 assembly for SP ECC/RSA,
+     * AES and SHA-2. The default (small) profile is portable C with the
+     * smallest flash footprint. */
+    #ifndef CRYPTO_PROFILE_FAST
+        #define WOLFSSL_SP_SMALL
+    #else /* ARM assembly speedups */
         #define WOLFSSL_SP_ARM_CORTEX_M_ASM
 
         #define WOLFSSL_ARMASM
@@ -173,8 +209,19 @@ extern void Cy_SysLib_DelayUs(uint16_t microseconds);
 #define WOLFSSL_BASE64_ENCODE
 
 #if 1
+    /* TLS v1.3 resumption: the server issues tickets, encrypted by the
+     * default wolfSSL ticket callback, and resumes with PSK (ECDHE) which
+     * skips the certificate and the ECDSA signature. A polling client
+     * resumes within the ticket hint; the ticket key is rotated on a fixed
+     * lifetime that must be longer than the hint. */
     #define HAVE_SESSION_TICKETS
-    #define SMALL_SESSION_CACHE
+    #define SESSION_TICKET_HINT_DEFAULT (60*60)
+    #define WOLFSSL_TICKET_KEY_LIFETIME (2*60*60)
+    /* default session cache (33 sessions) for TLS v1.2 session IDs and
+     * clients polling over several connections, 6 with min-ram */
+    #ifdef BUILD_PROFILE_MIN_RAM
+        #define SMALL_SESSION_CACHE
+    #endif
 #else
     #define NO_SESSION_CACHE
 #endif
@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+#
+# Generates source/secure_keys_der.c and source/secure_keys_der.h from the PEM
+# certificates and keys in source/secure_keys.h.
+#
+# Each key<NAME>_PEM string becomes a key<NAME>_DER array with its size in
+# key<NAME>_DER_SZ, so the TLS configuration is loaded without base64 decoding
+# and PEM parsing at run time. A PEM string holding several certificates (a
+# chain) becomes the concatenation of their DER encodings.
+#
+# Run from the application directory (the Makefile runs it as a pre-build
+# step). The output only changes when secure_keys.h does.
+
+import base64
+import os
+import re
+import sys
+
+KEYS_H = os.path.join("source", "secure_keys.h")
+OUT_C = os.path.join("source", "secure_keys_der.c")
+OUT_H = os.path.join("source", "secure_keys_der.h")
+
+LICENSE = """\
+*******************************************************************************
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+"""
+
+
+def banner(file_name, description):
+    return ("/******************************************************************************\n"
+            "* File Name: %s\n"
+            "*\n"
+            "* Description: %s\n"
+            "*\n"
+            "* Generated by generate_secure_keys.py from secure_keys.h, do not edit.\n"
+            "*\n"
+            "* Related Document: See README.md\n"
+            "*\n"
+            "%s\n" % (file_name, description, LICENSE))
+
+
+def read_pem_defines(path):
+    """ key<NAME>_PEM macros of secure_keys.h as (name, PEM text) """
+    with open(path, "r") as f:
+        text = f.read()
+    keys = []
+    for m in re.finditer(r"#define\s+(key\w+)_PEM\s*\\\n((?:\s*\"(?:[^\"\\]|\\.)*\"\s*\\?\n?)+)",
+                         text):
+        literals = re.findall(r"\"((?:[^\"\\]|\\.)*)\"", m.group(2))
+        pem = "".join(literals).replace("\\n", "\n")
+        keys.append((m.group(1), pem))
+    return keys
+
+
+def pem_to_der(name, pem):
+    blocks = re.findall(r"-----BEGIN ([A-Z ]+)-----(.*?)-----END \1-----", pem,
+                        re.S)
+    if not blocks:
+        sys.exit("%s: no PEM block in %s_PEM" % (KEYS_H, name))
+    der = b""
+    for label, body in blocks:
+        if "ENCRYPTED" in label or "Proc-Type" in body:
+            sys.exit("%s: %s_PEM is encrypted" % (KEYS_H, name))
+        der += base64.b64decode("".join(body.split()))
+    return [label for label, _ in blocks], der
+
+
+def write_if_changed(path, text):
+    if os.path.exists(path):
+        with open(path, "r", newline="") as f:
+            if f.read() == text:
+                return
+    with open(path, "w", newline="\n") as f:
+        f.write(text)
+    print("Generated %s" % path)
+
+
+def main():
+    keys = []
+    for name, pem in read_pem_defines(KEYS_H):
+        labels, der = pem_to_der(name, pem)
+        keys.append((name, labels, der))
+
+    h = banner("secure_keys_der.h",
+               "DER encoded certificates and keys of secure_keys.h.")
+    h += "/*******************************************************************************\n"
+    h += "* Include guard\n"
+    h += "*******************************************************************************/\n"
+    h += "#ifndef SECURE_KEYS_DER_H_\n#define SECURE_KEYS_DER_H_\n\n#include <stdint.h>\n\n"
+    h += "/*******************************************************************************\n"
+    h += "* Macros\n"
+    h += "*******************************************************************************/\n"
+    for name, labels, der in keys:
+        h += "/* %s_PEM: %s */\n" % (name, ", ".join(labels))
+        h += "#define %s_DER_SZ (%d)\n\n" % (name, len(der))
+    h += "/*******************************************************************************\n"
+    h += "* Global Variables\n"
+    h += "*******************************************************************************/\n"
+    for name, labels, der in keys:
+        h += "extern const uint8_t %s_DER[%s_DER_SZ];\n" % (name, name)
+    h += "\n#endif /* SECURE_KEYS_DER_H_ */\n\n/* [] END OF FILE */\n"
+
+    c = banner("secure_keys_der.c",
+               "DER encoded certificates and keys of secure_keys.h.")
+    c += "#include \"secure_keys_der.h\"\n"
+    for name, labels, der in keys:
+        c += "\n/* %s_PEM */\n" % name
+        c += "const uint8_t %s_DER[%s_DER_SZ] = {\n" % (name, name)
+        for i in range(0, len(der), 12):
+            c += "    " + " ".join("0x%02x," % b for b in der[i:i + 12]) + "\n"
+        c += "};\n"
+    c += "\n/* [] END OF FILE */\n"
+
+    write_if_changed(OUT_H, h)
+    write_if_changed(OUT_C, c)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,206 @@
+#!/usr/bin/env python3
+#
+# Generates source/web_assets.c and source/web_assets.h from the files in web/.
+#
+# Each asset is stored as a complete HTTP response (status line, headers and
+# body) for a CY_RAW_STATIC_URL_CONTENT resource, so serving it is a single
+# write of a flash-resident buffer. Text assets are gzip compressed and every
+# asset gets an ETag from the hash of its content. "{{<asset>}}" in an asset is
+# replaced with the URL of that asset, versioned with its ETag, so assets that
+# are cached as immutable are fetched again when they change.
+#
+# Run from the application directory (the Makefile runs it as a pre-build
+# step). The output only changes when the assets do.
+
+import gzip
+import hashlib
+import os
+import re
+import sys
+
+WEB_DIR = "web"
+OUT_C = os.path.join("source", "web_assets.c")
+OUT_H = os.path.join("source", "web_assets.h")
+
+# name, URL, content type, Cache-Control
+# Assets referenced with {{<name>}} must be listed before the assets using them
+ASSETS = [
+    ("logo.png",    "/logo.png",    "image/png",       "public, max-age=31536000, immutable"),
+    ("progress.js", "/progress.js", "text/javascript", "public, max-age=31536000, immutable"),
+    ("index.html",  "/",            "text/html",       "max-age=3600"),
+]
+
+# only keep the gzip encoding if it saves at least this fraction
+GZIP_MIN_SAVING = 0.1
+
+# a static response is written as one TLS record, keep it within one TCP
+# segment (HTTPS_TLS_RECORD_SZ in secure_http_server.h)
+TLS_RECORD_SZ = 1460 - 96
+
+LICENSE = """\
+*******************************************************************************
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+"""
+
+
+def banner(file_name, description):
+    return ("/******************************************************************************\n"
+            "* File Name: %s\n"
+            "*\n"
+            "* Description: %s\n"
+            "*\n"
+            "* Generated by generate_web_assets.py from the files in web/, do not edit.\n"
+            "*\n"
+            "* Related Document: See README.md\n"
+            "*\n"
+            "%s\n" % (file_name, description, LICENSE))
+
+
+def symbol(name):
+    return re.sub(r"[^0-9a-zA-Z]", "_", name).lower()
+
+
+def build_asset(name, url, mime, cache, urls):
+    with open(os.path.join(WEB_DIR, name), "rb") as f:
+        data = f.read()
+
+    # link the versioned URLs of the assets already built
+    def link(m):
+        ref = m.group(1).decode()
+        if ref not in urls:
+            sys.exit("%s: unknown asset {{%s}}" % (name, ref))
+        return urls[ref].encode()
+    data = re.sub(rb"\{\{([^}]+)\}\}", link, data)
+
+    etag = hashlib.sha256(data).hexdigest()[:16]
+    urls[name] = "%s?v=%s" % (url, etag)
+
+    encoding = None
+    body = data
+    if mime.startswith("text/"):
+        # mtime=0 keeps the output reproducible
+        packed = gzip.compress(data, compresslevel=9, mtime=0)
+        if len(packed) <= len(data) * (1.0 - GZIP_MIN_SAVING):
+            encoding = "gzip"
+            body = packed
+
+    header = "HTTP/1.1 200 OK\r\n"
+    header += "Content-Type: %s\r\n" % mime
+    header += "Content-Length: %d\r\n" % len(body)
+    if encoding:
+        header += "Content-Encoding: %s\r\n" % encoding
+    header += "ETag: \"%s\"\r\n" % etag
+    header += "Cache-Control: %s\r\n" % cache
+    header += "\r\n"
+
+    return {
+        "name": name,
+        "url": url,
+        "sym": symbol(name),
+        "etag": etag,
+        "header": header,
+        "response": header.encode() + body,
+        "size": len(data),
+        "encoded": len(body),
+        "encoding": encoding,
+    }
+
+
+def write_if_changed(path, text):
+    if os.path.exists(path):
+        with open(path, "r", newline="") as f:
+            if f.read() == text:
+                return
+    with open(path, "w", newline="\n") as f:
+        f.write(text)
+    print("Generated %s" % path)
+
+
+def main():
+    urls = {}
+    assets = [build_asset(*a, urls) for a in ASSETS]
+    for a in assets:
+        if len(a["response"]) > TLS_RECORD_SZ:
+            print("Warning: %s is %d bytes, more than one TLS record per TCP "
+                  "segment (%d)" % (a["name"], len(a["response"]),
+                                    TLS_RECORD_SZ))
+
+    h = banner("web_assets.h",
+               "Precompressed static web page responses.")
+    h += "/*******************************************************************************\n"
+    h += "* Include guard\n"
+    h += "*******************************************************************************/\n"
+    h += "#ifndef WEB_ASSETS_H_\n#define WEB_ASSETS_H_\n\n#include <stdint.h>\n\n"
+    h += "/*******************************************************************************\n"
+    h += "* Macros\n"
+    h += "*******************************************************************************/\n"
+    for a in assets:
+        up = a["sym"].upper()
+        h += "/* %s: %d bytes%s */\n" % (a["name"], a["size"],
+            (", %d %s" % (a["encoded"], a["encoding"])) if a["encoding"] else "")
+        h += "#define WEB_ASSET_%s_URL \"%s\"\n" % (up, a["url"])
+        h += "#define WEB_ASSET_%s_ETAG \"\\\"%s\\\"\"\n" % (up, a["etag"])
+        h += "#define WEB_ASSET_%s_SZ (%d)\n\n" % (up, len(a["response"]))
+    h += "/*******************************************************************************\n"
+    h += "* Global Variables\n"
+    h += "*******************************************************************************/\n"
+    h += "/* complete HTTP responses, for CY_RAW_STATIC_URL_CONTENT resources */\n"
+    for a in assets:
+        h += "extern const uint8_t web_asset_%s[WEB_ASSET_%s_SZ];\n" % (
+            a["sym"], a["sym"].upper())
+    h += "\n#endif /* WEB_ASSETS_H_ */\n\n/* [] END OF FILE */\n"
+
+    c = banner("web_assets.c",
+               "Precompressed static web page responses.")
+    c += "#include \"web_assets.h\"\n"
+    for a in assets:
+        c += "\n/* %s\n" % a["name"]
+        for line in a["header"].split("\r\n"):
+            if line:
+                c += " * %s\n" % line
+        c += " */\n"
+        c += "const uint8_t web_asset_%s[WEB_ASSET_%s_SZ] = {\n" % (
+            a["sym"], a["sym"].upper())
+        resp = a["response"]
+        for i in range(0, len(resp), 12):
+            c += "    " + " ".join("0x%02x," % b for b in resp[i:i + 12]) + "\n"
+        c += "};\n"
+    c += "\n/* [] END OF FILE */\n"
+
+    write_if_changed(OUT_H, h)
+    write_if_changed(OUT_C, c)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,281 @@
+#!/usr/bin/env python3
+#
+# Bounded HTTPS load test for the example server.
+#
+# Sweeps the number of concurrent clients from 1 up to --max-conns (the
+# server's MAX_SOCKETS, 4 with the default HTTPS_CONN_BUDGET_SZ), each step
+# running for --duration seconds, with persistent (keep-alive) connections,
+# a new TLS connection per request, or both. Each step reports the requests
+# per second and the client latency percentiles. --put sends PUT requests
+# that update one resource per client (/loadtest<n>) instead of GET requests.
+# With --fw-manifest and --fw-data, a firmware upload runs during the sweep.
+#
+# When the server is built with HTTP_LATENCY_STATS, the device histograms
+# from /stats/http are printed after each step and cleared (/stats/http?reset)
+# before the next one.
+#
+# Run from the application directory, the default certificates are the ones
+# generated by generate_ssl_certs.sh:
+#   python3 load_test.py https://mysecurehttpserver.local:50007
+#   python3 load_test.py https://<ip>:50007 --mode both --path /api/tpm
+#
+# Only standard Python 3 modules are used.
+
+import argparse
+import http.client
+import json
+import ssl
+import sys
+import threading
+import time
+import urllib.parse
+
+# requests on a persistent connection before the client opens a new one, the
+# server closes it after HTTPS_KEEPALIVE_MAX_REQUESTS anyway
+KEEPALIVE_REQUESTS = 1000
+
+# socket timeout, a request taking longer is counted as an error
+TIMEOUT_S = 10.0
+
+PUT_HEADERS = {"Content-Type": "application/x-www-form-urlencoded"}
+
+
+def percentile(values, pct):
+    if not values:
+        return 0.0
+    values = sorted(values)
+    idx = min(len(values) - 1, int(round(pct / 100.0 * (len(values) - 1))))
+    return values[idx]
+
+
+class Target:
+    def __init__(self, args):
+        url = urllib.parse.urlsplit(args.url)
+        self.https = (url.scheme == "https")
+        self.host = url.hostname
+        self.port = url.port or (443 if self.https else 80)
+        self.ctx = None
+        if self.https:
+            self.ctx = ssl.create_default_context(cafile=args.cacert)
+            self.ctx.load_cert_chain(args.cert, args.key)
+            # the example certificates are issued for the mDNS name
+            self.ctx.check_hostname = not args.insecure_name
+
+    def connect(self):
+        if self.https:
+            conn = http.client.HTTPSConnection(self.host, self.port,
+                timeout=TIMEOUT_S, context=self.ctx)
+        else:
+            conn = http.client.HTTPConnection(self.host, self.port,
+                timeout=TIMEOUT_S)
+        conn.connect()
+        return conn
+
+    def request(self, conn, method, path, body=None, headers=None):
+        conn.request(method, path, body=body, headers=headers or {})
+        resp = conn.getresponse()
+        data = resp.read()
+        return resp.status, data, resp.getheader("Connection", "")
+
+
+class Worker(threading.Thread):
+    """One client: sends requests until the step ends"""
+
+    def __init__(self, target, path, put, keepalive, stop, index):
+        super().__init__(daemon=True)
+        self.target = target
+        self.path = path
+        self.put = put
+        self.index = index
+        self.keepalive = keepalive
+        self.stop = stop
+        self.latency = []       # seconds, per request
+        self.connect = []       # seconds, TCP and TLS handshake
+        self.errors = 0
+
+    def run(self):
+        conn = None
+        served = 0
+        while not self.stop.is_set():
+            try:
+                if conn is None:
+                    start = time.perf_counter()
+                    conn = self.target.connect()
+                    self.connect.append(time.perf_counter() - start)
+                    served = 0
+                start = time.perf_counter()
+                if self.put:
+                    # the same name every time, the resource is updated
+                    body = "/loadtest%d=%d" % (self.index, served)
+                    status, _, connection = self.target.request(conn, "PUT",
+                        self.path, body, PUT_HEADERS)
+                else:
+                    status, _, connection = self.target.request(conn, "GET",
+                        self.path)
+                self.latency.append(time.perf_counter() - start)
+                served += 1
+                if status != 200:
+                    self.errors += 1
+                if (not self.keepalive or connection.lower() == "close" or
+                        served >= KEEPALIVE_REQUESTS):
+                    conn.close()
+                    conn = None
+            except (OSError, http.client.HTTPException):
+                # includes the server closing an idle or used up connection
+                self.errors += 1
+                if conn is not None:
+                    conn.close()
+                conn = None
+                time.sleep(0.1)
+        if conn is not None:
+            conn.close()
+
+
+class FirmwareUpload(threading.Thread):
+    """Uploads the manifest and the firmware data as raw bodies"""
+
+    def __init__(self, target, manifest, data):
+        super().__init__(daemon=True)
+        self.target = target
+        self.manifest = manifest
+        self.data = data
+        self.result = None
+
+    def run(self):
+        headers = {"Content-Type": "application/octet-stream"}
+        try:
+            for path, name in (("/fw/manifest", self.manifest),
+                               ("/fw/data", self.data)):
+                with open(name, "rb") as f:
+                    body = f.read()
+                conn = self.target.connect()
+                conn.timeout = None
+                status, text, _ = self.target.request(conn, "POST", path,
+                    body, headers)
+                conn.close()
+                self.result = "%s: %d %s" % (path, status,
+                    text.decode(errors="replace").strip())
+                if status != 200:
+                    break
+        except (OSError, http.client.HTTPException) as e:
+            self.result = "upload failed: %s" % e
+
+
+def device_stats(target, reset):
+    """The /stats/http report (HTTP_LATENCY_STATS), or None"""
+    try:
+        conn = target.connect()
+        status, text, _ = target.request(conn, "GET",
+            "/stats/http" + ("?reset" if reset else ""))
+        conn.close()
+    except (OSError, http.client.HTTPException):
+        return None
+    return text.decode(errors="replace") if status == 200 else None
+
+
+def run_step(target, args, clients, keepalive):
+    stop = threading.Event()
+    workers = [Worker(target, args.path, args.put, keepalive, stop, i)
+               for i in range(clients)]
+    start = time.perf_counter()
+    for w in workers:
+        w.start()
+    time.sleep(args.duration)
+    stop.set()
+    for w in workers:
+        w.join(TIMEOUT_S + 1)
+    elapsed = time.perf_counter() - start
+
+    latency = [l for w in workers for l in w.latency]
+    connect = [c for w in workers for c in w.connect]
+    return {
+        "clients": clients,
+        "mode": "keepalive" if keepalive else "new",
+        "method": "PUT" if args.put else "GET",
+        "requests": len(latency),
+        "errors": sum(w.errors for w in workers),
+        "rps": round(len(latency) / elapsed, 2),
+        "p50Ms": round(percentile(latency, 50) * 1000, 1),
+        "p90Ms": round(percentile(latency, 90) * 1000, 1),
+        "p99Ms": round(percentile(latency, 99) * 1000, 1),
+        "maxMs": round(max(latency, default=0) * 1000, 1),
+        "connects": len(connect),
+        "connectP50Ms": round(percentile(connect, 50) * 1000, 1),
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__ or
+        "HTTPS load test for the example server")
+    parser.add_argument("url", help="server URL, for example "
+        "https://mysecurehttpserver.local:50007")
+    parser.add_argument("--path", default="/tpm",
+        help="resource requested by the clients (default /tpm)")
+    parser.add_argument("--put", action="store_true",
+        help="send PUT requests that create and update /loadtest<n>")
+    parser.add_argument("--max-conns", type=int, default=4,
+        help="largest number of concurrent clients, the server "
+             "MAX_SOCKETS (default 4)")
+    parser.add_argument("--duration", type=float, default=10.0,
+        help="seconds per step (default 10)")
+    parser.add_argument("--mode", choices=("keepalive", "new", "both"),
+        default="keepalive", help="persistent connections, a new TLS "
+        "connection per request, or both (default keepalive)")
+    parser.add_argument("--cacert", default="root_ca.crt")
+    parser.add_argument("--cert", default="mysecurehttpclient.crt")
+    parser.add_argument("--key", default="mysecurehttpclient.key")
+    parser.add_argument("--insecure-name", action="store_true",
+        help="do not check the certificate name, to use an IP address")
+    parser.add_argument("--fw-manifest", help="firmware upload during the "
+        "sweep: manifest file (this updates the TPM firmware)")
+    parser.add_argument("--fw-data", help="firmware data file")
+    parser.add_argument("--json", action="store_true",
+        help="print the results as JSON lines")
+    args = parser.parse_args()
+
+    if args.max_conns < 1 or args.duration <= 0:
+        parser.error("--max-conns and --duration must be positive")
+    if bool(args.fw_manifest) != bool(args.fw_data):
+        parser.error("--fw-manifest and --fw-data go together")
+
+    target = Target(args)
+    modes = [True, False] if args.mode == "both" else \
+        [args.mode == "keepalive"]
+
+    upload = None
+    if args.fw_manifest:
+        upload = FirmwareUpload(target, args.fw_manifest, args.fw_data)
+        upload.start()
+
+    device_stats(target, True)
+    if not args.json:
+        print("%-9s %7s %8s %6s %8s %8s %8s %8s %8s" % ("mode", "clients",
+            "requests", "errors", "req/s", "p50 ms", "p90 ms", "p99 ms",
+            "conn ms"))
+    for keepalive in modes:
+        for clients in range(1, args.max_conns + 1):
+            r = run_step(target, args, clients, keepalive)
+            stats = device_stats(target, True)
+            if args.json:
+                if stats is not None:
+                    r["device"] = stats
+                r["fwUpload"] = upload is not None and upload.is_alive()
+                print(json.dumps(r))
+            else:
+                print("%-9s %7d %8d %6d %8.2f %8.1f %8.1f %8.1f %8.1f" % (
+                    r["mode"], clients, r["requests"], r["errors"], r["rps"],
+                    r["p50Ms"], r["p90Ms"], r["p99Ms"], r["connectP50Ms"]))
+                if stats is not None:
+                    for line in stats.strip().splitlines():
+                        print("    " + line)
+            sys.stdout.flush()
+
+    if upload is not None:
+        if upload.is_alive():
+            print("Firmware upload still running, waiting for it")
+        upload.join()
+        print(upload.result)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,773 @@
+/******************************************************************************
+* File Name: bench.c
+*
+* Description: This file contains the on-device benchmark (BENCH). A low
+*              priority task times the wolfCrypt algorithms enabled in
+*              user_settings.h (SHA-256/384, AES-GCM, P-256 ECDHE/ECDSA and
+*              RSA-2048), the TPM commands (GetCapabilities, GetRandom, a
+*              P-256 sign) and full and resumed TLS v1.3 handshakes between a
+*              client and a server connected in memory. The results are
+*              served as one JSON object on /bench, to compare build
+*              profiles and boards.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cyhal.h"
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include "bench.h"
+
+#ifdef BENCH
+
+#include <wolfssl/wolfcrypt/settings.h>
+#include <wolfssl/ssl.h>
+#include <wolfssl/wolfcrypt/random.h>
+#include <wolfssl/wolfcrypt/sha256.h>
+#include <wolfssl/wolfcrypt/sha512.h>
+#include <wolfssl/wolfcrypt/aes.h>
+#include <wolfssl/wolfcrypt/ecc.h>
+#include <wolfssl/wolfcrypt/rsa.h>
+#include <wolfssl/wolfcrypt/error-crypt.h>
+#if !defined(NO_RSA) && !defined(WOLFSSL_RSA_PUBLIC_ONLY)
+#define BENCH_RSA
+/* RSA-2048 test key (client_key_der_2048) */
+#define USE_CERT_BUFFERS_2048
+#include <wolfssl/certs_test.h>
+#endif
+
+#include "perf_stats.h"
+#include "secure_http_server.h"
+#include "tls_crypto.h"
+#include "tpm_dev.h"
+#include "secure_keys.h"
+
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* stack depth in words (StackType_t) */
+#define BENCH_TASK_STACK_SIZE       (4 * 1024)
+#define BENCH_TASK_PRIORITY         (1)
+
+/* result id and JSON name (unit in the name) */
+#define BENCH_RESULTS(X) \
+    X(SHA256,           "sha256KBps") \
+    X(SHA384,           "sha384KBps") \
+    X(AES128_GCM_ENC,   "aes128GcmEncKBps") \
+    X(AES128_GCM_DEC,   "aes128GcmDecKBps") \
+    X(AES256_GCM_ENC,   "aes256GcmEncKBps") \
+    X(ECC_KEYGEN,       "eccKeyGenUs") \
+    X(ECDHE,            "ecdheUs") \
+    X(ECDSA_SIGN,       "ecdsaSignUs") \
+    X(ECDSA_VERIFY,     "ecdsaVerifyUs") \
+    X(RSA_SIGN,         "rsa2048SignUs") \
+    X(RSA_VERIFY,       "rsa2048VerifyUs") \
+    X(TPM_GET_CAPS,     "tpmGetCapsUs") \
+    X(TPM_GET_RANDOM,   "tpmGetRandomUs") \
+    X(TPM_CREATE_KEY,   "tpmCreatePrimaryUs") \
+    X(TPM_SIGN,         "tpmSignUs") \
+    X(TLS_FULL,         "tlsFullUs") \
+    X(TLS_FULL_SERVER,  "tlsFullServerUs") \
+    X(TLS_RESUME,       "tlsResumeUs") \
+    X(TLS_RESUME_SERVER,"tlsResumeServerUs")
+
+#define BENCH_ID(id, name)   BENCH_##id,
+#define BENCH_NAME(id, name) name,
+
+/* The keys and TLS contexts of the benchmark are on the software device,
+ * so they bypass tls_crypto_cb and its counters of the server's key
+ * operations (/stats/tls) */
+#define BENCH_DEVID                 TLS_CRYPTO_SW_DEVID
+
+/* handshake steps before giving up on the in-memory connection */
+#define BENCH_TLS_ROUNDS            (32)
+
+
+/*******************************************************************************
+ * Data Types
+ ******************************************************************************/
+enum {
+    BENCH_RESULTS(BENCH_ID)
+    BENCH_COUNT
+};
+
+typedef enum {
+    BENCH_STATE_IDLE,
+    BENCH_STATE_RUNNING,
+    BENCH_STATE_DONE
+} bench_state_t;
+
+/* keys and buffers, allocated for a run */
+typedef struct {
+    WC_RNG   rng;
+    ecc_key  key;
+    ecc_key  peer;
+#ifdef BENCH_RSA
+    RsaKey   rsa;
+#endif
+    Aes      aes;
+    uint8_t  block[BENCH_BLOCK_SZ];
+    uint8_t  out[BENCH_BLOCK_SZ];
+} bench_work_t;
+
+/* one direction of the in-memory TLS connection */
+typedef struct {
+    uint8_t buf[BENCH_TLS_BUF_SZ];
+    int     len;
+} bench_pipe_t;
+
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static const char* const mBenchNames[BENCH_COUNT] = {
+    BENCH_RESULTS(BENCH_NAME)
+};
+/* -1 when not run or failed */
+static int32_t mBenchValue[BENCH_COUNT];
+static volatile bench_state_t mBenchState;
+static uint32_t mBenchRuns;
+static int mBenchTpm;
+static WOLFTPM2_DEV* mBenchDev;
+
+static TaskHandle_t mBenchTask;
+static StaticTask_t mBenchTaskBuf;
+static StackType_t  mBenchTaskStack[BENCH_TASK_STACK_SIZE];
+
+static bench_pipe_t mToServer;
+static bench_pipe_t mToClient;
+
+/* digest signed by the ECDSA, RSA and TPM benchmarks */
+static const uint8_t mBenchHash[32] = {
+    0x2c, 0xf2, 0x4d, 0xba, 0x5f, 0xb0, 0xa3, 0x0e,
+    0x26, 0xe8, 0x3b, 0x2a, 0xc5, 0xb9, 0xe2, 0x9e,
+    0x1b, 0x16, 0x1e, 0x5c, 0x1f, 0xa7, 0x42, 0x5e,
+    0x73, 0x04, 0x33, 0x62, 0x93, 0x8b, 0x98, 0x24
+};
+
+extern int TPM2_IFX_GetCaps(WOLFTPM2_CAPS* caps);
+
+
+/*******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+static void bench_set(int id, int rc, int32_t value)
+{
+    mBenchValue[id] = (rc == 0) ? value : -1;
+    if (rc != 0) {
+        printf("Bench %s failed %d\n", mBenchNames[id], rc);
+    }
+}
+
+/* KB/s for bytes processed in cycles */
+static int32_t bench_kbps(uint32_t bytes, uint64_t cycles)
+{
+    uint32_t us = perf_cycles_to_us(cycles);
+    return (us > 0) ? (int32_t)(((uint64_t)bytes * 1000000 / 1024) / us) : -1;
+}
+
+/* average microseconds per operation */
+static int32_t bench_us(uint64_t cycles, uint32_t ops)
+{
+    return (int32_t)(perf_cycles_to_us(cycles) / ops);
+}
+
+static void bench_hash(bench_work_t* w)
+{
+    wc_Sha256 sha256;
+    wc_Sha384 sha384;
+    uint8_t digest[WC_SHA384_DIGEST_SIZE];
+    uint32_t start;
+    int i, rc;
+
+    start = perf_cycles();
+    rc = wc_InitSha256(&sha256);
+    for (i = 0; i < BENCH_BLOCKS && rc == 0; i++) {
+        rc = wc_Sha256Update(&sha256, w->block, BENCH_BLOCK_SZ);
+    }
+    if (rc == 0) {
+        rc = wc_Sha256Final(&sha256, digest);
+    }
+    wc_Sha256Free(&sha256);
+    bench_set(BENCH_SHA256, rc,
+        bench_kbps(BENCH_BLOCKS * BENCH_BLOCK_SZ, perf_cycles() - start));
+
+    start = perf_cycles();
+    rc = wc_InitSha384(&sha384);
+    for (i = 0; i < BENCH_BLOCKS && rc == 0; i++) {
+        rc = wc_Sha384Update(&sha384, w->block, BENCH_BLOCK_SZ);
+    }
+    if (rc == 0) {
+        rc = wc_Sha384Final(&sha384, digest);
+    }
+    wc_Sha384Free(&sha384);
+    bench_set(BENCH_SHA384, rc,
+        bench_kbps(BENCH_BLOCKS * BENCH_BLOCK_SZ, perf_cycles() - start));
+}
+
+/* AES-GCM encrypt (and decrypt if decId >= 0) of BENCH_BLOCK_SZ records */
+static void bench_aes_gcm(bench_work_t* w, uint32_t keySz, int encId,
+    int decId)
+{
+    static const uint8_t key[32] = {
+        0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+        0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10,
+        0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18,
+        0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20
+    };
+    uint8_t iv[GCM_NONCE_MID_SZ] = { 0 };
+    uint8_t tag[AES_BLOCK_SIZE];
+    uint32_t start;
+    int i, rc;
+
+    rc = wc_AesInit(&w->aes, NULL, INVALID_DEVID);
+    if (rc == 0) {
+        rc = wc_AesGcmSetKey(&w->aes, key, keySz);
+    }
+    start = perf_cycles();
+    for (i = 0; i < BENCH_BLOCKS && rc == 0; i++) {
+        rc = wc_AesGcmEncrypt(&w->aes, w->out, w->block, BENCH_BLOCK_SZ,
+            iv, sizeof(iv), tag, sizeof(tag), NULL, 0);
+    }
+    bench_set(encId, rc,
+        bench_kbps(BENCH_BLOCKS * BENCH_BLOCK_SZ, perf_cycles() - start));
+
+    if (decId >= 0) {
+        /* the last record back into the plain text */
+        start = perf_cycles();
+        for (i = 0; i < BENCH_BLOCKS && rc == 0; i++) {
+            rc = wc_AesGcmDecrypt(&w->aes, w->block, w->out, BENCH_BLOCK_SZ,
+                iv, sizeof(iv), tag, sizeof(tag), NULL, 0);
+        }
+        bench_set(decId, rc,
+            bench_kbps(BENCH_BLOCKS * BENCH_BLOCK_SZ, perf_cycles() - start));
+    }
+    wc_AesFree(&w->aes);
+}
+
+static void bench_ecc(bench_work_t* w)
+{
+    uint8_t secret[32];
+    uint8_t sig[80];
+    word32 secretSz, sigSz = 0;
+    uint64_t cycles = 0;
+    uint32_t start;
+    int i, rc, verified = 0;
+
+    rc = wc_ecc_init_ex(&w->key, NULL, BENCH_DEVID);
+    if (rc == 0) {
+        rc = wc_ecc_make_key(&w->rng, 32, &w->key);
+    }
+    if (rc == 0) {
+        rc = wc_ecc_set_rng(&w->key, &w->rng);
+    }
+
+    /* ephemeral keys */
+    for (i = 0; i < BENCH_OPS && rc == 0; i++) {
+        if (i > 0) {
+            wc_ecc_free(&w->peer);
+        }
+        rc = wc_ecc_init_ex(&w->peer, NULL, BENCH_DEVID);
+        start = perf_cycles();
+        if (rc == 0) {
+            rc = wc_ecc_make_key(&w->rng, 32, &w->peer);
+        }
+        cycles += perf_cycles() - start;
+    }
+    bench_set(BENCH_ECC_KEYGEN, rc, bench_us(cycles, BENCH_OPS));
+
+    cycles = 0;
+    for (i = 0; i < BENCH_OPS && rc == 0; i++) {
+        secretSz = sizeof(secret);
+        start = perf_cycles();
+        rc = wc_ecc_shared_secret(&w->key, &w->peer, secret, &secretSz);
+        cycles += perf_cycles() - start;
+    }
+    bench_set(BENCH_ECDHE, rc, bench_us(cycles, BENCH_OPS));
+
+    cycles = 0;
+    for (i = 0; i < BENCH_OPS && rc == 0; i++) {
+        sigSz = sizeof(sig);
+        start = perf_cycles();
+        rc = wc_ecc_sign_hash(mBenchHash, sizeof(mBenchHash), sig, &sigSz,
+            &w->rng, &w->key);
+        cycles += perf_cycles() - start;
+    }
+    bench_set(BENCH_ECDSA_SIGN, rc, bench_us(cycles, BENCH_OPS));
+
+    cycles = 0;
+    for (i = 0; i < BENCH_OPS && rc == 0; i++) {
+        start = perf_cycles();
+        rc = wc_ecc_verify_hash(sig, sigSz, mBenchHash, sizeof(mBenchHash),
+            &verified, &w->key);
+        cycles += perf_cycles() - start;
+        if (rc == 0 && !verified) {
+            rc = SIG_VERIFY_E;
+        }
+    }
+    bench_set(BENCH_ECDSA_VERIFY, rc, bench_us(cycles, BENCH_OPS));
+
+    wc_ecc_free(&w->peer);
+    wc_ecc_free(&w->key);
+}
+
+#ifdef BENCH_RSA
+static void bench_rsa(bench_work_t* w)
+{
+    uint8_t sig[256];
+    uint8_t plain[sizeof(mBenchHash)];
+    uint64_t cycles = 0;
+    uint32_t start;
+    word32 idx = 0;
+    int i, rc, sigSz = 0;
+
+    rc = wc_InitRsaKey_ex(&w->rsa, NULL, BENCH_DEVID);
+    if (rc == 0) {
+        rc = wc_RsaPrivateKeyDecode(client_key_der_2048, &idx, &w->rsa,
+            sizeof_client_key_der_2048);
+    }
+    if (rc == 0) {
+        rc = wc_RsaSetRNG(&w->rsa, &w->rng);
+    }
+
+    for (i = 0; i < BENCH_OPS && rc == 0; i++) {
+        start = perf_cycles();
+        sigSz = wc_RsaSSL_Sign(mBenchHash, sizeof(mBenchHash), sig,
+            sizeof(sig), &w->rsa, &w->rng);
+        cycles += perf_cycles() - start;
+        rc = (sigSz > 0) ? 0 : sigSz;
+    }
+    bench_set(BENCH_RSA_SIGN, rc, bench_us(cycles, BENCH_OPS));
+
+    cycles = 0;
+    for (i = 0; i < BENCH_OPS && rc == 0; i++) {
+        start = perf_cycles();
+        rc = wc_RsaSSL_Verify(sig, (word32)sigSz, plain, sizeof(plain),
+            &w->rsa);
+        cycles += perf_cycles() - start;
+        rc = (rc == (int)sizeof(plain)) ? 0 : SIG_VERIFY_E;
+    }
+    bench_set(BENCH_RSA_VERIFY, rc, bench_us(cycles, BENCH_OPS));
+
+    wc_FreeRsaKey(&w->rsa);
+}
+#endif
+
+/* The benchmark owns the TPMs (TPM2_IFX_OwnerTake) while device 0 is
+ * timed, so a firmware update is refused meanwhile and the TLS server key
+ * stays in software. Skipped if an update owns them. */
+static void bench_tpm(WOLFTPM2_DEV* dev)
+{
+    WOLFTPM2_CAPS caps;
+    WOLFTPM2_KEY key;
+    TPMT_PUBLIC tmpl;
+    uint8_t buf[64];
+    uint64_t cycles = 0;
+    uint32_t start;
+    int i, rc = 0, sigSz;
+
+    if (TPM2_IFX_OwnerTake(TPM_OWNER_BENCH) != TPM_OWNER_NONE) {
+        printf("Bench: TPM used by a firmware update, skipped\n");
+        return;
+    }
+    TPM2_IFX_DevLock(0);
+    for (i = 0; i < BENCH_OPS && rc == 0; i++) {
+        start = perf_cycles();
+        rc = wolfTPM2_GetCapabilities(dev, &caps);
+        cycles += perf_cycles() - start;
+    }
+    bench_set(BENCH_TPM_GET_CAPS, rc, bench_us(cycles, BENCH_OPS));
+
+    cycles = 0;
+    for (i = 0; i < BENCH_OPS && rc == 0; i++) {
+        start = perf_cycles();
+        rc = wolfTPM2_GetRandom(dev, buf, 32);
+        cycles += perf_cycles() - start;
+    }
+    bench_set(BENCH_TPM_GET_RANDOM, rc, bench_us(cycles, BENCH_OPS));
+
+    /* P-256 signing key, derived from the owner seed */
+    memset(&key, 0, sizeof(key));
+    rc = wolfTPM2_GetKeyTemplate_ECC(&tmpl,
+        TPMA_OBJECT_sign | TPMA_OBJECT_fixedTPM | TPMA_OBJECT_fixedParent |
+        TPMA_OBJECT_sensitiveDataOrigin | TPMA_OBJECT_userWithAuth |
+        TPMA_OBJECT_noDA, TPM_ECC_NIST_P256, TPM_ALG_ECDSA);
+    start = perf_cycles();
+    if (rc == 0) {
+        rc = wolfTPM2_CreatePrimaryKey(dev, &key, TPM_RH_OWNER, &tmpl,
+            NULL, 0);
+    }
+    bench_set(BENCH_TPM_CREATE_KEY, rc, bench_us(perf_cycles() - start, 1));
+
+    cycles = 0;
+    for (i = 0; i < BENCH_OPS && rc == 0; i++) {
+        sigSz = (int)sizeof(buf);
+        start = perf_cycles();
+        rc = wolfTPM2_SignHash(dev, &key, mBenchHash, sizeof(mBenchHash),
+            buf, &sigSz);
+        cycles += perf_cycles() - start;
+    }
+    bench_set(BENCH_TPM_SIGN, rc, bench_us(cycles, BENCH_OPS));
+
+    if (key.handle.hndl != 0) {
+        wolfTPM2_UnloadHandle(dev, &key.handle);
+    }
+    TPM2_IFX_DevUnlock();
+    TPM2_IFX_OwnerGive(TPM_OWNER_BENCH);
+}
+
+static int bench_tls_recv(WOLFSSL* ssl, char* buf, int sz, void* ctx)
+{
+    bench_pipe_t* pipe = (bench_pipe_t*)ctx;
+    (void)ssl;
+
+    if (pipe->len == 0) {
+        return WOLFSSL_CBIO_ERR_WANT_READ;
+    }
+    if (sz > pipe->len) {
+        sz = pipe->len;
+    }
+    memcpy(buf, pipe->buf, sz);
+    pipe->len -= sz;
+    memmove(pipe->buf, pipe->buf + sz, pipe->len);
+    return sz;
+}
+
+static int bench_tls_send(WOLFSSL* ssl, char* buf, int sz, void* ctx)
+{
+    bench_pipe_t* pipe = (bench_pipe_t*)ctx;
+    int room = (int)sizeof(pipe->buf) - pipe->len;
+    (void)ssl;
+
+    if (room == 0) {
+        return WOLFSSL_CBIO_ERR_WANT_WRITE;
+    }
+    if (sz > room) {
+        sz = room;
+    }
+    memcpy(pipe->buf + pipe->len, buf, sz);
+    pipe->len += sz;
+    return sz;
+}
+
+/* The example root CA may be out of its validity period and the board has
+ * no clock, accept date errors only */
+static int bench_tls_verify(int preverify, WOLFSSL_X509_STORE_CTX* store)
+{
+    if (!preverify && (store->error == ASN_AFTER_DATE_E ||
+            store->error == ASN_BEFORE_DATE_E)) {
+        return 1;
+    }
+    return preverify;
+}
+
+/* A client and a server connected through the two pipes */
+static int bench_tls_new(WOLFSSL_CTX* cliCtx, WOLFSSL_CTX* srvCtx,
+    WOLFSSL** cli, WOLFSSL** srv)
+{
+    mToServer.len = 0;
+    mToClient.len = 0;
+    *cli = wolfSSL_new(cliCtx);
+    *srv = wolfSSL_new(srvCtx);
+    if (*cli == NULL || *srv == NULL) {
+        return MEMORY_E;
+    }
+    wolfSSL_SetIOWriteCtx(*cli, &mToServer);
+    wolfSSL_SetIOReadCtx(*cli, &mToClient);
+    wolfSSL_SetIOWriteCtx(*srv, &mToClient);
+    wolfSSL_SetIOReadCtx(*srv, &mToServer);
+    return 0;
+}
+
+static int bench_tls_step(WOLFSSL* ssl, int rc, int* done)
+{
+    int err;
+
+    if (rc == WOLFSSL_SUCCESS) {
+        *done = 1;
+        return 0;
+    }
+    err = wolfSSL_get_error(ssl, rc);
+    return (err == WOLFSSL_ERROR_WANT_READ ||
+            err == WOLFSSL_ERROR_WANT_WRITE) ? 0 : err;
+}
+
+/* Runs the handshake, adds the time of both sides and of the server */
+static int bench_tls_handshake(WOLFSSL* cli, WOLFSSL* srv, uint64_t* total,
+    uint64_t* server)
+{
+    int cliDone = 0, srvDone = 0, rounds, rc = 0;
+    uint32_t start = perf_cycles(), srvStart;
+
+    for (rounds = 0; rounds < BENCH_TLS_ROUNDS && rc == 0 &&
+            !(cliDone && srvDone); rounds++) {
+        if (!cliDone) {
+            rc = bench_tls_step(cli, wolfSSL_connect(cli), &cliDone);
+        }
+        if (rc == 0 && !srvDone) {
+            srvStart = perf_cycles();
+            rc = bench_tls_step(srv, wolfSSL_accept(srv), &srvDone);
+            *server += perf_cycles() - srvStart;
+        }
+    }
+    *total += perf_cycles() - start;
+    if (rc == 0 && !(cliDone && srvDone)) {
+        rc = WC_TIMEOUT_E;
+    }
+    return rc;
+}
+
+static void bench_tls(void)
+{
+    WOLFSSL_CTX* cliCtx;
+    WOLFSSL_CTX* srvCtx;
+    WOLFSSL* cli = NULL;
+    WOLFSSL* srv = NULL;
+    WOLFSSL* cli2 = NULL;
+    WOLFSSL* srv2 = NULL;
+    uint64_t full = 0, fullSrv = 0, res = 0, resSrv = 0;
+    int i, rc = 0, rcRes = 0;
+    uint8_t b;
+
+    srvCtx = wolfSSL_CTX_new(wolfTLSv1_3_server_method());
+    cliCtx = wolfSSL_CTX_new(wolfTLSv1_3_client_method());
+    if (srvCtx == NULL || cliCtx == NULL) {
+        rc = MEMORY_E;
+    }
+    if (rc == 0 && (wolfSSL_CTX_SetDevId(srvCtx, BENCH_DEVID) !=
+            WOLFSSL_SUCCESS ||
+            wolfSSL_CTX_SetDevId(cliCtx, BENCH_DEVID) != WOLFSSL_SUCCESS)) {
+        rc = BAD_FUNC_ARG;
+    }
+    if (rc == 0 && wolfSSL_CTX_use_certificate_buffer(srvCtx,
+            (const uint8_t*)keySERVER_CERTIFICATE_PEM,
+            sizeof(keySERVER_CERTIFICATE_PEM) - 1,
+            WOLFSSL_FILETYPE_PEM) != WOLFSSL_SUCCESS) {
+        rc = BAD_FUNC_ARG;
+    }
+    if (rc == 0 && wolfSSL_CTX_use_PrivateKey_buffer(srvCtx,
+            (const uint8_t*)keySERVER_PRIVATE_KEY_PEM,
+            sizeof(keySERVER_PRIVATE_KEY_PEM) - 1,
+            WOLFSSL_FILETYPE_PEM) != WOLFSSL_SUCCESS) {
+        rc = BAD_FUNC_ARG;
+    }
+    if (rc == 0 && wolfSSL_CTX_load_verify_buffer(cliCtx,
+            (const uint8_t*)keyCLIENT_ROOTCA_PEM,
+            sizeof(keyCLIENT_ROOTCA_PEM) - 1,
+            WOLFSSL_FILETYPE_PEM) != WOLFSSL_SUCCESS) {
+        rc = BAD_FUNC_ARG;
+    }
+    if (rc == 0) {
+        wolfSSL_CTX_set_verify(cliCtx, WOLFSSL_VERIFY_PEER, bench_tls_verify);
+        wolfSSL_CTX_SetIORecv(cliCtx, bench_tls_recv);
+        wolfSSL_CTX_SetIOSend(cliCtx, bench_tls_send);
+        wolfSSL_CTX_SetIORecv(srvCtx, bench_tls_recv);
+        wolfSSL_CTX_SetIOSend(srvCtx, bench_tls_send);
+    }
+
+    for (i = 0; i < BENCH_OPS && rc == 0 && rcRes == 0; i++) {
+        rc = bench_tls_new(cliCtx, srvCtx, &cli, &srv);
+        if (rc == 0) {
+            rc = bench_tls_handshake(cli, srv, &full, &fullSrv);
+        }
+        if (rc == 0) {
+            /* the client takes the session ticket sent after the handshake */
+            (void)wolfSSL_read(cli, &b, 1);
+            rcRes = bench_tls_new(cliCtx, srvCtx, &cli2, &srv2);
+        }
+        if (rc == 0 && rcRes == 0 && wolfSSL_set_session(cli2,
+                wolfSSL_get_session(cli)) != WOLFSSL_SUCCESS) {
+            rcRes = BAD_FUNC_ARG;
+        }
+        if (rc == 0 && rcRes == 0) {
+            rcRes = bench_tls_handshake(cli2, srv2, &res, &resSrv);
+        }
+        if (rc == 0 && rcRes == 0 && !wolfSSL_session_reused(cli2)) {
+            /* full handshake again, no ticket */
+            rcRes = BAD_STATE_E;
+        }
+        wolfSSL_free(srv2);
+        wolfSSL_free(cli2);
+        wolfSSL_free(srv);
+        wolfSSL_free(cli);
+        srv2 = cli2 = srv = cli = NULL;
+    }
+    bench_set(BENCH_TLS_FULL, rc, bench_us(full, BENCH_OPS));
+    bench_set(BENCH_TLS_FULL_SERVER, rc, bench_us(fullSrv, BENCH_OPS));
+    rcRes = (rc != 0) ? rc : rcRes;
+    bench_set(BENCH_TLS_RESUME, rcRes, bench_us(res, BENCH_OPS));
+    bench_set(BENCH_TLS_RESUME_SERVER, rcRes, bench_us(resSrv, BENCH_OPS));
+
+    wolfSSL_CTX_free(cliCtx);
+    wolfSSL_CTX_free(srvCtx);
+}
+
+static void bench_run(void)
+{
+    bench_work_t* w;
+    char json[MAX_HTTP_RESPONSE_LENGTH];
+    int i, rc;
+
+    for (i = 0; i < BENCH_COUNT; i++) {
+        mBenchValue[i] = -1;
+    }
+
+    w = (bench_work_t*)malloc(sizeof(*w));
+    rc = (w != NULL) ? wc_InitRng(&w->rng) : MEMORY_E;
+    if (rc == 0) {
+        memset(w->block, 0x5a, sizeof(w->block));
+        bench_hash(w);
+        bench_aes_gcm(w, 16, BENCH_AES128_GCM_ENC, BENCH_AES128_GCM_DEC);
+        bench_aes_gcm(w, 32, BENCH_AES256_GCM_ENC, -1);
+        bench_ecc(w);
+    #ifdef BENCH_RSA
+        bench_rsa(w);
+    #endif
+        wc_FreeRng(&w->rng);
+    }
+    else {
+        printf("Bench init failed %d\n", rc);
+    }
+    free(w);
+
+    if (mBenchTpm) {
+        bench_tpm(mBenchDev);
+    }
+    bench_tls();
+
+    mBenchRuns++;
+    mBenchState = BENCH_STATE_DONE;
+    printf("Bench: %s\n", bench_report(json, sizeof(json)));
+}
+
+static void bench_task(void* arg)
+{
+    (void)arg;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        bench_run();
+    }
+}
+
+
+/*******************************************************************************
+ * Public Functions
+ ******************************************************************************/
+/* Creates the benchmark task, call once the TPM and wolfSSL are ready */
+cy_rslt_t bench_init(WOLFTPM2_DEV* dev)
+{
+    mBenchDev = dev;
+    mBenchTask = xTaskCreateStatic(bench_task, "Bench",
+        BENCH_TASK_STACK_SIZE, NULL, BENCH_TASK_PRIORITY, mBenchTaskStack,
+        &mBenchTaskBuf);
+    if (mBenchTask == NULL) {
+        return CY_RSLT_TYPE_ERROR;
+    }
+#if BENCH_AT_BOOT
+    bench_start(1);
+#endif
+    return CY_RSLT_SUCCESS;
+}
+
+/* Starts a run, with the TPM commands if tpm is set. Returns -1 if a run
+ * is in progress. */
+int bench_start(int tpm)
+{
+    if (mBenchTask == NULL || mBenchState == BENCH_STATE_RUNNING) {
+        return -1;
+    }
+    mBenchTpm = tpm && (mBenchDev != NULL);
+    mBenchState = BENCH_STATE_RUNNING;
+    xTaskNotifyGive(mBenchTask);
+    return 0;
+}
+
+/* The results of the last run as a JSON object, null where a benchmark did
+ * not run or failed */
+const char* bench_report(char* buf, size_t bufSz)
+{
+    static const char* const states[] = { "idle", "running", "done" };
+    WOLFTPM2_CAPS caps;
+    size_t pos = 0;
+    int i, len;
+
+    memset(&caps, 0, sizeof(caps));
+    (void)TPM2_IFX_GetCaps(&caps);
+    len = snprintf(buf, bufSz,
+        "{\"state\":\"%s\",\"runs\":%lu,\"cpuHz\":%lu,\"build\":\"%s\","
+        "\"profile\":\"%s\",\"tpmFw\":\"%u.%u\"",
+        states[mBenchState], (unsigned long)mBenchRuns,
+        (unsigned long)SystemCoreClock, BUILD_PROFILE_NAME,
+    #ifdef CRYPTO_PROFILE_FAST
+        "fast",
+    #else
+        "small",
+    #endif
+        caps.fwVerMajor, caps.fwVerMinor);
+    if (len > 0) {
+        pos = (size_t)len;
+    }
+    for (i = 0; i < BENCH_COUNT && mBenchRuns > 0 && pos < bufSz; i++) {
+        if (mBenchValue[i] < 0) {
+            len = snprintf(buf + pos, bufSz - pos, ",\"%s\":null",
+                mBenchNames[i]);
+        }
+        else {
+            len = snprintf(buf + pos, bufSz - pos, ",\"%s\":%ld",
+                mBenchNames[i], (long)mBenchValue[i]);
+        }
+        if (len > 0) {
+            pos += len;
+        }
+    }
+    if (pos + 2 <= bufSz) {
+        buf[pos++] = '}';
+        buf[pos] = '\0';
+    }
+    return buf;
+}
+
+#endif /* BENCH */
+
+/* [] END OF FILE */
@@ -0,0 +1,81 @@
+/******************************************************************************
+* File Name: bench.h
+*
+* Description: This file contains the on-device benchmark of the wolfCrypt
+* algorithms, the TPM commands and the TLS v1.3 handshake, served as JSON on
+* /bench.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "cy_result.h"
+
+#include <wolftpm/tpm2_wrap.h>
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* run the benchmark once when the server has started */
+#ifndef BENCH_AT_BOOT
+#define BENCH_AT_BOOT               (0)
+#endif
+
+/* hashes and ciphers: BENCH_BLOCKS blocks of BENCH_BLOCK_SZ bytes */
+#define BENCH_BLOCK_SZ              (1024)
+#define BENCH_BLOCKS                (64)
+
+/* operations averaged for each public key, TPM and TLS result */
+#define BENCH_OPS                   (4)
+
+/* one direction of the in-memory TLS connection */
+#define BENCH_TLS_BUF_SZ            (4096)
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+cy_rslt_t bench_init(WOLFTPM2_DEV* dev);
+int bench_start(int tpm);
+const char* bench_report(char* buf, size_t bufSz);
+
+#endif /* BENCH_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,172 @@
+/******************************************************************************
+* File Name: boot.c
+*
+* Description: This file contains the boot phase events and timestamps. The
+*              TPM bring-up, the Wi-Fi join and the HTTPS server setup run on
+*              their own tasks (PARALLEL_BOOT) and signal an event group when
+*              done. Each phase is timestamped in milliseconds since reset:
+*              from the cycle counter before the scheduler starts, then from
+*              the tick count.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+
+#include "cyhal.h"
+#include <FreeRTOS.h>
+#include <task.h>
+#include <event_groups.h>
+
+#include "perf_stats.h"
+#include "boot.h"
+
+
+/*******************************************************************************
+ * Data Types
+ ******************************************************************************/
+typedef struct {
+    const char* phase;
+    uint32_t    ms;
+} boot_mark_t;
+
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static EventGroupHandle_t mBootEvents;
+static StaticEventGroup_t mBootEventsBuf;
+static cy_rslt_t mBootResult[BOOT_EVENT_COUNT];
+
+static boot_mark_t mBootMarks[BOOT_MAX_MARKS];
+static int mBootMarkCount;
+/* time at the scheduler start, the tick count starts from there */
+static uint32_t mBootSchedMs;
+
+
+/*******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+static uint32_t boot_ms(void)
+{
+    if (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) {
+        /* cycle counter since perf_init, early in main */
+        return perf_cycles_to_us(perf_cycles()) / 1000;
+    }
+    return mBootSchedMs + xTaskGetTickCount() * portTICK_PERIOD_MS;
+}
+
+
+/*******************************************************************************
+ * Public Functions
+ ******************************************************************************/
+/* call in main, before the boot tasks are created */
+void boot_init(void)
+{
+    mBootEvents = xEventGroupCreateStatic(&mBootEventsBuf);
+}
+
+/* Records a timestamp for phase (a string literal) and prints it */
+void boot_mark(const char* phase)
+{
+    uint32_t ms = boot_ms();
+    int sched = (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED);
+
+    if (!sched) {
+        /* the last mark before the scheduler starts is the tick base */
+        mBootSchedMs = ms;
+    }
+    else {
+        taskENTER_CRITICAL();
+    }
+    if (mBootMarkCount < BOOT_MAX_MARKS) {
+        mBootMarks[mBootMarkCount].phase = phase;
+        mBootMarks[mBootMarkCount].ms = ms;
+        mBootMarkCount++;
+    }
+    if (sched) {
+        taskEXIT_CRITICAL();
+    }
+
+    printf("Boot %5lu ms: %s\n", (unsigned long)ms, phase);
+}
+
+/* Signals that a boot phase is done, with its result */
+void boot_done(EventBits_t event, cy_rslt_t result)
+{
+    int i;
+
+    for (i = 0; i < BOOT_EVENT_COUNT; i++) {
+        if (event & (1u << i)) {
+            mBootResult[i] = result;
+        }
+    }
+    xEventGroupSetBits(mBootEvents, event);
+}
+
+/* Waits for the boot phases and returns the first failed result */
+cy_rslt_t boot_wait(EventBits_t events)
+{
+    int i;
+
+    xEventGroupWaitBits(mBootEvents, events, pdFALSE, pdTRUE, portMAX_DELAY);
+    for (i = 0; i < BOOT_EVENT_COUNT; i++) {
+        if ((events & (1u << i)) && mBootResult[i] != CY_RSLT_SUCCESS) {
+            return mBootResult[i];
+        }
+    }
+    return CY_RSLT_SUCCESS;
+}
+
+const char* boot_report(char* buf, size_t bufSz)
+{
+    size_t pos = 0;
+    int i, len;
+
+    buf[0] = '\0';
+    for (i = 0; i < mBootMarkCount && pos < bufSz; i++) {
+        len = snprintf(buf + pos, bufSz - pos, "%5lu ms: %s\r\n",
+            (unsigned long)mBootMarks[i].ms, mBootMarks[i].phase);
+        if (len > 0) {
+            pos += len;
+        }
+    }
+    return buf;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,75 @@
+/******************************************************************************
+* File Name: boot.h
+*
+* Description: This file contains the boot phase events and timestamps used
+* to run the TPM, Wi-Fi and TLS bring-up in parallel.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef BOOT_H_
+#define BOOT_H_
+
+#include <stddef.h>
+#include "cy_result.h"
+#include <FreeRTOS.h>
+#include <event_groups.h>
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* boot phases, set when done */
+#define BOOT_EVENT_TPM              (1u << 0) /* TPM initialized, info read */
+#define BOOT_EVENT_NET              (1u << 1) /* network stack (cy_wcm_init) */
+#define BOOT_EVENT_WIFI             (1u << 2) /* joined the AP, IP assigned */
+#define BOOT_EVENT_COUNT            (3)
+
+/* timestamps kept for the boot report */
+#define BOOT_MAX_MARKS              (16)
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+void boot_init(void);
+void boot_mark(const char* phase);
+void boot_done(EventBits_t event, cy_rslt_t result);
+cy_rslt_t boot_wait(EventBits_t events);
+const char* boot_report(char* buf, size_t bufSz);
+
+#endif /* BOOT_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,256 @@
+/******************************************************************************
+* File Name: cpu_stats.c
+*
+* Description: This file contains the CPU profiling build mode (CPU_STATS).
+*              The FreeRTOS run time counter is the DWT cycle counter,
+*              extended to 64 bits and scaled down by CPU_STATS_SHIFT. The
+*              context switches are counted per task from the
+*              traceTASK_SWITCHED_IN hook and the hot handlers are timed as
+*              sections. Each /stats/cpu report covers the time since the
+*              previous one.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+
+#include "cyhal.h"
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include "perf_stats.h"
+#include "cpu_stats.h"
+
+#ifdef CPU_STATS
+
+/*******************************************************************************
+ * Data Types
+ ******************************************************************************/
+typedef struct {
+    uint64_t cycles;
+    uint32_t count;
+    uint32_t max;
+} cpu_section_t;
+
+/* counters at the previous report */
+typedef struct {
+    UBaseType_t number;
+    uint32_t    runTime;
+    uint32_t    switches;
+} cpu_task_prev_t;
+
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static uint64_t mCpuCycles;
+static uint32_t mCpuLast;
+
+static uint32_t mSwitches[CPU_STATS_SWITCH_SLOTS];
+static uint32_t mSwitchTotal;
+
+static cpu_section_t mSections[CPU_SECTION_COUNT];
+static const char* const mSectionNames[CPU_SECTION_COUNT] = {
+    "/tpm handler", "other handlers", "mdns_recv", "TPM2_IFX_FwData_Cb"
+};
+
+static cpu_task_prev_t mPrev[CPU_STATS_MAX_TASKS];
+static int mPrevCount;
+static uint32_t mPrevTotal;
+static uint32_t mPrevSwitchTotal;
+
+
+/*******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+static const cpu_task_prev_t* cpu_stats_prev(UBaseType_t number)
+{
+    int i;
+    for (i = 0; i < mPrevCount; i++) {
+        if (mPrev[i].number == number) {
+            return &mPrev[i];
+        }
+    }
+    return NULL;
+}
+
+
+/*******************************************************************************
+ * Public Functions
+ ******************************************************************************/
+/* portCONFIGURE_TIMER_FOR_RUN_TIME_STATS, from vTaskStartScheduler */
+void cpu_stats_timer_init(void)
+{
+    perf_init();
+    mCpuLast = perf_cycles();
+}
+
+/* portGET_RUN_TIME_COUNTER_VALUE: called at every context switch, so the
+ * 32-bit cycle counter never wraps twice between two calls */
+uint32_t cpu_stats_counter(void)
+{
+    UBaseType_t state = taskENTER_CRITICAL_FROM_ISR();
+    uint32_t now = perf_cycles();
+
+    mCpuCycles += (uint32_t)(now - mCpuLast);
+    mCpuLast = now;
+    taskEXIT_CRITICAL_FROM_ISR(state);
+    return (uint32_t)(mCpuCycles >> CPU_STATS_SHIFT);
+}
+
+/* traceTASK_SWITCHED_IN, from vTaskSwitchContext with interrupts masked */
+void cpu_stats_switched_in(uint32_t taskNumber)
+{
+    mSwitches[taskNumber % CPU_STATS_SWITCH_SLOTS]++;
+    mSwitchTotal++;
+}
+
+uint32_t cpu_trace_enter(void)
+{
+    return perf_cycles();
+}
+
+/* Adds a section time: elapsed, including the time other tasks run */
+void cpu_trace_exit(int section, uint32_t start)
+{
+    uint32_t cycles = perf_cycles() - start;
+    cpu_section_t* sec = &mSections[section];
+
+    taskENTER_CRITICAL();
+    sec->cycles += cycles;
+    sec->count++;
+    if (cycles > sec->max) {
+        sec->max = cycles;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/* The status array is sized for the tasks there are, with room for a few
+ * created meanwhile: uxTaskGetSystemState returns none if they do not all
+ * fit */
+const char* cpu_stats_report(char* buf, size_t bufSz)
+{
+    TaskStatus_t* tasks;
+    cpu_section_t sections[CPU_SECTION_COUNT];
+    const cpu_task_prev_t* prev;
+    uint32_t* switches;
+    uint32_t total = 0, elapsed, switchTotal, run, sw;
+    UBaseType_t size, count = 0, i;
+    size_t pos = 0;
+    int len;
+
+    size = uxTaskGetNumberOfTasks() + 2;
+    tasks = (TaskStatus_t*)pvPortMalloc(size *
+        (sizeof(*tasks) + sizeof(*switches)));
+    if (tasks == NULL) {
+        snprintf(buf, bufSz, "CPU stats: out of memory\r\n");
+        return buf;
+    }
+    switches = (uint32_t*)&tasks[size];
+    count = uxTaskGetSystemState(tasks, size, &total);
+    if (count == 0) {
+        vPortFree(tasks);
+        snprintf(buf, bufSz, "CPU stats: tasks not sampled\r\n");
+        return buf;
+    }
+    taskENTER_CRITICAL();
+    for (i = 0; i < count; i++) {
+        switches[i] = mSwitches[tasks[i].xTaskNumber % CPU_STATS_SWITCH_SLOTS];
+    }
+    switchTotal = mSwitchTotal;
+    memcpy(sections, mSections, sizeof(sections));
+    taskEXIT_CRITICAL();
+
+    elapsed = total - mPrevTotal;
+    len = snprintf(buf, bufSz,
+        "CPU over %lu ms, %lu context switches\r\n"
+        "  Task              CPU%%  switches\r\n",
+        (unsigned long)perf_cycles_to_us((uint64_t)elapsed << CPU_STATS_SHIFT) / 1000,
+        (unsigned long)(switchTotal - mPrevSwitchTotal));
+    if (len > 0) {
+        pos = (size_t)len;
+    }
+    for (i = 0; i < count && pos < bufSz; i++) {
+        prev = cpu_stats_prev(tasks[i].xTaskNumber);
+        run = tasks[i].ulRunTimeCounter - (prev ? prev->runTime : 0);
+        sw = switches[i] - (prev ? prev->switches : 0);
+        /* tenths of a percent */
+        run = (elapsed > 0) ? (uint32_t)(((uint64_t)run * 1000) / elapsed) : 0;
+        len = snprintf(buf + pos, bufSz - pos, "  %-16s %3lu.%lu %9lu\r\n",
+            tasks[i].pcTaskName, (unsigned long)(run / 10),
+            (unsigned long)(run % 10), (unsigned long)sw);
+        if (len > 0) {
+            pos += len;
+        }
+    }
+    for (i = 0; i < CPU_SECTION_COUNT && pos < bufSz; i++) {
+        len = snprintf(buf + pos, bufSz - pos,
+            "%s%-20s %6lu calls, %8lu us total, %6lu us max\r\n",
+            (i == 0) ? "Sections (since boot):\r\n" : "", mSectionNames[i],
+            (unsigned long)sections[i].count,
+            (unsigned long)perf_cycles_to_us(sections[i].cycles),
+            (unsigned long)perf_cycles_to_us(sections[i].max));
+        if (len > 0) {
+            pos += len;
+        }
+    }
+
+    if (count > CPU_STATS_MAX_TASKS && pos < bufSz) {
+        (void)snprintf(buf + pos, bufSz - pos, "  (more tasks than "
+            "CPU_STATS_MAX_TASKS, the rest are counted since boot)\r\n");
+    }
+
+    /* the next report starts here */
+    if (count > CPU_STATS_MAX_TASKS) {
+        count = CPU_STATS_MAX_TASKS;
+    }
+    for (i = 0; i < count; i++) {
+        mPrev[i].number = tasks[i].xTaskNumber;
+        mPrev[i].runTime = tasks[i].ulRunTimeCounter;
+        mPrev[i].switches = switches[i];
+    }
+    mPrevCount = (int)count;
+    mPrevTotal = total;
+    mPrevSwitchTotal = switchTotal;
+    vPortFree(tasks);
+    return buf;
+}
+
+#endif /* CPU_STATS */
+
+/* [] END OF FILE */
@@ -0,0 +1,90 @@
+/******************************************************************************
+* File Name: cpu_stats.h
+*
+* Description: This file contains the CPU profiling build mode (CPU_STATS):
+* the FreeRTOS run time counter, context switch counts and timed sections
+* around the hot handlers, served on /stats/cpu.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef CPU_STATS_H_
+#define CPU_STATS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* tasks whose counters are kept for the next report, the report says so
+ * if there are more */
+#ifndef CPU_STATS_MAX_TASKS
+#define CPU_STATS_MAX_TASKS         (24)
+#endif
+
+/* context switch counters, by FreeRTOS task number modulo this size */
+#define CPU_STATS_SWITCH_SLOTS      (32)
+
+/* run time counter unit: 2^CPU_STATS_SHIFT cycles, so the 32-bit counter
+ * wraps after about an hour at 150 MHz */
+#define CPU_STATS_SHIFT             (7)
+
+/* timed sections */
+#define CPU_SECTION_TPM_PAGE        (0) /* dynamic_resource_handler */
+#define CPU_SECTION_HTTP            (1) /* the other resource handlers */
+#define CPU_SECTION_MDNS            (2) /* mdns_recv */
+#define CPU_SECTION_FW_DATA         (3) /* TPM2_IFX_FwData_Cb */
+#define CPU_SECTION_COUNT           (4)
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+#ifdef CPU_STATS
+/* FreeRTOSConfig.h run time stats and trace hooks */
+void cpu_stats_timer_init(void);
+uint32_t cpu_stats_counter(void);
+void cpu_stats_switched_in(uint32_t taskNumber);
+
+uint32_t cpu_trace_enter(void);
+void cpu_trace_exit(int section, uint32_t start);
+const char* cpu_stats_report(char* buf, size_t bufSz);
+#endif
+
+#endif /* CPU_STATS_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,495 @@
+/******************************************************************************
+* File Name: fw_stage.c
+*
+* Description: This file contains the firmware staging area in the external
+* QSPI NOR flash. The manifest and the firmware data are written there while
+* they are received, hashed on the way in and read back and hashed again at
+* the end. The header with the sizes and the hash is written last, so only a
+* complete and verified image is ever reported as staged.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "cyhal.h"
+#include "cybsp.h"
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+
+#include "secure_http_server.h"
+#include "fw_stage.h"
+
+#ifdef FW_STAGE
+
+#include "cy_serial_flash_qspi.h"
+#include "cycfg_qspi_memslot.h"
+
+#include <wolfssl/wolfcrypt/settings.h>
+#include <wolfssl/wolfcrypt/sha256.h>
+
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define FW_STAGE_MAGIC              (0x54535746UL) /* "FWST" */
+
+/* header (sector 0), manifest (sector 1), data (from sector 2) */
+#define FW_STAGE_HDR_ADDR           (mBase)
+#define FW_STAGE_MANIFEST_ADDR      (mBase + mSector)
+#define FW_STAGE_DATA_ADDR          (mBase + 2 * mSector)
+
+
+/*******************************************************************************
+ * Type Definitions
+ ******************************************************************************/
+typedef struct {
+    uint32_t magic;
+    uint32_t manifestSz;
+    uint32_t dataSz;
+    uint8_t  sha256[FW_STAGE_HASH_SZ];
+} fw_stage_hdr_t;
+
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static SemaphoreHandle_t mLock;
+static StaticSemaphore_t mLockBuf;
+static int mReady;
+static uint32_t mBase;
+static uint32_t mSector;        /* erase size */
+static uint32_t mDataMax;
+static fw_stage_hdr_t mHdr;     /* staged image, magic 0 if none */
+
+/* the image being written */
+static int mPart = -1;
+static uint32_t mAddr;          /* next write */
+static uint32_t mErased;        /* end of the erased range */
+static uint32_t mLeft;
+static uint32_t mManifestSz;    /* received, 0 until the part ends */
+static uint32_t mDataSz;
+static wc_Sha256 mSha;
+static int mShaOpen;
+
+static uint8_t mBuf[FW_STAGE_READ_SZ];
+
+
+/*******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+/* erases ahead of a write, sector by sector */
+static int fw_stage_erase(uint32_t end)
+{
+    while (mErased < end) {
+        if (cy_serial_flash_qspi_erase(mErased, mSector) != CY_RSLT_SUCCESS) {
+            return FW_STAGE_FLASH_ERROR;
+        }
+        mErased += mSector;
+    }
+    return FW_STAGE_SUCCESS;
+}
+
+/* hashes flash contents in FW_STAGE_READ_SZ blocks */
+static int fw_stage_hash_flash(wc_Sha256* sha, uint32_t addr, uint32_t sz)
+{
+    uint32_t len;
+
+    while (sz > 0) {
+        len = (sz < sizeof(mBuf)) ? sz : sizeof(mBuf);
+        if (cy_serial_flash_qspi_read(addr, len, mBuf) != CY_RSLT_SUCCESS) {
+            return FW_STAGE_FLASH_ERROR;
+        }
+        if (wc_Sha256Update(sha, mBuf, len) != 0) {
+            return FW_STAGE_FLASH_ERROR;
+        }
+        addr += len;
+        sz -= len;
+    }
+    return FW_STAGE_SUCCESS;
+}
+
+/* reads the staged image back and compares its hash */
+static int fw_stage_check(uint32_t manifestSz, uint32_t dataSz,
+    const uint8_t* expect)
+{
+    wc_Sha256 sha;
+    uint8_t digest[FW_STAGE_HASH_SZ];
+    int rc;
+
+    if (wc_InitSha256(&sha) != 0) {
+        return FW_STAGE_FLASH_ERROR;
+    }
+    rc = fw_stage_hash_flash(&sha, FW_STAGE_MANIFEST_ADDR, manifestSz);
+    if (rc == FW_STAGE_SUCCESS)
+        rc = fw_stage_hash_flash(&sha, FW_STAGE_DATA_ADDR, dataSz);
+    if (rc == FW_STAGE_SUCCESS && wc_Sha256Final(&sha, digest) != 0)
+        rc = FW_STAGE_FLASH_ERROR;
+    wc_Sha256Free(&sha);
+    if (rc == FW_STAGE_SUCCESS &&
+            memcmp(digest, expect, FW_STAGE_HASH_SZ) != 0) {
+        rc = FW_STAGE_HASH_MISMATCH;
+    }
+    return rc;
+}
+
+static void fw_stage_abort(void)
+{
+    if (mShaOpen) {
+        wc_Sha256Free(&mSha);
+    }
+    mShaOpen = 0;
+    mPart = -1;
+    mManifestSz = 0;
+}
+
+
+/*******************************************************************************
+ * Function Name: fw_stage_init
+ *******************************************************************************
+ * Summary:
+ *  Initializes the QSPI flash and loads the header of a staged image.
+ *
+ * Return:
+ *  cy_rslt_t - CY_RSLT_SUCCESS, or the serial flash error.
+ *
+ *******************************************************************************/
+cy_rslt_t fw_stage_init(void)
+{
+    cy_rslt_t result;
+    uint32_t size;
+
+    if (mLock == NULL) {
+        mLock = xSemaphoreCreateMutexStatic(&mLockBuf);
+    }
+
+    result = cy_serial_flash_qspi_init(smifMemConfigs[0], CYBSP_QSPI_D0,
+        CYBSP_QSPI_D1, CYBSP_QSPI_D2, CYBSP_QSPI_D3, NC, NC, NC, NC,
+        CYBSP_QSPI_SCK, CYBSP_QSPI_SS, FW_STAGE_QSPI_HZ);
+    if (result != CY_RSLT_SUCCESS) {
+        ERR_INFO(("QSPI flash init failed 0x%lx\n", (unsigned long)result));
+        return result;
+    }
+
+    size = cy_serial_flash_qspi_get_size();
+#ifdef FW_STAGE_ADDR
+    mBase = FW_STAGE_ADDR;
+#else
+    mBase = size - FW_STAGE_SIZE;
+#endif
+    mSector = cy_serial_flash_qspi_get_erase_size(mBase);
+    if (mSector == 0 || FW_STAGE_SIZE > size || mBase > size - FW_STAGE_SIZE ||
+            (mBase % mSector) != 0 || FW_STAGE_SIZE <= 2 * mSector) {
+        ERR_INFO(("Firmware staging area does not fit the flash (%lu bytes, "
+                  "%lu byte sectors)\n", (unsigned long)size,
+                  (unsigned long)mSector));
+        return CY_RSLT_TYPE_ERROR;
+    }
+    mDataMax = FW_STAGE_SIZE - 2 * mSector;
+
+    result = cy_serial_flash_qspi_read(FW_STAGE_HDR_ADDR, sizeof(mHdr),
+        (uint8_t*)&mHdr);
+    if (result != CY_RSLT_SUCCESS || mHdr.magic != FW_STAGE_MAGIC ||
+            mHdr.manifestSz > mSector || mHdr.dataSz > mDataMax) {
+        memset(&mHdr, 0, sizeof(mHdr));
+    }
+    mReady = 1;
+
+    APP_INFO(("Firmware staging area 0x%lx, %lu KB, %s\n",
+        (unsigned long)mBase, (unsigned long)(FW_STAGE_SIZE / 1024),
+        mHdr.magic ? "image staged" : "empty"));
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: fw_stage_begin
+ *******************************************************************************
+ * Summary:
+ *  Starts writing one part of an image. The manifest comes first and drops
+ *  the staged image, the data must follow it.
+ *
+ * Parameters:
+ *  part - FW_STAGE_MANIFEST or FW_STAGE_DATA.
+ *  sz - Size of the part.
+ *
+ * Return:
+ *  int - FW_STAGE_SUCCESS, otherwise FW_STAGE_BAD_ARG (no manifest, too
+ *  large) or FW_STAGE_FLASH_ERROR.
+ *
+ *******************************************************************************/
+int fw_stage_begin(int part, size_t sz)
+{
+    int rc = FW_STAGE_SUCCESS;
+
+    if (!mReady || sz == 0) {
+        return FW_STAGE_BAD_ARG;
+    }
+    xSemaphoreTake(mLock, portMAX_DELAY);
+    if (part == FW_STAGE_MANIFEST) {
+        fw_stage_abort();
+        if (sz > mSector) {
+            rc = FW_STAGE_BAD_ARG;
+        }
+        else {
+            /* the header goes first, the old image is lost from here */
+            memset(&mHdr, 0, sizeof(mHdr));
+            mErased = FW_STAGE_HDR_ADDR;
+            rc = fw_stage_erase(FW_STAGE_DATA_ADDR);
+        }
+        if (rc == FW_STAGE_SUCCESS && wc_InitSha256(&mSha) != 0)
+            rc = FW_STAGE_FLASH_ERROR;
+        if (rc == FW_STAGE_SUCCESS) {
+            mShaOpen = 1;
+            mAddr = FW_STAGE_MANIFEST_ADDR;
+        }
+    }
+    else if (part == FW_STAGE_DATA && mPart < 0 && mManifestSz > 0 &&
+            sz <= mDataMax) {
+        /* the manifest part left the hash open */
+        mAddr = FW_STAGE_DATA_ADDR;
+        mErased = FW_STAGE_DATA_ADDR;
+    }
+    else {
+        fw_stage_abort();
+        rc = FW_STAGE_BAD_ARG;
+    }
+    if (rc == FW_STAGE_SUCCESS) {
+        mPart = part;
+        mLeft = sz;
+    }
+    xSemaphoreGive(mLock);
+    return rc;
+}
+
+/*******************************************************************************
+ * Function Name: fw_stage_write
+ *******************************************************************************
+ * Summary:
+ *  Writes the next bytes of the part, erasing ahead of them.
+ *
+ * Return:
+ *  int - FW_STAGE_SUCCESS, otherwise FW_STAGE_BAD_ARG (more than the size
+ *  given to fw_stage_begin) or FW_STAGE_FLASH_ERROR. An error ends the part.
+ *
+ *******************************************************************************/
+int fw_stage_write(const uint8_t* data, size_t sz)
+{
+    int rc;
+
+    if (!mReady) {
+        return FW_STAGE_BAD_ARG;
+    }
+    xSemaphoreTake(mLock, portMAX_DELAY);
+    if (mPart < 0 || sz > mLeft) {
+        rc = FW_STAGE_BAD_ARG;
+    }
+    else {
+        rc = fw_stage_erase(mAddr + sz);
+        if (rc == FW_STAGE_SUCCESS &&
+                cy_serial_flash_qspi_write(mAddr, sz, data) != CY_RSLT_SUCCESS)
+            rc = FW_STAGE_FLASH_ERROR;
+        if (rc == FW_STAGE_SUCCESS && wc_Sha256Update(&mSha, data, sz) != 0)
+            rc = FW_STAGE_FLASH_ERROR;
+        mAddr += sz;
+        mLeft -= sz;
+    }
+    if (rc != FW_STAGE_SUCCESS) {
+        fw_stage_abort();
+    }
+    xSemaphoreGive(mLock);
+    return rc;
+}
+
+/*******************************************************************************
+ * Function Name: fw_stage_end
+ *******************************************************************************
+ * Summary:
+ *  Ends a part. At the end of the data the image is read back and its hash
+ *  compared with the one computed while writing, and with sha256 if given,
+ *  before the header is written.
+ *
+ * Parameters:
+ *  sha256 - Expected SHA-256 of the manifest followed by the data, or NULL.
+ *   Only used at the end of the data.
+ *
+ * Return:
+ *  int - FW_STAGE_SUCCESS, otherwise FW_STAGE_BAD_ARG (short part),
+ *  FW_STAGE_HASH_MISMATCH or FW_STAGE_FLASH_ERROR.
+ *
+ *******************************************************************************/
+int fw_stage_end(const uint8_t* sha256)
+{
+    fw_stage_hdr_t hdr;
+    int rc = FW_STAGE_SUCCESS;
+
+    if (!mReady) {
+        return FW_STAGE_BAD_ARG;
+    }
+    xSemaphoreTake(mLock, portMAX_DELAY);
+    if (mPart < 0 || mLeft != 0) {
+        fw_stage_abort();
+        xSemaphoreGive(mLock);
+        return FW_STAGE_BAD_ARG;
+    }
+    if (mPart == FW_STAGE_MANIFEST) {
+        mManifestSz = mAddr - FW_STAGE_MANIFEST_ADDR;
+        mPart = -1;
+        xSemaphoreGive(mLock);
+        return FW_STAGE_SUCCESS;
+    }
+
+    mDataSz = mAddr - FW_STAGE_DATA_ADDR;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = FW_STAGE_MAGIC;
+    hdr.manifestSz = mManifestSz;
+    hdr.dataSz = mDataSz;
+    if (wc_Sha256Final(&mSha, hdr.sha256) != 0) {
+        rc = FW_STAGE_FLASH_ERROR;
+    }
+    if (rc == FW_STAGE_SUCCESS && sha256 != NULL &&
+            memcmp(sha256, hdr.sha256, FW_STAGE_HASH_SZ) != 0) {
+        rc = FW_STAGE_HASH_MISMATCH;
+    }
+    if (rc == FW_STAGE_SUCCESS)
+        rc = fw_stage_check(hdr.manifestSz, hdr.dataSz, hdr.sha256);
+    if (rc == FW_STAGE_SUCCESS &&
+            cy_serial_flash_qspi_write(FW_STAGE_HDR_ADDR, sizeof(hdr),
+                (const uint8_t*)&hdr) != CY_RSLT_SUCCESS) {
+        rc = FW_STAGE_FLASH_ERROR;
+    }
+    if (rc == FW_STAGE_SUCCESS) {
+        mHdr = hdr;
+    }
+    fw_stage_abort();
+    xSemaphoreGive(mLock);
+    return rc;
+}
+
+/* The sizes and hash of the staged image. Returns FW_STAGE_NOT_STAGED if
+ * there is none. */
+int fw_stage_info(size_t* manifestSz, size_t* dataSz, uint8_t* sha256)
+{
+    int rc = FW_STAGE_NOT_STAGED;
+
+    if (!mReady) {
+        return rc;
+    }
+    xSemaphoreTake(mLock, portMAX_DELAY);
+    if (mHdr.magic == FW_STAGE_MAGIC) {
+        if (manifestSz != NULL)
+            *manifestSz = mHdr.manifestSz;
+        if (dataSz != NULL)
+            *dataSz = mHdr.dataSz;
+        if (sha256 != NULL)
+            memcpy(sha256, mHdr.sha256, FW_STAGE_HASH_SZ);
+        rc = FW_STAGE_SUCCESS;
+    }
+    xSemaphoreGive(mLock);
+    return rc;
+}
+
+/* Reads the staged image back and checks its hash, before programming */
+int fw_stage_verify(void)
+{
+    int rc = FW_STAGE_NOT_STAGED;
+
+    if (!mReady) {
+        return rc;
+    }
+    xSemaphoreTake(mLock, portMAX_DELAY);
+    if (mHdr.magic == FW_STAGE_MAGIC && mPart < 0) {
+        rc = fw_stage_check(mHdr.manifestSz, mHdr.dataSz, mHdr.sha256);
+    }
+    xSemaphoreGive(mLock);
+    return rc;
+}
+
+/* Copies the staged manifest to buf and sets sz */
+int fw_stage_read_manifest(uint8_t* buf, size_t bufSz, size_t* sz)
+{
+    int rc = FW_STAGE_NOT_STAGED;
+
+    if (!mReady) {
+        return rc;
+    }
+    xSemaphoreTake(mLock, portMAX_DELAY);
+    if (mHdr.magic == FW_STAGE_MAGIC) {
+        rc = FW_STAGE_BAD_ARG;
+        if (mHdr.manifestSz <= bufSz) {
+            rc = FW_STAGE_FLASH_ERROR;
+            if (cy_serial_flash_qspi_read(FW_STAGE_MANIFEST_ADDR,
+                    mHdr.manifestSz, buf) == CY_RSLT_SUCCESS) {
+                *sz = mHdr.manifestSz;
+                rc = FW_STAGE_SUCCESS;
+            }
+        }
+    }
+    xSemaphoreGive(mLock);
+    return rc;
+}
+
+/* Reads sz bytes of the staged firmware data from offset, straight into
+ * the caller's buffer */
+int fw_stage_read(size_t offset, uint8_t* buf, size_t sz)
+{
+    int rc = FW_STAGE_NOT_STAGED;
+
+    if (!mReady) {
+        return rc;
+    }
+    xSemaphoreTake(mLock, portMAX_DELAY);
+    if (mHdr.magic == FW_STAGE_MAGIC) {
+        rc = FW_STAGE_BAD_ARG;
+        if (offset <= mHdr.dataSz && sz <= mHdr.dataSz - offset) {
+            rc = FW_STAGE_FLASH_ERROR;
+            if (cy_serial_flash_qspi_read(FW_STAGE_DATA_ADDR + offset, sz,
+                    buf) == CY_RSLT_SUCCESS) {
+                rc = FW_STAGE_SUCCESS;
+            }
+        }
+    }
+    xSemaphoreGive(mLock);
+    return rc;
+}
+
+#endif /* FW_STAGE */
+
+/* [] END OF FILE */
@@ -0,0 +1,103 @@
+/******************************************************************************
+* File Name: fw_stage.h
+*
+* Description: This file contains the firmware staging area in the external
+* QSPI NOR flash: a TPM firmware image (manifest and data) is received and
+* verified there before it is programmed into the TPMs.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef FW_STAGE_H_
+#define FW_STAGE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "cy_result.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Size of the staging area at the end of the QSPI flash, or at
+ * FW_STAGE_ADDR if set. It holds a header and the manifest (one erase
+ * sector each) and the firmware data. */
+#ifndef FW_STAGE_SIZE
+#define FW_STAGE_SIZE               (4UL * 1024 * 1024)
+#endif
+
+/* QSPI clock */
+#ifndef FW_STAGE_QSPI_HZ
+#define FW_STAGE_QSPI_HZ            (50000000UL)
+#endif
+
+/* flash read size while hashing the staged image */
+#define FW_STAGE_READ_SZ            (512)
+
+/* SHA-256 of the manifest followed by the data */
+#define FW_STAGE_HASH_SZ            (32)
+
+/* fw_stage results */
+#define FW_STAGE_SUCCESS            (0)
+#define FW_STAGE_BAD_ARG            (-1)
+#define FW_STAGE_FLASH_ERROR        (-2)
+#define FW_STAGE_NOT_STAGED         (-3)
+#define FW_STAGE_HASH_MISMATCH      (-4)
+
+/* image parts */
+#define FW_STAGE_MANIFEST           (0)
+#define FW_STAGE_DATA               (1)
+
+#if defined(FW_STAGE) && defined(CY_ENABLE_XIP_PROGRAM)
+    /* writes and erases would stall the XIP reads of the Wi-Fi firmware */
+    #error FW_STAGE needs the QSPI flash free of XIP (CY_ENABLE_XIP_PROGRAM)
+#endif
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+cy_rslt_t fw_stage_init(void);
+int fw_stage_begin(int part, size_t sz);
+int fw_stage_write(const uint8_t* data, size_t sz);
+int fw_stage_end(const uint8_t* sha256);
+int fw_stage_info(size_t* manifestSz, size_t* dataSz, uint8_t* sha256);
+int fw_stage_verify(void);
+int fw_stage_read_manifest(uint8_t* buf, size_t bufSz, size_t* sz);
+int fw_stage_read(size_t offset, uint8_t* buf, size_t sz);
+
+#endif /* FW_STAGE_H_ */
+
+/* [] END OF FILE */
@@ -48,6 +48,10 @@
 #include <inttypes.h>
 #include <stdio.h>
 
+#ifdef MEM_STATS
+#include "mem_stats.h"
+#endif
+
 /* ARM compiler also defines __GNUC__ */
 #if defined (__GNUC__) && !defined(__ARMCC_VERSION)
 #include <malloc.h>
@@ -94,6 +98,19 @@ void print_heap_usage(char *msg)
     printf("Heap in use at this point   : %u bytes/%.2f KB, %.2f%% of available heap\r\n",
             mall_info.uordblks, TO_KB(mall_info.uordblks), ((float) mall_info.uordblks * 100u)/heap_size);
 
+#ifdef MEM_STATS
+    {
+        mem_heap_info_t info;
+        mem_stats_heap(&info);
+        printf("Minimum free heap so far    : %"PRIu32" bytes/%.2f KB\r\n",
+                info.freeMin, TO_KB(info.freeMin));
+        printf("Largest free block          : %"PRIu32" bytes/%.2f KB\r\n",
+                info.largestFree, TO_KB(info.largestFree));
+        printf("Allocations                 : %"PRIu32", %"PRIu32" failed\r\n",
+                info.allocs, info.failed);
+    }
+#endif
+
     printf("********************************\r\n\n");
 #endif /* #if defined(PRINT_HEAP_USAGE) && defined (__GNUC__) && !defined(__ARMCC_VERSION) */
 }
@@ -0,0 +1,171 @@
+/******************************************************************************
+* File Name: http_tmpl.c
+*
+* Description: This file contains the response template renderer. A template
+*              is a table of literal segments, with their lengths taken at
+*              compile time, and placeholders filled by a callback. The
+*              output is gathered in one buffer of a TLS record and flushed
+*              when full, so a response goes out in full records without a
+*              buffer for the whole page. A literal that doesn't fit in the
+*              buffer is written from flash directly.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include "http_tmpl.h"
+
+
+/*******************************************************************************
+ * Public Functions
+ ******************************************************************************/
+void http_tmpl_init(http_tmpl_out_t* out, char* buf, uint32_t bufSz,
+    http_tmpl_flush_cb flush, void* ctx)
+{
+    out->buf = buf;
+    out->bufSz = bufSz;
+    out->len = 0;
+    out->flush = flush;
+    out->ctx = ctx;
+    out->err = 0;
+}
+
+/* Writes the bytes gathered so far, returns 0 on success */
+int http_tmpl_flush(http_tmpl_out_t* out)
+{
+    if (out->len > 0 && !out->err &&
+            out->flush(out->ctx, out->buf, out->len) != 0) {
+        out->err = 1;
+    }
+    out->len = 0;
+    return out->err;
+}
+
+void http_tmpl_write(http_tmpl_out_t* out, const char* data, uint32_t sz)
+{
+    uint32_t len;
+
+    while (sz > 0 && !out->err) {
+        if (out->len == 0 && sz >= out->bufSz) {
+            /* a full flush from the source, no copy */
+            if (out->flush(out->ctx, data, out->bufSz) != 0) {
+                out->err = 1;
+            }
+            data += out->bufSz;
+            sz -= out->bufSz;
+            continue;
+        }
+        len = out->bufSz - out->len;
+        if (len > sz)
+            len = sz;
+        memcpy(&out->buf[out->len], data, len);
+        out->len += len;
+        data += len;
+        sz -= len;
+        if (out->len == out->bufSz) {
+            http_tmpl_flush(out);
+        }
+    }
+}
+
+void http_tmpl_str(http_tmpl_out_t* out, const char* s)
+{
+    http_tmpl_write(out, s, (uint32_t)strlen(s));
+}
+
+/* JSON string value: keeps printable characters other than '"' and '\\' */
+void http_tmpl_json_str(http_tmpl_out_t* out, const char* s)
+{
+    const char* start = s;
+
+    for (; *s != '\0'; s++) {
+        if (*s < 0x20 || *s >= 0x7f || *s == '"' || *s == '\\') {
+            http_tmpl_write(out, start, (uint32_t)(s - start));
+            start = s + 1;
+        }
+    }
+    http_tmpl_write(out, start, (uint32_t)(s - start));
+}
+
+/* Formats into the free space of the buffer, flushing first if the value
+ * doesn't fit. A value longer than the buffer is truncated. */
+void http_tmpl_printf(http_tmpl_out_t* out, const char* fmt, ...)
+{
+    va_list args;
+    uint32_t room;
+    int n;
+
+    if (out->err)
+        return;
+    room = out->bufSz - out->len;
+    va_start(args, fmt);
+    n = vsnprintf(&out->buf[out->len], room, fmt, args);
+    va_end(args);
+    if (n > 0 && (uint32_t)n >= room && out->len > 0) {
+        http_tmpl_flush(out);
+        room = out->bufSz;
+        va_start(args, fmt);
+        n = vsnprintf(out->buf, room, fmt, args);
+        va_end(args);
+    }
+    if (n > 0) {
+        /* vsnprintf leaves one byte for the terminator */
+        out->len += ((uint32_t)n < room) ? (uint32_t)n : room - 1;
+    }
+}
+
+/* Renders the template and flushes the rest, returns 0 on success */
+int http_tmpl_render(http_tmpl_out_t* out, const http_tmpl_t* tmpl,
+    http_tmpl_var_cb var, void* ctx)
+{
+    uint16_t i;
+
+    for (i = 0; i < tmpl->count && !out->err; i++) {
+        if (tmpl->seg[i].text != NULL) {
+            http_tmpl_write(out, tmpl->seg[i].text, tmpl->seg[i].len);
+        }
+        else if (var != NULL) {
+            var(out, tmpl->seg[i].len, ctx);
+        }
+    }
+    return http_tmpl_flush(out);
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,110 @@
+/******************************************************************************
+* File Name: http_tmpl.h
+*
+* Description: This file contains the response templates: flash resident
+* literal segments and placeholders, rendered into the response stream in
+* flushes of one TLS record.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef HTTP_TMPL_H_
+#define HTTP_TMPL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Literal segment, its length from sizeof at compile time */
+#define HTTP_TMPL_TEXT(s)       { (s), sizeof(s) - 1 }
+/* Placeholder, rendered by the variable callback of http_tmpl_render */
+#define HTTP_TMPL_VAR(id)       { NULL, (id) }
+
+/* Defines the template name from the segments */
+#define HTTP_TMPL(name, ...) \
+    static const http_tmpl_seg_t name##_seg[] = { __VA_ARGS__ }; \
+    static const http_tmpl_t name = { name##_seg, \
+        sizeof(name##_seg) / sizeof(name##_seg[0]) }
+
+/*******************************************************************************
+* Data Types
+*******************************************************************************/
+typedef struct {
+    const char* text;           /* literal, NULL for a placeholder */
+    uint16_t len;               /* literal length, or the placeholder id */
+} http_tmpl_seg_t;
+
+typedef struct {
+    const http_tmpl_seg_t* seg;
+    uint16_t count;
+} http_tmpl_t;
+
+/* Writes a flush to the response, returns 0 on success */
+typedef int (*http_tmpl_flush_cb)(void* ctx, const void* data, uint32_t sz);
+
+/* Output of a render: the bytes not flushed yet. buf holds one flush,
+ * bufSz bytes. */
+typedef struct {
+    char* buf;
+    uint32_t bufSz;
+    uint32_t len;
+    http_tmpl_flush_cb flush;
+    void* ctx;
+    int err;                    /* a flush failed, the rest is dropped */
+} http_tmpl_out_t;
+
+typedef void (*http_tmpl_var_cb)(http_tmpl_out_t* out, uint16_t id,
+    void* ctx);
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+void http_tmpl_init(http_tmpl_out_t* out, char* buf, uint32_t bufSz,
+    http_tmpl_flush_cb flush, void* ctx);
+void http_tmpl_write(http_tmpl_out_t* out, const char* data, uint32_t sz);
+void http_tmpl_str(http_tmpl_out_t* out, const char* s);
+void http_tmpl_json_str(http_tmpl_out_t* out, const char* s);
+void http_tmpl_printf(http_tmpl_out_t* out, const char* fmt, ...);
+int http_tmpl_render(http_tmpl_out_t* out, const http_tmpl_t* tmpl,
+    http_tmpl_var_cb var, void* ctx);
+int http_tmpl_flush(http_tmpl_out_t* out);
+
+#endif /* HTTP_TMPL_H_ */
+
+/* [] END OF FILE */
@@ -53,6 +53,7 @@
 #include "secure_http_server.h"
 #include <FreeRTOS.h>
 #include <task.h>
+#include <semphr.h>
 
 /* Include serial flash library and QSPI memory configurations only for the
  * kits that require the Wi-Fi firmware to be loaded in external QSPI NOR flash.
@@ -64,6 +65,15 @@
 
 #include <wolftpm/tpm2_wrap.h>
 #include <hal/tpm_io.h>
+#include <wolfssl/wolfcrypt/wc_port.h>
+
+#include "perf_stats.h"
+#include "tls_heap.h"
+#include "tpm_io_async.h"
+#include "tpm_wait.h"
+#include "tpm_dev.h"
+#include "boot.h"
+#include "mem_stats.h"
 
 /*****************************************************************************
 * Macros
@@ -71,9 +81,19 @@
 /* RTOS related macros. */
 #define HTTPS_SERVER_TASK_STACK_SIZE        (5 * 1024)
 #define HTTPS_SERVER_TASK_PRIORITY          (1)
+#define TPM_BOOT_TASK_STACK_SIZE            (3 * 1024)
+#define TPM_BOOT_TASK_PRIORITY              (1)
 
+/* TPM bus clock, with TPM_BUS_PROBE the fastest one tried */
+#ifndef TPM2_I2C_HZ
 #define TPM2_I2C_HZ    1000000UL /*  1MHz */
+#endif
+#ifndef TPM2_SPI_HZ
 #define TPM2_SPI_HZ   30000000UL /* 30MHz */
+#endif
+
+/* capability reads at each bus clock of the probe */
+#define TPM2_BUS_PROBE_READS    (4)
 
 /*******************************************************************************
 * Global Variables
@@ -89,7 +109,34 @@ cyhal_spi_t mSPI;
 
 WOLFTPM2_DEV mDev;
 
-static const char* TPM2_IFX_GetOpModeStr(int opMode)
+#ifdef FW_UPDATE_STATS
+/* time spent in TPM bus transfers */
+perf_timer_t mTpmIoTime;
+#endif
+
+/* TPM bus clock in use and its capability read round trip */
+static uint32_t mTPMBusHz;
+static uint32_t mTPMBusRttUs;
+static uint32_t mTPMBusBytesPerSec;
+
+#ifdef TPM_BUS_PROBE
+/* bus clocks tried by TPM2_IFX_BusProbe, fastest first, the ones above
+ * TPM2_I2C_HZ / TPM2_SPI_HZ are skipped */
+#ifdef WOLFTPM_I2C
+static const uint32_t mTPMBusProbeHz[] = {
+    1000000UL, 400000UL, 100000UL
+};
+#else
+static const uint32_t mTPMBusProbeHz[] = {
+    43000000UL, 33000000UL, 30000000UL, 25000000UL, 16000000UL, 8000000UL
+};
+#endif
+
+/* bytes moved by the HAL IO callback */
+static uint32_t mTpmIoBytes;
+#endif
+
+const char* TPM2_IFX_GetOpModeStr(int opMode)
 {
     const char* opModeStr = "Unknown";
     switch (opMode) {
@@ -114,46 +161,524 @@ static const char* TPM2_IFX_GetOpModeStr(int opMode)
     return opModeStr;
 }
 
-static char mTPMInfo[MAX_STATUS_LENGTH];
-const char* TPM2_IFX_GetInfo(int* opMode)
-{
-    int rc;
+/* TPM device context. Reading the capabilities takes several TPM
+ * transactions, so the cached information is only read again after
+ * TPM2_IFX_DevRefreshInfo. */
+typedef struct {
+    int           ready;    /* wolfTPM2_Init succeeded */
+    char          info[MAX_STATUS_LENGTH];
     WOLFTPM2_CAPS caps;
+    int           capsRc;
+    int           infoValid;
+#if TPM_DEV_COUNT > 1
+    tpm_io_i2c_dev_t io;    /* bus and address of devices 1 and up */
+#endif
+} tpm_dev_t;
+
+static tpm_dev_t mTPMDev[TPM_DEV_COUNT];
+static SemaphoreHandle_t mTPMInfoLock;
+static StaticSemaphore_t mTPMInfoLockBuf;
+
+#if TPM_DEV_COUNT > 1
+static WOLFTPM2_DEV mDevExtra[TPM_DEV_COUNT - 1];
+static const uint8_t mTPMDevAddr[] = { TPM_DEV_I2C_ADDRS };
+
+/* wolfTPM takes the context of a command from its active context, one for
+ * all tasks, so the TPM commands of different devices are serialized */
+static SemaphoreHandle_t mTPMLock;
+static StaticSemaphore_t mTPMLockBuf;
+#endif
+static volatile tpm_owner_t mTPMOwner;
+
+WOLFTPM2_DEV* TPM2_IFX_GetDev(int idx)
+{
+#if TPM_DEV_COUNT > 1
+    if (idx > 0)
+        return &mDevExtra[idx - 1];
+#endif
+    (void)idx;
+    return &mDev;
+}
+
+/* I2C address of the device, 0 for the SPI TPM */
+int TPM2_IFX_DevAddr(int idx)
+{
+#if TPM_DEV_COUNT > 1
+    if (idx > 0)
+        return (idx - 1 < (int)sizeof(mTPMDevAddr)) ? mTPMDevAddr[idx - 1] : 0;
+#endif
+    (void)idx;
+#ifdef WOLFTPM_I2C
+    return TPM_IO_ASYNC_I2C_ADDR;
+#else
+    return 0;
+#endif
+}
+
+/* Makes the device the target of the following wolfTPM calls, until
+ * TPM2_IFX_DevUnlock. With one TPM the wolfTPM context lock is enough. */
+void TPM2_IFX_DevLock(int idx)
+{
+#if TPM_DEV_COUNT > 1
+    if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED)
+        xSemaphoreTake(mTPMLock, portMAX_DELAY);
+    TPM2_SetActiveCtx(&TPM2_IFX_GetDev(idx)->ctx);
+#else
+    (void)idx;
+#endif
+}
+
+void TPM2_IFX_DevUnlock(void)
+{
+#if TPM_DEV_COUNT > 1
+    if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED)
+        xSemaphoreGive(mTPMLock);
+#endif
+}
+
+/* The firmware update and the benchmark own the TPMs for a whole run, so
+ * their commands are not interleaved. Returns TPM_OWNER_NONE if owner now
+ * has them, else the current owner, which keeps them. */
+tpm_owner_t TPM2_IFX_OwnerTake(tpm_owner_t owner)
+{
+    tpm_owner_t cur;
+
+    taskENTER_CRITICAL();
+    cur = mTPMOwner;
+    if (cur == TPM_OWNER_NONE)
+        mTPMOwner = owner;
+    taskEXIT_CRITICAL();
+    return cur;
+}
+
+/* releases the TPMs if owner has them */
+void TPM2_IFX_OwnerGive(tpm_owner_t owner)
+{
+    taskENTER_CRITICAL();
+    if (mTPMOwner == owner)
+        mTPMOwner = TPM_OWNER_NONE;
+    taskEXIT_CRITICAL();
+}
+
+tpm_owner_t TPM2_IFX_GetOwner(void)
+{
+    return mTPMOwner;
+}
+
+/* the lock is not needed before the scheduler starts */
+static void TPM2_IFX_InfoLock(void)
+{
+    if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED)
+        xSemaphoreTake(mTPMInfoLock, portMAX_DELAY);
+}
+static void TPM2_IFX_InfoUnlock(void)
+{
+    if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED)
+        xSemaphoreGive(mTPMInfoLock);
+}
 
-    memset(mTPMInfo, 0, sizeof(mTPMInfo));
-    rc = wolfTPM2_GetCapabilities(&mDev, &caps);
+static void TPM2_IFX_ReadInfo(int idx)
+{
+    int rc = TPM_RC_FAILURE;
+    tpm_dev_t* t = &mTPMDev[idx];
+    WOLFTPM2_CAPS* caps = &t->caps;
+    char* info = t->info;
+
+    memset(info, 0, sizeof(t->info));
+    memset(caps, 0, sizeof(*caps));
+    if (t->ready) {
+        TPM2_IFX_DevLock(idx);
+        rc = wolfTPM2_GetCapabilities(TPM2_IFX_GetDev(idx), caps);
+        TPM2_IFX_DevUnlock();
+    }
     if (rc == TPM_RC_SUCCESS) {
-        sprintf(mTPMInfo,
+        sprintf(info,
             "Mfg %s (%d), Vendor %s, Fw %u.%u (0x%x)\n",
-            caps.mfgStr, caps.mfg, caps.vendorStr, caps.fwVerMajor,
-            caps.fwVerMinor, caps.fwVerVendor);
-        sprintf(mTPMInfo + strlen(mTPMInfo),
+            caps->mfgStr, caps->mfg, caps->vendorStr, caps->fwVerMajor,
+            caps->fwVerMinor, caps->fwVerVendor);
+        sprintf(info + strlen(info),
             "Operational mode: %s (0x%x)\n",
-            TPM2_IFX_GetOpModeStr(caps.opMode), caps.opMode);
-        sprintf(mTPMInfo + strlen(mTPMInfo),
+            TPM2_IFX_GetOpModeStr(caps->opMode), caps->opMode);
+        sprintf(info + strlen(info),
             "KeyGroupId 0x%x, FwCounter %d (%d same)\n",
-            caps.keyGroupId, caps.fwCounter, caps.fwCounterSame);
-        if (opMode)
-            *opMode = caps.opMode;
+            caps->keyGroupId, caps->fwCounter, caps->fwCounterSame);
     }
     else {
-        sprintf(mTPMInfo, "Get Capabilities failed 0x%x: %s\n",
+        sprintf(info, "Get Capabilities failed 0x%x: %s\n",
             rc, TPM2_GetRCString(rc));
     }
-    return mTPMInfo;
+    t->capsRc = rc;
+    t->infoValid = 1;
+}
+
+/* Copies the TPM information into info (if not NULL), reading it from the
+ * TPM only when the cached copy was invalidated. Call without the device
+ * lock held. */
+void TPM2_IFX_DevGetInfo(int idx, char* info, size_t infoSz, int* opMode)
+{
+    tpm_dev_t* t = &mTPMDev[idx];
+
+    TPM2_IFX_InfoLock();
+    if (!t->infoValid) {
+        TPM2_IFX_ReadInfo(idx);
+    }
+    if (info != NULL && infoSz > 0) {
+        strncpy(info, t->info, infoSz - 1);
+        info[infoSz - 1] = '\0';
+    }
+    if (opMode)
+        *opMode = t->caps.opMode;
+    TPM2_IFX_InfoUnlock();
+}
+
+/* Copies the cached TPM capabilities, returns the result of reading them */
+int TPM2_IFX_DevGetCaps(int idx, WOLFTPM2_CAPS* caps)
+{
+    int rc;
+    tpm_dev_t* t = &mTPMDev[idx];
+
+    TPM2_IFX_InfoLock();
+    if (!t->infoValid) {
+        TPM2_IFX_ReadInfo(idx);
+    }
+    *caps = t->caps;
+    rc = t->capsRc;
+    TPM2_IFX_InfoUnlock();
+    return rc;
+}
+
+/* The next TPM2_IFX_DevGetInfo reads the TPM again */
+void TPM2_IFX_DevRefreshInfo(int idx)
+{
+    TPM2_IFX_InfoLock();
+    mTPMDev[idx].infoValid = 0;
+    TPM2_IFX_InfoUnlock();
+}
+
+/* device 0 */
+void TPM2_IFX_GetInfo(char* info, size_t infoSz, int* opMode)
+{
+    TPM2_IFX_DevGetInfo(0, info, infoSz, opMode);
+}
+
+int TPM2_IFX_GetCaps(WOLFTPM2_CAPS* caps)
+{
+    return TPM2_IFX_DevGetCaps(0, caps);
+}
+
+void TPM2_IFX_RefreshInfo(void)
+{
+    TPM2_IFX_DevRefreshInfo(0);
+}
+
+/* bus transfers: interrupt driven (TPM_IO_ASYNC) or the polled wolfTPM HAL */
+#ifdef TPM_IO_ASYNC
+#define TPM2_IFX_BusIoCb TPM2_IFX_AsyncIoCb
+#else
+#define TPM2_IFX_BusIoCb TPM2_IoCb
+#endif
+
+#if defined(FW_UPDATE_STATS) || defined(TPM_WAIT_RTOS) || \
+    defined(TPM_BUS_PROBE)
+/* times the bus transfers of the HAL IO callback, follows the commands
+ * for the TPM wait statistics and counts the bytes for the bus probe */
+#ifdef WOLFTPM_ADV_IO
+static int TPM2_IFX_IoCb(TPM2_CTX* ctx, INT32 isRead, UINT32 addr,
+    BYTE* buf, UINT16 size, void* userCtx)
+#else
+static int TPM2_IFX_IoCb(TPM2_CTX* ctx, const BYTE* txBuf, BYTE* rxBuf,
+    UINT16 xferSz, void* userCtx)
+#endif
+{
+    int rc;
+#ifdef FW_UPDATE_STATS
+    uint32_t start = perf_cycles();
+#endif
+
+#ifdef WOLFTPM_ADV_IO
+    rc = TPM2_IFX_BusIoCb(ctx, isRead, addr, buf, size, userCtx);
+#else
+    rc = TPM2_IFX_BusIoCb(ctx, txBuf, rxBuf, xferSz, userCtx);
+#endif
+#ifdef FW_UPDATE_STATS
+    perf_timer_add(&mTpmIoTime, perf_cycles() - start);
+#endif
+#ifdef TPM_BUS_PROBE
+    #ifdef WOLFTPM_ADV_IO
+    mTpmIoBytes += size;
+    #else
+    mTpmIoBytes += xferSz;
+    #endif
+#endif
+#ifdef TPM_WAIT_RTOS
+    if (rc == TPM_RC_SUCCESS) {
+    #ifdef WOLFTPM_ADV_IO
+        tpm_wait_io(isRead, addr, buf, size);
+    #else
+        tpm_wait_io(txBuf, xferSz);
+    #endif
+    }
+#endif
+    return rc;
+}
+#else
+#define TPM2_IFX_IoCb TPM2_IFX_BusIoCb
+#endif
+
+#if TPM_DEV_COUNT > 1
+/* devices 1 and up, at their own address: follows the commands for the
+ * TPM wait statistics, the bus time and bytes are those of device 0 */
+static int TPM2_IFX_DevIoCb(TPM2_CTX* ctx, INT32 isRead, UINT32 addr,
+    BYTE* buf, UINT16 size, void* userCtx)
+{
+    int rc = TPM2_IFX_AsyncIoDevCb(ctx, isRead, addr, buf, size, userCtx);
+#ifdef TPM_WAIT_RTOS
+    if (rc == TPM_RC_SUCCESS) {
+        tpm_wait_io(isRead, addr, buf, size);
+    }
+#endif
+    return rc;
 }
+#endif
 
 int TPM2_IFX_Init(void)
 {
-    return wolfTPM2_Init(&mDev, TPM2_IoCb,
+    int rc;
+
+    TPM2_IFX_DevLock(0);
+    rc = wolfTPM2_Init(&mDev, TPM2_IFX_IoCb,
     #ifdef WOLFTPM_I2C
         &mI2C
     #else
         &mSPI
     #endif
     );
+    TPM2_IFX_DevUnlock();
+    mTPMDev[0].ready = (rc == TPM_RC_SUCCESS);
+    return rc;
+}
+
+/* Initializes device idx, on the bus set up by the TPM boot. Device 0 is
+ * initialized by the boot, the others by their firmware update worker. */
+int TPM2_IFX_DevInit(int idx)
+{
+    int rc = BAD_FUNC_ARG;
+
+    if (idx == 0) {
+        return TPM2_IFX_Init();
+    }
+#if TPM_DEV_COUNT > 1
+    if (idx > 0 && idx < TPM_DEV_COUNT &&
+            idx - 1 < (int)sizeof(mTPMDevAddr)) {
+        tpm_dev_t* t = &mTPMDev[idx];
+        t->io.i2c = &mI2C;
+        t->io.addr = mTPMDevAddr[idx - 1];
+        TPM2_IFX_DevLock(idx);
+        rc = wolfTPM2_Init(TPM2_IFX_GetDev(idx), TPM2_IFX_DevIoCb, &t->io);
+        TPM2_IFX_DevUnlock();
+        t->ready = (rc == TPM_RC_SUCCESS);
+        TPM2_IFX_DevRefreshInfo(idx);
+    }
+#endif
+    return rc;
+}
+
+/* Sets the TPM bus clock, fails if the bus can't run at that rate */
+static cy_rslt_t TPM2_IFX_SetBusHz(uint32_t hz)
+{
+    cy_rslt_t result;
+#ifdef WOLFTPM_I2C
+    cyhal_i2c_cfg_t i2c_cfg;
+    memset(&i2c_cfg, 0, sizeof(i2c_cfg));
+    i2c_cfg.frequencyhal_hz = hz;
+    result = cyhal_i2c_configure(&mI2C, &i2c_cfg);
+#else
+    result = cyhal_spi_set_frequency(&mSPI, hz);
+#endif
+    if (result == CY_RSLT_SUCCESS) {
+        mTPMBusHz = hz;
+    }
+    return result;
+}
+
+/* Reports the TPM bus clock, the capability read round trip and the bus
+ * throughput measured at that clock */
+void TPM2_IFX_GetBusInfo(uint32_t* hz, uint32_t* rttUs, uint32_t* bytesPerSec)
+{
+    *hz = mTPMBusHz;
+    *rttUs = mTPMBusRttUs;
+    *bytesPerSec = mTPMBusBytesPerSec;
+}
+
+#ifdef TPM_BUS_PROBE
+/* Tries the bus clocks from the fastest down with TPM2_BUS_PROBE_READS
+ * capability reads each and keeps the fastest one where all reads succeed
+ * and agree. The TPM is initialized at the first clock it answers on. */
+static int TPM2_IFX_BusProbe(void)
+{
+    static WOLFTPM2_CAPS caps[2];
+    int initRc = -1;
+    size_t i;
+    uint32_t bestHz = 0, bestRtt = 0, bestBps = 0;
+
+    for (i = 0; i < sizeof(mTPMBusProbeHz) / sizeof(mTPMBusProbeHz[0]); i++) {
+        uint32_t hz = mTPMBusProbeHz[i];
+        uint32_t start, cycles, bytes, rttUs, bps;
+        int n, rc = TPM_RC_SUCCESS;
+
+    #ifdef WOLFTPM_I2C
+        if (hz > TPM2_I2C_HZ)
+    #else
+        if (hz > TPM2_SPI_HZ)
+    #endif
+            continue;
+
+        if (TPM2_IFX_SetBusHz(hz) != CY_RSLT_SUCCESS) {
+            printf("TPM bus %lu Hz: not supported\n", (unsigned long)hz);
+            continue;
+        }
+        if (initRc != TPM_RC_SUCCESS) {
+            initRc = TPM2_IFX_Init();
+            if (initRc != TPM_RC_SUCCESS) {
+                printf("TPM bus %lu Hz: init failed 0x%x\n",
+                    (unsigned long)hz, initRc);
+                continue;
+            }
+        }
+
+        bytes = mTpmIoBytes;
+        start = perf_cycles();
+        for (n = 0; n < TPM2_BUS_PROBE_READS && rc == TPM_RC_SUCCESS; n++) {
+            memset(&caps[n > 0], 0, sizeof(caps[0]));
+            TPM2_IFX_DevLock(0);
+            rc = wolfTPM2_GetCapabilities(&mDev, &caps[n > 0]);
+            TPM2_IFX_DevUnlock();
+            if (rc == TPM_RC_SUCCESS && n > 0 &&
+                    memcmp(&caps[0], &caps[1], sizeof(caps[0])) != 0) {
+                rc = TPM_RC_FAILURE;
+            }
+        }
+        cycles = perf_cycles() - start;
+        bytes = mTpmIoBytes - bytes;
+        if (rc != TPM_RC_SUCCESS) {
+            printf("TPM bus %lu Hz: unstable (read %d: 0x%x)\n",
+                (unsigned long)hz, n, rc);
+            continue;
+        }
+
+        rttUs = perf_cycles_to_us(cycles) / TPM2_BUS_PROBE_READS;
+        bps = (uint32_t)((uint64_t)bytes * 1000000 /
+            (perf_cycles_to_us(cycles) ? perf_cycles_to_us(cycles) : 1));
+        printf("TPM bus %lu Hz: capability read %lu us, %lu bytes/sec\n",
+            (unsigned long)hz, (unsigned long)rttUs, (unsigned long)bps);
+        if (bestHz == 0) {
+            bestHz = hz;
+            bestRtt = rttUs;
+            bestBps = bps;
+        }
+    }
+
+    if (bestHz == 0) {
+        return (initRc != TPM_RC_SUCCESS) ? initRc : TPM_RC_FAILURE;
+    }
+    TPM2_IFX_SetBusHz(bestHz);
+    mTPMBusRttUs = bestRtt;
+    mTPMBusBytesPerSec = bestBps;
+    printf("TPM bus %lu Hz selected\n", (unsigned long)bestHz);
+    return TPM_RC_SUCCESS;
+}
+#endif
+
+
+/* TPM bring-up: bus, TPM init and information. Runs on its own task with
+ * PARALLEL_BOOT, while the Wi-Fi joins. */
+static void TPM2_IFX_Boot(void)
+{
+    cy_rslt_t result;
+    int rc;
+
+#ifdef WOLFTPM_I2C
+    result = cyhal_i2c_init(&mI2C, CYBSP_I2C_SDA, CYBSP_I2C_SCL, NULL);
+    if (result == CY_RSLT_SUCCESS) {
+        result = TPM2_IFX_SetBusHz(TPM2_I2C_HZ);
+    }
+#else
+    result = cyhal_spi_init(&mSPI,
+        CYBSP_MIKROBUS_SPI_MOSI, CYBSP_MIKROBUS_SPI_MISO,
+        CYBSP_MIKROBUS_SPI_SCK, CYBSP_MIKROBUS_SPI_CS,
+        NULL, 8, CYHAL_SPI_MODE_00_MSB, false);
+    if (result == CY_RSLT_SUCCESS) {
+        result = TPM2_IFX_SetBusHz(TPM2_SPI_HZ);
+    }
+#endif
+    if (result != CY_RSLT_SUCCESS) {
+        printf("Infineon I2C/SPI init failed! 0x%lx\n", (uint32_t)result);
+    }
+#ifdef TPM_IO_ASYNC
+    else {
+        /* polled until the scheduler starts, then interrupt driven */
+    #ifdef WOLFTPM_I2C
+        TPM2_IFX_AsyncIoInit(&mI2C);
+    #else
+        TPM2_IFX_AsyncIoInit(&mSPI);
+    #endif
+    }
+#endif
+#ifdef TPM_WAIT_RTOS
+    /* TPM waits sleep once the scheduler starts */
+    #ifdef WOLFTPM_I2C
+    tpm_wait_init(TPM2_IFX_BusIoCb, &mI2C);
+    #else
+    tpm_wait_init(TPM2_IFX_BusIoCb, &mSPI);
+    #endif
+#endif
+
+#ifdef TPM_BUS_PROBE
+    rc = TPM2_IFX_BusProbe();
+#else
+    rc = TPM2_IFX_Init();
+#endif
+#ifdef TPM_WAIT_PIRQ
+    if (rc == TPM_RC_SUCCESS) {
+        tpm_wait_pirq_enable();
+    }
+#endif
+    if (rc == TPM_RC_SUCCESS) {
+        int opMode = 0;
+        char info[MAX_STATUS_LENGTH];
+        TPM2_IFX_GetInfo(info, sizeof(info), &opMode);
+        puts(info);
+
+        /* cancel update that hasn't started */
+        if (opMode == 0x01) {
+            printf("Abandoning firmware update\r\n");
+            printf("Reset board\r\n");
+            TPM2_IFX_DevLock(0);
+            wolfTPM2_FirmwareUpgradeCancel(&mDev);
+            TPM2_IFX_DevUnlock();
+        }
+    }
+    else {
+        printf("Infineon get information failed 0x%x: %s\n",
+            rc, TPM2_GetRCString(rc));
+    }
+
+    boot_mark("TPM ready");
+    boot_done(BOOT_EVENT_TPM,
+        (rc == TPM_RC_SUCCESS) ? CY_RSLT_SUCCESS : CY_RSLT_TYPE_ERROR);
 }
 
+#ifdef PARALLEL_BOOT
+static void TPM2_IFX_BootTask(void* arg)
+{
+    (void)arg;
+    TPM2_IFX_Boot();
+#ifdef MEM_STATS
+    mem_stats_task_exit();
+#endif
+    vTaskDelete(NULL);
+}
+#endif
 
 /*******************************************************************************
  * Function Name: main
@@ -181,6 +706,17 @@ int main(void)
     /* Enable global interrupts */
     __enable_irq();
 
+    /* Enable the cycle counter for the performance statistics */
+    perf_init();
+
+#ifdef TLS_HEAP_POOL
+    /* wolfSSL and wolfCrypt allocate from their own pool, before the TPM
+     * init allocates */
+    if (tls_heap_init() != 0) {
+        CY_ASSERT(0);
+    }
+#endif
+
     /* Initialize retarget-io to use the debug UART port */
     cy_retarget_io_init(CYBSP_DEBUG_UART_TX, CYBSP_DEBUG_UART_RX, CY_RETARGET_IO_BAUDRATE);
 
@@ -202,6 +738,10 @@ int main(void)
         cy_serial_flash_qspi_enable_xip(true);
     #endif
 
+    /* Boot phase events and timestamps */
+    boot_init();
+    boot_mark("Board initialized");
+
 #if defined(ENABLE_SECURE_SOCKETS_LOGS) || defined(ENABLE_HTTP_SERVER_LOGS)
     result = cy_log_init(CY_LOG_OFF, NULL, NULL);
     CHECK_RESULT(result);
@@ -216,59 +756,36 @@ int main(void)
     APP_INFO(("===================================\n\n"));
 
     /* Get TPM information */
-    {
-        int rc;
-
-    #ifdef WOLFTPM_I2C
-        cyhal_i2c_cfg_t i2c_cfg;
-        memset(&i2c_cfg, 0, sizeof(i2c_cfg));
-        i2c_cfg.frequencyhal_hz = TPM2_I2C_HZ;
-        result = cyhal_i2c_init(&mI2C, CYBSP_I2C_SDA, CYBSP_I2C_SCL, NULL);
-        if (result == CY_RSLT_SUCCESS) {
-            result = cyhal_i2c_configure(&mI2C, &i2c_cfg);
-        }
-    #else
-        result = cyhal_spi_init(&mSPI,
-            CYBSP_MIKROBUS_SPI_MOSI, CYBSP_MIKROBUS_SPI_MISO,
-            CYBSP_MIKROBUS_SPI_SCK, CYBSP_MIKROBUS_SPI_CS,
-            NULL, 8, CYHAL_SPI_MODE_00_MSB, false);
-        if (result == CY_RSLT_SUCCESS) {
-            result = cyhal_spi_set_frequency(&mSPI, TPM2_SPI_HZ);
-        }
-    #endif
-        if (result != CY_RSLT_SUCCESS) {
-            printf("Infineon I2C/SPI init failed! 0x%lx\n", (uint32_t)result);
-        }
-
-        rc = TPM2_IFX_Init();
-        if (rc == TPM_RC_SUCCESS) {
-            int opMode = 0;
-            const char* buf = TPM2_IFX_GetInfo(&opMode);
-            puts(buf);
-
-            /* cancel update that hasn't started */
-            if (opMode == 0x01) {
-                printf("Abandoning firmware update\r\n");
-                printf("Reset board\r\n");
-                wolfTPM2_FirmwareUpgradeCancel(&mDev);
-            }
-        }
-        else {
-            printf("Infineon get information failed 0x%x: %s\n",
-                rc, TPM2_GetRCString(rc));
-        }
-    }
-
+    mTPMInfoLock = xSemaphoreCreateMutexStatic(&mTPMInfoLockBuf);
+#if TPM_DEV_COUNT > 1
+    mTPMLock = xSemaphoreCreateMutexStatic(&mTPMLockBuf);
+#endif
+#ifdef PARALLEL_BOOT
+    /* wolfTPM2_Init and the TLS library initialize wolfCrypt, now on
+     * different tasks, so do it once here */
+    wolfCrypt_Init();
+    xTaskCreate(TPM2_IFX_BootTask, "TPM Boot", TPM_BOOT_TASK_STACK_SIZE, NULL,
+                TPM_BOOT_TASK_PRIORITY, NULL);
+#else
+    TPM2_IFX_Boot();
+#endif
 
     APP_INFO(("===================================\n"));
     APP_INFO(("HTTPS Server\n"));
     APP_INFO(("===================================\n\n"));
+    APP_INFO(("Build profile: %s\n", BUILD_PROFILE_NAME));
+#ifdef CRYPTO_PROFILE_FAST
+    APP_INFO(("Crypto profile: fast (Cortex-M4 assembly)\n"));
+#else
+    APP_INFO(("Crypto profile: small (portable C)\n"));
+#endif
 
     /* Starts the HTTPS server in secure mode. */
     xTaskCreate(https_server_task, "HTTPS Server", HTTPS_SERVER_TASK_STACK_SIZE, NULL,
                 HTTPS_SERVER_TASK_PRIORITY, &https_server_task_handle);
 
     /* Start the FreeRTOS scheduler */
+    boot_mark("Scheduler start");
     vTaskStartScheduler();
 
     /* Should never get here */
@@ -16,10 +16,8 @@
  * - Tiebreaking for simultaneous probing
  * - Sending goodbye messages (zero ttl) - shutdown, DHCP lease about to expire, DHCP turned off...
  * - Checking that source address of unicast requests are on the same network
- * - Limiting multicast responses to 1 per second per resource record
  * - Fragmenting replies if required
  * - Handling multi-packet known answers
- * - Individual known answer detection for all local IPv6 addresses
  * - Dynamic size of outgoing packet
  */
 
@@ -65,6 +63,9 @@
 #include "lwip/prot/iana.h"
 #include "lwip/timeouts.h"
 #include "secure_http_server.h"
+#ifdef CPU_STATS
+#include "cpu_stats.h"
+#endif
 
 #include <string.h>
 
@@ -94,12 +95,17 @@ static const ip_addr_t v6group = DNS_MQUERY_IPV6_GROUP_INIT;
 
 #define MDNS_TTL  255
 
-/* Stored offsets to beginning of domain names
- * Used for compression.
+/* Stored offsets to the name suffixes written in a packet, in a hash table
+ * indexed by the hash of the suffix. Used for compression.
+ * Must be a power of 2, filled up to 3/4 to keep the probe sequences short.
  */
-#define NUM_DOMAIN_OFFSETS 10
+#define NUM_DOMAIN_OFFSETS 128
+#define MAX_DOMAIN_OFFSETS (NUM_DOMAIN_OFFSETS * 3 / 4)
 #define DOMAIN_JUMP_SIZE 2
 #define DOMAIN_JUMP 0xc000
+/* Multiplier of the suffix hash and its inverse modulo 2^32 */
+#define DOMAIN_HASH_MUL 0x01000193UL
+#define DOMAIN_HASH_INV 0x359c449bUL
 
 static u8_t mdns_netif_client_id;
 static struct udp_pcb *mdns_pcb;
@@ -122,6 +128,24 @@ static mdns_name_result_cb_t mdns_name_result_cb;
 /* Payload size allocated for each outgoing UDP packet */
 #define OUTPACKET_SIZE 500
 
+/* Number of replies kept per netif. A reply is written once and sent again
+ * while the names, addresses and TXT data stay the same. 0 disables the cache.
+ */
+#ifndef MDNS_RESP_CACHE_ENTRIES
+#define MDNS_RESP_CACHE_ENTRIES 4
+#endif
+
+/* Minimum time between two multicasts of a record in replies to queries
+ * (RFC 6762 section 6), and the shorter one for replies to probes. Records
+ * multicast more recently on the same IP version are left out. 0 disables it.
+ */
+#ifndef MDNS_RESP_RATE_LIMIT_MS
+#define MDNS_RESP_RATE_LIMIT_MS 1000
+#endif
+#ifndef MDNS_RESP_PROBE_RATE_LIMIT_MS
+#define MDNS_RESP_PROBE_RATE_LIMIT_MS 250
+#endif
+
 /* Lookup from hostname -> IPv4 */
 #define REPLY_HOST_A            0x01
 /* Lookup from IPv4/v6 -> hostname */
@@ -140,6 +164,25 @@ static mdns_name_result_cb_t mdns_name_result_cb;
 /* Lookup for text info on service instance */
 #define REPLY_SERVICE_TXT       0x80
 
+/* Index of each record of a host, for the record bitmasks of an outpacket
+ * and the time each record was last multicast */
+#define MDNS_RR_HOST_A          0
+#define MDNS_RR_HOST_PTR_V4     1
+#define MDNS_RR_HOST_AAAA(i)    (2 + (i))
+#define MDNS_RR_HOST_PTR_V6(i)  (2 + LWIP_IPV6_NUM_ADDRESSES + (i))
+#define MDNS_RR_SERVICE(s, rr)  (2 + 2 * LWIP_IPV6_NUM_ADDRESSES + 4 * (s) + (rr))
+#define MDNS_RR_TYPE_PTR        0
+#define MDNS_RR_NAME_PTR        1
+#define MDNS_RR_SRV             2
+#define MDNS_RR_TXT             3
+#define MDNS_RR_COUNT           MDNS_RR_SERVICE(MDNS_MAX_SERVICES, 0)
+#define MDNS_RR_BIT(rr)         ((u32_t)1 << (rr))
+#define MDNS_RR_SERVICE_BITS(s) ((u32_t)0xf << MDNS_RR_SERVICE(s, 0))
+
+#if MDNS_RR_COUNT > 32
+#error "MDNS_MAX_SERVICES too large for the record bitmasks"
+#endif
+
 #define MDNS_PROBE_DELAY_MS       250
 #define MDNS_PROBE_COUNT          3
 #ifdef LWIP_RAND
@@ -178,6 +221,33 @@ struct mdns_service {
   u16_t port;
 };
 
+#if MDNS_RESP_CACHE_ENTRIES
+/** A reply packet written earlier. The selected answers are the key. */
+struct mdns_cached_reply {
+  /** Length of the packet, 0 if the entry is unused */
+  u16_t len;
+  /** Value of mdns_host.cache_use when the entry was last used */
+  u16_t last_use;
+  /** Record counts for the header */
+  u16_t answers;
+  u16_t authoritative;
+  u16_t additional;
+  /** Header flags */
+  u8_t flags;
+  u8_t cache_flush;
+  u8_t host_replies;
+  u8_t host_reverse_v6_replies;
+  u8_t serv_replies[MDNS_MAX_SERVICES];
+  /** Records left out, and records in the packet */
+  u32_t rr_skip;
+  u32_t rr_written;
+  /** Hash of the TXT data of each service in the reply */
+  u32_t txt_hash[MDNS_MAX_SERVICES];
+  /** Packet, header included */
+  u8_t data[OUTPACKET_SIZE];
+};
+#endif
+
 /** Description of a host/netif */
 struct mdns_host {
   /** Hostname */
@@ -190,6 +260,29 @@ struct mdns_host {
   u8_t probes_sent;
   /** State in probing sequence */
   u8_t probing_state;
+  /** Offsets for written domain name suffixes in the outpacket being written,
+   *  0 if unused, and the hash of each suffix. Used for compression.
+   *  Packets for a netif are written one at a time, on the tcpip thread. */
+  u16_t domain_offsets[NUM_DOMAIN_OFFSETS];
+  u16_t domain_hashes[NUM_DOMAIN_OFFSETS];
+  u8_t domain_count;
+  /** Addresses the cached replies and the multicast times below are for */
+#if LWIP_IPV4
+  ip4_addr_t addr_v4;
+#endif
+#if LWIP_IPV6
+  ip6_addr_p_t addr_v6[LWIP_IPV6_NUM_ADDRESSES];
+  u8_t addr_v6_valid;
+#endif
+  /** Bitmask of the records multicast since the last change, and the
+   *  sys_now() time each one was last multicast. [0] IPv4, [1] IPv6 */
+  u32_t rr_multicast[2];
+  u32_t rr_sent[2][MDNS_RR_COUNT];
+#if MDNS_RESP_CACHE_ENTRIES
+  /** Incremented for each cache use, for replacement */
+  u16_t cache_use;
+  struct mdns_cached_reply cache[MDNS_RESP_CACHE_ENTRIES];
+#endif
 };
 
 /** Information about received packet */
@@ -218,6 +311,10 @@ struct mdns_packet {
   u16_t answers;
   /** Number of unparsed answers */
   u16_t answers_left;
+  /** Number of answers in the answer section, the known answers of a query */
+  u16_t known_answers;
+  /** Number of authority records, set in a probe */
+  u16_t authoritative;
 };
 
 /** Information about outgoing packet */
@@ -241,9 +338,6 @@ struct mdns_outpacket {
   u16_t authoritative;
   /** Number of additional answers written */
   u16_t additional;
-  /** Offsets for written domain names in packet.
-   *  Used for compression */
-  u16_t domain_offsets[NUM_DOMAIN_OFFSETS];
   /** If all answers in packet should set cache_flush bit */
   u8_t cache_flush;
   /** If reply should be sent unicast */
@@ -257,6 +351,10 @@ struct mdns_outpacket {
   u8_t host_reverse_v6_replies;
   /* Reply bitmask per service */
   u8_t serv_replies[MDNS_MAX_SERVICES];
+  /* Records left out of the reply, known to the querier or multicast recently */
+  u32_t rr_skip;
+  /* Records written to the packet */
+  u32_t rr_written;
 };
 
 /** Domain, type and class.
@@ -827,6 +925,160 @@ mdns_compress_domain(struct pbuf *pbuf, u16_t *offset, struct mdns_domain *domai
   return domain->length;
 }
 
+/** Position in a domain name, with the hash of the suffix that starts there */
+struct mdns_domain_suffix {
+  /** Hash polynomial of the whole name, sum of name[i] * DOMAIN_HASH_MUL^i */
+  u32_t total;
+  /** The same sum for the bytes before pos */
+  u32_t prefix;
+  /** DOMAIN_HASH_MUL^pos and DOMAIN_HASH_INV^pos */
+  u32_t mul;
+  u32_t inv;
+  /** Start of the current label */
+  u16_t pos;
+};
+
+/** Start at the first label of a domain */
+static void
+mdns_suffix_first(struct mdns_domain_suffix *sfx, const struct mdns_domain *domain)
+{
+  u32_t mul = 1;
+  u16_t i;
+
+  sfx->total = 0;
+  for (i = 0; i < domain->length; i++) {
+    sfx->total += domain->name[i] * mul;
+    mul *= DOMAIN_HASH_MUL;
+  }
+  sfx->prefix = 0;
+  sfx->mul = 1;
+  sfx->inv = 1;
+  sfx->pos = 0;
+}
+
+/** Return 1 if pos is at a label, 0 at the end of the name */
+static int
+mdns_suffix_valid(const struct mdns_domain_suffix *sfx, const struct mdns_domain *domain)
+{
+  return sfx->pos < domain->length && domain->name[sfx->pos] != 0;
+}
+
+/** Skip to the next label */
+static void
+mdns_suffix_next(struct mdns_domain_suffix *sfx, const struct mdns_domain *domain)
+{
+  u16_t end = (u16_t)(sfx->pos + 1 + domain->name[sfx->pos]);
+
+  for (; sfx->pos < end && sfx->pos < domain->length; sfx->pos++) {
+    sfx->prefix += domain->name[sfx->pos] * sfx->mul;
+    sfx->mul *= DOMAIN_HASH_MUL;
+    sfx->inv *= DOMAIN_HASH_INV;
+  }
+}
+
+/** Hash of the name from pos to the end, the same for the same bytes at any position */
+static u16_t
+mdns_suffix_hash(const struct mdns_domain_suffix *sfx)
+{
+  u32_t hash = (sfx->total - sfx->prefix) * sfx->inv;
+  return (u16_t)(hash ^ (hash >> 16));
+}
+
+/**
+ * Find the longest suffix of a domain already written in the outpacket.
+ * Each suffix is looked up in the hash table of written suffixes, and only a
+ * hash match is read back from the packet to confirm it.
+ * @param outpkt The outpacket with the names written so far
+ * @param domain The domain to write
+ * @param offset Set to where the suffix was written, if one is found
+ * @return Number of bytes to write of the domain before a jump to offset.
+ *         The full domain length if no suffix was found.
+ */
+static u16_t
+mdns_compress_lookup(struct mdns_outpacket *outpkt, struct mdns_domain *domain, u16_t *offset)
+{
+  struct mdns_host *mdns = NETIF_TO_HOST(outpkt->netif);
+  struct mdns_domain_suffix sfx;
+  struct mdns_domain target;
+
+  if (outpkt->pbuf == NULL || domain->skip_compression) {
+    return domain->length;
+  }
+  for (mdns_suffix_first(&sfx, domain); mdns_suffix_valid(&sfx, domain); mdns_suffix_next(&sfx, domain)) {
+    u16_t hash = mdns_suffix_hash(&sfx);
+    u16_t len = (u16_t)(domain->length - sfx.pos);
+    int slot;
+
+    if (len <= DOMAIN_JUMP_SIZE) {
+      break;
+    }
+    /* The table is never full, there is an unused slot to stop at */
+    for (slot = hash & (NUM_DOMAIN_OFFSETS - 1); mdns->domain_offsets[slot] != 0;
+         slot = (slot + 1) & (NUM_DOMAIN_OFFSETS - 1)) {
+      if (mdns->domain_hashes[slot] == hash &&
+          mdns_readname(outpkt->pbuf, mdns->domain_offsets[slot], &target) != MDNS_READNAME_ERROR &&
+          target.length == len && memcmp(target.name, &domain->name[sfx.pos], len) == 0) {
+        *offset = mdns->domain_offsets[slot];
+        return sfx.pos;
+      }
+    }
+  }
+  return domain->length;
+}
+
+/**
+ * Return bytes needed in the outpacket for a domain, with compression
+ * against the names already written
+ */
+static u16_t
+mdns_compress_len(struct mdns_outpacket *outpkt, struct mdns_domain *domain)
+{
+  u16_t offset;
+  u16_t len = mdns_compress_lookup(outpkt, domain, &offset);
+  return (len < domain->length) ? (u16_t)(len + DOMAIN_JUMP_SIZE) : len;
+}
+
+/**
+ * Add the suffixes in the first writelen bytes of a domain to the hash table
+ * @param outpkt The outpacket the domain is written to
+ * @param domain The domain, written at outpkt->write_offset
+ * @param writelen Bytes of the domain written before a jump, if any
+ */
+static void
+mdns_compress_store(struct mdns_outpacket *outpkt, struct mdns_domain *domain, u16_t writelen)
+{
+  struct mdns_host *mdns = NETIF_TO_HOST(outpkt->netif);
+  struct mdns_domain_suffix sfx;
+
+  for (mdns_suffix_first(&sfx, domain); mdns_suffix_valid(&sfx, domain) && sfx.pos < writelen;
+       mdns_suffix_next(&sfx, domain)) {
+    u16_t hash = mdns_suffix_hash(&sfx);
+    int slot = hash & (NUM_DOMAIN_OFFSETS - 1);
+
+    if (mdns->domain_count >= MAX_DOMAIN_OFFSETS ||
+        outpkt->write_offset + sfx.pos > (u16_t)~DOMAIN_JUMP) {
+      /* Table full or beyond the reach of a jump, later names are
+       * written without these suffixes */
+      break;
+    }
+    while (mdns->domain_offsets[slot] != 0) {
+      slot = (slot + 1) & (NUM_DOMAIN_OFFSETS - 1);
+    }
+    mdns->domain_hashes[slot] = hash;
+    mdns->domain_offsets[slot] = (u16_t)(outpkt->write_offset + sfx.pos);
+    mdns->domain_count++;
+  }
+}
+
+/** Clear the written suffixes when a new outpacket is started */
+static void
+mdns_compress_reset(struct mdns_outpacket *outpkt)
+{
+  struct mdns_host *mdns = NETIF_TO_HOST(outpkt->netif);
+  memset(mdns->domain_offsets, 0, sizeof(mdns->domain_offsets));
+  mdns->domain_count = 0;
+}
+
 /**
  * Write domain to outpacket. Compression will be attempted,
  * unless domain->skip_compression is set.
@@ -837,24 +1089,12 @@ mdns_compress_domain(struct pbuf *pbuf, u16_t *offset, struct mdns_domain *domai
 static err_t
 mdns_write_domain(struct mdns_outpacket *outpkt, struct mdns_domain *domain)
 {
-  int i;
   err_t res;
-  u16_t writelen = domain->length;
+  u16_t writelen;
   u16_t jump_offset = 0;
   u16_t jump;
 
-  if (!domain->skip_compression) {
-    for (i = 0; i < NUM_DOMAIN_OFFSETS; i++) {
-      u16_t offset = outpkt->domain_offsets[i];
-      if (offset) {
-        u16_t len = mdns_compress_domain(outpkt->pbuf, &offset, domain);
-        if (len < writelen) {
-          writelen = len;
-          jump_offset = offset;
-        }
-      }
-    }
-  }
+  writelen = mdns_compress_lookup(outpkt, domain, &jump_offset);
 
   if (writelen) {
     /* Write uncompressed part of name */
@@ -863,13 +1103,8 @@ mdns_write_domain(struct mdns_outpacket *outpkt, struct mdns_domain *domain)
       return res;
     }
 
-    /* Store offset of this new domain */
-    for (i = 0; i < NUM_DOMAIN_OFFSETS; i++) {
-      if (outpkt->domain_offsets[i] == 0) {
-        outpkt->domain_offsets[i] = outpkt->write_offset;
-        break;
-      }
-    }
+    /* Store offsets of the suffixes of this new domain */
+    mdns_compress_store(outpkt, domain, writelen);
 
     outpkt->write_offset += writelen;
   }
@@ -911,10 +1146,11 @@ mdns_add_question(struct mdns_outpacket *outpkt, struct mdns_domain *domain, u16
       return ERR_MEM;
     }
     outpkt->write_offset = SIZEOF_DNS_HDR;
+    mdns_compress_reset(outpkt);
   }
 
-  /* Worst case calculation. Domain string might be compressed */
-  question_len = domain->length + sizeof(type) + sizeof(klass);
+  /* Domain string might be compressed */
+  question_len = mdns_compress_len(outpkt, domain) + sizeof(type) + sizeof(klass);
   if (outpkt->write_offset + question_len > outpkt->pbuf->tot_len) {
     /* No space */
     return ERR_MEM;
@@ -983,15 +1219,17 @@ mdns_add_answer(struct mdns_outpacket *reply, struct mdns_domain *domain, u16_t
       return ERR_MEM;
     }
     reply->write_offset = SIZEOF_DNS_HDR;
+    mdns_compress_reset(reply);
   }
 
-  /* Worst case calculation. Domain strings might be compressed */
-  answer_len = domain->length + sizeof(type) + sizeof(klass) + sizeof(ttl) + sizeof(field16)/*rd_length*/;
+  /* Domain strings might be compressed. The answer domain may also compress
+   * against the domain, so its length here is an upper bound. */
+  answer_len = mdns_compress_len(reply, domain) + sizeof(type) + sizeof(klass) + sizeof(ttl) + sizeof(field16)/*rd_length*/;
   if (buf) {
     answer_len += (u16_t)buf_length;
   }
   if (answer_domain) {
-    answer_len += answer_domain->length;
+    answer_len += mdns_compress_len(reply, answer_domain);
   }
   if (reply->write_offset + answer_len > reply->pbuf->tot_len) {
     /* No space */
@@ -1299,6 +1537,225 @@ mdns_init_outpacket(struct mdns_outpacket *out, struct mdns_packet *in)
   }
 }
 
+#if MDNS_RESP_CACHE_ENTRIES
+/**
+ * Drop all cached replies of a host
+ * @param mdns The host whose names or services changed
+ */
+static void
+mdns_cache_flush(struct mdns_host *mdns)
+{
+  int i;
+  for (i = 0; i < MDNS_RESP_CACHE_ENTRIES; i++) {
+    mdns->cache[i].len = 0;
+  }
+}
+
+#endif /* MDNS_RESP_CACHE_ENTRIES */
+
+/**
+ * Drop the cached replies and the multicast times if the netif addresses
+ * are not the ones they were written with
+ */
+static void
+mdns_check_addrs(struct netif *netif, struct mdns_host *mdns)
+{
+  u8_t changed = 0;
+#if LWIP_IPV6
+  int i;
+  u8_t valid = 0;
+
+  for (i = 0; i < LWIP_IPV6_NUM_ADDRESSES; i++) {
+    if (ip6_addr_isvalid(netif_ip6_addr_state(netif, i))) {
+      valid |= (1 << i);
+      if (memcmp(&mdns->addr_v6[i], netif_ip6_addr(netif, i), sizeof(ip6_addr_p_t)) != 0) {
+        SMEMCPY(&mdns->addr_v6[i], netif_ip6_addr(netif, i), sizeof(ip6_addr_p_t));
+        changed = 1;
+      }
+    }
+  }
+  if (valid != mdns->addr_v6_valid) {
+    mdns->addr_v6_valid = valid;
+    changed = 1;
+  }
+#endif
+#if LWIP_IPV4
+  if (!ip4_addr_cmp(&mdns->addr_v4, netif_ip4_addr(netif))) {
+    ip4_addr_copy(mdns->addr_v4, *netif_ip4_addr(netif));
+    changed = 1;
+  }
+#endif
+  if (changed) {
+#if MDNS_RESP_CACHE_ENTRIES
+    mdns_cache_flush(mdns);
+#endif
+    mdns->rr_multicast[0] = mdns->rr_multicast[1] = 0;
+  }
+}
+
+/**
+ * Check if a record goes in an outpacket, and mark it as written
+ * @param outpkt The outpacket being written
+ * @param rr Index of the record (MDNS_RR_*)
+ * @return 1 if the record is to be written, 0 if it is skipped or already in the packet
+ */
+static int
+mdns_rr_take(struct mdns_outpacket *outpkt, int rr)
+{
+  if ((outpkt->rr_skip | outpkt->rr_written) & MDNS_RR_BIT(rr)) {
+    return 0;
+  }
+  outpkt->rr_written |= MDNS_RR_BIT(rr);
+  return 1;
+}
+
+/**
+ * Leave out of a multicast reply the records multicast less than interval
+ * ms ago on the same IP version (RFC 6762 section 6). The querier got them
+ * from that reply.
+ * @param outpkt The outpacket with the reply bitmasks set
+ * @param interval Minimum time between two multicasts of a record
+ */
+static void
+mdns_rate_limit(struct mdns_outpacket *outpkt, u32_t interval)
+{
+  struct mdns_host *mdns = NETIF_TO_HOST(outpkt->netif);
+  int v6 = IP_IS_V6_VAL(outpkt->dest_addr) ? 1 : 0;
+  u32_t now = sys_now();
+  int rr;
+
+  for (rr = 0; rr < MDNS_RR_COUNT; rr++) {
+    if ((mdns->rr_multicast[v6] & MDNS_RR_BIT(rr)) &&
+        (u32_t)(now - mdns->rr_sent[v6][rr]) < interval) {
+      outpkt->rr_skip |= MDNS_RR_BIT(rr);
+    }
+  }
+}
+
+/** Keep the time the records of an outpacket were multicast */
+static void
+mdns_rate_sent(struct mdns_outpacket *outpkt)
+{
+  struct mdns_host *mdns = NETIF_TO_HOST(outpkt->netif);
+  int v6 = IP_IS_V6_VAL(outpkt->dest_addr) ? 1 : 0;
+  u32_t now = sys_now();
+  int rr;
+
+  for (rr = 0; rr < MDNS_RR_COUNT; rr++) {
+    if (outpkt->rr_written & MDNS_RR_BIT(rr)) {
+      mdns->rr_sent[v6][rr] = now;
+    }
+  }
+  mdns->rr_multicast[v6] |= outpkt->rr_written;
+}
+
+#if MDNS_RESP_CACHE_ENTRIES
+/** FNV-1a hash of the TXT data last prepared for a service */
+static u32_t
+mdns_cache_txt_hash(struct mdns_service *service)
+{
+  u32_t hash = 2166136261UL;
+  u16_t i;
+  for (i = 0; i < service->txtdata.length; i++) {
+    hash = (hash ^ service->txtdata.name[i]) * 16777619UL;
+  }
+  return hash;
+}
+
+/** Return 1 if the reply has the TXT record of service slot i */
+static int
+mdns_cache_has_txt(const u8_t *serv_replies, int i)
+{
+  return (serv_replies[i] & (REPLY_SERVICE_NAME_PTR | REPLY_SERVICE_TXT)) != 0;
+}
+
+/**
+ * Find a cached reply with the answers selected in an outpacket
+ * @param outpkt The outpacket with the reply bitmasks set
+ * @param flags Header flags of the reply
+ * @return The cached reply, or NULL if it has to be written
+ */
+static struct mdns_cached_reply *
+mdns_cache_find(struct mdns_outpacket *outpkt, u8_t flags)
+{
+  struct mdns_host *mdns = NETIF_TO_HOST(outpkt->netif);
+  struct mdns_cached_reply *cached;
+  int i, j;
+
+  for (i = 0; i < MDNS_RESP_CACHE_ENTRIES; i++) {
+    cached = &mdns->cache[i];
+    if (cached->len == 0 || cached->flags != flags ||
+        cached->cache_flush != outpkt->cache_flush ||
+        cached->host_replies != outpkt->host_replies ||
+        cached->host_reverse_v6_replies != outpkt->host_reverse_v6_replies ||
+        cached->rr_skip != outpkt->rr_skip ||
+        memcmp(cached->serv_replies, outpkt->serv_replies, sizeof(cached->serv_replies)) != 0) {
+      continue;
+    }
+    /* TXT data comes from a callback and may have changed */
+    for (j = 0; j < MDNS_MAX_SERVICES; j++) {
+      if (mdns->services[j] && mdns_cache_has_txt(cached->serv_replies, j)) {
+        mdns_prepare_txtdata(mdns->services[j]);
+        if (mdns_cache_txt_hash(mdns->services[j]) != cached->txt_hash[j]) {
+          break;
+        }
+      }
+    }
+    if (j < MDNS_MAX_SERVICES) {
+      cached->len = 0;
+      return NULL;
+    }
+    cached->last_use = ++mdns->cache_use;
+    return cached;
+  }
+  return NULL;
+}
+
+/**
+ * Keep a written reply, replacing the least recently used one
+ * @param outpkt The outpacket, with the header written
+ * @param flags Header flags of the reply
+ */
+static void
+mdns_cache_store(struct mdns_outpacket *outpkt, u8_t flags)
+{
+  struct mdns_host *mdns = NETIF_TO_HOST(outpkt->netif);
+  struct mdns_cached_reply *cached = &mdns->cache[0];
+  int i;
+
+  if (outpkt->write_offset > sizeof(cached->data)) {
+    return;
+  }
+  for (i = 0; i < MDNS_RESP_CACHE_ENTRIES && cached->len != 0; i++) {
+    struct mdns_cached_reply *entry = &mdns->cache[i];
+    if (entry->len == 0 ||
+        (u16_t)(mdns->cache_use - entry->last_use) > (u16_t)(mdns->cache_use - cached->last_use)) {
+      cached = entry;
+    }
+  }
+
+  cached->flags = flags;
+  cached->cache_flush = outpkt->cache_flush;
+  cached->host_replies = outpkt->host_replies;
+  cached->host_reverse_v6_replies = outpkt->host_reverse_v6_replies;
+  SMEMCPY(cached->serv_replies, outpkt->serv_replies, sizeof(cached->serv_replies));
+  cached->rr_skip = outpkt->rr_skip;
+  cached->rr_written = outpkt->rr_written;
+  for (i = 0; i < MDNS_MAX_SERVICES; i++) {
+    /* The TXT data was prepared while the reply was written */
+    cached->txt_hash[i] = 0;
+    if (mdns->services[i] && mdns_cache_has_txt(cached->serv_replies, i)) {
+      cached->txt_hash[i] = mdns_cache_txt_hash(mdns->services[i]);
+    }
+  }
+  cached->answers = outpkt->answers;
+  cached->authoritative = outpkt->authoritative;
+  cached->additional = outpkt->additional;
+  cached->len = pbuf_copy_partial(outpkt->pbuf, cached->data, outpkt->write_offset, 0);
+  cached->last_use = ++mdns->cache_use;
+}
+#endif /* MDNS_RESP_CACHE_ENTRIES */
+
 /**
  * Send chosen answers as a reply
  *
@@ -1314,17 +1771,48 @@ mdns_send_outpacket(struct mdns_outpacket *outpkt, u8_t flags)
   int i;
   struct mdns_host *mdns = NETIF_TO_HOST(outpkt->netif);
   u16_t answers = 0;
+  u32_t answered, addr_answered;
+#if MDNS_RESP_CACHE_ENTRIES
+  struct mdns_cached_reply *cached;
+  /* Replies without questions (not legacy or probe) are the same
+   * for the same answers */
+  u8_t cacheable = (outpkt->pbuf == NULL && !outpkt->legacy_query);
+#endif
+
+  mdns_check_addrs(outpkt->netif, mdns);
+#if MDNS_RESP_CACHE_ENTRIES
+
+  if (cacheable) {
+    cached = mdns_cache_find(outpkt, flags);
+    if (cached) {
+      LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Sending cached reply\n"));
+      outpkt->pbuf = pbuf_alloc(PBUF_TRANSPORT, cached->len, PBUF_RAM);
+      if (!outpkt->pbuf) {
+        res = ERR_MEM;
+        goto cleanup;
+      }
+      pbuf_take(outpkt->pbuf, cached->data, cached->len);
+      outpkt->write_offset = cached->len;
+      outpkt->answers = cached->answers;
+      outpkt->authoritative = cached->authoritative;
+      outpkt->additional = cached->additional;
+      outpkt->rr_written = cached->rr_written;
+      cacheable = 0;
+      goto send;
+    }
+  }
+#endif
 
   /* Write answers to host questions */
 #if LWIP_IPV4
-  if (outpkt->host_replies & REPLY_HOST_A) {
+  if ((outpkt->host_replies & REPLY_HOST_A) && mdns_rr_take(outpkt, MDNS_RR_HOST_A)) {
     res = mdns_add_a_answer(outpkt, outpkt->cache_flush, outpkt->netif);
     if (res != ERR_OK) {
       goto cleanup;
     }
     answers++;
   }
-  if (outpkt->host_replies & REPLY_HOST_PTR_V4) {
+  if ((outpkt->host_replies & REPLY_HOST_PTR_V4) && mdns_rr_take(outpkt, MDNS_RR_HOST_PTR_V4)) {
     res = mdns_add_hostv4_ptr_answer(outpkt, outpkt->cache_flush, outpkt->netif);
     if (res != ERR_OK) {
       goto cleanup;
@@ -1336,7 +1824,8 @@ mdns_send_outpacket(struct mdns_outpacket *outpkt, u8_t flags)
   if (outpkt->host_replies & REPLY_HOST_AAAA) {
     int addrindex;
     for (addrindex = 0; addrindex < LWIP_IPV6_NUM_ADDRESSES; addrindex++) {
-      if (ip6_addr_isvalid(netif_ip6_addr_state(outpkt->netif, addrindex))) {
+      if (ip6_addr_isvalid(netif_ip6_addr_state(outpkt->netif, addrindex)) &&
+          mdns_rr_take(outpkt, MDNS_RR_HOST_AAAA(addrindex))) {
         res = mdns_add_aaaa_answer(outpkt, outpkt->cache_flush, outpkt->netif, addrindex);
         if (res != ERR_OK) {
           goto cleanup;
@@ -1349,7 +1838,7 @@ mdns_send_outpacket(struct mdns_outpacket *outpkt, u8_t flags)
     u8_t rev_addrs = outpkt->host_reverse_v6_replies;
     int addrindex = 0;
     while (rev_addrs) {
-      if (rev_addrs & 1) {
+      if ((rev_addrs & 1) && mdns_rr_take(outpkt, MDNS_RR_HOST_PTR_V6(addrindex))) {
         res = mdns_add_hostv6_ptr_answer(outpkt, outpkt->cache_flush, outpkt->netif, addrindex);
         if (res != ERR_OK) {
           goto cleanup;
@@ -1369,7 +1858,8 @@ mdns_send_outpacket(struct mdns_outpacket *outpkt, u8_t flags)
       continue;
     }
 
-    if (outpkt->serv_replies[i] & REPLY_SERVICE_TYPE_PTR) {
+    if ((outpkt->serv_replies[i] & REPLY_SERVICE_TYPE_PTR) &&
+        mdns_rr_take(outpkt, MDNS_RR_SERVICE(i, MDNS_RR_TYPE_PTR))) {
       res = mdns_add_servicetype_ptr_answer(outpkt, service);
       if (res != ERR_OK) {
         goto cleanup;
@@ -1377,7 +1867,8 @@ mdns_send_outpacket(struct mdns_outpacket *outpkt, u8_t flags)
       answers++;
     }
 
-    if (outpkt->serv_replies[i] & REPLY_SERVICE_NAME_PTR) {
+    if ((outpkt->serv_replies[i] & REPLY_SERVICE_NAME_PTR) &&
+        mdns_rr_take(outpkt, MDNS_RR_SERVICE(i, MDNS_RR_NAME_PTR))) {
       res = mdns_add_servicename_ptr_answer(outpkt, service);
       if (res != ERR_OK) {
         goto cleanup;
@@ -1385,7 +1876,8 @@ mdns_send_outpacket(struct mdns_outpacket *outpkt, u8_t flags)
       answers++;
     }
 
-    if (outpkt->serv_replies[i] & REPLY_SERVICE_SRV) {
+    if ((outpkt->serv_replies[i] & REPLY_SERVICE_SRV) &&
+        mdns_rr_take(outpkt, MDNS_RR_SERVICE(i, MDNS_RR_SRV))) {
       res = mdns_add_srv_answer(outpkt, outpkt->cache_flush, mdns, service);
       if (res != ERR_OK) {
         goto cleanup;
@@ -1393,7 +1885,8 @@ mdns_send_outpacket(struct mdns_outpacket *outpkt, u8_t flags)
       answers++;
     }
 
-    if (outpkt->serv_replies[i] & REPLY_SERVICE_TXT) {
+    if ((outpkt->serv_replies[i] & REPLY_SERVICE_TXT) &&
+        mdns_rr_take(outpkt, MDNS_RR_SERVICE(i, MDNS_RR_TXT))) {
       res = mdns_add_txt_answer(outpkt, outpkt->cache_flush, service);
       if (res != ERR_OK) {
         goto cleanup;
@@ -1409,17 +1902,25 @@ mdns_send_outpacket(struct mdns_outpacket *outpkt, u8_t flags)
     outpkt->authoritative += answers;
   }
 
-  /* All answers written, add additional RRs */
+  /* All answers written, add additional RRs for the answers not skipped.
+   * Records already written or skipped are not added again. */
+  answered = outpkt->rr_written;
+  addr_answered = answered & MDNS_RR_BIT(MDNS_RR_HOST_A);
+#if LWIP_IPV6
+  for (i = 0; i < LWIP_IPV6_NUM_ADDRESSES; i++) {
+    addr_answered |= answered & MDNS_RR_BIT(MDNS_RR_HOST_AAAA(i));
+  }
+#endif
   for (i = 0; i < MDNS_MAX_SERVICES; i++) {
     service = mdns->services[i];
     if (!service) {
       continue;
     }
 
-    if (outpkt->serv_replies[i] & REPLY_SERVICE_NAME_PTR) {
+    if (answered & MDNS_RR_BIT(MDNS_RR_SERVICE(i, MDNS_RR_NAME_PTR))) {
       /* Our service instance requested, include SRV & TXT
        * if they are already not requested. */
-      if (!(outpkt->serv_replies[i] & REPLY_SERVICE_SRV)) {
+      if (mdns_rr_take(outpkt, MDNS_RR_SERVICE(i, MDNS_RR_SRV))) {
         res = mdns_add_srv_answer(outpkt, outpkt->cache_flush, mdns, service);
         if (res != ERR_OK) {
           goto cleanup;
@@ -1427,7 +1928,7 @@ mdns_send_outpacket(struct mdns_outpacket *outpkt, u8_t flags)
         outpkt->additional++;
       }
 
-      if (!(outpkt->serv_replies[i] & REPLY_SERVICE_TXT)) {
+      if (mdns_rr_take(outpkt, MDNS_RR_SERVICE(i, MDNS_RR_TXT))) {
         res = mdns_add_txt_answer(outpkt, outpkt->cache_flush, service);
         if (res != ERR_OK) {
           goto cleanup;
@@ -1439,25 +1940,24 @@ mdns_send_outpacket(struct mdns_outpacket *outpkt, u8_t flags)
     /* If service instance, SRV, record or an IP address is requested,
      * supply all addresses for the host
      */
-    if ((outpkt->serv_replies[i] & (REPLY_SERVICE_NAME_PTR | REPLY_SERVICE_SRV)) ||
-        (outpkt->host_replies & (REPLY_HOST_A | REPLY_HOST_AAAA))) {
+    if ((answered & (MDNS_RR_BIT(MDNS_RR_SERVICE(i, MDNS_RR_NAME_PTR)) |
+                     MDNS_RR_BIT(MDNS_RR_SERVICE(i, MDNS_RR_SRV)))) || addr_answered) {
 #if LWIP_IPV6
-      if (!(outpkt->host_replies & REPLY_HOST_AAAA)) {
-        int addrindex;
-        for (addrindex = 0; addrindex < LWIP_IPV6_NUM_ADDRESSES; addrindex++) {
-          if (ip6_addr_isvalid(netif_ip6_addr_state(outpkt->netif, addrindex))) {
-            res = mdns_add_aaaa_answer(outpkt, outpkt->cache_flush, outpkt->netif, addrindex);
-            if (res != ERR_OK) {
-              goto cleanup;
-            }
-            outpkt->additional++;
+      int addrindex;
+      for (addrindex = 0; addrindex < LWIP_IPV6_NUM_ADDRESSES; addrindex++) {
+        if (ip6_addr_isvalid(netif_ip6_addr_state(outpkt->netif, addrindex)) &&
+            mdns_rr_take(outpkt, MDNS_RR_HOST_AAAA(addrindex))) {
+          res = mdns_add_aaaa_answer(outpkt, outpkt->cache_flush, outpkt->netif, addrindex);
+          if (res != ERR_OK) {
+            goto cleanup;
           }
+          outpkt->additional++;
         }
       }
 #endif
 #if LWIP_IPV4
-      if (!(outpkt->host_replies & REPLY_HOST_A) &&
-          !ip4_addr_isany_val(*netif_ip4_addr(outpkt->netif))) {
+      if (!ip4_addr_isany_val(*netif_ip4_addr(outpkt->netif)) &&
+          mdns_rr_take(outpkt, MDNS_RR_HOST_A)) {
         res = mdns_add_a_answer(outpkt, outpkt->cache_flush, outpkt->netif);
         if (res != ERR_OK) {
           goto cleanup;
@@ -1468,6 +1968,9 @@ mdns_send_outpacket(struct mdns_outpacket *outpkt, u8_t flags)
     }
   }
 
+#if MDNS_RESP_CACHE_ENTRIES
+send:
+#endif
   if (outpkt->pbuf) {
     const ip_addr_t *mcast_destaddr;
     struct dns_hdr hdr;
@@ -1484,6 +1987,11 @@ mdns_send_outpacket(struct mdns_outpacket *outpkt, u8_t flags)
 
     /* Shrink packet */
     pbuf_realloc(outpkt->pbuf, outpkt->write_offset);
+#if MDNS_RESP_CACHE_ENTRIES
+    if (cacheable) {
+      mdns_cache_store(outpkt, flags);
+    }
+#endif
 
     if (IP_IS_V6_VAL(outpkt->dest_addr)) {
 #if LWIP_IPV6
@@ -1500,6 +2008,9 @@ mdns_send_outpacket(struct mdns_outpacket *outpkt, u8_t flags)
       res = udp_sendto_if(mdns_pcb, outpkt->pbuf, &outpkt->dest_addr, outpkt->dest_port, outpkt->netif);
     } else {
       res = udp_sendto_if(mdns_pcb, outpkt->pbuf, mcast_destaddr, LWIP_IANA_PORT_MDNS, outpkt->netif);
+      if (res == ERR_OK && (flags & DNS_FLAG1_RESPONSE)) {
+        mdns_rate_sent(outpkt);
+      }
     }
   }
 
@@ -1622,6 +2133,9 @@ mdns_handle_question(struct mdns_packet *pkt)
     struct mdns_answer ans;
     u8_t rev_v6;
     int match;
+    /* Only the answer section holds known answers, a probe
+     * has the records it claims in the authority section */
+    int known = (pkt->answers - pkt->answers_left) < pkt->known_answers;
 
     res = mdns_read_answer(pkt, &ans);
     if (res != ERR_OK) {
@@ -1634,15 +2148,17 @@ mdns_handle_question(struct mdns_packet *pkt)
     LWIP_DEBUGF(MDNS_DEBUG, (" type %d class %d\n", ans.info.type, ans.info.klass));
 
 
-    if (ans.info.type == DNS_RRTYPE_ANY || ans.info.klass == DNS_RRCLASS_ANY) {
+    if (!known || ans.info.type == DNS_RRTYPE_ANY || ans.info.klass == DNS_RRCLASS_ANY) {
       /* Skip known answers for ANY type & class */
       continue;
     }
 
+    /* Any of our records matching the known answer is left out, also
+     * from the additional section */
     rev_v6 = 0;
-    match = reply.host_replies & check_host(pkt->netif, &ans.info, &rev_v6);
+    match = check_host(pkt->netif, &ans.info, &rev_v6);
     if (match && (ans.ttl > (mdns->dns_ttl / 2))) {
-      /* The RR in the known answer matches an RR we are planning to send,
+      /* The RR in the known answer matches one of our RRs,
        * and the TTL is less than half gone.
        * If the payload matches we should not send that answer.
        */
@@ -1656,15 +2172,16 @@ mdns_handle_question(struct mdns_packet *pkt)
 #if LWIP_IPV4
           if (match & REPLY_HOST_PTR_V4) {
             LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Skipping known answer: v4 PTR\n"));
-            reply.host_replies &= ~REPLY_HOST_PTR_V4;
+            reply.rr_skip |= MDNS_RR_BIT(MDNS_RR_HOST_PTR_V4);
           }
 #endif
 #if LWIP_IPV6
           if (match & REPLY_HOST_PTR_V6) {
-            LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Skipping known answer: v6 PTR\n"));
-            reply.host_reverse_v6_replies &= ~rev_v6;
-            if (reply.host_reverse_v6_replies == 0) {
-              reply.host_replies &= ~REPLY_HOST_PTR_V6;
+            for (i = 0; i < LWIP_IPV6_NUM_ADDRESSES; i++) {
+              if (rev_v6 & (1 << i)) {
+                LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Skipping known answer: v6 PTR %d\n", i));
+                reply.rr_skip |= MDNS_RR_BIT(MDNS_RR_HOST_PTR_V6(i));
+              }
             }
           }
 #endif
@@ -1674,16 +2191,18 @@ mdns_handle_question(struct mdns_packet *pkt)
         if (ans.rd_length == sizeof(ip4_addr_t) &&
             pbuf_memcmp(pkt->pbuf, ans.rd_offset, netif_ip4_addr(pkt->netif), ans.rd_length) == 0) {
           LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Skipping known answer: A\n"));
-          reply.host_replies &= ~REPLY_HOST_A;
+          reply.rr_skip |= MDNS_RR_BIT(MDNS_RR_HOST_A);
         }
 #endif
       } else if (match & REPLY_HOST_AAAA) {
 #if LWIP_IPV6
-        if (ans.rd_length == sizeof(ip6_addr_p_t) &&
-            /* TODO this clears all AAAA responses if first addr is set as known */
-            pbuf_memcmp(pkt->pbuf, ans.rd_offset, netif_ip6_addr(pkt->netif, 0), ans.rd_length) == 0) {
-          LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Skipping known answer: AAAA\n"));
-          reply.host_replies &= ~REPLY_HOST_AAAA;
+        /* Each address is a record of its own */
+        for (i = 0; i < LWIP_IPV6_NUM_ADDRESSES && ans.rd_length == sizeof(ip6_addr_p_t); i++) {
+          if (ip6_addr_isvalid(netif_ip6_addr_state(pkt->netif, i)) &&
+              pbuf_memcmp(pkt->pbuf, ans.rd_offset, netif_ip6_addr(pkt->netif, i), ans.rd_length) == 0) {
+            LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Skipping known answer: AAAA %d\n", i));
+            reply.rr_skip |= MDNS_RR_BIT(MDNS_RR_HOST_AAAA(i));
+          }
         }
 #endif
       }
@@ -1694,9 +2213,9 @@ mdns_handle_question(struct mdns_packet *pkt)
       if (!service) {
         continue;
       }
-      match = reply.serv_replies[i] & check_service(service, &ans.info);
+      match = check_service(service, &ans.info);
       if (match && (ans.ttl > (service->dns_ttl / 2))) {
-        /* The RR in the known answer matches an RR we are planning to send,
+        /* The RR in the known answer matches one of our RRs,
          * and the TTL is less than half gone.
          * If the payload matches we should not send that answer.
          */
@@ -1710,14 +2229,14 @@ mdns_handle_question(struct mdns_packet *pkt)
               res = mdns_build_service_domain(&my_ans, service, 0);
               if (res == ERR_OK && mdns_domain_eq(&known_ans, &my_ans)) {
                 LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Skipping known answer: service type PTR\n"));
-                reply.serv_replies[i] &= ~REPLY_SERVICE_TYPE_PTR;
+                reply.rr_skip |= MDNS_RR_BIT(MDNS_RR_SERVICE(i, MDNS_RR_TYPE_PTR));
               }
             }
             if (match & REPLY_SERVICE_NAME_PTR) {
               res = mdns_build_service_domain(&my_ans, service, 1);
               if (res == ERR_OK && mdns_domain_eq(&known_ans, &my_ans)) {
                 LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Skipping known answer: service name PTR\n"));
-                reply.serv_replies[i] &= ~REPLY_SERVICE_NAME_PTR;
+                reply.rr_skip |= MDNS_RR_BIT(MDNS_RR_SERVICE(i, MDNS_RR_NAME_PTR));
               }
             }
           }
@@ -1752,20 +2271,26 @@ mdns_handle_question(struct mdns_packet *pkt)
               break;
             }
             LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Skipping known answer: SRV\n"));
-            reply.serv_replies[i] &= ~REPLY_SERVICE_SRV;
+            reply.rr_skip |= MDNS_RR_BIT(MDNS_RR_SERVICE(i, MDNS_RR_SRV));
           } while (0);
         } else if (match & REPLY_SERVICE_TXT) {
           mdns_prepare_txtdata(service);
           if (service->txtdata.length == ans.rd_length &&
               pbuf_memcmp(pkt->pbuf, ans.rd_offset, service->txtdata.name, ans.rd_length) == 0) {
             LWIP_DEBUGF(MDNS_DEBUG, ("MDNS: Skipping known answer: TXT\n"));
-            reply.serv_replies[i] &= ~REPLY_SERVICE_TXT;
+            reply.rr_skip |= MDNS_RR_BIT(MDNS_RR_SERVICE(i, MDNS_RR_TXT));
           }
         }
       }
     }
   }
 
+  if (!reply.unicast_reply) {
+    /* A reply to a probe defends our records, it can follow sooner */
+    mdns_check_addrs(pkt->netif, mdns);
+    mdns_rate_limit(&reply, pkt->authoritative ? MDNS_RESP_PROBE_RATE_LIMIT_MS : MDNS_RESP_RATE_LIMIT_MS);
+  }
+
   mdns_send_outpacket(&reply, DNS_FLAG1_RESPONSE | DNS_FLAG1_AUTHORATIVE);
 
 cleanup:
@@ -1857,6 +2382,9 @@ mdns_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr,
   struct mdns_packet packet;
   struct netif *recv_netif = ip_current_input_netif();
   u16_t offset = 0;
+#ifdef CPU_STATS
+  u32_t cpu_start = cpu_trace_enter();
+#endif
 
   LWIP_UNUSED_ARG(arg);
   LWIP_UNUSED_ARG(pcb);
@@ -1888,6 +2416,8 @@ mdns_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr,
   packet.tx_id = lwip_ntohs(hdr.id);
   packet.questions = packet.questions_left = lwip_ntohs(hdr.numquestions);
   packet.answers = packet.answers_left = lwip_ntohs(hdr.numanswers) + lwip_ntohs(hdr.numauthrr) + lwip_ntohs(hdr.numextrarr);
+  packet.known_answers = lwip_ntohs(hdr.numanswers);
+  packet.authoritative = lwip_ntohs(hdr.numauthrr);
 
 #if LWIP_IPV6
   if (IP_IS_V6(ip_current_dest_addr())) {
@@ -1913,6 +2443,9 @@ mdns_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr,
 
 dealloc:
   pbuf_free(p);
+#ifdef CPU_STATS
+  cpu_trace_exit(CPU_SECTION_MDNS, cpu_start);
+#endif
 }
 
 #if LWIP_NETIF_EXT_STATUS_CALLBACK && MDNS_RESP_USENETIF_EXTCALLBACK
@@ -2250,6 +2783,11 @@ mdns_resp_del_service(struct netif *netif, s8_t slot)
   srv = mdns->services[slot];
   mdns->services[slot] = NULL;
   mem_free(srv);
+#if MDNS_RESP_CACHE_ENTRIES
+  mdns_cache_flush(mdns);
+#endif
+  mdns->rr_multicast[0] &= ~MDNS_RR_SERVICE_BITS(slot);
+  mdns->rr_multicast[1] &= ~MDNS_RR_SERVICE_BITS(slot);
   return ERR_OK;
 }
 
@@ -2375,6 +2913,11 @@ mdns_resp_restart(struct netif *netif)
     sys_untimeout(mdns_probe, netif);
   }
   /* @todo if we've failed 15 times within a 10 second period we MUST wait 5 seconds (or wait 5 seconds every time except first)*/
+#if MDNS_RESP_CACHE_ENTRIES
+  /* Called after a name or service change */
+  mdns_cache_flush(mdns);
+#endif
+  mdns->rr_multicast[0] = mdns->rr_multicast[1] = 0;
   mdns->probes_sent = 0;
   mdns->probing_state = MDNS_PROBING_ONGOING;
   sys_timeout(MDNS_INITIAL_PROBE_DELAY_MS, mdns_probe, netif);
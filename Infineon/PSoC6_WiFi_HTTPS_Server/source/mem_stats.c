@@ -0,0 +1,388 @@
+/******************************************************************************
+* File Name: mem_stats.c
+*
+* Description: This file contains the memory telemetry served on /stats/mem:
+*              the stack high-water mark of every task, kept after a task
+*              exits, and the newlib heap use. With GCC_ARM the Makefile wraps
+*              malloc, calloc, realloc and free at link time to count the
+*              allocations, the failures and the peak use. With LWIP_STATS,
+*              the lwIP drop counters and the use of the pools sized by the
+*              memory profile in lwipopts.h follow. Used to size the task
+*              stacks, the TLS buffers and the lwIP profile.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include "secure_http_server.h"
+#include "mem_stats.h"
+
+#include "lwip/opt.h"
+#if LWIP_STATS
+#include "lwip/stats.h"
+#include "lwip/memp.h"
+#endif
+
+#ifdef MEM_STATS
+
+/* ARM compiler also defines __GNUC__ */
+#if defined (__GNUC__) && !defined(__ARMCC_VERSION)
+#include <malloc.h>
+#define MEM_STATS_MALLINFO
+#endif
+
+
+/*******************************************************************************
+ * Data Types
+ ******************************************************************************/
+typedef struct {
+    char     name[configMAX_TASK_NAME_LEN];
+    uint32_t stackFreeMin;  /* bytes, uxTaskGetStackHighWaterMark */
+    int      exited;
+} mem_task_t;
+
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static mem_task_t mTasks[MEM_STATS_MAX_TASKS];
+static int mTaskCount;
+static int mTaskOverflow;       /* a task did not fit in mTasks */
+static int mSampleFailed;       /* the last sample read no tasks */
+
+#ifdef MEM_STATS_WRAP
+static uint32_t mAllocs;
+static uint32_t mFrees;
+static uint32_t mFailed;
+static uint32_t mInUse;
+static uint32_t mPeak;
+#endif
+static uint32_t mRtosFailed;
+
+
+/*******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+/* Updates the entry for a task name, adds it if new */
+static void mem_stats_task_set(const char* name, uint32_t stackFree, int exited)
+{
+    int i;
+
+    for (i = 0; i < mTaskCount; i++) {
+        if (strncmp(mTasks[i].name, name, sizeof(mTasks[i].name)) == 0) {
+            break;
+        }
+    }
+    if (i == mTaskCount) {
+        if (mTaskCount >= MEM_STATS_MAX_TASKS) {
+            mTaskOverflow = 1;
+            return;
+        }
+        strncpy(mTasks[i].name, name, sizeof(mTasks[i].name) - 1);
+        mTasks[i].stackFreeMin = stackFree;
+        mTaskCount++;
+    }
+    else if (stackFree < mTasks[i].stackFreeMin) {
+        mTasks[i].stackFreeMin = stackFree;
+    }
+    mTasks[i].exited = exited;
+}
+
+#ifdef MEM_STATS_WRAP
+/* The linker (-Wl,--wrap) routes malloc to __wrap_malloc and
+ * __real_malloc to the newlib one. Called from tasks and before the
+ * scheduler starts, the counters are updated with interrupts masked. */
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t num, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void  __real_free(void* ptr);
+
+static void mem_stats_alloc(void* ptr, size_t size)
+{
+    UBaseType_t state = taskENTER_CRITICAL_FROM_ISR();
+    if (ptr != NULL) {
+        mInUse += malloc_usable_size(ptr);
+        if (mInUse > mPeak) {
+            mPeak = mInUse;
+        }
+        mAllocs++;
+    }
+    else if (size > 0) {
+        mFailed++;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(state);
+}
+
+void* __wrap_malloc(size_t size)
+{
+    void* ptr = __real_malloc(size);
+    mem_stats_alloc(ptr, size);
+    return ptr;
+}
+
+void* __wrap_calloc(size_t num, size_t size)
+{
+    void* ptr = __real_calloc(num, size);
+    mem_stats_alloc(ptr, num * size);
+    return ptr;
+}
+
+void* __wrap_realloc(void* old, size_t size)
+{
+    /* usable size of the old block, read before realloc releases it */
+    size_t oldSz = (old != NULL) ? malloc_usable_size(old) : 0;
+    void* ptr = __real_realloc(old, size);
+    UBaseType_t state;
+
+    if (old == NULL) {
+        mem_stats_alloc(ptr, size);
+    }
+    else if (ptr != NULL || size == 0) {
+        /* the old block is released */
+        state = taskENTER_CRITICAL_FROM_ISR();
+        mInUse -= oldSz;
+        mFrees++;
+        taskEXIT_CRITICAL_FROM_ISR(state);
+        mem_stats_alloc(ptr, size);
+    }
+    else {
+        mem_stats_alloc(NULL, size);
+    }
+    return ptr;
+}
+
+void __wrap_free(void* ptr)
+{
+    UBaseType_t state;
+
+    if (ptr != NULL) {
+        state = taskENTER_CRITICAL_FROM_ISR();
+        mInUse -= malloc_usable_size(ptr);
+        mFrees++;
+        taskEXIT_CRITICAL_FROM_ISR(state);
+    }
+    __real_free(ptr);
+}
+#endif /* MEM_STATS_WRAP */
+
+
+#if LWIP_STATS
+/* The lwIP counters of dropped packets, and the pools of the memory
+ * profile. A pool that failed is too small for the traffic. */
+static void mem_stats_lwip_report(char* buf, size_t bufSz)
+{
+    static const struct {
+        const char* name;
+        memp_t pool;
+    } pools[] = {
+        { "pbuf pool", MEMP_PBUF_POOL },
+        { "tcp seg",   MEMP_TCP_SEG },
+        { "tcp pcb",   MEMP_TCP_PCB },
+        { "netbuf",    MEMP_NETBUF },
+    };
+    const struct stats_mem* mem;
+    size_t pos = 0;
+    int len;
+    size_t i;
+
+    len = snprintf(buf, bufSz,
+        "lwIP: tcp rx %lu, tx %lu, drop %lu (memory %lu, checksum %lu)\r\n"
+        "lwIP drops: link %lu, ip %lu, ip6 %lu, udp %lu\r\n"
+        "lwIP pools (used, max, size, failed):\r\n",
+        (unsigned long)lwip_stats.tcp.recv, (unsigned long)lwip_stats.tcp.xmit,
+        (unsigned long)lwip_stats.tcp.drop, (unsigned long)lwip_stats.tcp.memerr,
+        (unsigned long)lwip_stats.tcp.chkerr,
+        (unsigned long)lwip_stats.link.drop,
+    #if LWIP_IPV4
+        (unsigned long)lwip_stats.ip.drop,
+    #else
+        0UL,
+    #endif
+    #if LWIP_IPV6
+        (unsigned long)lwip_stats.ip6.drop,
+    #else
+        0UL,
+    #endif
+        (unsigned long)lwip_stats.udp.drop);
+    if (len > 0) {
+        pos = (size_t)len;
+    }
+    for (i = 0; i < sizeof(pools) / sizeof(pools[0]) && pos < bufSz; i++) {
+        mem = lwip_stats.memp[pools[i].pool];
+        if (mem == NULL) {
+            continue;
+        }
+        len = snprintf(buf + pos, bufSz - pos, "  %-16s %4u %4u %4u %6lu\r\n",
+            pools[i].name, (unsigned)mem->used, (unsigned)mem->max,
+            (unsigned)mem->avail, (unsigned long)mem->err);
+        if (len > 0) {
+            pos += len;
+        }
+    }
+}
+#endif /* LWIP_STATS */
+
+
+/*******************************************************************************
+ * Public Functions
+ ******************************************************************************/
+/* configUSE_MALLOC_FAILED_HOOK: pvPortMalloc (heap_3, newlib malloc)
+ * returned NULL */
+void vApplicationMallocFailedHook(void)
+{
+    mRtosFailed++;
+    ERR_INFO(("pvPortMalloc failed\n"));
+}
+
+/* Samples the stack high-water mark of every task. The status array is
+ * sized for the tasks there are, with room for a few created meanwhile:
+ * uxTaskGetSystemState returns none if they do not all fit. */
+void mem_stats_sample(void)
+{
+    TaskStatus_t* tasks;
+    UBaseType_t size, count = 0, i;
+
+    size = uxTaskGetNumberOfTasks() + 2;
+    tasks = (TaskStatus_t*)pvPortMalloc(size * sizeof(*tasks));
+    if (tasks != NULL) {
+        count = uxTaskGetSystemState(tasks, size, NULL);
+    }
+    vTaskSuspendAll();
+    mSampleFailed = (count == 0);
+    for (i = 0; i < count; i++) {
+        mem_stats_task_set(tasks[i].pcTaskName,
+            (uint32_t)tasks[i].usStackHighWaterMark * sizeof(StackType_t), 0);
+    }
+    (void)xTaskResumeAll();
+    vPortFree(tasks);
+}
+
+/* Call before a task deletes itself, keeps its stack high-water mark */
+void mem_stats_task_exit(void)
+{
+    uint32_t stackFree = (uint32_t)uxTaskGetStackHighWaterMark(NULL) *
+        sizeof(StackType_t);
+    char* name = pcTaskGetName(NULL);
+
+    vTaskSuspendAll();
+    mem_stats_task_set(name, stackFree, 1);
+    (void)xTaskResumeAll();
+}
+
+void mem_stats_heap(mem_heap_info_t* info)
+{
+    memset(info, 0, sizeof(*info));
+#ifdef MEM_STATS_MALLINFO
+    {
+        struct mallinfo mall_info = mallinfo();
+        extern uint8_t __HeapBase;  /* Symbol exported by the linker. */
+        extern uint8_t __HeapLimit; /* Symbol exported by the linker. */
+        uint32_t untouched;
+
+        info->total = (uint32_t)(&__HeapLimit - &__HeapBase);
+        untouched = info->total - mall_info.arena;
+        info->inUse = mall_info.uordblks;
+        /* the top chunk joins the heap not yet taken from sbrk */
+        info->largestFree = untouched + mall_info.keepcost;
+    #ifdef MEM_STATS_WRAP
+        info->freeMin = info->total - mPeak;
+    #else
+        /* newlib does not return the arena, its size is the peak */
+        info->freeMin = untouched;
+    #endif
+    }
+#endif
+#ifdef MEM_STATS_WRAP
+    info->allocs = mAllocs;
+    info->frees = mFrees;
+    info->failed = mFailed;
+#endif
+    info->rtosFailed = mRtosFailed;
+}
+
+const char* mem_stats_report(char* buf, size_t bufSz)
+{
+    mem_heap_info_t heap;
+    size_t pos = 0;
+    int i, len;
+
+    mem_stats_sample();
+    mem_stats_heap(&heap);
+
+    len = snprintf(buf, bufSz,
+        "Heap: %lu bytes, in use %lu, min free %lu, largest free %lu\r\n"
+        "Allocations: %lu, frees %lu, failed %lu (pvPortMalloc %lu)\r\n"
+        "Stack free (min bytes):\r\n",
+        (unsigned long)heap.total, (unsigned long)heap.inUse,
+        (unsigned long)heap.freeMin, (unsigned long)heap.largestFree,
+        (unsigned long)heap.allocs, (unsigned long)heap.frees,
+        (unsigned long)heap.failed, (unsigned long)heap.rtosFailed);
+    if (len > 0) {
+        pos = (size_t)len;
+    }
+    for (i = 0; i < mTaskCount && pos < bufSz; i++) {
+        len = snprintf(buf + pos, bufSz - pos, "  %-16s %6lu%s\r\n",
+            mTasks[i].name, (unsigned long)mTasks[i].stackFreeMin,
+            mTasks[i].exited ? " (exited)" : "");
+        if (len > 0) {
+            pos += len;
+        }
+    }
+    if ((mSampleFailed || mTaskOverflow) && pos < bufSz) {
+        len = snprintf(buf + pos, bufSz - pos, "  %s\r\n", mSampleFailed ?
+            "(task stacks not sampled)" :
+            "(more tasks than MEM_STATS_MAX_TASKS, not all listed)");
+        if (len > 0) {
+            pos += len;
+        }
+    }
+#if LWIP_STATS
+    if (pos < bufSz) {
+        mem_stats_lwip_report(buf + pos, bufSz - pos);
+    }
+#endif
+    return buf;
+}
+
+#endif /* MEM_STATS */
+
+/* [] END OF FILE */
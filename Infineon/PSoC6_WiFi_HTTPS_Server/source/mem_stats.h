@@ -0,0 +1,83 @@
+/******************************************************************************
+* File Name: mem_stats.h
+*
+* Description: This file contains the per-task stack high-water marks and the
+* heap statistics served on /stats/mem.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef MEM_STATS_H_
+#define MEM_STATS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* tasks kept in the stack table, including the ones that have exited.
+ * The report says so if there are more. */
+#ifndef MEM_STATS_MAX_TASKS
+#define MEM_STATS_MAX_TASKS         (24)
+#endif
+
+/*******************************************************************************
+* Data Types
+*******************************************************************************/
+typedef struct {
+    uint32_t total;         /* heap size (linker __HeapBase to __HeapLimit) */
+    uint32_t inUse;         /* allocated now */
+    uint32_t freeMin;       /* minimum ever free */
+    uint32_t largestFree;   /* largest block that can still be allocated */
+    uint32_t allocs;        /* malloc, calloc and realloc calls */
+    uint32_t frees;
+    uint32_t failed;        /* allocations that returned NULL */
+    uint32_t rtosFailed;    /* of those, from pvPortMalloc */
+} mem_heap_info_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+void mem_stats_sample(void);
+void mem_stats_task_exit(void);
+void mem_stats_heap(mem_heap_info_t* info);
+const char* mem_stats_report(char* buf, size_t bufSz);
+
+#endif /* MEM_STATS_H_ */
+
+/* [] END OF FILE */
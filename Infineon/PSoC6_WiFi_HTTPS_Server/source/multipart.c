@@ -0,0 +1,343 @@
+/******************************************************************************
+* File Name: multipart.c
+*
+* Description: This file contains a streaming multipart/form-data parser.
+*              The body can be passed in segments of any size (for example as
+*              received in TLS records). Part data is found with a KMP matcher
+*              on the delimiter that keeps its state across segments, so each
+*              byte is only looked at once.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+
+#include "multipart.h"
+
+
+/*******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+static void multipart_reset_part(multipart_t* mp)
+{
+    mp->lineSz = 0;
+    mp->name[0] = '\0';
+    mp->fileName[0] = '\0';
+}
+
+/* hand part data to the callback, the preamble is discarded */
+static int multipart_emit(multipart_t* mp, const uint8_t* data, size_t sz)
+{
+    if (sz == 0 || mp->state != MULTIPART_STATE_DATA ||
+            mp->partData == NULL) {
+        return MULTIPART_SUCCESS;
+    }
+    return mp->partData(mp, data, sz, mp->ctx);
+}
+
+/* Get a parameter value from a header line such as
+ *  Content-Disposition: form-data; name="data"; filename="fw.bin" */
+static void multipart_get_param(const char* line, const char* key,
+    char* out, size_t outSz)
+{
+    size_t keySz = strlen(key), sz;
+    const char* p = strchr(line, ';');
+    const char* end;
+
+    while (p != NULL) {
+        p++;
+        while (*p == ' ' || *p == '\t')
+            p++;
+        if (strncasecmp(p, key, keySz) == 0 && p[keySz] == '=') {
+            p += keySz + 1;
+            if (*p == '"') {
+                p++;
+                end = strchr(p, '"');
+            }
+            else {
+                end = strchr(p, ';');
+            }
+            if (end == NULL)
+                end = p + strlen(p);
+            sz = end - p;
+            if (sz > outSz - 1)
+                sz = outSz - 1;
+            memcpy(out, p, sz);
+            out[sz] = '\0'; /* null term */
+            return;
+        }
+        p = strchr(p, ';');
+    }
+}
+
+static void multipart_parse_header(multipart_t* mp)
+{
+    static const char contentDisp[] = "Content-Disposition:";
+
+    if (strncasecmp(mp->line, contentDisp, sizeof(contentDisp)-1) == 0) {
+        multipart_get_param(mp->line, "name", mp->name, sizeof(mp->name));
+        multipart_get_param(mp->line, "filename", mp->fileName,
+            sizeof(mp->fileName));
+    }
+}
+
+/* Collect a header line, returns 1 once the line is complete */
+static int multipart_line(multipart_t* mp, uint8_t c)
+{
+    if (c == '\n') {
+        /* drop CR and trailing whitespace */
+        while (mp->lineSz > 0 && isspace((int)mp->line[mp->lineSz-1]))
+            mp->lineSz--;
+        mp->line[mp->lineSz] = '\0';
+        return 1;
+    }
+    if (mp->lineSz < sizeof(mp->line) - 1) {
+        mp->line[mp->lineSz++] = (char)c;
+    }
+    return 0;
+}
+
+/* Search a segment for the delimiter. Part data before it is passed on as
+ * views into the segment; matched bytes are held back until the match
+ * completes or fails, which may be in a later segment. On a failed match
+ * the held bytes are a prefix of the delimiter and are passed on from it.
+ * Returns 1 with the bytes used (up to the end of the delimiter) once
+ * found, 0 if the whole segment is used or a callback error. */
+static int multipart_scan(multipart_t* mp, const uint8_t* data, size_t sz,
+    size_t* used)
+{
+    const uint8_t* p;
+    size_t i = 0, k, drop;
+    int rc;
+
+    while (i < sz) {
+        if (mp->match == 0) {
+            /* fast skip to the next candidate */
+            p = memchr(&data[i], mp->delim[0], sz - i);
+            if (p == NULL) {
+                i = sz;
+                break;
+            }
+            i = p - data;
+        }
+        while (mp->match > 0 && (uint8_t)mp->delim[mp->match] != data[i]) {
+            k = mp->fail[mp->match - 1];
+            if (mp->held > 0) {
+                drop = mp->match - k;
+                if (drop > mp->held)
+                    drop = mp->held;
+                rc = multipart_emit(mp, (const uint8_t*)mp->delim, drop);
+                if (rc != 0)
+                    return rc;
+                mp->held -= drop;
+            }
+            mp->match = k;
+        }
+        if ((uint8_t)mp->delim[mp->match] == data[i])
+            mp->match++;
+        i++;
+        if (mp->match == mp->delimSz) {
+            rc = multipart_emit(mp, data, i - (mp->match - mp->held));
+            mp->match = 0;
+            mp->held = 0;
+            *used = i;
+            return (rc != 0) ? rc : 1;
+        }
+    }
+
+    rc = multipart_emit(mp, data, sz - (mp->match - mp->held));
+    mp->held = mp->match;
+    *used = sz;
+    return rc;
+}
+
+
+/*******************************************************************************
+ * Public Functions
+ ******************************************************************************/
+/* Set the boundary (without the leading "--"), such as from the
+ * Content-Type header. */
+int multipart_set_boundary(multipart_t* mp, const char* boundary,
+    size_t boundarySz)
+{
+    uint32_t i, k;
+
+    if (boundarySz == 0 || boundarySz > MULTIPART_MAX_BOUNDARY_SZ) {
+        return MULTIPART_BAD_BOUNDARY;
+    }
+    memcpy(mp->delim, "\r\n--", 4);
+    memcpy(&mp->delim[4], boundary, boundarySz);
+    mp->delimSz = boundarySz + 4;
+    mp->delim[mp->delimSz] = '\0';
+
+    /* KMP failure table: longest proper prefix that is also a suffix */
+    mp->fail[0] = 0;
+    for (i = 1, k = 0; i < mp->delimSz; i++) {
+        while (k > 0 && mp->delim[i] != mp->delim[k])
+            k = mp->fail[k - 1];
+        if (mp->delim[i] == mp->delim[k])
+            k++;
+        mp->fail[i] = (uint8_t)k;
+    }
+
+    /* the first boundary line has no leading CRLF */
+    mp->match = 2;
+    mp->held = 2;
+    return MULTIPART_SUCCESS;
+}
+
+/* If boundary is NULL it is taken from the first line of the body */
+void multipart_init(multipart_t* mp, const char* boundary,
+    multipart_part_cb partBegin, multipart_data_cb partData,
+    multipart_part_cb partEnd, void* ctx)
+{
+    memset(mp, 0, sizeof(*mp));
+    mp->state = MULTIPART_STATE_PREAMBLE;
+    mp->partBegin = partBegin;
+    mp->partData = partData;
+    mp->partEnd = partEnd;
+    mp->ctx = ctx;
+    if (boundary != NULL) {
+        (void)multipart_set_boundary(mp, boundary, strlen(boundary));
+    }
+}
+
+const char* multipart_get_boundary(const multipart_t* mp)
+{
+    return (mp->delimSz > 4) ? &mp->delim[4] : "";
+}
+
+/* Parse the next segment of the body. Returns MULTIPART_SUCCESS, a parse
+ * error or the error returned by a callback. Check for
+ * MULTIPART_STATE_DONE to know the close delimiter was seen. */
+int multipart_parse(multipart_t* mp, const uint8_t* data, size_t sz)
+{
+    int rc = MULTIPART_SUCCESS;
+    size_t used;
+
+    while (sz > 0 && rc == MULTIPART_SUCCESS) {
+        used = 1;
+        switch (mp->state) {
+            case MULTIPART_STATE_PREAMBLE:
+                if (mp->delimSz == 0) {
+                    /* learn the boundary from the first line */
+                    if (multipart_line(mp, *data)) {
+                        if (mp->lineSz < 3 || mp->line[0] != '-' ||
+                                mp->line[1] != '-') {
+                            rc = MULTIPART_BAD_BOUNDARY;
+                            break;
+                        }
+                        rc = multipart_set_boundary(mp, &mp->line[2],
+                            mp->lineSz - 2);
+                        mp->match = 0;
+                        mp->held = 0;
+                        multipart_reset_part(mp);
+                        mp->state = MULTIPART_STATE_HEADERS;
+                    }
+                    break;
+                }
+                /* fall-through */
+
+            case MULTIPART_STATE_DATA:
+                rc = multipart_scan(mp, data, sz, &used);
+                if (rc == 1) {
+                    rc = MULTIPART_SUCCESS;
+                    if (mp->state == MULTIPART_STATE_DATA &&
+                            mp->partEnd != NULL) {
+                        rc = mp->partEnd(mp, mp->ctx);
+                    }
+                    mp->dashes = 0;
+                    mp->state = MULTIPART_STATE_DELIM_END;
+                }
+                break;
+
+            case MULTIPART_STATE_DELIM_END:
+                /* "--" closes the body, otherwise a new part starts on the
+                 * next line (transport padding is allowed) */
+                if (*data == '-') {
+                    if (++mp->dashes == 2)
+                        mp->state = MULTIPART_STATE_DONE;
+                }
+                else if (*data == '\n' && mp->dashes == 0) {
+                    multipart_reset_part(mp);
+                    mp->state = MULTIPART_STATE_HEADERS;
+                }
+                else if (*data != ' ' && *data != '\t' && *data != '\r') {
+                    rc = MULTIPART_BAD_FORMAT;
+                }
+                break;
+
+            case MULTIPART_STATE_HEADERS:
+                if (multipart_line(mp, *data)) {
+                    if (mp->lineSz == 0) {
+                        /* blank line, part data follows */
+                        mp->partCount++;
+                        mp->state = MULTIPART_STATE_DATA;
+                        if (mp->partBegin != NULL) {
+                            rc = mp->partBegin(mp, mp->ctx);
+                        }
+                    }
+                    else {
+                        multipart_parse_header(mp);
+                        mp->lineSz = 0;
+                    }
+                }
+                break;
+
+            case MULTIPART_STATE_DONE:
+                used = sz; /* ignore the epilogue */
+                break;
+
+            case MULTIPART_STATE_ERROR:
+            default:
+                rc = MULTIPART_BAD_FORMAT;
+                break;
+        }
+        data += used;
+        sz -= used;
+    }
+
+    if (rc != MULTIPART_SUCCESS) {
+        mp->state = MULTIPART_STATE_ERROR;
+    }
+    return rc;
+}
+
+/* [] END OF FILE */
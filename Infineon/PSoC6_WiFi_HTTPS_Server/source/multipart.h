@@ -0,0 +1,128 @@
+/******************************************************************************
+* File Name: multipart.h
+*
+* Description: This file contains the streaming multipart/form-data parser
+* used for the firmware upload form.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef MULTIPART_H_
+#define MULTIPART_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* RFC 2046 limits the boundary to 70 characters */
+#define MULTIPART_MAX_BOUNDARY_SZ   (70)
+/* delimiter: CRLF "--" boundary */
+#define MULTIPART_MAX_DELIM_SZ      (MULTIPART_MAX_BOUNDARY_SZ + 4)
+/* longest part header line kept, longer lines are truncated */
+#define MULTIPART_MAX_LINE_SZ       (256)
+#define MULTIPART_MAX_NAME_SZ       (64)
+
+/* Return codes */
+#define MULTIPART_SUCCESS           (0)
+#define MULTIPART_BAD_BOUNDARY      (-1)
+#define MULTIPART_BAD_FORMAT        (-2)
+/* callbacks return any other negative value to abort parsing with it */
+
+/*******************************************************************************
+* Data Types
+*******************************************************************************/
+typedef enum {
+    MULTIPART_STATE_PREAMBLE,   /* looking for the first boundary line */
+    MULTIPART_STATE_HEADERS,    /* part header lines */
+    MULTIPART_STATE_DATA,       /* part body, up to the next delimiter */
+    MULTIPART_STATE_DELIM_END,  /* rest of the delimiter line */
+    MULTIPART_STATE_DONE,       /* close delimiter seen */
+    MULTIPART_STATE_ERROR
+} MultipartState;
+
+typedef struct multipart multipart_t;
+
+/* Called once the headers of a part are parsed (name and fileName set) */
+typedef int (*multipart_part_cb)(multipart_t* mp, void* ctx);
+/* Called with part body bytes, data is only valid for the call unless it
+ * points into the segment passed to multipart_parse() */
+typedef int (*multipart_data_cb)(multipart_t* mp, const uint8_t* data,
+    size_t sz, void* ctx);
+
+struct multipart {
+    MultipartState state;
+
+    /* delimiter and KMP failure table */
+    char     delim[MULTIPART_MAX_DELIM_SZ + 1];
+    uint8_t  fail[MULTIPART_MAX_DELIM_SZ];
+    uint32_t delimSz;
+    uint32_t match;     /* delimiter bytes matched so far */
+    uint32_t held;      /* matched bytes from previous segments */
+    uint32_t dashes;    /* close delimiter "--" count */
+
+    /* current header line */
+    char     line[MULTIPART_MAX_LINE_SZ];
+    uint32_t lineSz;
+
+    /* current part */
+    char     name[MULTIPART_MAX_NAME_SZ];
+    char     fileName[MULTIPART_MAX_NAME_SZ];
+    uint32_t partCount;
+
+    multipart_part_cb partBegin;
+    multipart_data_cb partData;
+    multipart_part_cb partEnd;
+    void*             ctx;
+};
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+void multipart_init(multipart_t* mp, const char* boundary,
+    multipart_part_cb partBegin, multipart_data_cb partData,
+    multipart_part_cb partEnd, void* ctx);
+int multipart_set_boundary(multipart_t* mp, const char* boundary,
+    size_t boundarySz);
+int multipart_parse(multipart_t* mp, const uint8_t* data, size_t sz);
+const char* multipart_get_boundary(const multipart_t* mp);
+
+#endif /* MULTIPART_H_ */
+
+/* [] END OF FILE */
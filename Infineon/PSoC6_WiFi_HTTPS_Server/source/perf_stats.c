@@ -0,0 +1,142 @@
+/******************************************************************************
+* File Name: perf_stats.c
+*
+* Description: This file contains the cycle counter timers and latency
+*              histograms used for the performance statistics. Times are
+*              taken from the Cortex-M4 DWT cycle counter.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <string.h>
+
+#include "perf_stats.h"
+
+
+/*******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+static uint32_t perf_msb(uint32_t v)
+{
+    uint32_t n = 0;
+    while (v >>= 1)
+        n++;
+    return n;
+}
+
+/* bucket of a value: power of two and the next PERF_HIST_SUB_BITS bits */
+static uint32_t perf_hist_index(uint32_t v)
+{
+    uint32_t msb;
+
+    if (v < (1UL << PERF_HIST_SUB_BITS))
+        return v;
+    msb = perf_msb(v);
+    return ((msb - PERF_HIST_SUB_BITS + 1) << PERF_HIST_SUB_BITS) |
+        ((v >> (msb - PERF_HIST_SUB_BITS)) & ((1UL << PERF_HIST_SUB_BITS) - 1));
+}
+
+/* largest value in a bucket */
+static uint32_t perf_hist_value(uint32_t idx)
+{
+    uint32_t shift, sub;
+
+    if (idx < (1UL << PERF_HIST_SUB_BITS))
+        return idx;
+    shift = (idx >> PERF_HIST_SUB_BITS) - 1;
+    sub = (idx & ((1UL << PERF_HIST_SUB_BITS) - 1)) |
+        (1UL << PERF_HIST_SUB_BITS);
+    return (uint32_t)((((uint64_t)sub + 1) << shift) - 1);
+}
+
+
+/*******************************************************************************
+ * Public Functions
+ ******************************************************************************/
+/* Enable the DWT cycle counter */
+void perf_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+uint32_t perf_cycles_to_us(uint64_t cycles)
+{
+    return (uint32_t)(cycles / (SystemCoreClock / 1000000UL));
+}
+
+void perf_timer_add(perf_timer_t* timer, uint32_t cycles)
+{
+    timer->cycles += cycles;
+    timer->count++;
+}
+
+void perf_hist_add(perf_hist_t* hist, uint32_t cycles)
+{
+    uint32_t idx = perf_hist_index(cycles);
+
+    if (hist->count == 0 || cycles < hist->min)
+        hist->min = cycles;
+    if (cycles > hist->max)
+        hist->max = cycles;
+    hist->count++;
+    hist->sum += cycles;
+    if (hist->bucket[idx] < UINT16_MAX)
+        hist->bucket[idx]++;
+}
+
+/* Approximate percentile (upper bound of its bucket, capped at the max) */
+uint32_t perf_hist_percentile(const perf_hist_t* hist, uint32_t pct)
+{
+    uint32_t idx, seen = 0, rank;
+
+    if (hist->count == 0)
+        return 0;
+    rank = (uint32_t)(((uint64_t)hist->count * pct + 99) / 100);
+    for (idx = 0; idx < PERF_HIST_BUCKETS; idx++) {
+        seen += hist->bucket[idx];
+        if (seen >= rank) {
+            idx = perf_hist_value(idx);
+            return (idx < hist->max) ? idx : hist->max;
+        }
+    }
+    return hist->max;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,94 @@
+/******************************************************************************
+* File Name: perf_stats.h
+*
+* Description: This file contains the cycle counter timers and latency
+* histograms used for the performance statistics.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef PERF_STATS_H_
+#define PERF_STATS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "cyhal.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* latency histogram: 4 buckets per power of two (within 25%) */
+#define PERF_HIST_SUB_BITS          (2)
+#define PERF_HIST_BUCKETS           (32 << PERF_HIST_SUB_BITS)
+
+/*******************************************************************************
+* Data Types
+*******************************************************************************/
+/* accumulated time of a phase */
+typedef struct {
+    uint64_t cycles;
+    uint32_t count;
+} perf_timer_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint16_t bucket[PERF_HIST_BUCKETS];
+} perf_hist_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+/* DWT cycle counter, wraps after 2^32 cycles (about 28 seconds at 150 MHz)
+ * so only use it for intervals */
+static inline uint32_t perf_cycles(void)
+{
+    return DWT->CYCCNT;
+}
+
+void perf_init(void);
+uint32_t perf_cycles_to_us(uint64_t cycles);
+void perf_timer_add(perf_timer_t* timer, uint32_t cycles);
+void perf_hist_add(perf_hist_t* hist, uint32_t cycles);
+uint32_t perf_hist_percentile(const perf_hist_t* hist, uint32_t pct);
+
+#endif /* PERF_STATS_H_ */
+
+/* [] END OF FILE */
@@ -46,7 +46,9 @@
 /* FreeRTOS header file */
 #include <FreeRTOS.h>
 #include <task.h>
+#include <queue.h>
 #include <semphr.h>
+#include <event_groups.h>
 
 /* Cypress Secure Sockets header file */
 #include "cy_secure_sockets.h"
@@ -57,22 +59,88 @@
 #include "cy_wcm_error.h"
 
 /* Standard C header file */
- #define _GNU_SOURCE
 #include <string.h>
-extern void *memmem(const void* haystack, size_t haystacklen,
-                    const void* needle, size_t needlelen);
 
 /* HTTPS server task header file. */
 #include "secure_http_server.h"
 #include "cy_http_server.h"
 #include "secure_keys.h"
+#ifdef SERVER_KEYS_DER
+#include "secure_keys_der.h"
+#endif
+#include "multipart.h"
+#include "http_tmpl.h"
+#include "perf_stats.h"
+#include "web_assets.h"
+#include "url_db.h"
+#include "tls_crypto.h"
+#include "tls_heap.h"
+#include "tpm_wait.h"
+#include "tpm_dev.h"
+#include "boot.h"
+#include "wifi_link.h"
+#include "wifi_power.h"
+#include "mem_stats.h"
+#include "cpu_stats.h"
+#include "bench.h"
+#include "fw_stage.h"
 
 /* MDNS responder header file */
 #include "mdns.h"
 
+/* lwIP options, MEMP_NUM_TCP_PCB sizes MAX_SOCKETS */
+#include "lwip/opt.h"
+#include "lwip/tcpip.h"
+
+#if MAX_SOCKETS < 1
+    #error HTTPS_CONN_BUDGET_SZ too small for one connection
+#endif
+
 /* TPM */
 #include <wolftpm/tpm2_wrap.h>
 extern WOLFTPM2_DEV mDev;
+#ifdef FW_UPDATE_STATS
+extern perf_timer_t mTpmIoTime;
+#endif
+
+
+/* A dynamic resource, registered through https_conn_handler to track the
+ * requests on each connection */
+typedef struct
+{
+    cy_resource_dynamic_data_t conn;    /* registered with the server */
+    cy_resource_dynamic_data_t app;     /* resource handler and arg */
+#ifdef HTTP_LATENCY_STATS
+    struct https_latency *latency;      /* NULL if not recorded */
+#endif
+} https_resource_t;
+
+#ifdef HTTP_LATENCY_STATS
+/* Request latency of a resource, in microseconds: from the first call of
+ * the resource handler to the first response write, and to the end of the
+ * request (the last call, when a body takes several) */
+typedef struct https_latency
+{
+    const char *name;
+    perf_hist_t first_byte;
+    perf_hist_t total;
+} https_latency_t;
+#endif
+
+/* Requests on a persistent connection */
+typedef struct
+{
+    cy_http_response_stream_t *stream;  /* NULL if unused */
+    TickType_t last;                    /* end of the last request */
+    uint32_t requests;
+    int busy;                           /* in a resource handler */
+#ifdef HTTP_LATENCY_STATS
+    int req_open;                       /* request started, not ended */
+    uint32_t req_start;                 /* cycles */
+    TickType_t req_tick;
+    uint32_t req_first_byte_us;         /* 0 until the first write */
+#endif
+} https_conn_t;
 
 /*******************************************************************************
 * Global Variables
@@ -96,33 +164,115 @@ static cy_socket_sockaddr_t https_ip_address;
 static cy_https_server_security_info_t security_config;
 #endif
 
+/* Holds the precompressed web page and logo responses. */
+static cy_resource_static_data_t https_page_resource;
+static cy_resource_static_data_t https_logo_resource;
+static cy_resource_static_data_t https_progress_js_resource;
+
 /* Holds the response handler for HTTPS GET and POST request from the client. */
-static cy_resource_dynamic_data_t https_get_post_resource;
+static https_resource_t https_get_post_resource;
 
 /* Holds the user data which adds/updates the URL data resources. */
-static cy_resource_dynamic_data_t https_put_resource;
+static https_resource_t https_put_resource;
+
+/* Holds the raw (application/octet-stream) firmware upload handlers. */
+static https_resource_t fw_manifest_resource;
+static https_resource_t fw_data_resource;
+
+/* Holds the JSON status API handlers. */
+static https_resource_t api_tpm_resource;
+static https_resource_t api_fw_status_resource;
+static https_resource_t fw_progress_resource;
+
+#ifdef FW_UPDATE_STATS
+/* Holds the firmware update statistics handler. */
+static https_resource_t fw_stats_resource;
+#endif
+
+#ifdef TLS_CRYPTO_CB
+/* Holds the TLS statistics handler. */
+static https_resource_t tls_stats_resource;
+#endif
+
+#ifdef TLS_HEAP_POOL
+/* Holds the TLS heap pool statistics handler. */
+static https_resource_t tls_heap_resource;
+#endif
+
+#ifdef TPM_WAIT_RTOS
+/* Holds the TPM wait statistics handler. */
+static https_resource_t tpm_stats_resource;
+#endif
+
+/* Holds the boot timestamps handler. */
+static https_resource_t boot_stats_resource;
+
+#ifdef MEM_STATS
+/* Holds the stack and heap statistics handler. */
+static https_resource_t mem_stats_resource;
+#endif
+
+#ifdef CPU_STATS
+/* Holds the CPU profiling handler. */
+static https_resource_t cpu_stats_resource;
+#endif
+
+#ifdef BENCH
+/* Holds the benchmark handler. */
+static https_resource_t bench_resource;
+#endif
+
+#ifdef WIFI_POWER
+/* Holds the Wi-Fi power-save policy handler. */
+static https_resource_t power_resource;
+#endif
+
+#ifdef FW_STAGE
+/* Holds the firmware staging area handlers. */
+static https_resource_t fw_stage_resource;
+static https_resource_t fw_stage_manifest_resource;
+static https_resource_t fw_stage_data_resource;
+#endif
+
+/* Output of the response templates, one TLS record. The handlers run on
+ * the server thread, one at a time. */
+static char https_out_buf[HTTPS_TLS_RECORD_SZ];
+static http_tmpl_out_t https_out;
+
+/* Requests on each connection, see https_conn_handler. */
+static https_conn_t https_conns[MAX_SOCKETS];
+static SemaphoreHandle_t https_conns_lock;
+static StaticSemaphore_t https_conns_lock_buf;
+
+/* Connection of the running resource handler. The handlers run on the
+ * server thread, one at a time. */
+static https_conn_t *https_conn_current;
+
+/* Connection receiving the firmware upload, NULL if none. See
+ * https_conn_bulk_begin. */
+static https_conn_t *https_conn_bulk;
+
+#ifdef HTTP_LATENCY_STATS
+/* Latency of the /tpm page and of the resources created with HTTPS PUT */
+#define HTTPS_LATENCY_TPM   (0)
+#define HTTPS_LATENCY_PUT   (1)
+#define HTTPS_LATENCY_COUNT (2)
+static https_latency_t https_latency[HTTPS_LATENCY_COUNT] = {
+    { "/tpm" }, { "PUT resources" }
+};
+
+/* Holds the request latency handler. */
+static https_resource_t http_stats_resource;
+#endif
 
 /* Global variable to track number of resources registered. */
 static uint32_t number_of_resources_registered = 0;
 
-/* Holds all the URL resources along with its data. */
-typedef struct
-{
-    char *resource_name;
-    char *value;
-    uint32_t length;
-} https_url_database_t;
-
-/* Initializes the URL database with first entry reserved for HTTPS root URL.
- * The default value of MAX_NUMBER_OF_HTTP_SERVER_RESOURCES is 10 as defined
- * by the HTTPS server middleware. This can be overriden by setting its value
- * in the application Makefile. Refer to README.md for details.
+/* The resources created with HTTPS PUT requests are kept in the URL
+ * database (see url_db.h) and registered with the HTTPS server, which holds
+ * at most MAX_NUMBER_OF_HTTP_SERVER_RESOURCES resources (10 by default, set
+ * in the application Makefile). Refer to README.md for details.
  */
-static https_url_database_t url_resources_db[MAX_NUMBER_OF_HTTP_SERVER_RESOURCES] =
-{
-    /* First entry in the URL database is reserved for HTTPS Root URL. */
-    { (char *)"/", NULL, 0 }
-};
 
 
 #define MAX_FIRMWARE_MANIFEST_SZ 4096
@@ -131,18 +281,77 @@ static https_url_database_t url_resources_db[MAX_NUMBER_OF_HTTP_SERVER_RESOURCES
 #define HTTP_SERVER_MTU_SIZE             (1460)
 #endif
 
+/* stack depth in words (StackType_t) */
 #define FW_UPDATE_TASK_STACK_SIZE        (5 * 1024)
 #define FW_UPDATE_TASK_PRIORITY          (1)
+#define WIFI_BOOT_TASK_STACK_SIZE        (2 * 1024)
+#define WIFI_BOOT_TASK_PRIORITY          (1)
 
+/* Largest firmware chunk buffered. The chunk size used is the block size
+ * the TPM asks for (data_req_sz), up to this. */
+#ifndef IFX_FW_MAX_CHUNK_SZ
 #define IFX_FW_MAX_CHUNK_SZ 1024
+#endif
+
+/* Number of chunk buffers in the ring between the HTTP task and the firmware
+ * update task. With two or more the HTTP task fills the next chunk while the
+ * update task is still streaming the previous one to the TPM. */
+#ifndef IFX_FW_CHUNK_COUNT
+#define IFX_FW_CHUNK_COUNT 2
+#endif
+#if IFX_FW_CHUNK_COUNT < 2
+    #error IFX_FW_CHUNK_COUNT must be at least 2
+#endif
 
-static TaskHandle_t fw_update_task_handle = NULL;
+/* Zero-copy mode: queue views into the received HTTP body to the update task
+ * instead of copying them into the chunk ring, so each firmware byte is only
+ * copied once (into the TPM command buffer). A delimiter prefix held back
+ * across TLS records is queued from the parser's delimiter. The HTTP task
+ * waits for the TPM to consume each body before handing it back to the
+ * server. */
+//#define IFX_FW_ZERO_COPY
+
+/* error returned by the multipart callbacks, see fwInfo->status */
+#define FW_PART_ABORT (-100)
+/* request failed, but the update is kept for a resumed upload */
+#define FW_PART_RETRY (-101)
+
+/* The firmware update tasks, one per TPM (TPM_DEV_COUNT), are created once
+ * at startup and wait on a job queue for the next update, so their stacks
+ * are never taken from the heap. */
+static TaskHandle_t fw_update_task_handle[TPM_DEV_COUNT];
+static StaticTask_t fw_update_task_tcb[TPM_DEV_COUNT];
+static StackType_t  fw_update_task_stack[TPM_DEV_COUNT][FW_UPDATE_TASK_STACK_SIZE];
+static QueueHandle_t fw_update_queue[TPM_DEV_COUNT];
+static StaticQueue_t fw_update_queue_buf[TPM_DEV_COUNT];
+static uint8_t fw_update_queue_storage[TPM_DEV_COUNT][sizeof(void*)];
 
 typedef struct FirmwareChunk {
     uint32_t sz;
+    uint32_t pending; /* workers (bits) yet to hand it to their TPM */
+    const uint8_t* ptr; /* buf or a view into the HTTP body */
+#ifndef IFX_FW_ZERO_COPY
     uint8_t  buf[IFX_FW_MAX_CHUNK_SZ];
+#endif
 } FirmwareChunk_t;
 
+struct fw_info;
+
+/* Firmware update worker of one TPM. Every worker drains every chunk of
+ * the ring, a slot is free again once the last one is done with it. */
+typedef struct {
+    struct fw_info*   fwInfo;
+    int               idx;        /* TPM device */
+    uint32_t          rd;         /* next slot to drain */
+    FirmwareChunk_t*  drain;      /* slot being drained, NULL if none */
+    uint32_t          pos;        /* bytes of it already handed to the TPM */
+    SemaphoreHandle_t ready;      /* counts filled slots */
+    StaticSemaphore_t readyBuf;
+    int               asked;      /* the TPM asked for the firmware data */
+    int               rc;
+    size_t            firmwareSz; /* bytes handed to the TPM */
+} fw_worker_t;
+
 typedef enum {
     FW_STATE_INIT,
     FW_STATE_MANIFEST_START,
@@ -153,27 +362,115 @@ typedef enum {
     FW_STATE_FIRMWARE_REST
 } FwState;
 
+/* FwState names for the status API */
+static const char* const fw_state_str[] = {
+    "idle",
+    "manifest",
+    "manifest_done",
+    "data_start",
+    "data",
+    "data_done",
+    "done"
+};
+
+/* update task state, set by the update task in fwInfo->events */
+#define FW_EVENT_READY   (1UL << 0) /* TPM asks for the firmware data */
+#define FW_EVENT_DONE    (1UL << 1) /* update succeeded */
+#define FW_EVENT_FAILED  (1UL << 2) /* update failed, see threadRc */
+
+/* time for the TPM to take the manifest and ask for the firmware data */
+#define FW_UPDATE_READY_TIMEOUT_MS  (30 * 1000)
+/* The HTTP task waits this long for the TPMs to take a chunk, and for the
+ * workers to end the update once the data is sent. Then the update fails
+ * (fw_update_abort), so a TPM that stops responding does not stop the
+ * server. */
+#define FW_CHUNK_TIMEOUT_MS         (10 * 1000)
+#define FW_UPDATE_DONE_TIMEOUT_MS   (60 * 1000)
+
+/* /fw/progress asks the browser to reconnect after this long while an
+ * upload or update runs, and after FW_PROGRESS_IDLE_RETRY_MS otherwise,
+ * well above WIFI_POWER_IDLE_S so a client left open allows power save */
+#define FW_PROGRESS_RETRY_MS        (1000)
+#define FW_PROGRESS_IDLE_RETRY_MS   (5 * 60 * 1000)
+
+/* upload refused while the TPMs are programmed from the staging area, or
+ * used by the benchmark */
+#define FW_STAGE_BUSY_MSG \
+    "Programming from the staging area, try again later\r\n"
+#define FW_BENCH_BUSY_MSG \
+    "TPM used by the benchmark, try again later\r\n"
+#define FW_ABORT_BUSY_MSG \
+    "The failed update is still ending, try again later\r\n"
+
 typedef enum {
-    FW_STATE_THREAD_INIT,
-    FW_STATE_THREAD_STARTED,
-    FW_STATE_THREAD_READY,
-    FW_STATE_THREAD_DONE,
-    FW_STATE_THREAD_FAILED
-} FwThreadState;
+    FW_PART_NONE,
+    FW_PART_MANIFEST,
+    FW_PART_DATA
+} FwPart;
 
+#ifdef FW_UPDATE_STATS
+/* Firmware data upload timing, in DWT cycles */
 typedef struct {
+    int          active;
+    int          httpActive; /* active at the start of body handling */
+    TickType_t   startTick;
+    TickType_t   endTick;
+    uint32_t     httpExit;   /* last return of the HTTP handler */
+    uint32_t     cbExit;     /* last return of the data callback */
+    uint64_t     ioStart;    /* TPM bus time at cbExit */
+    uint64_t     handoffStart;
+    perf_timer_t recv;       /* TLS receive, between body segments */
+    perf_timer_t parse;      /* body handling (multipart parse) */
+    perf_timer_t handoff;    /* HTTP task waiting for a free chunk */
+    perf_timer_t starve;     /* update task waiting for data */
+    perf_timer_t tpm;        /* TPM commands, between data callbacks */
+    perf_timer_t tpmIo;      /* bus transfer part of tpm */
+    perf_hist_t  chunk;      /* TPM latency per chunk */
+} fw_stats_t;
+#endif
+
+typedef struct fw_info {
     FwState state;
-    FwThreadState threadState;
-    int           threadRc;
-    TaskHandle_t  notifyHandle;
+    EventGroupHandle_t events;
+    StaticEventGroup_t eventsBuf;
+    int           threadRc;   /* first failure of the workers */
     uint8_t manifest[MAX_FIRMWARE_MANIFEST_SZ];
     size_t  manifestSz;
-    size_t  firmwareSz;
-    FirmwareChunk_t chunk;
-
-    char boundary[64];
-    char fieldName[64];
-    char fileName[64];
+    size_t  firmwareSz; /* bytes handed to the furthest TPM */
+    size_t  dataSz;   /* firmware bytes queued, offset to resume an upload at */
+    size_t  totalSz;  /* firmware bytes expected, 0 if not known */
+    size_t  bodySz;   /* of the form upload */
+    TickType_t dataTick; /* the TPM asked for the firmware data */
+    uint32_t chunkSz; /* TPM block size, chunks are posted once full */
+    size_t  skipSz;   /* resent bytes of the current body to drop */
+
+    /* chunk ring: HTTP task fills chunk[chunkWr], each worker drains
+     * chunk[worker.rd] */
+    FirmwareChunk_t   chunk[IFX_FW_CHUNK_COUNT];
+    FirmwareChunk_t*  chunkFill;  /* slot being filled, NULL if none */
+    uint32_t          chunkWr;
+    SemaphoreHandle_t chunkFree;  /* counts empty slots */
+    StaticSemaphore_t chunkFreeBuf;
+
+    /* update workers, readers are the ones (bits) still taking data */
+    fw_worker_t       worker[TPM_DEV_COUNT];
+    uint32_t          readers;
+    int               readyLeft;  /* workers yet to ask for data or fail */
+    int               doneLeft;   /* workers still running */
+    int               staged;     /* data read from the staging area */
+    volatile int      aborted;    /* the HTTP task gave up on the TPMs */
+
+    /* body bytes still to come for the request being received */
+    uint32_t    bodyRemaining;
+
+    /* multipart/form-data upload */
+    multipart_t mp;
+    FwPart      part;
+    char        status[MAX_STATUS_LENGTH];
+
+#ifdef FW_UPDATE_STATS
+    fw_stats_t  stats;
+#endif
 } fw_info_t;
 static fw_info_t mFwInfo;
 
@@ -182,264 +479,2657 @@ static fw_info_t mFwInfo;
 * Function Prototypes
 *******************************************************************************/
 static cy_rslt_t configure_https_server(void);
+#ifdef PARALLEL_BOOT
+static void wifi_boot_task(void *arg);
+#endif
+static const char* register_https_resource(const char* request,
+    size_t requestSz);
+int32_t dynamic_resource_handler(const char* url_path,
+    const char* url_parameters, cy_http_response_stream_t* stream, void* arg,
+    cy_http_message_body_t* https_message_body);
 void print_heap_usage(char *msg);
-extern const char* TPM2_IFX_GetInfo(int* opMode);
+extern void TPM2_IFX_GetInfo(char* info, size_t infoSz, int* opMode);
+extern void TPM2_IFX_RefreshInfo(void);
+extern int TPM2_IFX_GetCaps(WOLFTPM2_CAPS* caps);
+extern const char* TPM2_IFX_GetOpModeStr(int opMode);
+extern void TPM2_IFX_GetBusInfo(uint32_t* hz, uint32_t* rttUs,
+    uint32_t* bytesPerSec);
 extern int TPM2_IFX_Init(void);
+#if LWIP_MDNS_RESPONDER
+static void mdns_txt_refresh(void);
+#endif
 
 
-/* Company Logo */
-#define INFINEON_LOGO \
-    "<img style=\"float: right;\" alt=\"logo.png\" "\
-    "src=\"data:image/png;base64,iVBORw0KGgoAAAANSUhEUgAAATkAAABcBAMAAADngd+fAA" \
-           "AAD1BMVEX///8VWJbiOlVtkLHIxNm177myAAAEAklEQVR4AezBgQAAAACAoP2pF6kCA" \
-           "ABmxgxw29VhMO4WHwArHABlOQBpOIAJvv+ZnmPolnbbwn9Dev2EPNJK3m+fHZPRlmRf" \
-           "JMKvh7aRwSvKXAsMryg0NnhFdcmKyvCSIupf1DgVErnzjJMkp8KJ0p2WLJJqhtPkR6L" \
-           "hPfvfPOxIdSZe9iHS9JGdV/5Lj+xiOEVX7z2851qIkHr4rRbadFqrKNz4sYpOkAY4qD" \
-           "XNX1unmk6zDtM7nZLR9Fu6hehU89CGcEc1HcJhurdHOqrFp1gXoKL7sqp80LuObPNHR" \
-           "0V9NQHQgsZ6MohmbnYdG10XOxr0xiVIvV6JGGAx2LKjMUp0LbqF9nXcS4tEk+aO/aI3" \
-           "EPdA5dcwLORwbhYWNjpSleiAesvRW5OzfQP4ZaOvt4f0kRKY5iIquEpAQJPeKKSuNjr" \
-           "LrmGeWoUdKzrWON/pBriQUF8cUS6rVcM7EqlWUrp4VZSZeHErcVkxDSJIcxw6DY3RlS" \
-           "u6qSPWfGB0rlyLK2vSq99iw7tHYdn9SJqIYOn1Pk5ArAGQ4OI6/XRoth3c6RgrumFHW" \
-           "4Z9qfa1vENhqNT1G91C7hMdd4Xucozu8kHXP9E5pOkrOkxpnW+3Oa1p5R2HXA27FiIQ" \
-           "TT5A3Ohwo7PJgJbuD96RaqNzn+lu6e2W0k1/vFUDZVLsaaMnoysf9+pdAbMudPr9Qlz" \
-           "2EP8zXX+ULhU85dPr3TvTYMs4CG90qLHes7rEYl6n4U/eORH5wbtk3qW3is7U0YQidz" \
-           "ogLnRDAes1p5tA1xYODONvvTNU+IYOtO20qKkInuimZLbvfWd0pSPjFDWzAVsu1NCiG" \
-           "3/cs6qDe7aic3C50yFtdD0UusXy2EQZOge6bM278L13eiHf593UnHdIpr2IVDx/ors4" \
-           "8647Nu/s/PS9dxcb55FWmo54B7RrMhct21LT9epX9ayQOLQPUOO3dLg/z4jgEF2kTfv" \
-           "N9pyt6dC+stCDudtsvHCn657oLDvrmmZoVbY+fA5I1RmlriwSG123obsjR2OGbyWsAe" \
-           "Xw+c7ES32++1JoyaEpr4J/kDTPxhOg6az/K0Y4rEczuvRIt9JjtbIwewx5CygIeQyIE" \
-           "vLoOaCwHDHvMB6OT5V9Si8fAlXAEHzmMAbPOWD2cMV8zXqFEHL2oxwxz/NBuAA/a42b" \
-           "Ukyg8tkrXQjjqDBidNd89Uo3+qx0DE3lw3jY7FBMd7GlDlLolEV8HtU29c5flVKCmoq" \
-           "Z4Tw8+1sP4vHZ72SbxhlcG68UVgBOxWvZlw8PHhGBc3X1JvneNx/+75faX79zx/wC75" \
-           "SNwRSC4MYlcv/I1i/C96QALyH8ClDgdYTy4Jr81x4cEwAAACAMsn9qM+wHlgEAAADAA" \
-           "To83zvHyP+JAAAAAElFTkSuQmCC\" />"
-
-#define HTTPS_STARTUP_HEADER \
-"<!DOCTYPE html>" \
-"<html>" \
-"<head>" \
-"<title>Infineon TPM Firmware Update Demo</title>" \
-"</head>" \
-"<body>" \
-"<h1 style=\"text-align: left\">Infineon TPM Firmware Update Demo" \
-INFINEON_LOGO \
-"</h1>" \
-"<p><span style=\"font-size: 12pt;\"><strong>Infineon</strong> is the first TPM vendor to <strong>open source their " \
-"firmware update procedure and process</strong> in their latest <strong>Infineon SLB9672 (SPI) and SLB9673 (I2C)</strong> versions of the TPM 2.0 module.</span></p>" \
-"<p><span style=\"font-size: 12pt;\"><strong>wolfTPM</strong> is the only library to offer integrated support for updating TPM firmware.</span></p>" \
-"<p><span style=\"text-decoration: underline;\"><span style=\"font-size: 12pt;\">Demo Platform:</span></span></p>" \
-"<ul>" \
-"    <li><span style=\"font-size: 12pt;\">Infineon PSoC 62S2 evaluation kit (Wifi)</span></li>" \
-"    <li><span style=\"font-size: 12pt;\">Infineon SLB9373 (I2C) TPM 2.0 mikroBUS module</span></li>" \
-"    <li><span style=\"font-size: 12pt;\">Modus Toolbox Wi-Fi-HTTPS-Server demo</span>" \
-"    <ul>" \
-"        <li><span style=\"font-size: 12pt;\">wolfSSL TLS v1.3 server</span></li>" \
-"        <li><span style=\"font-size: 12pt;\">wolfTPM</span></li>" \
-"    </ul>" \
-"    </li>" \
-"</ul>" \
-"<h2>TPM Module Interface</h2>" \
-"<form method=\"get\">" \
-"<fieldset>" \
-"    <legend>Firmware Status</legend>" \
-"    <input type=\"submit\" value=\"Refresh TPM\"/>" \
-"    <textarea id=\"tpm_status\" name=\"tpm_status\" rows=\"4\" cols=\"60\">"
-
-#define HTTPS_STARTUP_FOOTER \
-"    </textarea>" \
-"</fieldset>" \
-"</form>" \
-"<form method=\"post\" enctype=\"multipart/form-data\">" \
-"<fieldset>" \
-"    <legend>Firmware Update</legend>" \
-"    <p>" \
-"        <label for=\"manifest\">Manifest File:</label>" \
-"        <input type=\"file\" name=\"manifest\" value=\"Manifest File\"/></br></br>" \
-"    </p>" \
-"    <p>" \
-"        <label for=\"data\">Firmware File:</label>" \
-"        <input type=\"file\" name=\"data\" value=\"Firmware File\"/>" \
-"    </p>" \
-"    <input type=\"submit\" name=\"submit\" value=\"Update Firmware\"/>" \
-"</fieldset>" \
-"</form>" \
-"</body>" \
-"</html>"
-
 //#define TEST_MODE
 
 /* Local Functions */
+#ifdef FW_UPDATE_STATS
+static char mFwStatsStr[512];
+#define FW_STATS_CYCLES() perf_cycles()
+#else
+#define FW_STATS_CYCLES() 0
+#endif
+
+/* Firmware update statistics: the data upload time is split into TLS
+ * receive (between body segments), body parsing and chunk handoff waits in
+ * the HTTP task and TPM data waits and TPM commands (bus transfers and the
+ * rest, mostly busy-waiting on the TPM) in the update task. */
+static void fw_stats_start(fw_info_t* fwInfo)
+{
+#ifdef FW_UPDATE_STATS
+    memset(&fwInfo->stats, 0, sizeof(fwInfo->stats));
+    fwInfo->stats.startTick = xTaskGetTickCount();
+    fwInfo->stats.active = 1;
+#else
+    (void)fwInfo;
+#endif
+}
+
+static void fw_stats_stop(fw_info_t* fwInfo)
+{
+#ifdef FW_UPDATE_STATS
+    if (fwInfo->stats.active) {
+        fwInfo->stats.endTick = xTaskGetTickCount();
+        fwInfo->stats.active = 0;
+    }
+#else
+    (void)fwInfo;
+#endif
+}
+
+/* HTTP task: start of body handling, returns the start time */
+static uint32_t fw_stats_http_enter(fw_info_t* fwInfo)
+{
+    uint32_t now = FW_STATS_CYCLES();
+#ifdef FW_UPDATE_STATS
+    fw_stats_t* st = &fwInfo->stats;
+    if (st->active && st->httpExit != 0) {
+        perf_timer_add(&st->recv, now - st->httpExit);
+    }
+    st->httpActive = st->active;
+    st->handoffStart = st->handoff.cycles;
+#else
+    (void)fwInfo;
+#endif
+    return now;
+}
+
+static void fw_stats_http_exit(fw_info_t* fwInfo, uint32_t start)
+{
+#ifdef FW_UPDATE_STATS
+    fw_stats_t* st = &fwInfo->stats;
+    uint32_t now = perf_cycles();
+    /* not counted while the update task is started or finished */
+    if (st->httpActive && st->active) {
+        perf_timer_add(&st->parse, (now - start) -
+            (uint32_t)(st->handoff.cycles - st->handoffStart));
+        st->httpExit = now;
+    }
+#else
+    (void)fwInfo;
+    (void)start;
+#endif
+}
+
+static void fw_stats_handoff(fw_info_t* fwInfo, uint32_t start)
+{
+#ifdef FW_UPDATE_STATS
+    if (fwInfo->stats.active) {
+        perf_timer_add(&fwInfo->stats.handoff, perf_cycles() - start);
+    }
+#else
+    (void)fwInfo;
+    (void)start;
+#endif
+}
+
+/* update task: the time since the last data callback is the TPM command */
+static void fw_stats_cb_enter(fw_info_t* fwInfo)
+{
+#ifdef FW_UPDATE_STATS
+    fw_stats_t* st = &fwInfo->stats;
+    uint32_t d;
+    if (st->active && st->cbExit != 0) {
+        d = perf_cycles() - st->cbExit;
+        perf_timer_add(&st->tpm, d);
+        perf_hist_add(&st->chunk, d);
+        perf_timer_add(&st->tpmIo, (uint32_t)(mTpmIoTime.cycles - st->ioStart));
+    }
+#else
+    (void)fwInfo;
+#endif
+}
+
+static void fw_stats_cb_exit(fw_info_t* fwInfo)
+{
+#ifdef FW_UPDATE_STATS
+    fwInfo->stats.cbExit = perf_cycles();
+    fwInfo->stats.ioStart = mTpmIoTime.cycles;
+#else
+    (void)fwInfo;
+#endif
+}
+
+static void fw_stats_starve(fw_info_t* fwInfo, uint32_t start)
+{
+#ifdef FW_UPDATE_STATS
+    if (fwInfo->stats.active) {
+        perf_timer_add(&fwInfo->stats.starve, perf_cycles() - start);
+    }
+#else
+    (void)fwInfo;
+    (void)start;
+#endif
+}
+
+#ifdef FW_UPDATE_STATS
+static const char* fw_stats_report(const fw_info_t* fwInfo)
+{
+    const fw_stats_t* st = &fwInfo->stats;
+    TickType_t end = st->active ? xTaskGetTickCount() : st->endTick;
+    uint32_t ms = (uint32_t)(end - st->startTick) * portTICK_PERIOD_MS;
+    uint32_t tpmMs = perf_cycles_to_us(st->tpm.cycles) / 1000;
+    uint32_t ioMs = perf_cycles_to_us(st->tpmIo.cycles) / 1000;
+
+    snprintf(mFwStatsStr, sizeof(mFwStatsStr),
+        "Firmware data: %lu bytes in %lu ms (%lu bytes/sec)\r\n"
+        "TLS receive: %lu ms (%lu segments)\r\n"
+        "Body parse: %lu ms\r\n"
+        "Chunk handoff wait: %lu ms\r\n"
+        "TPM data wait: %lu ms\r\n"
+        "TPM commands: %lu ms (bus %lu ms, busy-wait %lu ms)\r\n"
+        "Chunk latency: %lu chunks, p50 %lu us, p99 %lu us, max %lu us\r\n",
+        (unsigned long)fwInfo->firmwareSz, (unsigned long)ms,
+        (unsigned long)(ms ? (uint64_t)fwInfo->firmwareSz * 1000 / ms : 0),
+        (unsigned long)(perf_cycles_to_us(st->recv.cycles) / 1000),
+        (unsigned long)st->recv.count,
+        (unsigned long)(perf_cycles_to_us(st->parse.cycles) / 1000),
+        (unsigned long)(perf_cycles_to_us(st->handoff.cycles) / 1000),
+        (unsigned long)(perf_cycles_to_us(st->starve.cycles) / 1000),
+        (unsigned long)tpmMs, (unsigned long)ioMs,
+        (unsigned long)((tpmMs > ioMs) ? tpmMs - ioMs : 0),
+        (unsigned long)st->chunk.count,
+        (unsigned long)perf_cycles_to_us(perf_hist_percentile(&st->chunk, 50)),
+        (unsigned long)perf_cycles_to_us(perf_hist_percentile(&st->chunk, 99)),
+        (unsigned long)perf_cycles_to_us(st->chunk.max));
+    return mFwStatsStr;
+}
+#endif
+
+static void fw_chunk_init(fw_info_t* fwInfo)
+{
+    int i;
+
+    fwInfo->chunkFill = NULL;
+    fwInfo->chunkWr = 0;
+    fwInfo->chunkFree = xSemaphoreCreateCountingStatic(IFX_FW_CHUNK_COUNT,
+        IFX_FW_CHUNK_COUNT, &fwInfo->chunkFreeBuf);
+    fwInfo->readers = 0;
+    for (i = 0; i < TPM_DEV_COUNT; i++) {
+        fw_worker_t* w = &fwInfo->worker[i];
+        w->fwInfo = fwInfo;
+        w->idx = i;
+        w->rd = 0;
+        w->drain = NULL;
+        w->pos = 0;
+        w->ready = xSemaphoreCreateCountingStatic(IFX_FW_CHUNK_COUNT, 0,
+            &w->readyBuf);
+    }
+}
+
+/* hand the slot being filled to the update workers (HTTP task) */
+static void fw_chunk_post(fw_info_t* fwInfo)
+{
+    FirmwareChunk_t* fwChunk = fwInfo->chunkFill;
+    uint32_t readers;
+    int i;
+
+    fwInfo->chunkFill = NULL;
+    fwInfo->chunkWr = (fwInfo->chunkWr + 1) % IFX_FW_CHUNK_COUNT;
+    taskENTER_CRITICAL();
+    readers = fwInfo->readers;
+    fwChunk->pending = readers;
+    taskEXIT_CRITICAL();
+    if (readers == 0) {
+        /* no TPM takes the data anymore */
+        xSemaphoreGive(fwInfo->chunkFree);
+        return;
+    }
+    for (i = 0; i < TPM_DEV_COUNT; i++) {
+        if (readers & (1UL << i))
+            xSemaphoreGive(fwInfo->worker[i].ready);
+    }
+}
+
+/* The TPMs did not take the data, or their workers did not end the
+ * update, in time: the update fails and the HTTP task stops waiting for
+ * it. The ring takes no more data, the workers are woken to leave it the
+ * next time they ask for data, and the TPMs are released for the rest of
+ * the server. A new update waits until the workers have ended. */
+static void fw_update_abort(fw_info_t* fwInfo, const char* why)
+{
+    uint32_t readers;
+    int i;
+
+    if (fwInfo->aborted)
+        return;
+    printf("Firmware update failed: %s\n", why);
+    snprintf(fwInfo->status, sizeof(fwInfo->status),
+        "Update failed: %s\r\n", why);
+    taskENTER_CRITICAL();
+    fwInfo->aborted = 1;
+    if (fwInfo->threadRc == 0)
+        fwInfo->threadRc = TPM_RC_TIMEOUT;
+    readers = fwInfo->readers;
+    taskEXIT_CRITICAL();
+    for (i = 0; i < TPM_DEV_COUNT; i++) {
+        if (readers & (1UL << i))
+            xSemaphoreGive(fwInfo->worker[i].ready);
+    }
+    TPM2_IFX_OwnerGive(TPM_OWNER_FW_UPDATE);
+}
+
+/* get a slot to fill, blocks only when all slots are queued to the TPM.
+ * NULL once the update is aborted. */
+static FirmwareChunk_t* fw_chunk_get(fw_info_t* fwInfo)
+{
+    if (fwInfo->aborted)
+        return NULL;
+    if (fwInfo->chunkFill == NULL) {
+        uint32_t start = FW_STATS_CYCLES();
+        if (xSemaphoreTake(fwInfo->chunkFree,
+                pdMS_TO_TICKS(FW_CHUNK_TIMEOUT_MS)) != pdTRUE) {
+            fw_update_abort(fwInfo, "TPM did not take the firmware data");
+            return NULL;
+        }
+        fw_stats_handoff(fwInfo, start);
+        fwInfo->chunkFill = &fwInfo->chunk[fwInfo->chunkWr];
+        fwInfo->chunkFill->sz = 0;
+    #ifndef IFX_FW_ZERO_COPY
+        fwInfo->chunkFill->ptr = fwInfo->chunkFill->buf;
+    #endif
+    }
+    return fwInfo->chunkFill;
+}
+
+#ifndef IFX_FW_ZERO_COPY
+/* queue firmware data for the update task, posting each chunk once full */
+static void fw_data_write(fw_info_t* fwInfo, const uint8_t* data, size_t sz)
+{
+    FirmwareChunk_t* fwChunk;
+    size_t len;
+
+    while (sz > 0) {
+        fwChunk = fw_chunk_get(fwInfo);
+        if (fwChunk == NULL)
+            return;
+        len = fwInfo->chunkSz - fwChunk->sz;
+        if (len > sz)
+            len = sz;
+        memcpy(&fwChunk->buf[fwChunk->sz], data, len);
+        fwChunk->sz += len;
+        data += len;
+        sz -= len;
+        if (fwChunk->sz >= fwInfo->chunkSz) {
+            fw_chunk_post(fwInfo);
+        }
+    }
+}
+#endif
+
+/* queue firmware data that stays valid until fw_data_sync() */
+static void fw_data_view(fw_info_t* fwInfo, const uint8_t* data, size_t sz)
+{
+#ifdef IFX_FW_ZERO_COPY
+    FirmwareChunk_t* fwChunk;
+
+    if (sz == 0)
+        return;
+    fwChunk = fw_chunk_get(fwInfo);
+    if (fwChunk == NULL)
+        return;
+    fwChunk->ptr = data;
+    fwChunk->sz = sz;
+    fw_chunk_post(fwInfo);
+#else
+    fw_data_write(fwInfo, data, sz);
+#endif
+}
+
+/* wait until the update task is done with all queued views */
+static void fw_data_sync(fw_info_t* fwInfo)
+{
+#ifdef IFX_FW_ZERO_COPY
+    int i, n = IFX_FW_CHUNK_COUNT;
+    uint32_t start = FW_STATS_CYCLES();
+
+    if (fwInfo->aborted)
+        return; /* the workers read no more views */
+    if (fwInfo->chunkFill != NULL)
+        n--; /* held by the HTTP task and holds no view */
+    for (i = 0; i < n; i++) {
+        if (xSemaphoreTake(fwInfo->chunkFree,
+                pdMS_TO_TICKS(FW_CHUNK_TIMEOUT_MS)) != pdTRUE) {
+            fw_update_abort(fwInfo, "TPM did not take the firmware data");
+            break;
+        }
+    }
+    n = i;
+    for (i = 0; i < n; i++)
+        xSemaphoreGive(fwInfo->chunkFree);
+    fw_stats_handoff(fwInfo, start);
+#else
+    (void)fwInfo;
+#endif
+}
+
+/* post any partial chunk followed by an empty chunk to end the data */
+static void fw_data_finish(fw_info_t* fwInfo)
+{
+    if (fwInfo->chunkFill != NULL && fwInfo->chunkFill->sz > 0) {
+        fw_chunk_post(fwInfo);
+    }
+    if (fw_chunk_get(fwInfo) != NULL)
+        fw_chunk_post(fwInfo);
+}
+
+/* the worker is done with the drained slot, the last one releases it back
+ * to the HTTP task */
+static void fw_chunk_release(fw_worker_t* w)
+{
+    FirmwareChunk_t* fwChunk = w->drain;
+    uint32_t pending;
+
+    w->drain = NULL;
+    w->pos = 0;
+    w->rd = (w->rd + 1) % IFX_FW_CHUNK_COUNT;
+    taskENTER_CRITICAL();
+    fwChunk->pending &= ~(1UL << w->idx);
+    pending = fwChunk->pending;
+    taskEXIT_CRITICAL();
+    if (pending == 0)
+        xSemaphoreGive(w->fwInfo->chunkFree);
+}
+
+/* the worker takes no more data: the chunks it has not drained are
+ * released for it, so the other TPMs and the upload carry on */
+static void fw_chunk_detach(fw_worker_t* w)
+{
+    fw_info_t* fwInfo = w->fwInfo;
+    uint32_t bit = 1UL << w->idx;
+    int i, freed = 0;
+
+    taskENTER_CRITICAL();
+    fwInfo->readers &= ~bit;
+    for (i = 0; i < IFX_FW_CHUNK_COUNT; i++) {
+        if (fwInfo->chunk[i].pending & bit) {
+            fwInfo->chunk[i].pending &= ~bit;
+            if (fwInfo->chunk[i].pending == 0)
+                freed++;
+        }
+    }
+    taskEXIT_CRITICAL();
+    w->drain = NULL;
+    while (freed-- > 0)
+        xSemaphoreGive(fwInfo->chunkFree);
+}
+
+/* A worker asked for the data or failed before: once all have, the data
+ * upload starts if any TPM asked for it */
+static void fw_worker_ready(fw_info_t* fwInfo)
+{
+    int i, left, asked = 0;
+
+    taskENTER_CRITICAL();
+    left = --fwInfo->readyLeft;
+    taskEXIT_CRITICAL();
+    if (left != 0)
+        return;
+    for (i = 0; i < TPM_DEV_COUNT; i++)
+        asked |= fwInfo->worker[i].asked;
+    if (asked)
+        xEventGroupSetBits(fwInfo->events, FW_EVENT_READY);
+}
+
+/* A worker is done: the last one ends the update, failed if any failed */
+static void fw_worker_done(fw_worker_t* w, int rc)
+{
+    fw_info_t* fwInfo = w->fwInfo;
+    int left;
+
+    fw_chunk_detach(w);
+    w->rc = rc;
+    if (!w->asked)
+        fw_worker_ready(fwInfo);
+
+    taskENTER_CRITICAL();
+    if (rc != 0 && fwInfo->threadRc == 0)
+        fwInfo->threadRc = rc;
+    left = --fwInfo->doneLeft;
+    taskEXIT_CRITICAL();
+    if (left != 0)
+        return;
+
+    TPM2_IFX_OwnerGive(TPM_OWNER_FW_UPDATE);
+    if (fwInfo->staged) {
+        /* programmed from the staging area, no request waits for the end */
+        printf("Staged firmware written: %d bytes\n", fwInfo->firmwareSz);
+        fw_stats_stop(fwInfo);
+        cyhal_gpio_write(CYBSP_USER_LED2, CYBSP_LED_STATE_OFF);
+        if (fwInfo->threadRc == 0)
+            cyhal_gpio_write(CYBSP_LED_RGB_GREEN, CYBSP_LED_STATE_ON);
+    }
+    xEventGroupSetBits(fwInfo->events,
+        (fwInfo->threadRc != 0) ? FW_EVENT_FAILED : FW_EVENT_DONE);
+    if (fwInfo->staged) {
+        /* last, the next update may reset fwInfo from here */
+        fwInfo->state = (fwInfo->threadRc == 0) ?
+            FW_STATE_FIRMWARE_REST : FW_STATE_INIT;
+    }
+}
+
+#ifdef FW_STAGE
+/* reads the next block of a staged image straight into the TPM command
+ * buffer, 0 at the end or on a flash error */
+static uint32_t fw_stage_data(fw_worker_t* w, uint8_t* data,
+    uint32_t data_req_sz)
+{
+    size_t sz = w->fwInfo->totalSz - w->firmwareSz;
+
+    if (sz > data_req_sz)
+        sz = data_req_sz;
+    if (sz > 0 &&
+            fw_stage_read(w->firmwareSz, data, sz) != FW_STAGE_SUCCESS) {
+        printf("TPM %d: staged firmware read failed at %lu\n", w->idx,
+            (unsigned long)w->firmwareSz);
+        sz = 0;
+    }
+    return (uint32_t)sz;
+}
+#endif
+
+/* Supplies the firmware data to the TPM of the worker (cb_ctx). The whole
+ * request is filled, across chunks if needed, so every TPM command carries
+ * a full block; only the end of the data gives a short one. The device
+ * lock is released meanwhile, for the commands of the other TPMs. */
 static int TPM2_IFX_FwData_Cb(uint8_t* data, uint32_t data_req_sz,
     uint32_t offset, void* cb_ctx)
 {
-    fw_info_t* fwInfo = (fw_info_t*)cb_ctx;
+    fw_worker_t* w = (fw_worker_t*)cb_ctx;
+    fw_info_t* fwInfo = w->fwInfo;
     FirmwareChunk_t* fwChunk = NULL;
+    uint32_t len, sz;
+#ifdef CPU_STATS
+    uint32_t cpuStart;
+#endif
 
-    fwInfo->threadState = FW_STATE_THREAD_READY;
+    (void)offset;
+    TPM2_IFX_DevUnlock();
+
+    if (!w->asked) {
+        /* size the chunks posted by the HTTP task to the TPM block size,
+         * the first TPM to ask sets it */
+        taskENTER_CRITICAL();
+        if (fwInfo->chunkSz == 0) {
+            fwInfo->chunkSz = (data_req_sz < IFX_FW_MAX_CHUNK_SZ) ?
+                data_req_sz : IFX_FW_MAX_CHUNK_SZ;
+            if (fwInfo->chunkSz == 0)
+                fwInfo->chunkSz = IFX_FW_MAX_CHUNK_SZ;
+        }
+        taskEXIT_CRITICAL();
+        /* the manifest is taken, ready for the firmware data */
+        w->asked = 1;
+        fw_worker_ready(fwInfo);
+    }
+    if (w->idx == 0)
+        fw_stats_cb_enter(fwInfo);
+#ifdef CPU_STATS
+    cpuStart = cpu_trace_enter();
+#endif
 
 #ifdef TEST_MODE
     do {
 #endif
 
-    /* wait for chunk */
-    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
-    fwChunk = &fwInfo->chunk;
+    sz = 0;
+#ifdef FW_STAGE
+    if (fwInfo->staged)
+        sz = fw_stage_data(w, data, data_req_sz);
+#endif
+    /* an aborted update gets no more data, its TPM ends the update */
+    while (!fwInfo->staged && !fwInfo->aborted && sz < data_req_sz) {
+        /* wait for chunk */
+        if (w->drain == NULL) {
+            uint32_t start = FW_STATS_CYCLES();
+            xSemaphoreTake(w->ready, portMAX_DELAY);
+            if (w->idx == 0)
+                fw_stats_starve(fwInfo, start);
+            if (fwInfo->aborted)
+                break;
+            w->drain = &fwInfo->chunk[w->rd];
+        }
+        fwChunk = w->drain;
+
+        if (fwChunk->sz == 0) {
+            /* end of data: kept until a call has nothing else to return */
+            if (sz == 0)
+                fw_chunk_release(w);
+            break;
+        }
 
-    /* Process chunks */
-    if (data_req_sz > fwChunk->sz) {
-        data_req_sz = fwChunk->sz;
-    }
-    if (data_req_sz > 0) {
-        XMEMCPY(data, fwChunk->buf, data_req_sz);
-        fwInfo->firmwareSz += data_req_sz;
+        /* Process chunks */
+        len = fwChunk->sz - w->pos;
+        if (len > data_req_sz - sz)
+            len = data_req_sz - sz;
+        XMEMCPY(&data[sz], &fwChunk->ptr[w->pos], len);
+        w->pos += len;
+        sz += len;
+
+        /* release slot back to the HTTP task once drained */
+        if (w->pos == fwChunk->sz)
+            fw_chunk_release(w);
     }
+    w->firmwareSz += sz;
+    taskENTER_CRITICAL();
+    if (w->firmwareSz > fwInfo->firmwareSz)
+        fwInfo->firmwareSz = w->firmwareSz;
+    taskEXIT_CRITICAL();
 
 #if 0
-    printf("Chunk %d (total %d)\r\n", (int)fwChunk->sz, fwInfo->firmwareSz);
+    printf("TPM %d chunk %d (total %d)\r\n", w->idx, (int)sz,
+        (int)w->firmwareSz);
 #endif
 
-    xTaskNotifyGive(fwInfo->notifyHandle);
-
 #ifdef TEST_MODE
-    } while (fwChunk->sz > 0);
+    } while (sz > 0);
 #endif
 
-    return data_req_sz;
+#ifdef CPU_STATS
+    cpu_trace_exit(CPU_SECTION_FW_DATA, cpuStart);
+#endif
+    if (w->idx == 0)
+        fw_stats_cb_exit(fwInfo);
+    TPM2_IFX_DevLock(w->idx);
+    return sz;
 }
 
-static void fw_update_task(void *arg)
+static void fw_update_run(fw_worker_t* w)
 {
+    fw_info_t* fwInfo = w->fwInfo;
+    WOLFTPM2_CAPS caps;
     int rc;
-    int opMode = 0, recovery = 0;
-    fw_info_t* fwInfo = (fw_info_t*)arg;
-    (void)TPM2_IFX_GetInfo(&opMode);
-    if (opMode == 0x02 || (opMode & 0x80)) {
+    int recovery = 0;
+
+    /* read the current operational mode, the cached TPM information is
+     * served unchanged while the update runs */
+    TPM2_IFX_DevRefreshInfo(w->idx);
+    rc = TPM2_IFX_DevGetCaps(w->idx, &caps);
+    if (rc != TPM_RC_SUCCESS) {
+        printf("TPM %d: firmware update not started 0x%x: %s\n",
+            w->idx, rc, TPM2_GetRCString(rc));
+        fw_worker_done(w, rc);
+        return;
+    }
+    if (caps.opMode == 0x02 || (caps.opMode & 0x80)) {
         /* if opmode == 2 or 0x8x then we need to use recovery mode */
         recovery = 1;
     }
 
-    /* task has started */
-    fwInfo->threadState = FW_STATE_THREAD_STARTED;
-    fwInfo->threadRc = 0;
+    /* start the update process */
+    TPM2_IFX_DevLock(w->idx);
+    if (recovery) {
+        printf("TPM %d: Firmware Update (recovery mode):\n", w->idx);
+        rc = wolfTPM2_FirmwareUpgradeRecover(TPM2_IFX_GetDev(w->idx),
+            fwInfo->manifest, fwInfo->manifestSz,
+            TPM2_IFX_FwData_Cb, w);
+    }
+    else {
+        printf("TPM %d: Firmware Update (normal mode):\n", w->idx);
+        rc = wolfTPM2_FirmwareUpgrade(TPM2_IFX_GetDev(w->idx),
+            fwInfo->manifest, fwInfo->manifestSz,
+            TPM2_IFX_FwData_Cb, w);
+    }
+    TPM2_IFX_DevUnlock();
+    /* the firmware version and mode have changed */
+    TPM2_IFX_DevRefreshInfo(w->idx);
+
+    if (rc != 0) {
+        printf("TPM %d: Infineon firmware update failed 0x%x: %s\n",
+            w->idx, rc, TPM2_GetRCString(rc));
+    }
+    else {
+        printf("TPM %d: Infineon firmware update success!\n", w->idx);
+    }
+    fw_worker_done(w, rc);
+}
+
+#if TPM_DEV_COUNT > 1
+/* devices 1 and up are brought up by their worker, after the TPM boot set
+ * up the bus */
+static void fw_update_dev_init(int idx)
+{
+    int rc, opMode = 0;
+    char info[MAX_STATUS_LENGTH];
+
+    rc = TPM2_IFX_DevInit(idx);
+    if (rc != TPM_RC_SUCCESS) {
+        printf("TPM %d (I2C 0x%x): init failed 0x%x: %s\n", idx,
+            TPM2_IFX_DevAddr(idx), rc, TPM2_GetRCString(rc));
+        return;
+    }
+    TPM2_IFX_DevGetInfo(idx, info, sizeof(info), &opMode);
+    printf("TPM %d (I2C 0x%x):\n%s\n", idx, TPM2_IFX_DevAddr(idx), info);
+
+    /* cancel update that hasn't started */
+    if (opMode == 0x01) {
+        printf("TPM %d: Abandoning firmware update\r\n", idx);
+        TPM2_IFX_DevLock(idx);
+        wolfTPM2_FirmwareUpgradeCancel(TPM2_IFX_GetDev(idx));
+        TPM2_IFX_DevUnlock();
+        TPM2_IFX_DevRefreshInfo(idx);
+    }
+}
+#endif
+
+static void fw_update_task(void *arg)
+{
+    int idx = (int)(intptr_t)arg;
+    fw_worker_t* w;
+
+#if TPM_DEV_COUNT > 1
+    if (idx > 0)
+        fw_update_dev_init(idx);
+#endif
+    while (1) {
+        /* wait for the next update job */
+        if (xQueueReceive(fw_update_queue[idx], &w, portMAX_DELAY) == pdTRUE) {
+            fw_update_run(w);
+        }
+    }
+}
+
+/* create the firmware update task and its job queue of each TPM */
+static cy_rslt_t fw_update_task_init(void)
+{
+    char name[configMAX_TASK_NAME_LEN];
+    int i;
+
+    for (i = 0; i < TPM_DEV_COUNT; i++) {
+        if (i == 0)
+            snprintf(name, sizeof(name), "FW Update");
+        else
+            snprintf(name, sizeof(name), "FW Update %d", i);
+        fw_update_queue[i] = xQueueCreateStatic(1, sizeof(fw_worker_t*),
+            fw_update_queue_storage[i], &fw_update_queue_buf[i]);
+        fw_update_task_handle[i] = xTaskCreateStatic(fw_update_task, name,
+            FW_UPDATE_TASK_STACK_SIZE, (void*)(intptr_t)i,
+            FW_UPDATE_TASK_PRIORITY, fw_update_task_stack[i],
+            &fw_update_task_tcb[i]);
+        if (fw_update_queue[i] == NULL || fw_update_task_handle[i] == NULL) {
+            return CY_RSLT_TYPE_ERROR;
+        }
+    }
+    return CY_RSLT_SUCCESS;
+}
+
+/* the update task is not using the TPM */
+static int fw_update_idle(const fw_info_t* fwInfo)
+{
+    return (fwInfo->state < FW_STATE_MANIFEST_DONE ||
+            fwInfo->state == FW_STATE_FIRMWARE_REST);
+}
+
+/* the TPMs are programmed from the staging area, uploads must wait */
+static int fw_stage_running(const fw_info_t* fwInfo)
+{
+    return (fwInfo->staged && !fw_update_idle(fwInfo));
+}
+
+/* why an upload must wait, NULL if it can go on */
+static const char* fw_upload_busy(const fw_info_t* fwInfo)
+{
+    if (fw_stage_running(fwInfo))
+        return FW_STAGE_BUSY_MSG;
+    if (TPM2_IFX_GetOwner() == TPM_OWNER_BENCH)
+        return FW_BENCH_BUSY_MSG;
+    if (fwInfo->aborted && fwInfo->doneLeft > 0)
+        return FW_ABORT_BUSY_MSG; /* the workers still use fwInfo */
+    return NULL;
+}
+
+/* The server passes a request body to the handler in segments, counting
+ * data_remaining down. Returns 1 if the segment starts a new body. */
+static int fw_body_begin(const fw_info_t* fwInfo,
+    const cy_http_message_body_t* body)
+{
+    return (fwInfo->bodyRemaining == 0 ||
+        fwInfo->bodyRemaining != body->data_length + body->data_remaining);
+}
+
+static void fw_update_finish(fw_info_t* fwInfo);
+
+/* Marks the connection of the running handler as receiving the firmware
+ * upload, until the update is idle again. The receive window of a PCB is
+ * fixed by TCP_WND and cannot grow for one connection, so the pbuf pool
+ * is sized for one full window (LWIP_PROFILE=throughput, see lwipopts.h)
+ * and the other connections are closed once idle for HTTPS_BULK_IDLE_MS,
+ * leaving the pool and the TCP/IP thread to the upload. */
+static void https_conn_bulk_begin(void)
+{
+    xSemaphoreTake(https_conns_lock, portMAX_DELAY);
+    if (https_conn_current != NULL && https_conn_bulk != https_conn_current) {
+        https_conn_bulk = https_conn_current;
+        APP_INFO(("Firmware upload, bulk receive on connection %d.\n",
+            (int)(https_conn_bulk - https_conns)));
+    }
+    xSemaphoreGive(https_conns_lock);
+}
+
+/* clear the state of the last update */
+static void fw_update_reset(fw_info_t* fwInfo)
+{
+    memset(fwInfo, 0, sizeof(*fwInfo));
+    fw_chunk_init(fwInfo);
+    fwInfo->events = xEventGroupCreateStatic(&fwInfo->eventsBuf);
+}
+
+/* start a new upload, ending an update left waiting by a dropped request */
+static void fw_upload_begin(fw_info_t* fwInfo)
+{
+    if (fwInfo->state == FW_STATE_FIRMWARE_DATA_CHUNK) {
+        printf("Ending unfinished firmware update\n");
+        fw_update_finish(fwInfo);
+    }
+    cyhal_gpio_write(CYBSP_USER_LED2, CYBSP_LED_STATE_ON);
+
+    fw_update_reset(fwInfo);
+    fwInfo->state = FW_STATE_MANIFEST_START;
+    https_conn_bulk_begin();
+}
+
+/* hand the update to the firmware update task of each TPM, the data is
+ * received once and streamed to all of them (or read from the staging
+ * area by each) */
+static void fw_update_dispatch(fw_info_t* fwInfo)
+{
+    int i;
+
+    printf("Starting firmware update\r\n");
+    fwInfo->threadRc = 0;
+    fwInfo->readyLeft = TPM_DEV_COUNT;
+    fwInfo->doneLeft = TPM_DEV_COUNT;
+    fwInfo->readers = fwInfo->staged ? 0 : (1UL << TPM_DEV_COUNT) - 1;
+    if (TPM2_IFX_OwnerTake(TPM_OWNER_FW_UPDATE) != TPM_OWNER_NONE) {
+        /* the benchmark started since the upload was accepted */
+        printf("TPM used by the benchmark, firmware update failed\n");
+        for (i = 0; i < TPM_DEV_COUNT; i++) {
+            fw_worker_done(&fwInfo->worker[i], TPM_RC_FAILURE);
+        }
+        return;
+    }
+    for (i = 0; i < TPM_DEV_COUNT; i++) {
+        fw_worker_t* w = &fwInfo->worker[i];
+        if (xQueueSend(fw_update_queue[i], &w, 0) != pdTRUE) {
+            printf("TPM %d: firmware update task busy\n", i);
+            fw_worker_done(w, TPM_RC_FAILURE);
+        }
+    }
+}
+
+/* start the update task with the received manifest and wait until the TPM
+ * asks for the firmware data */
+static int fw_update_start(fw_info_t* fwInfo)
+{
+    EventBits_t bits;
+
+    printf("Manifest data received: %d bytes\r\n", fwInfo->manifestSz);
+    fwInfo->state = FW_STATE_MANIFEST_DONE;
+
+    fw_update_dispatch(fwInfo);
+    /* wait for task to mark state as "ready" */
+    bits = xEventGroupWaitBits(fwInfo->events,
+        FW_EVENT_READY | FW_EVENT_FAILED, pdFALSE, pdFALSE,
+        pdMS_TO_TICKS(FW_UPDATE_READY_TIMEOUT_MS));
+    if (bits & FW_EVENT_FAILED) {
+        snprintf(fwInfo->status, sizeof(fwInfo->status), "Update failed 0x%x: %s",
+            fwInfo->threadRc, TPM2_GetRCString(fwInfo->threadRc));
+        return FW_PART_ABORT;
+    }
+    if (!(bits & FW_EVENT_READY)) {
+        snprintf(fwInfo->status, sizeof(fwInfo->status),
+            "Update failed: TPM did not ask for data in %d ms",
+            FW_UPDATE_READY_TIMEOUT_MS);
+        /* the data ends as soon as the TPM asks for it */
+        fwInfo->state = FW_STATE_FIRMWARE_DATA_CHUNK;
+        return FW_PART_ABORT;
+    }
+    fwInfo->state = FW_STATE_FIRMWARE_DATA_CHUNK;
+    fwInfo->dataTick = xTaskGetTickCount();
+    fw_stats_start(fwInfo);
+    return 0;
+}
+
+/* send the last chunk and wait for the update task to complete */
+static void fw_update_finish(fw_info_t* fwInfo)
+{
+    fwInfo->state = FW_STATE_FIRMWARE_DONE;
+
+    /* send remaining data and last 0 byte chunk to finalize */
+    fw_data_finish(fwInfo);
+
+    /* wait for task to complete, it uses fwInfo until then */
+    if (!fwInfo->aborted && !(xEventGroupWaitBits(fwInfo->events,
+                FW_EVENT_DONE | FW_EVENT_FAILED, pdFALSE, pdFALSE,
+                pdMS_TO_TICKS(FW_UPDATE_DONE_TIMEOUT_MS)) &
+            (FW_EVENT_DONE | FW_EVENT_FAILED))) {
+        fw_update_abort(fwInfo, "TPM did not end the update");
+    }
+    printf("Firmware data received: %d bytes\n", fwInfo->firmwareSz);
+    fw_stats_stop(fwInfo);
+#ifdef FW_UPDATE_STATS
+    printf("%s", fw_stats_report(fwInfo));
+#endif
+}
+
+/* multipart callbacks for the firmware update form: the "manifest" part
+ * is collected, the "data" part is streamed to the TPM and other fields
+ * (like the submit button) are ignored */
+static int fw_part_begin(multipart_t* mp, void* ctx)
+{
+    fw_info_t* fwInfo = (fw_info_t*)ctx;
+
+    printf("POST: Field: %s, File %s, Boundary %s\n",
+        mp->name, mp->fileName, multipart_get_boundary(mp));
+
+    fwInfo->part = FW_PART_NONE;
+    if (strcmp(mp->name, "manifest") == 0) {
+        if (fwInfo->state != FW_STATE_MANIFEST_START) {
+            snprintf(fwInfo->status, sizeof(fwInfo->status),
+                "POST manifest failed! Field: %s, File %s, Boundary %s\r\n",
+                mp->name, mp->fileName, multipart_get_boundary(mp));
+            return FW_PART_ABORT;
+        }
+        fwInfo->part = FW_PART_MANIFEST;
+    }
+    else if (strcmp(mp->name, "data") == 0) {
+        if (fwInfo->state != FW_STATE_FIRMWARE_DATA_START) {
+            snprintf(fwInfo->status, sizeof(fwInfo->status),
+                "POST firmware data failed! Field: %s, File %s, Boundary %s\r\n",
+                mp->name, mp->fileName, multipart_get_boundary(mp));
+            return FW_PART_ABORT;
+        }
+        fwInfo->part = FW_PART_DATA;
+        /* at most the rest of the body */
+        fwInfo->totalSz = (fwInfo->bodySz > fwInfo->manifestSz) ?
+            fwInfo->bodySz - fwInfo->manifestSz : 0;
+        return fw_update_start(fwInfo);
+    }
+    return 0;
+}
+
+static int fw_part_data(multipart_t* mp, const uint8_t* data, size_t sz,
+    void* ctx)
+{
+    fw_info_t* fwInfo = (fw_info_t*)ctx;
+    (void)mp;
+
+    if (fwInfo->part == FW_PART_MANIFEST) {
+        if (fwInfo->manifestSz + sz > sizeof(fwInfo->manifest)) {
+            snprintf(fwInfo->status, sizeof(fwInfo->status),
+                "POST manifest overrun! Manifest Sz %d, Data %d\r\n",
+                fwInfo->manifestSz, sz);
+            return FW_PART_ABORT;
+        }
+        memcpy(&fwInfo->manifest[fwInfo->manifestSz], data, sz);
+        fwInfo->manifestSz += sz;
+    }
+    else if (fwInfo->part == FW_PART_DATA) {
+        /* drop data already queued by an interrupted upload */
+        if (fwInfo->skipSz > 0) {
+            size_t skip = (sz < fwInfo->skipSz) ? sz : fwInfo->skipSz;
+            fwInfo->skipSz -= skip;
+            data += skip;
+            sz -= skip;
+        }
+        /* firmware data, queued up to the closing delimiter */
+        fw_data_view(fwInfo, data, sz);
+        if (fwInfo->aborted)
+            return FW_PART_ABORT;
+        fwInfo->dataSz += sz;
+    }
+    return 0;
+}
+
+static int fw_part_end(multipart_t* mp, void* ctx)
+{
+    fw_info_t* fwInfo = (fw_info_t*)ctx;
+    (void)mp;
+
+    if (fwInfo->part == FW_PART_MANIFEST) {
+        fwInfo->state = FW_STATE_FIRMWARE_DATA_START;
+    }
+    else if (fwInfo->part == FW_PART_DATA) {
+        fw_update_finish(fwInfo);
+        if (fwInfo->threadRc == 0) {
+            fwInfo->state = FW_STATE_FIRMWARE_REST;
+            cyhal_gpio_write(CYBSP_USER_LED2, CYBSP_LED_STATE_OFF);
+            cyhal_gpio_write(CYBSP_LED_RGB_GREEN, CYBSP_LED_STATE_ON);
+
+            printf("Reset device\n");
+        }
+    }
+    fwInfo->part = FW_PART_NONE;
+    return 0;
+}
+
+/* Finds the connection of stream, or takes a free one (or the least
+ * recently used, whose client likely went away). Call locked. */
+static https_conn_t* https_conn_get(cy_http_response_stream_t *stream)
+{
+    https_conn_t *conn = NULL;
+    int i;
+
+    for (i = 0; i < MAX_SOCKETS; i++) {
+        if (https_conns[i].stream == stream) {
+            return &https_conns[i];
+        }
+        if (https_conns[i].busy) {
+            continue;
+        }
+        if (conn == NULL || (conn->stream != NULL &&
+                (https_conns[i].stream == NULL ||
+                 (int32_t)(https_conns[i].last - conn->last) < 0))) {
+            conn = &https_conns[i];
+        }
+    }
+    if (conn != NULL) {
+        if (conn == https_conn_bulk) {
+            https_conn_bulk = NULL;
+        }
+        memset(conn, 0, sizeof(*conn));
+        conn->stream = stream;
+    }
+    return conn;
+}
+
+#ifdef HTTP_LATENCY_STATS
+/* Microseconds since the request started: from the cycle counter, or the
+ * tick count for requests longer than the cycle counter wrap */
+static uint32_t https_latency_us(const https_conn_t *conn)
+{
+    TickType_t ticks = xTaskGetTickCount() - conn->req_tick;
+
+    if (ticks > pdMS_TO_TICKS(10000)) {
+        return ticks * portTICK_PERIOD_MS * 1000;
+    }
+    return perf_cycles_to_us(perf_cycles() - conn->req_start);
+}
+
+/* Records a request that has ended. Call locked. */
+static void https_latency_end(https_latency_t *latency, https_conn_t *conn)
+{
+    uint32_t total = https_latency_us(conn);
+
+    if (latency != NULL) {
+        perf_hist_add(&latency->total, total);
+        perf_hist_add(&latency->first_byte, (conn->req_first_byte_us != 0) ?
+            conn->req_first_byte_us : total);
+    }
+    conn->req_open = 0;
+}
+#endif
+
+/*******************************************************************************
+ * Function Name: https_conn_handler
+ *******************************************************************************
+ * Summary:
+ *  Runs the resource handler of a dynamic resource, counting the requests on
+ *  the connection. The connection is closed once it has served
+ *  HTTPS_KEEPALIVE_MAX_REQUESTS requests.
+ *
+ * Parameters:
+ *  url_path - Pointer to the HTTPS URL path.
+ *  url_parameters - Pointer to the HTTPS URL query string.
+ *  stream - Pointer to the HTTPS response stream.
+ *  arg - Pointer to the https_resource_t.
+ *  https_message_body - Pointer to the HTTPS data from the client.
+ *
+ * Return:
+ *  int32_t - The result of the resource handler.
+ *
+ *******************************************************************************/
+static int32_t https_conn_handler(const char* url_path,
+                                  const char* url_parameters,
+                                  cy_http_response_stream_t* stream,
+                                  void* arg,
+                                  cy_http_message_body_t* https_message_body)
+{
+    const https_resource_t *res = (const https_resource_t*)arg;
+    https_conn_t *conn;
+    int32_t status;
+    int close = 0;
+#ifdef CPU_STATS
+    uint32_t cpuStart;
+#endif
+
+    xSemaphoreTake(https_conns_lock, portMAX_DELAY);
+    conn = https_conn_get(stream);
+    if (conn != NULL) {
+        conn->busy = 1;
+#ifdef HTTP_LATENCY_STATS
+        if (!conn->req_open) {
+            conn->req_open = 1;
+            conn->req_start = perf_cycles();
+            conn->req_tick = xTaskGetTickCount();
+            conn->req_first_byte_us = 0;
+        }
+#endif
+    }
+    https_conn_current = conn;
+    xSemaphoreGive(https_conns_lock);
+
+#ifdef WIFI_POWER
+    wifi_power_request_begin();
+#endif
+#ifdef CPU_STATS
+    cpuStart = cpu_trace_enter();
+#endif
+    status = res->app.resource_handler(url_path, url_parameters, stream,
+        res->app.arg, https_message_body);
+#ifdef CPU_STATS
+    cpu_trace_exit((res->app.resource_handler == dynamic_resource_handler) ?
+        CPU_SECTION_TPM_PAGE : CPU_SECTION_HTTP, cpuStart);
+#endif
+#ifdef WIFI_POWER
+    wifi_power_request_end();
+#endif
+
+    xSemaphoreTake(https_conns_lock, portMAX_DELAY);
+    https_conn_current = NULL;
+    if (conn != NULL && conn->stream == stream) {
+        conn->busy = 0;
+        conn->last = xTaskGetTickCount();
+#ifdef HTTP_LATENCY_STATS
+        if (https_message_body->data_remaining == 0) {
+            https_latency_end(res->latency, conn);
+        }
+#endif
+        /* a request body may take several calls, count it on the last */
+        if (conn == https_conn_bulk &&
+                https_message_body->data_remaining == 0 &&
+                fw_update_idle(&mFwInfo)) {
+            https_conn_bulk = NULL;
+        }
+        if (https_message_body->data_remaining == 0 &&
+                ++conn->requests >= HTTPS_KEEPALIVE_MAX_REQUESTS) {
+            conn->stream = NULL;
+            close = 1;
+        }
+    }
+    xSemaphoreGive(https_conns_lock);
+
+    if (close) {
+        /* queued to the server, after the response */
+        APP_INFO(("Closing connection after %d requests.\n",
+            HTTPS_KEEPALIVE_MAX_REQUESTS));
+        cy_http_server_response_stream_disconnect(stream);
+    }
+    return status;
+}
+
+/* Routes a dynamic resource through https_conn_handler, returns the
+ * resource to register */
+static cy_resource_dynamic_data_t* https_resource_init(https_resource_t *res,
+    url_processor_t handler, void *arg)
+{
+    res->app.resource_handler = handler;
+    res->app.arg = arg;
+    res->conn.resource_handler = https_conn_handler;
+    res->conn.arg = res;
+    return &res->conn;
+}
+
+/* Writes a response payload as TLS records of at most HTTPS_TLS_RECORD_SZ
+ * bytes, so each record fits in one TCP segment and the wolfSSL output
+ * buffer stays one segment long */
+static cy_rslt_t https_write_payload(cy_http_response_stream_t* stream,
+    const void* data, uint32_t length)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    const uint8_t* p = (const uint8_t*)data;
+    uint32_t sz;
+
+#ifdef HTTP_LATENCY_STATS
+    if (https_conn_current != NULL &&
+            https_conn_current->req_first_byte_us == 0) {
+        https_conn_current->req_first_byte_us =
+            https_latency_us(https_conn_current) + 1;
+    }
+#endif
+#ifdef WIFI_POWER
+    wifi_power_first_byte();
+#endif
+    do {
+        sz = (length > HTTPS_TLS_RECORD_SZ) ? HTTPS_TLS_RECORD_SZ : length;
+        result = cy_http_server_response_stream_write_payload(stream, p, sz);
+        p += sz;
+        length -= sz;
+    } while (CY_RSLT_SUCCESS == result && length > 0);
+    return result;
+}
+
+static int https_tmpl_flush(void* ctx, const void* data, uint32_t sz)
+{
+    return (https_write_payload((cy_http_response_stream_t*)ctx, data, sz) ==
+        CY_RSLT_SUCCESS) ? 0 : -1;
+}
+
+/* Renders a response template into the stream, in full TLS records */
+static cy_rslt_t https_render(cy_http_response_stream_t* stream,
+    const http_tmpl_t* tmpl, http_tmpl_var_cb var, void* ctx)
+{
+    http_tmpl_init(&https_out, https_out_buf, sizeof(https_out_buf),
+        https_tmpl_flush, stream);
+    return (http_tmpl_render(&https_out, tmpl, var, ctx) == 0) ?
+        CY_RSLT_SUCCESS : CY_RSLT_TYPE_ERROR;
+}
+
+/* Closes the connections idle for HTTPS_KEEPALIVE_IDLE_MS, or for
+ * HTTPS_BULK_IDLE_MS while a firmware upload is received (except the
+ * uploading one), called from the HTTPS server task */
+static void https_conn_sweep(void)
+{
+    cy_http_response_stream_t *idle[MAX_SOCKETS];
+    TickType_t now = xTaskGetTickCount();
+    TickType_t limit;
+    int i, count = 0;
+
+    xSemaphoreTake(https_conns_lock, portMAX_DELAY);
+    for (i = 0; i < MAX_SOCKETS; i++) {
+        limit = (https_conn_bulk != NULL && https_conn_bulk != &https_conns[i]) ?
+            pdMS_TO_TICKS(HTTPS_BULK_IDLE_MS) :
+            pdMS_TO_TICKS(HTTPS_KEEPALIVE_IDLE_MS);
+        if (https_conns[i].stream != NULL && !https_conns[i].busy &&
+                (now - https_conns[i].last) >= limit) {
+            idle[count++] = https_conns[i].stream;
+            https_conns[i].stream = NULL;
+            if (https_conn_bulk == &https_conns[i]) {
+                https_conn_bulk = NULL;
+            }
+        }
+    }
+    xSemaphoreGive(https_conns_lock);
+
+    for (i = 0; i < count; i++) {
+        APP_INFO(("Closing idle connection.\n"));
+        cy_http_server_response_stream_disconnect(idle[i]);
+    }
+}
+
+/* Placeholders of the response templates, see https_tmpl_var */
+enum {
+    TMPL_TPM_MFG_STR,
+    TMPL_TPM_MFG,
+    TMPL_TPM_VENDOR_STR,
+    TMPL_TPM_FW_MAJOR,
+    TMPL_TPM_FW_MINOR,
+    TMPL_TPM_FW_VENDOR,
+    TMPL_TPM_OPMODE_STR,
+    TMPL_TPM_OPMODE,
+    TMPL_TPM_KEYGROUP,
+    TMPL_TPM_FW_COUNTER,
+    TMPL_TPM_FW_COUNTER_SAME,
+    TMPL_TPM_RC,
+    TMPL_TPM_RC_STR,
+    TMPL_BUS_HZ,
+    TMPL_BUS_RTT_US,
+    TMPL_BUS_BPS,
+    TMPL_FW_STATE,
+    TMPL_FW_RESUMABLE,
+    TMPL_FW_MANIFEST_SZ,
+    TMPL_FW_RECEIVED,
+    TMPL_FW_WRITTEN,
+    TMPL_FW_RC,
+    TMPL_FW_RC_STR,
+    TMPL_FW_TOTAL,
+    TMPL_FW_BPS,
+    TMPL_FW_ETA_S,
+    TMPL_FW_RETRY_MS,
+    TMPL_FW_DEVICES
+};
+
+/* Values of the placeholders */
+typedef struct {
+    WOLFTPM2_CAPS caps;
+    int rc;                     /* of TPM2_IFX_GetCaps */
+    uint32_t busHz;
+    uint32_t busRttUs;
+    uint32_t busBps;
+    const fw_info_t* fwInfo;
+    uint32_t fwBps;             /* firmware bytes per second to the TPM */
+    int32_t fwEtaS;             /* seconds left, -1 if not known */
+    int json;                   /* strings as JSON string values */
+} https_tmpl_ctx_t;
+
+/* TPM status frame of the page (/tpm) and the firmware update result */
+HTTP_TMPL(tpm_info_tmpl,
+    HTTP_TMPL_TEXT("Mfg "), HTTP_TMPL_VAR(TMPL_TPM_MFG_STR),
+    HTTP_TMPL_TEXT(" ("), HTTP_TMPL_VAR(TMPL_TPM_MFG),
+    HTTP_TMPL_TEXT("), Vendor "), HTTP_TMPL_VAR(TMPL_TPM_VENDOR_STR),
+    HTTP_TMPL_TEXT(", Fw "), HTTP_TMPL_VAR(TMPL_TPM_FW_MAJOR),
+    HTTP_TMPL_TEXT("."), HTTP_TMPL_VAR(TMPL_TPM_FW_MINOR),
+    HTTP_TMPL_TEXT(" (0x"), HTTP_TMPL_VAR(TMPL_TPM_FW_VENDOR),
+    HTTP_TMPL_TEXT(")\nOperational mode: "), HTTP_TMPL_VAR(TMPL_TPM_OPMODE_STR),
+    HTTP_TMPL_TEXT(" (0x"), HTTP_TMPL_VAR(TMPL_TPM_OPMODE),
+    HTTP_TMPL_TEXT(")\nKeyGroupId 0x"), HTTP_TMPL_VAR(TMPL_TPM_KEYGROUP),
+    HTTP_TMPL_TEXT(", FwCounter "), HTTP_TMPL_VAR(TMPL_TPM_FW_COUNTER),
+    HTTP_TMPL_TEXT(" ("), HTTP_TMPL_VAR(TMPL_TPM_FW_COUNTER_SAME),
+    HTTP_TMPL_TEXT(" same)\n"));
+HTTP_TMPL(tpm_error_tmpl,
+    HTTP_TMPL_TEXT("Get Capabilities failed 0x"), HTTP_TMPL_VAR(TMPL_TPM_RC),
+    HTTP_TMPL_TEXT(": "), HTTP_TMPL_VAR(TMPL_TPM_RC_STR),
+    HTTP_TMPL_TEXT("\n"));
+HTTP_TMPL(fw_result_tmpl,
+    HTTP_TMPL_TEXT("Update result 0x"), HTTP_TMPL_VAR(TMPL_FW_RC),
+    HTTP_TMPL_TEXT(": "), HTTP_TMPL_VAR(TMPL_FW_RC_STR));
+HTTP_TMPL(fw_raw_result_tmpl,
+    HTTP_TMPL_TEXT("Update result 0x"), HTTP_TMPL_VAR(TMPL_FW_RC),
+    HTTP_TMPL_TEXT(": "), HTTP_TMPL_VAR(TMPL_FW_RC_STR),
+    HTTP_TMPL_TEXT("\r\n"));
+
+/* JSON status API, see api_resource_handler */
+HTTP_TMPL(api_tpm_tmpl,
+    HTTP_TMPL_TEXT("{\"rc\":0,\"mfg\":\""), HTTP_TMPL_VAR(TMPL_TPM_MFG_STR),
+    HTTP_TMPL_TEXT("\",\"vendor\":\""), HTTP_TMPL_VAR(TMPL_TPM_VENDOR_STR),
+    HTTP_TMPL_TEXT("\",\"fwVerMajor\":"), HTTP_TMPL_VAR(TMPL_TPM_FW_MAJOR),
+    HTTP_TMPL_TEXT(",\"fwVerMinor\":"), HTTP_TMPL_VAR(TMPL_TPM_FW_MINOR),
+    HTTP_TMPL_TEXT(",\"fwVerVendor\":"), HTTP_TMPL_VAR(TMPL_TPM_FW_VENDOR),
+    HTTP_TMPL_TEXT(",\"opMode\":"), HTTP_TMPL_VAR(TMPL_TPM_OPMODE),
+    HTTP_TMPL_TEXT(",\"keyGroupId\":"), HTTP_TMPL_VAR(TMPL_TPM_KEYGROUP),
+    HTTP_TMPL_TEXT(",\"fwCounter\":"), HTTP_TMPL_VAR(TMPL_TPM_FW_COUNTER),
+    HTTP_TMPL_TEXT(",\"fwCounterSame\":"),
+    HTTP_TMPL_VAR(TMPL_TPM_FW_COUNTER_SAME),
+    HTTP_TMPL_TEXT(",\"busHz\":"), HTTP_TMPL_VAR(TMPL_BUS_HZ),
+    HTTP_TMPL_TEXT(",\"busRttUs\":"), HTTP_TMPL_VAR(TMPL_BUS_RTT_US),
+    HTTP_TMPL_TEXT(",\"busBytesPerSec\":"), HTTP_TMPL_VAR(TMPL_BUS_BPS),
+    HTTP_TMPL_TEXT("}"));
+HTTP_TMPL(api_tpm_error_tmpl,
+    HTTP_TMPL_TEXT("{\"rc\":"), HTTP_TMPL_VAR(TMPL_TPM_RC),
+    HTTP_TMPL_TEXT(",\"busHz\":"), HTTP_TMPL_VAR(TMPL_BUS_HZ),
+    HTTP_TMPL_TEXT("}"));
+HTTP_TMPL(api_fw_status_tmpl,
+    HTTP_TMPL_TEXT("{\"state\":\""), HTTP_TMPL_VAR(TMPL_FW_STATE),
+    HTTP_TMPL_TEXT("\",\"resumable\":"), HTTP_TMPL_VAR(TMPL_FW_RESUMABLE),
+    HTTP_TMPL_TEXT(",\"manifestSz\":"), HTTP_TMPL_VAR(TMPL_FW_MANIFEST_SZ),
+    HTTP_TMPL_TEXT(",\"received\":"), HTTP_TMPL_VAR(TMPL_FW_RECEIVED),
+    HTTP_TMPL_TEXT(",\"written\":"), HTTP_TMPL_VAR(TMPL_FW_WRITTEN),
+    HTTP_TMPL_TEXT(",\"rc\":"), HTTP_TMPL_VAR(TMPL_FW_RC),
+    HTTP_TMPL_TEXT(",\"devices\":"), HTTP_TMPL_VAR(TMPL_FW_DEVICES),
+    HTTP_TMPL_TEXT("}"));
+/* Server-Sent Events stream of /fw/progress: one event per request, the
+ * browser (EventSource) reconnects after the retry time */
+HTTP_TMPL(fw_progress_tmpl,
+    HTTP_TMPL_TEXT("retry: "), HTTP_TMPL_VAR(TMPL_FW_RETRY_MS),
+    HTTP_TMPL_TEXT("\nid: "), HTTP_TMPL_VAR(TMPL_FW_WRITTEN),
+    HTTP_TMPL_TEXT("\nevent: progress\ndata: {\"state\":\""),
+    HTTP_TMPL_VAR(TMPL_FW_STATE),
+    HTTP_TMPL_TEXT("\",\"received\":"), HTTP_TMPL_VAR(TMPL_FW_RECEIVED),
+    HTTP_TMPL_TEXT(",\"written\":"), HTTP_TMPL_VAR(TMPL_FW_WRITTEN),
+    HTTP_TMPL_TEXT(",\"total\":"), HTTP_TMPL_VAR(TMPL_FW_TOTAL),
+    HTTP_TMPL_TEXT(",\"bytesPerSec\":"), HTTP_TMPL_VAR(TMPL_FW_BPS),
+    HTTP_TMPL_TEXT(",\"etaS\":"), HTTP_TMPL_VAR(TMPL_FW_ETA_S),
+    HTTP_TMPL_TEXT(",\"rc\":"), HTTP_TMPL_VAR(TMPL_FW_RC),
+    HTTP_TMPL_TEXT("}\n\n"));
+HTTP_TMPL(api_use_get_tmpl,
+    HTTP_TMPL_TEXT("{\"error\":\"use GET\"}"));
+
+static int fw_data_resumable(const fw_info_t* fwInfo);
+
+static void https_tmpl_str(http_tmpl_out_t* out, const https_tmpl_ctx_t* t,
+    const char* s)
+{
+    if (t->json)
+        http_tmpl_json_str(out, s);
+    else
+        http_tmpl_str(out, s);
+}
+
+/* Writes the value of a placeholder, ctx is a https_tmpl_ctx_t */
+static void https_tmpl_var(http_tmpl_out_t* out, uint16_t id, void* ctx)
+{
+    const https_tmpl_ctx_t* t = (const https_tmpl_ctx_t*)ctx;
+    const WOLFTPM2_CAPS* caps = &t->caps;
+    int i;
+
+    switch (id) {
+        case TMPL_TPM_MFG_STR:
+            https_tmpl_str(out, t, caps->mfgStr);
+            break;
+        case TMPL_TPM_MFG:
+            http_tmpl_printf(out, "%d", (int)caps->mfg);
+            break;
+        case TMPL_TPM_VENDOR_STR:
+            https_tmpl_str(out, t, caps->vendorStr);
+            break;
+        case TMPL_TPM_FW_MAJOR:
+            http_tmpl_printf(out, "%u", (unsigned)caps->fwVerMajor);
+            break;
+        case TMPL_TPM_FW_MINOR:
+            http_tmpl_printf(out, "%u", (unsigned)caps->fwVerMinor);
+            break;
+        case TMPL_TPM_FW_VENDOR:
+            http_tmpl_printf(out, t->json ? "%lu" : "%lx",
+                (unsigned long)caps->fwVerVendor);
+            break;
+        case TMPL_TPM_OPMODE_STR:
+            https_tmpl_str(out, t, TPM2_IFX_GetOpModeStr(caps->opMode));
+            break;
+        case TMPL_TPM_OPMODE:
+            http_tmpl_printf(out, t->json ? "%u" : "%x",
+                (unsigned)caps->opMode);
+            break;
+        case TMPL_TPM_KEYGROUP:
+            http_tmpl_printf(out, t->json ? "%lu" : "%lx",
+                (unsigned long)caps->keyGroupId);
+            break;
+        case TMPL_TPM_FW_COUNTER:
+            http_tmpl_printf(out, "%u", (unsigned)caps->fwCounter);
+            break;
+        case TMPL_TPM_FW_COUNTER_SAME:
+            http_tmpl_printf(out, "%u", (unsigned)caps->fwCounterSame);
+            break;
+        case TMPL_TPM_RC:
+            http_tmpl_printf(out, t->json ? "%d" : "%x", t->rc);
+            break;
+        case TMPL_TPM_RC_STR:
+            https_tmpl_str(out, t, TPM2_GetRCString(t->rc));
+            break;
+        case TMPL_BUS_HZ:
+            http_tmpl_printf(out, "%lu", (unsigned long)t->busHz);
+            break;
+        case TMPL_BUS_RTT_US:
+            http_tmpl_printf(out, "%lu", (unsigned long)t->busRttUs);
+            break;
+        case TMPL_BUS_BPS:
+            http_tmpl_printf(out, "%lu", (unsigned long)t->busBps);
+            break;
+        case TMPL_FW_STATE:
+            http_tmpl_str(out, fw_state_str[t->fwInfo->state]);
+            break;
+        case TMPL_FW_RESUMABLE:
+            http_tmpl_str(out, fw_data_resumable(t->fwInfo) ? "true" : "false");
+            break;
+        case TMPL_FW_MANIFEST_SZ:
+            http_tmpl_printf(out, "%lu", (unsigned long)t->fwInfo->manifestSz);
+            break;
+        case TMPL_FW_RECEIVED:
+            http_tmpl_printf(out, "%lu", (unsigned long)t->fwInfo->dataSz);
+            break;
+        case TMPL_FW_WRITTEN:
+            http_tmpl_printf(out, "%lu", (unsigned long)t->fwInfo->firmwareSz);
+            break;
+        case TMPL_FW_RC:
+            http_tmpl_printf(out, t->json ? "%d" : "%x", t->fwInfo->threadRc);
+            break;
+        case TMPL_FW_RC_STR:
+            https_tmpl_str(out, t, TPM2_GetRCString(t->fwInfo->threadRc));
+            break;
+        case TMPL_FW_TOTAL:
+            http_tmpl_printf(out, "%lu", (unsigned long)t->fwInfo->totalSz);
+            break;
+        case TMPL_FW_BPS:
+            http_tmpl_printf(out, "%lu", (unsigned long)t->fwBps);
+            break;
+        case TMPL_FW_ETA_S:
+            if (t->fwEtaS < 0)
+                http_tmpl_str(out, "null");
+            else
+                http_tmpl_printf(out, "%ld", (long)t->fwEtaS);
+            break;
+        case TMPL_FW_RETRY_MS:
+            http_tmpl_printf(out, "%d",
+                (t->fwInfo->state == FW_STATE_INIT ||
+                 t->fwInfo->state == FW_STATE_FIRMWARE_REST) ?
+                FW_PROGRESS_IDLE_RETRY_MS : FW_PROGRESS_RETRY_MS);
+            break;
+        case TMPL_FW_DEVICES:
+            /* JSON array, the result of each TPM of the last update */
+            for (i = 0; i < TPM_DEV_COUNT; i++) {
+                const fw_worker_t* w = &t->fwInfo->worker[i];
+                http_tmpl_printf(out,
+                    "%s{\"addr\":%d,\"written\":%lu,\"rc\":%d}",
+                    (i == 0) ? "[" : ",", TPM2_IFX_DevAddr(i),
+                    (unsigned long)w->firmwareSz, w->rc);
+            }
+            http_tmpl_str(out, "]");
+            break;
+        default:
+            break;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: dynamic_resource_handler
+ *******************************************************************************
+ * Summary:
+ *  Handles HTTPS GET, POST, and PUT requests for the /tpm resource, shown in
+ *  the TPM status frame of the web page.
+ *  HTTPS GET sends the TPM information as a response to the client.
+ *  HTTPS POST runs the firmware update with the multipart/form-data upload and
+ *  then sends its result as a response to the client.
+ *  HTTPS PUT registers or updates the resource "/<name>=<value>" in its body,
+ *  and sends an error message as a response to the client if the resource
+ *  registration is unsuccessful.
+ *
+ * Parameters:
+ *  url_path - Pointer to the HTTPS URL path.
+ *  url_parameters - Pointer to the HTTPS URL query string.
+ *  stream - Pointer to the HTTPS response stream.
+ *  arg - Pointer to the argument passed during HTTPS resource registration.
+ *  https_message_body - Pointer to the HTTPS data from the client.
+ *
+ * Return:
+ *  int32_t - Returns HTTPS_REQUEST_HANDLE_SUCCESS if the request from the client
+ *  was handled successfully. Otherwise, it returns HTTPS_REQUEST_HANDLE_ERROR.
+ *
+ *******************************************************************************/
+int32_t dynamic_resource_handler(const char* url_path,
+                                 const char* url_parameters,
+                                 cy_http_response_stream_t* stream,
+                                 void* arg,
+                                 cy_http_message_body_t* https_message_body)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    int32_t status = HTTPS_REQUEST_HANDLE_SUCCESS;
+    const char* msg;
+    uint32_t start;
+    int rc;
+
+    cyhal_gpio_write(CYBSP_USER_LED, CYBSP_LED_STATE_ON);
+
+    switch (https_message_body->request_type)
+    {
+        case CY_HTTP_REQUEST_GET:
+            APP_INFO(("Received HTTPS GET request.\n"));
+
+            /* Send the TPM status shown in the page. */
+            {
+                https_tmpl_ctx_t t;
+                char* value = NULL;
+                uint32_t valueSz = 0;
+                /* "Refresh TPM" reads the TPM again, unless an update is
+                 * using it */
+                if (fw_update_idle(&mFwInfo) && url_parameters != NULL &&
+                        cy_http_server_get_query_parameter_value(url_parameters,
+                            "refresh", &value, &valueSz) == CY_RSLT_SUCCESS) {
+                    TPM2_IFX_RefreshInfo();
+                }
+                memset(&t, 0, sizeof(t));
+                t.rc = TPM2_IFX_GetCaps(&t.caps);
+                result = https_render(stream, (t.rc == TPM_RC_SUCCESS) ?
+                    &tpm_info_tmpl : &tpm_error_tmpl, https_tmpl_var, &t);
+            }
+            if (CY_RSLT_SUCCESS != result) {
+                ERR_INFO(("Failed to send the HTTPS GET response.\n"));
+            }
+            break;
+
+        case CY_HTTP_REQUEST_POST:
+            APP_INFO(("Received HTTPS POST request.\n"));
+
+            if ((msg = fw_upload_busy(&mFwInfo)) != NULL) {
+                result = https_write_payload(stream, msg, strlen(msg));
+                status = HTTPS_REQUEST_HANDLE_ERROR;
+                break;
+            }
+
+            if (fw_body_begin(&mFwInfo, https_message_body)) {
+                /* new upload, the boundary is taken from the first line */
+                fw_upload_begin(&mFwInfo);
+                mFwInfo.bodySz = https_message_body->data_length +
+                    https_message_body->data_remaining;
+                multipart_init(&mFwInfo.mp, NULL, fw_part_begin, fw_part_data,
+                    fw_part_end, &mFwInfo);
+            }
+
+            /* the multipart callbacks above run the update state machine */
+            start = fw_stats_http_enter(&mFwInfo);
+            rc = multipart_parse(&mFwInfo.mp, https_message_body->data,
+                https_message_body->data_length);
+            /* body is handed back to the server on return */
+            fw_data_sync(&mFwInfo);
+            fw_stats_http_exit(&mFwInfo, start);
+            mFwInfo.bodyRemaining = https_message_body->data_remaining;
+            if (rc == MULTIPART_SUCCESS &&
+                    https_message_body->data_remaining == 0 &&
+                    mFwInfo.mp.state != MULTIPART_STATE_DONE) {
+                rc = MULTIPART_BAD_FORMAT; /* truncated body */
+            }
+            if (rc != MULTIPART_SUCCESS) {
+                if (mFwInfo.status[0] == '\0') {
+                    snprintf(mFwInfo.status, sizeof(mFwInfo.status),
+                        "POST parse failed %d! Field: %s, File %s, Boundary %s\r\n",
+                        rc, mFwInfo.mp.name, mFwInfo.mp.fileName,
+                        multipart_get_boundary(&mFwInfo.mp));
+                }
+                if (mFwInfo.state == FW_STATE_FIRMWARE_DATA_CHUNK) {
+                    /* do not leave the update task waiting for data */
+                    fw_update_finish(&mFwInfo);
+                }
+                puts(mFwInfo.status);
+                result = https_write_payload(stream,
+                    mFwInfo.status, strlen(mFwInfo.status));
+                mFwInfo.state = FW_STATE_INIT;
+                mFwInfo.bodyRemaining = 0;
+                return HTTPS_REQUEST_HANDLE_ERROR;
+            }
+
+            if (https_message_body->data_remaining == 0) {
+                /* Send the update result, shown as the TPM status. */
+                https_tmpl_ctx_t t;
+                memset(&t, 0, sizeof(t));
+                t.fwInfo = &mFwInfo;
+                result = https_render(stream, &fw_result_tmpl,
+                    https_tmpl_var, &t);
+                if (CY_RSLT_SUCCESS != result) {
+                    ERR_INFO(("Failed to send the HTTPS POST response.\n"));
+                }
+
+                mFwInfo.state = FW_STATE_INIT; /* reset state */
+            }
+            break;
+
+        case CY_HTTP_REQUEST_PUT:
+            APP_INFO(("Received HTTPS PUT request.\n"));
+
+            /* Register or update the resource "/<name>=<value>". */
+            if (https_message_body->data_remaining != 0) {
+                msg = "HTTP PUT body too large\r\n";
+            }
+            else {
+                msg = register_https_resource(
+                    (const char*)https_message_body->data,
+                    https_message_body->data_length);
+            }
+            if (msg != NULL) {
+                /* Send the HTTPS error response. */
+                result = https_write_payload(stream,
+                    msg, strlen(msg));
+                status = HTTPS_REQUEST_HANDLE_ERROR;
+                if (CY_RSLT_SUCCESS != result)
+                {
+                    ERR_INFO(("Failed to send the HTTPS PUT error response.\n"));
+                }
+            }
+            break;
+
+        default:
+            ERR_INFO(("Received invalid HTTP request method. Supported HTTP methods are GET, POST, and PUT.\n"));
+            break;
+    }
+
+    if (CY_RSLT_SUCCESS != result)
+    {
+        status = HTTPS_REQUEST_HANDLE_ERROR;
+    }
+
+    print_heap_usage("At the end of GET/POST/PUT request handler");
+    cyhal_gpio_write(CYBSP_USER_LED, CYBSP_LED_STATE_OFF);
+
+    return status;
+}
+
+/* An upload of the firmware data that was interrupted (for example by a
+ * Wi-Fi drop) can be continued while the update task still waits for
+ * data, the TPM keeps the update state across the gap */
+static int fw_data_resumable(const fw_info_t* fwInfo)
+{
+    return (fwInfo->state == FW_STATE_FIRMWARE_DATA_CHUNK && !fwInfo->staged &&
+            !fwInfo->aborted && (xEventGroupGetBits(fwInfo->events) &
+                (FW_EVENT_READY | FW_EVENT_DONE | FW_EVENT_FAILED)) ==
+            FW_EVENT_READY);
+}
+
+/* Continue an interrupted upload at the offset=<bytes> query parameter.
+ * The body may start before the queued offset (the resent bytes are
+ * dropped) but not after it. */
+static int fw_data_resume(fw_info_t* fwInfo, const char* url_parameters)
+{
+    char* value = NULL;
+    uint32_t valueSz = 0, i;
+    size_t offset = 0;
+
+    if (url_parameters == NULL ||
+        cy_http_server_get_query_parameter_value(url_parameters, "offset",
+            &value, &valueSz) != CY_RSLT_SUCCESS || valueSz == 0) {
+        snprintf(fwInfo->status, sizeof(fwInfo->status),
+            "Update in progress, resume with offset=%lu\r\n",
+            (unsigned long)fwInfo->dataSz);
+        return FW_PART_RETRY;
+    }
+    for (i = 0; i < valueSz; i++) {
+        if (value[i] < '0' || value[i] > '9')
+            break;
+        offset = (offset * 10) + (value[i] - '0');
+    }
+    if (i != valueSz || offset > fwInfo->dataSz) {
+        snprintf(fwInfo->status, sizeof(fwInfo->status),
+            "Invalid resume offset, resume with offset=%lu\r\n",
+            (unsigned long)fwInfo->dataSz);
+        return FW_PART_RETRY;
+    }
+
+    printf("Resuming firmware data at %lu (queued %lu)\n",
+        (unsigned long)offset, (unsigned long)fwInfo->dataSz);
+    fwInfo->skipSz = fwInfo->dataSz - offset;
+    fwInfo->part = FW_PART_DATA;
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: fw_raw_resource_handler
+ *******************************************************************************
+ * Summary:
+ *  Handles HTTPS POST and PUT requests with a raw (application/octet-stream)
+ *  body for the /fw/manifest and /fw/data resources. The manifest is
+ *  collected first, then the firmware data body is streamed to the TPM as
+ *  it is received. No multipart parsing is done.
+ *  If a data upload is interrupted it can be continued with
+ *  /fw/data?offset=<bytes>, resending the file from any offset up to the
+ *  one returned by GET /fw/data.
+ *
+ *  curl --data-binary @fw.manifest https://<server>/fw/manifest
+ *  curl --data-binary @fw.data https://<server>/fw/data
+ *
+ * Parameters:
+ *  url_path - Pointer to the HTTPS URL path.
+ *  url_parameters - Pointer to the HTTPS URL query string.
+ *  stream - Pointer to the HTTPS response stream.
+ *  arg - FW_PART_MANIFEST or FW_PART_DATA.
+ *  https_message_body - Pointer to the HTTPS data from the client.
+ *
+ * Return:
+ *  int32_t - Returns HTTPS_REQUEST_HANDLE_SUCCESS if the request from the client
+ *  was handled successfully. Otherwise, it returns HTTPS_REQUEST_HANDLE_ERROR.
+ *
+ *******************************************************************************/
+int32_t fw_raw_resource_handler(const char* url_path,
+                                const char* url_parameters,
+                                cy_http_response_stream_t* stream,
+                                void* arg,
+                                cy_http_message_body_t* https_message_body)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    FwPart part = (FwPart)(uintptr_t)arg;
+    const char* msg;
+    uint32_t start;
+    int rc = 0;
+
+    (void)url_path;
+
+    if (https_message_body->request_type == CY_HTTP_REQUEST_GET) {
+        /* bytes received so far, the offset to resume an upload at */
+        snprintf(mFwInfo.status, sizeof(mFwInfo.status), "offset=%lu\r\n",
+            (unsigned long)((part == FW_PART_MANIFEST) ? mFwInfo.manifestSz :
+                (fw_data_resumable(&mFwInfo) ? mFwInfo.dataSz : 0)));
+        result = https_write_payload(stream,
+            mFwInfo.status, strlen(mFwInfo.status));
+        return (CY_RSLT_SUCCESS == result) ?
+            HTTPS_REQUEST_HANDLE_SUCCESS : HTTPS_REQUEST_HANDLE_ERROR;
+    }
+    if (https_message_body->request_type != CY_HTTP_REQUEST_POST &&
+        https_message_body->request_type != CY_HTTP_REQUEST_PUT) {
+        msg = "Use POST or PUT with the raw file as body\r\n";
+        result = https_write_payload(stream,
+            msg, strlen(msg));
+        return HTTPS_REQUEST_HANDLE_ERROR;
+    }
+    if ((msg = fw_upload_busy(&mFwInfo)) != NULL) {
+        result = https_write_payload(stream,
+            msg, strlen(msg));
+        return HTTPS_REQUEST_HANDLE_ERROR;
+    }
+
+    cyhal_gpio_write(CYBSP_USER_LED, CYBSP_LED_STATE_ON);
+
+    if (fw_body_begin(&mFwInfo, https_message_body)) {
+        printf("POST: Raw %s, %lu bytes\n",
+            (part == FW_PART_MANIFEST) ? "manifest" : "data", (unsigned long)
+            (https_message_body->data_length + https_message_body->data_remaining));
+        if (part == FW_PART_MANIFEST) {
+            fw_upload_begin(&mFwInfo);
+            mFwInfo.part = FW_PART_MANIFEST;
+        }
+        else if (fw_data_resumable(&mFwInfo)) {
+            https_conn_bulk_begin();
+            rc = fw_data_resume(&mFwInfo, url_parameters);
+            if (rc == 0) {
+                mFwInfo.totalSz = mFwInfo.dataSz - mFwInfo.skipSz +
+                    https_message_body->data_length +
+                    https_message_body->data_remaining;
+            }
+        }
+        else if (mFwInfo.state == FW_STATE_FIRMWARE_DATA_START) {
+            https_conn_bulk_begin();
+            mFwInfo.part = FW_PART_DATA;
+            mFwInfo.totalSz = https_message_body->data_length +
+                https_message_body->data_remaining;
+            rc = fw_update_start(&mFwInfo);
+        }
+        else {
+            snprintf(mFwInfo.status, sizeof(mFwInfo.status),
+                "POST firmware data failed! Send the manifest first\r\n");
+            rc = FW_PART_ABORT;
+        }
+    }
+
+    /* body bytes go straight to the manifest or the chunk pipeline */
+    start = fw_stats_http_enter(&mFwInfo);
+    if (rc == 0) {
+        rc = fw_part_data(NULL, https_message_body->data,
+            https_message_body->data_length, &mFwInfo);
+    }
+    /* body is handed back to the server on return */
+    fw_data_sync(&mFwInfo);
+    fw_stats_http_exit(&mFwInfo, start);
+    mFwInfo.bodyRemaining = https_message_body->data_remaining;
+
+    if (rc == 0 && https_message_body->data_remaining == 0) {
+        if (part == FW_PART_MANIFEST) {
+            snprintf(mFwInfo.status, sizeof(mFwInfo.status),
+                "Manifest received: %d bytes\r\n", mFwInfo.manifestSz);
+        }
+        rc = fw_part_end(NULL, &mFwInfo);
+        if (part == FW_PART_DATA) {
+            https_tmpl_ctx_t t;
+            memset(&t, 0, sizeof(t));
+            t.fwInfo = &mFwInfo;
+            result = https_render(stream, &fw_raw_result_tmpl,
+                https_tmpl_var, &t);
+            mFwInfo.state = FW_STATE_INIT;
+        }
+        else {
+            result = https_write_payload(stream,
+                mFwInfo.status, strlen(mFwInfo.status));
+        }
+    }
+
+    if (rc == FW_PART_RETRY) {
+        /* keep the update waiting for a resumed upload */
+        puts(mFwInfo.status);
+        result = https_write_payload(stream,
+            mFwInfo.status, strlen(mFwInfo.status));
+        mFwInfo.bodyRemaining = 0;
+    }
+    else if (rc != 0) {
+        if (mFwInfo.state == FW_STATE_FIRMWARE_DATA_CHUNK) {
+            /* do not leave the update task waiting for data */
+            fw_update_finish(&mFwInfo);
+        }
+        puts(mFwInfo.status);
+        result = https_write_payload(stream,
+            mFwInfo.status, strlen(mFwInfo.status));
+        mFwInfo.state = FW_STATE_INIT;
+        mFwInfo.bodyRemaining = 0;
+    }
+
+    cyhal_gpio_write(CYBSP_USER_LED, CYBSP_LED_STATE_OFF);
+
+    return (rc == 0 && CY_RSLT_SUCCESS == result) ?
+        HTTPS_REQUEST_HANDLE_SUCCESS : HTTPS_REQUEST_HANDLE_ERROR;
+}
+
+#ifdef FW_STAGE
+/* staging upload being received */
+static uint32_t mStageSz;           /* of the body */
+static uint32_t mStageRemaining;    /* body bytes still to come */
+static int      mStageRc;           /* of the body, errors drop the rest */
+static uint8_t  mStageSha[FW_STAGE_HASH_SZ];
+static int      mStageShaSet;       /* sha256= given with the data */
+static char     mStageStatus[MAX_STATUS_LENGTH];
+
+static const char* fw_stage_error_str(int rc)
+{
+    switch (rc) {
+        case FW_STAGE_BAD_ARG:       return "stage the manifest first";
+        case FW_STAGE_FLASH_ERROR:   return "flash error";
+        case FW_STAGE_NOT_STAGED:    return "no image staged";
+        case FW_STAGE_HASH_MISMATCH: return "SHA-256 mismatch";
+        default:                     return "failed";
+    }
+}
+
+static char* fw_stage_hex(char* out, const uint8_t* sha256)
+{
+    static const char hex[] = "0123456789abcdef";
+    int i;
+
+    for (i = 0; i < FW_STAGE_HASH_SZ; i++) {
+        out[2 * i] = hex[sha256[i] >> 4];
+        out[2 * i + 1] = hex[sha256[i] & 0xF];
+    }
+    out[2 * FW_STAGE_HASH_SZ] = '\0';
+    return out;
+}
+
+/* sha256=<64 hex digits> query parameter: returns 1 if present, 0 if not
+ * and -1 if it is not a SHA-256 */
+static int fw_stage_query_sha(const char* url_parameters, uint8_t* sha256)
+{
+    char* value = NULL;
+    uint32_t valueSz = 0, i;
+    int nibble;
+
+    if (url_parameters == NULL ||
+        cy_http_server_get_query_parameter_value(url_parameters, "sha256",
+            &value, &valueSz) != CY_RSLT_SUCCESS) {
+        return 0;
+    }
+    if (valueSz != 2 * FW_STAGE_HASH_SZ)
+        return -1;
+    for (i = 0; i < valueSz; i++) {
+        char c = value[i];
+        if (c >= '0' && c <= '9')
+            nibble = c - '0';
+        else if (c >= 'a' && c <= 'f')
+            nibble = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F')
+            nibble = c - 'A' + 10;
+        else
+            return -1;
+        if ((i & 1) == 0)
+            sha256[i / 2] = (uint8_t)(nibble << 4);
+        else
+            sha256[i / 2] |= (uint8_t)nibble;
+    }
+    return 1;
+}
+
+/* Starts programming the TPMs from the staged image, in the background:
+ * the update tasks read the data from the flash as the TPMs ask for it */
+static const char* fw_stage_program(fw_info_t* fwInfo)
+{
+    const char* busy;
+    size_t manifestSz = 0, dataSz = 0;
+    int rc;
+
+    if (fwInfo->state != FW_STATE_INIT &&
+            fwInfo->state != FW_STATE_FIRMWARE_REST) {
+        return "Firmware update in progress\r\n";
+    }
+    if ((busy = fw_upload_busy(fwInfo)) != NULL) {
+        return busy;
+    }
+    /* the flash is read back in full, the image is only used if intact */
+    rc = fw_stage_verify();
+    if (rc == FW_STAGE_SUCCESS)
+        rc = fw_stage_info(&manifestSz, &dataSz, NULL);
+    if (rc != FW_STAGE_SUCCESS) {
+        snprintf(mStageStatus, sizeof(mStageStatus),
+            "Staged image not usable: %s\r\n", fw_stage_error_str(rc));
+        return mStageStatus;
+    }
+
+    fw_update_reset(fwInfo);
+    rc = fw_stage_read_manifest(fwInfo->manifest, sizeof(fwInfo->manifest),
+        &fwInfo->manifestSz);
+    if (rc != FW_STAGE_SUCCESS) {
+        snprintf(mStageStatus, sizeof(mStageStatus),
+            "Staged manifest not read: %s\r\n", fw_stage_error_str(rc));
+        return mStageStatus;
+    }
+    fwInfo->staged = 1;
+    fwInfo->dataSz = dataSz;
+    fwInfo->totalSz = dataSz;
+    cyhal_gpio_write(CYBSP_USER_LED2, CYBSP_LED_STATE_ON);
+    printf("Programming the staged firmware: manifest %lu, data %lu bytes\n",
+        (unsigned long)manifestSz, (unsigned long)dataSz);
+
+    /* set before the workers start, the last one to finish ends it */
+    fwInfo->state = FW_STATE_FIRMWARE_DATA_CHUNK;
+    fwInfo->dataTick = xTaskGetTickCount();
+    fw_stats_start(fwInfo);
+    fw_update_dispatch(fwInfo);
+
+    snprintf(mStageStatus, sizeof(mStageStatus),
+        "Programming %lu bytes from the staging area, see /api/fw/status\r\n",
+        (unsigned long)dataSz);
+    return mStageStatus;
+}
+
+/*******************************************************************************
+ * Function Name: fw_stage_resource_handler
+ *******************************************************************************
+ * Summary:
+ *  Handles the firmware staging area in the external QSPI flash (FW_STAGE).
+ *  The manifest and the firmware data are uploaded as raw bodies to
+ *  /fw/stage/manifest and /fw/stage/data, written to the flash as they are
+ *  received and verified there (SHA-256, and the sha256=<hex> query
+ *  parameter of the data if given). GET /fw/stage returns the staged image,
+ *  POST /fw/stage programs it into the TPMs, as often as needed, without
+ *  another upload.
+ *
+ *  curl --data-binary @fw.manifest https://<server>/fw/stage/manifest
+ *  curl --data-binary @fw.data https://<server>/fw/stage/data?sha256=<hex>
+ *  curl -X POST https://<server>/fw/stage
+ *
+ * Parameters:
+ *  url_path - Pointer to the HTTPS URL path.
+ *  url_parameters - Pointer to the HTTPS URL query string.
+ *  stream - Pointer to the HTTPS response stream.
+ *  arg - FW_PART_NONE (/fw/stage), FW_PART_MANIFEST or FW_PART_DATA.
+ *  https_message_body - Pointer to the HTTPS data from the client.
+ *
+ * Return:
+ *  int32_t - Returns HTTPS_REQUEST_HANDLE_SUCCESS if the request from the client
+ *  was handled successfully. Otherwise, it returns HTTPS_REQUEST_HANDLE_ERROR.
+ *
+ *******************************************************************************/
+int32_t fw_stage_resource_handler(const char* url_path,
+                                  const char* url_parameters,
+                                  cy_http_response_stream_t* stream,
+                                  void* arg,
+                                  cy_http_message_body_t* https_message_body)
+{
+    cy_rslt_t result;
+    FwPart part = (FwPart)(uintptr_t)arg;
+    const char* msg = NULL;
+    size_t manifestSz, dataSz;
+    uint8_t sha256[FW_STAGE_HASH_SZ];
+    char hex[2 * FW_STAGE_HASH_SZ + 1];
+    int rc;
+
+    (void)url_path;
+
+    if (part == FW_PART_NONE) {
+        if (https_message_body->request_type == CY_HTTP_REQUEST_GET) {
+            if (fw_stage_info(&manifestSz, &dataSz, sha256) ==
+                    FW_STAGE_SUCCESS) {
+                snprintf(mStageStatus, sizeof(mStageStatus),
+                    "staged=1 manifest=%lu data=%lu sha256=%s\r\n",
+                    (unsigned long)manifestSz, (unsigned long)dataSz,
+                    fw_stage_hex(hex, sha256));
+            }
+            else {
+                snprintf(mStageStatus, sizeof(mStageStatus), "staged=0\r\n");
+            }
+            msg = mStageStatus;
+        }
+        else if (https_message_body->data_remaining == 0) {
+            msg = fw_stage_program(&mFwInfo);
+        }
+        if (msg == NULL)
+            return HTTPS_REQUEST_HANDLE_SUCCESS; /* rest of the body */
+        result = https_write_payload(stream, msg, strlen(msg));
+        return (CY_RSLT_SUCCESS == result) ?
+            HTTPS_REQUEST_HANDLE_SUCCESS : HTTPS_REQUEST_HANDLE_ERROR;
+    }
+
+    if (https_message_body->request_type != CY_HTTP_REQUEST_POST &&
+        https_message_body->request_type != CY_HTTP_REQUEST_PUT) {
+        msg = "Use POST or PUT with the raw file as body\r\n";
+        result = https_write_payload(stream, msg, strlen(msg));
+        return HTTPS_REQUEST_HANDLE_ERROR;
+    }
+
+    if (mStageRemaining == 0 || mStageRemaining !=
+            https_message_body->data_length + https_message_body->data_remaining) {
+        /* new body */
+        mStageSz = https_message_body->data_length +
+            https_message_body->data_remaining;
+        mStageRc = FW_STAGE_SUCCESS;
+        mStageShaSet = 0;
+        if (fw_stage_running(&mFwInfo)) {
+            msg = FW_STAGE_BUSY_MSG;
+            mStageRc = FW_STAGE_BAD_ARG;
+        }
+        else if (part == FW_PART_MANIFEST &&
+                mStageSz > MAX_FIRMWARE_MANIFEST_SZ) {
+            msg = "Manifest too large\r\n";
+            mStageRc = FW_STAGE_BAD_ARG;
+        }
+        else if (part == FW_PART_DATA &&
+                (mStageShaSet = fw_stage_query_sha(url_parameters,
+                    mStageSha)) < 0) {
+            msg = "sha256 must be 64 hex digits\r\n";
+            mStageRc = FW_STAGE_BAD_ARG;
+        }
+        else {
+            printf("POST: Staging %s, %lu bytes\n",
+                (part == FW_PART_MANIFEST) ? "manifest" : "data",
+                (unsigned long)mStageSz);
+            if (part == FW_PART_DATA)
+                https_conn_bulk_begin();
+            mStageRc = fw_stage_begin((part == FW_PART_MANIFEST) ?
+                FW_STAGE_MANIFEST : FW_STAGE_DATA, mStageSz);
+        }
+    }
+    else if (mStageRc != FW_STAGE_SUCCESS) {
+        /* the rest of a failed body */
+        mStageRemaining = https_message_body->data_remaining;
+        return HTTPS_REQUEST_HANDLE_ERROR;
+    }
+
+    cyhal_gpio_write(CYBSP_USER_LED, CYBSP_LED_STATE_ON);
+    rc = mStageRc;
+    if (rc == FW_STAGE_SUCCESS && https_message_body->data_length > 0) {
+        rc = fw_stage_write(https_message_body->data,
+            https_message_body->data_length);
+    }
+    mStageRemaining = https_message_body->data_remaining;
+    if (rc == FW_STAGE_SUCCESS && mStageRemaining == 0) {
+        rc = fw_stage_end(mStageShaSet ? mStageSha : NULL);
+        if (rc == FW_STAGE_SUCCESS && part == FW_PART_MANIFEST) {
+            snprintf(mStageStatus, sizeof(mStageStatus),
+                "Manifest staged: %lu bytes\r\n", (unsigned long)mStageSz);
+            msg = mStageStatus;
+        }
+        else if (rc == FW_STAGE_SUCCESS &&
+                fw_stage_info(&manifestSz, &dataSz, sha256) ==
+                    FW_STAGE_SUCCESS) {
+            snprintf(mStageStatus, sizeof(mStageStatus),
+                "Firmware staged and verified: manifest %lu, data %lu bytes, "
+                "sha256=%s\r\n", (unsigned long)manifestSz,
+                (unsigned long)dataSz, fw_stage_hex(hex, sha256));
+            msg = mStageStatus;
+        }
+    }
+    if (rc != FW_STAGE_SUCCESS && msg == NULL) {
+        snprintf(mStageStatus, sizeof(mStageStatus), "Staging failed: %s\r\n",
+            fw_stage_error_str(rc));
+        msg = mStageStatus;
+    }
+    mStageRc = rc;
+
+    result = CY_RSLT_SUCCESS;
+    if (msg != NULL) {
+        puts(msg);
+        result = https_write_payload(stream, msg, strlen(msg));
+    }
+    cyhal_gpio_write(CYBSP_USER_LED, CYBSP_LED_STATE_OFF);
+
+    return (rc == FW_STAGE_SUCCESS && CY_RSLT_SUCCESS == result) ?
+        HTTPS_REQUEST_HANDLE_SUCCESS : HTTPS_REQUEST_HANDLE_ERROR;
+}
+#endif
+
+#ifdef FW_UPDATE_STATS
+/*******************************************************************************
+ * Function Name: fw_stats_resource_handler
+ *******************************************************************************
+ * Summary:
+ *  Handles HTTPS GET requests for /stats/fwupdate with the timing statistics
+ *  of the last (or running) firmware data upload.
+ *
+ * Parameters:
+ *  url_path - Pointer to the HTTPS URL path.
+ *  url_parameters - Pointer to the HTTPS URL query string.
+ *  stream - Pointer to the HTTPS response stream.
+ *  arg - Unused.
+ *  https_message_body - Pointer to the HTTPS data from the client.
+ *
+ * Return:
+ *  int32_t - Returns HTTPS_REQUEST_HANDLE_SUCCESS if the request from the client
+ *  was handled successfully. Otherwise, it returns HTTPS_REQUEST_HANDLE_ERROR.
+ *
+ *******************************************************************************/
+int32_t fw_stats_resource_handler(const char* url_path,
+                                  const char* url_parameters,
+                                  cy_http_response_stream_t* stream,
+                                  void* arg,
+                                  cy_http_message_body_t* https_message_body)
+{
+    cy_rslt_t result;
+    const char* msg = fw_stats_report(&mFwInfo);
+
+    (void)url_path;
+    (void)url_parameters;
+    (void)arg;
+    (void)https_message_body;
+
+    result = https_write_payload(stream,
+        msg, strlen(msg));
+    return (CY_RSLT_SUCCESS == result) ?
+        HTTPS_REQUEST_HANDLE_SUCCESS : HTTPS_REQUEST_HANDLE_ERROR;
+}
+#endif
+
+#ifdef TLS_CRYPTO_CB
+/*******************************************************************************
+ * Function Name: tls_stats_resource_handler
+ *******************************************************************************
+ * Summary:
+ *  Handles HTTPS GET requests for /stats/tls with the number of full and
+ *  resumed TLS handshakes since boot and the server key signing latency.
+ *  The query parameter policy=sw|tpm|fallback selects the signing policy
+ *  for the next handshakes.
+ *
+ * Parameters:
+ *  url_path - Pointer to the HTTPS URL path.
+ *  url_parameters - Pointer to the HTTPS URL query string.
+ *  stream - Pointer to the HTTPS response stream.
+ *  arg - Unused.
+ *  https_message_body - Pointer to the HTTPS data from the client.
+ *
+ * Return:
+ *  int32_t - Returns HTTPS_REQUEST_HANDLE_SUCCESS if the request from the client
+ *  was handled successfully. Otherwise, it returns HTTPS_REQUEST_HANDLE_ERROR.
+ *
+ *******************************************************************************/
+int32_t tls_stats_resource_handler(const char* url_path,
+                                   const char* url_parameters,
+                                   cy_http_response_stream_t* stream,
+                                   void* arg,
+                                   cy_http_message_body_t* https_message_body)
+{
+    cy_rslt_t result;
+    char msg[MAX_STATUS_LENGTH + 128];
+    char* value = NULL;
+    uint32_t valueSz = 0;
+    int policy = -1;
+
+    (void)url_path;
+    (void)arg;
+    (void)https_message_body;
+
+    if (url_parameters != NULL &&
+            cy_http_server_get_query_parameter_value(url_parameters,
+                "policy", &value, &valueSz) == CY_RSLT_SUCCESS) {
+        if (valueSz == 2 && strncmp(value, "sw", 2) == 0)
+            policy = TLS_KEY_POLICY_SW;
+        else if (valueSz == 3 && strncmp(value, "tpm", 3) == 0)
+            policy = TLS_KEY_POLICY_TPM;
+        else if (valueSz == 8 && strncmp(value, "fallback", 8) == 0)
+            policy = TLS_KEY_POLICY_TPM_FALLBACK;
+        if (policy < 0 || tls_crypto_set_policy(policy) != 0) {
+            snprintf(msg, sizeof(msg), "Key policy not available\r\n");
+            result = https_write_payload(stream,
+                msg, strlen(msg));
+            return (CY_RSLT_SUCCESS == result) ?
+                HTTPS_REQUEST_HANDLE_SUCCESS : HTTPS_REQUEST_HANDLE_ERROR;
+        }
+    }
+
+    tls_crypto_report(msg, sizeof(msg));
+    result = https_write_payload(stream,
+        msg, strlen(msg));
+    return (CY_RSLT_SUCCESS == result) ?
+        HTTPS_REQUEST_HANDLE_SUCCESS : HTTPS_REQUEST_HANDLE_ERROR;
+}
+#endif
+
+#ifdef TLS_HEAP_POOL
+/*******************************************************************************
+ * Function Name: tls_heap_resource_handler
+ *******************************************************************************
+ * Summary:
+ *  Handles HTTPS GET requests for /stats/tls/heap with the use of the wolfSSL
+ *  memory pool: blocks in use and peak per bucket, the allocations that fell
+ *  back to the heap and the peak allocations per request size.
+ *
+ * Parameters:
+ *  url_path - Pointer to the HTTPS URL path.
+ *  url_parameters - Pointer to the HTTPS URL query string.
+ *  stream - Pointer to the HTTPS response stream.
+ *  arg - Unused.
+ *  https_message_body - Pointer to the HTTPS data from the client.
+ *
+ * Return:
+ *  int32_t - Returns HTTPS_REQUEST_HANDLE_SUCCESS if the request from the client
+ *  was handled successfully. Otherwise, it returns HTTPS_REQUEST_HANDLE_ERROR.
+ *
+ *******************************************************************************/
+int32_t tls_heap_resource_handler(const char* url_path,
+                                  const char* url_parameters,
+                                  cy_http_response_stream_t* stream,
+                                  void* arg,
+                                  cy_http_message_body_t* https_message_body)
+{
+    cy_rslt_t result;
+    char msg[MAX_HTTP_RESPONSE_LENGTH];
+
+    (void)url_path;
+    (void)url_parameters;
+    (void)arg;
+    (void)https_message_body;
+
+    tls_heap_report(msg, sizeof(msg));
+    result = https_write_payload(stream, msg, strlen(msg));
+    return (CY_RSLT_SUCCESS == result) ?
+        HTTPS_REQUEST_HANDLE_SUCCESS : HTTPS_REQUEST_HANDLE_ERROR;
+}
+#endif
+
+#ifdef TPM_WAIT_RTOS
+/*******************************************************************************
+ * Function Name: tpm_stats_resource_handler
+ *******************************************************************************
+ * Summary:
+ *  Handles HTTPS GET requests for /stats/tpm with the TPM waits by kind
+ *  (spin before the scheduler, timer, tick, interrupt) and the waits and
+ *  latency of each TPM command.
+ *
+ * Parameters:
+ *  url_path - Pointer to the HTTPS URL path.
+ *  url_parameters - Pointer to the HTTPS URL query string.
+ *  stream - Pointer to the HTTPS response stream.
+ *  arg - Unused.
+ *  https_message_body - Pointer to the HTTPS data from the client.
+ *
+ * Return:
+ *  int32_t - Returns HTTPS_REQUEST_HANDLE_SUCCESS if the request from the client
+ *  was handled successfully. Otherwise, it returns HTTPS_REQUEST_HANDLE_ERROR.
+ *
+ *******************************************************************************/
+int32_t tpm_stats_resource_handler(const char* url_path,
+                                   const char* url_parameters,
+                                   cy_http_response_stream_t* stream,
+                                   void* arg,
+                                   cy_http_message_body_t* https_message_body)
+{
+    cy_rslt_t result;
+    char msg[MAX_HTTP_RESPONSE_LENGTH];
+
+    (void)url_path;
+    (void)url_parameters;
+    (void)arg;
+    (void)https_message_body;
+
+    tpm_wait_report(msg, sizeof(msg));
+    result = https_write_payload(stream, msg, strlen(msg));
+    return (CY_RSLT_SUCCESS == result) ?
+        HTTPS_REQUEST_HANDLE_SUCCESS : HTTPS_REQUEST_HANDLE_ERROR;
+}
+#endif
+
+/*******************************************************************************
+ * Function Name: boot_stats_resource_handler
+ *******************************************************************************
+ * Summary:
+ *  Handles HTTPS GET requests for /stats/boot with the timestamps of the boot
+ *  phases, in milliseconds since reset.
+ *
+ * Parameters:
+ *  url_path - Pointer to the HTTPS URL path.
+ *  url_parameters - Pointer to the HTTPS URL query string.
+ *  stream - Pointer to the HTTPS response stream.
+ *  arg - Unused.
+ *  https_message_body - Pointer to the HTTPS data from the client.
+ *
+ * Return:
+ *  int32_t - Returns HTTPS_REQUEST_HANDLE_SUCCESS if the request from the client
+ *  was handled successfully. Otherwise, it returns HTTPS_REQUEST_HANDLE_ERROR.
+ *
+ *******************************************************************************/
+int32_t boot_stats_resource_handler(const char* url_path,
+                                    const char* url_parameters,
+                                    cy_http_response_stream_t* stream,
+                                    void* arg,
+                                    cy_http_message_body_t* https_message_body)
+{
+    cy_rslt_t result;
+    char msg[MAX_HTTP_RESPONSE_LENGTH];
+
+    (void)url_path;
+    (void)url_parameters;
+    (void)arg;
+    (void)https_message_body;
+
+    boot_report(msg, sizeof(msg));
+    result = https_write_payload(stream, msg, strlen(msg));
+    return (CY_RSLT_SUCCESS == result) ?
+        HTTPS_REQUEST_HANDLE_SUCCESS : HTTPS_REQUEST_HANDLE_ERROR;
+}
+
+#ifdef MEM_STATS
+/*******************************************************************************
+ * Function Name: mem_stats_resource_handler
+ *******************************************************************************
+ * Summary:
+ *  Handles HTTPS GET requests for /stats/mem with the heap use, the minimum
+ *  free stack of each task and, with LWIP_STATS, the lwIP counters.
+ *
+ * Parameters:
+ *  url_path - Pointer to the HTTPS URL path.
+ *  url_parameters - Pointer to the HTTPS URL query string.
+ *  stream - Pointer to the HTTPS response stream.
+ *  arg - Unused.
+ *  https_message_body - Pointer to the HTTPS data from the client.
+ *
+ * Return:
+ *  int32_t - Returns HTTPS_REQUEST_HANDLE_SUCCESS if the request from the client
+ *  was handled successfully. Otherwise, it returns HTTPS_REQUEST_HANDLE_ERROR.
+ *
+ *******************************************************************************/
+int32_t mem_stats_resource_handler(const char* url_path,
+                                   const char* url_parameters,
+                                   cy_http_response_stream_t* stream,
+                                   void* arg,
+                                   cy_http_message_body_t* https_message_body)
+{
+    cy_rslt_t result;
+    char msg[MAX_HTTP_RESPONSE_LENGTH];
+
+    (void)url_path;
+    (void)url_parameters;
+    (void)arg;
+    (void)https_message_body;
+
+    mem_stats_report(msg, sizeof(msg));
+    result = https_write_payload(stream, msg, strlen(msg));
+    return (CY_RSLT_SUCCESS == result) ?
+        HTTPS_REQUEST_HANDLE_SUCCESS : HTTPS_REQUEST_HANDLE_ERROR;
+}
+#endif
+
+#ifdef HTTP_LATENCY_STATS
+static char* https_latency_report_hist(char* out, size_t outSz,
+    const char* name, const perf_hist_t* hist)
+{
+    snprintf(out, outSz,
+        "  %-10s p50 %lu us, p90 %lu us, p99 %lu us, max %lu us\r\n", name,
+        (unsigned long)perf_hist_percentile(hist, 50),
+        (unsigned long)perf_hist_percentile(hist, 90),
+        (unsigned long)perf_hist_percentile(hist, 99),
+        (unsigned long)hist->max);
+    return out + strlen(out);
+}
+
+/*******************************************************************************
+ * Function Name: http_stats_resource_handler
+ *******************************************************************************
+ * Summary:
+ *  Handles HTTPS GET requests for /stats/http with the request latency
+ *  histograms of the /tpm page and of the resources created with HTTPS PUT.
+ *  "reset" in the query string clears them after the report.
+ *
+ * Parameters:
+ *  url_path - Pointer to the HTTPS URL path.
+ *  url_parameters - Pointer to the HTTPS URL query string.
+ *  stream - Pointer to the HTTPS response stream.
+ *  arg - Unused.
+ *  https_message_body - Pointer to the HTTPS data from the client.
+ *
+ * Return:
+ *  int32_t - Returns HTTPS_REQUEST_HANDLE_SUCCESS if the request from the client
+ *  was handled successfully. Otherwise, it returns HTTPS_REQUEST_HANDLE_ERROR.
+ *
+ *******************************************************************************/
+int32_t http_stats_resource_handler(const char* url_path,
+                                    const char* url_parameters,
+                                    cy_http_response_stream_t* stream,
+                                    void* arg,
+                                    cy_http_message_body_t* https_message_body)
+{
+    cy_rslt_t result;
+    char msg[MAX_HTTP_RESPONSE_LENGTH];
+    char* p = msg;
+    char* value = NULL;
+    uint32_t valueSz = 0;
+    int i;
+
+    (void)url_path;
+    (void)arg;
+    (void)https_message_body;
+
+    msg[0] = '\0';
+    xSemaphoreTake(https_conns_lock, portMAX_DELAY);
+    for (i = 0; i < HTTPS_LATENCY_COUNT; i++) {
+        const https_latency_t* lat = &https_latency[i];
+        snprintf(p, sizeof(msg) - (p - msg), "%s: %lu requests\r\n",
+            lat->name, (unsigned long)lat->total.count);
+        p += strlen(p);
+        p = https_latency_report_hist(p, sizeof(msg) - (p - msg),
+            "first byte", &lat->first_byte);
+        p = https_latency_report_hist(p, sizeof(msg) - (p - msg),
+            "total", &lat->total);
+    }
+    if (url_parameters != NULL &&
+            cy_http_server_get_query_parameter_value(url_parameters, "reset",
+                &value, &valueSz) == CY_RSLT_SUCCESS) {
+        for (i = 0; i < HTTPS_LATENCY_COUNT; i++) {
+            memset(&https_latency[i].first_byte, 0,
+                sizeof(https_latency[i].first_byte));
+            memset(&https_latency[i].total, 0, sizeof(https_latency[i].total));
+        }
+    }
+    xSemaphoreGive(https_conns_lock);
+
+    result = https_write_payload(stream, msg, strlen(msg));
+    return (CY_RSLT_SUCCESS == result) ?
+        HTTPS_REQUEST_HANDLE_SUCCESS : HTTPS_REQUEST_HANDLE_ERROR;
+}
+#endif
+
+#ifdef CPU_STATS
+/*******************************************************************************
+ * Function Name: cpu_stats_resource_handler
+ *******************************************************************************
+ * Summary:
+ *  Handles HTTPS GET requests for /stats/cpu with the CPU use and context
+ *  switches of each task since the previous request, and the time spent in
+ *  the timed handlers.
+ *
+ * Parameters:
+ *  url_path - Pointer to the HTTPS URL path.
+ *  url_parameters - Pointer to the HTTPS URL query string.
+ *  stream - Pointer to the HTTPS response stream.
+ *  arg - Unused.
+ *  https_message_body - Pointer to the HTTPS data from the client.
+ *
+ * Return:
+ *  int32_t - Returns HTTPS_REQUEST_HANDLE_SUCCESS if the request from the client
+ *  was handled successfully. Otherwise, it returns HTTPS_REQUEST_HANDLE_ERROR.
+ *
+ *******************************************************************************/
+int32_t cpu_stats_resource_handler(const char* url_path,
+                                   const char* url_parameters,
+                                   cy_http_response_stream_t* stream,
+                                   void* arg,
+                                   cy_http_message_body_t* https_message_body)
+{
+    cy_rslt_t result;
+    char msg[MAX_HTTP_RESPONSE_LENGTH];
+
+    (void)url_path;
+    (void)url_parameters;
+    (void)arg;
+    (void)https_message_body;
+
+    cpu_stats_report(msg, sizeof(msg));
+    result = https_write_payload(stream, msg, strlen(msg));
+    return (CY_RSLT_SUCCESS == result) ?
+        HTTPS_REQUEST_HANDLE_SUCCESS : HTTPS_REQUEST_HANDLE_ERROR;
+}
+#endif
+
+#ifdef BENCH
+/*******************************************************************************
+ * Function Name: bench_resource_handler
+ *******************************************************************************
+ * Summary:
+ *  Handles HTTPS GET requests for /bench with the results of the last
+ *  benchmark run as JSON. "run" in the query string starts a new run on the
+ *  benchmark task, with the TPM commands unless a firmware update is using
+ *  the TPM.
+ *
+ * Parameters:
+ *  url_path - Pointer to the HTTPS URL path.
+ *  url_parameters - Pointer to the HTTPS URL query string.
+ *  stream - Pointer to the HTTPS response stream.
+ *  arg - Unused.
+ *  https_message_body - Pointer to the HTTPS data from the client.
+ *
+ * Return:
+ *  int32_t - Returns HTTPS_REQUEST_HANDLE_SUCCESS if the request from the client
+ *  was handled successfully. Otherwise, it returns HTTPS_REQUEST_HANDLE_ERROR.
+ *
+ *******************************************************************************/
+int32_t bench_resource_handler(const char* url_path,
+                               const char* url_parameters,
+                               cy_http_response_stream_t* stream,
+                               void* arg,
+                               cy_http_message_body_t* https_message_body)
+{
+    cy_rslt_t result;
+    char msg[MAX_HTTP_RESPONSE_LENGTH];
+    char* value = NULL;
+    uint32_t valueSz = 0;
+
+    (void)url_path;
+    (void)arg;
+    (void)https_message_body;
+
+    if (url_parameters != NULL &&
+            cy_http_server_get_query_parameter_value(url_parameters, "run",
+                &value, &valueSz) == CY_RSLT_SUCCESS) {
+        (void)bench_start(fw_update_idle(&mFwInfo));
+    }
+    bench_report(msg, sizeof(msg));
+    result = https_write_payload(stream, msg, strlen(msg));
+    return (CY_RSLT_SUCCESS == result) ?
+        HTTPS_REQUEST_HANDLE_SUCCESS : HTTPS_REQUEST_HANDLE_ERROR;
+}
+#endif
+
+#ifdef WIFI_POWER
+/* Unsigned query parameter: returns 1 if present, 0 if not and -1 if it is
+ * not a number */
+static int power_query_value(const char* url_parameters, const char* name,
+    uint32_t* out)
+{
+    char* value = NULL;
+    uint32_t valueSz = 0, i, v = 0;
+
+    if (url_parameters == NULL ||
+            cy_http_server_get_query_parameter_value(url_parameters, name,
+                &value, &valueSz) != CY_RSLT_SUCCESS) {
+        return 0;
+    }
+    if (valueSz == 0 || valueSz > 9) {
+        return -1;
+    }
+    for (i = 0; i < valueSz; i++) {
+        if (value[i] < '0' || value[i] > '9')
+            return -1;
+        v = (v * 10) + (value[i] - '0');
+    }
+    *out = v;
+    return 1;
+}
+
+/*******************************************************************************
+ * Function Name: power_resource_handler
+ *******************************************************************************
+ * Summary:
+ *  Handles HTTPS GET requests for /stats/power with the Wi-Fi power-save
+ *  policy, the time in each mode and the wake latency. The query string
+ *  parameters "idle" (seconds), "listen" (DTIM periods), "pm2" (ms) and
+ *  "deepsleep" (0 or 1) change the policy.
+ *
+ * Parameters:
+ *  url_path - Pointer to the HTTPS URL path.
+ *  url_parameters - Pointer to the HTTPS URL query string.
+ *  stream - Pointer to the HTTPS response stream.
+ *  arg - Unused.
+ *  https_message_body - Pointer to the HTTPS data from the client.
+ *
+ * Return:
+ *  int32_t - Returns HTTPS_REQUEST_HANDLE_SUCCESS if the request from the client
+ *  was handled successfully. Otherwise, it returns HTTPS_REQUEST_HANDLE_ERROR.
+ *
+ *******************************************************************************/
+int32_t power_resource_handler(const char* url_path,
+                               const char* url_parameters,
+                               cy_http_response_stream_t* stream,
+                               void* arg,
+                               cy_http_message_body_t* https_message_body)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    char msg[MAX_HTTP_RESPONSE_LENGTH];
+    wifi_power_policy_t policy;
+    uint32_t v;
+    int rc, set = 0;
+
+    (void)url_path;
+    (void)arg;
+    (void)https_message_body;
 
-    /* start the update process */
-    if (recovery) {
-        printf("Firmware Update (recovery mode):\n");
-        rc = wolfTPM2_FirmwareUpgradeRecover(&mDev,
-            fwInfo->manifest, fwInfo->manifestSz,
-            TPM2_IFX_FwData_Cb, fwInfo);
+    wifi_power_get_policy(&policy);
+    if ((rc = power_query_value(url_parameters, "idle", &v)) > 0) {
+        policy.idle_s = v;
     }
-    else {
-        printf("Firmware Update (normal mode):\n");
-        rc = wolfTPM2_FirmwareUpgrade(&mDev,
-            fwInfo->manifest, fwInfo->manifestSz,
-            TPM2_IFX_FwData_Cb, fwInfo);
+    set |= rc;
+    if ((rc = power_query_value(url_parameters, "listen", &v)) > 0) {
+        policy.listen_interval = (v > 255) ? 0 : (uint8_t)v;
     }
-    if (rc != 0) {
-        printf("Infineon firmware update failed 0x%x: %s\n",
-            rc, TPM2_GetRCString(rc));
-        /* task failed */
-        fwInfo->threadState = FW_STATE_THREAD_FAILED;
-        fwInfo->threadRc = rc;
+    set |= rc;
+    if ((rc = power_query_value(url_parameters, "pm2", &v)) > 0) {
+        policy.pm2_sleep_ms = (v > 0xffff) ? 0 : (uint16_t)v;
     }
-    else {
-        printf("Infineon firmware update success!\n");
-        fwInfo->threadState = FW_STATE_THREAD_DONE;
-        fwInfo->threadRc = rc;
+    set |= rc;
+    if ((rc = power_query_value(url_parameters, "deepsleep", &v)) > 0) {
+        policy.deepsleep = (v != 0);
     }
-
-    vTaskDelete(NULL); /* done with task */
-    fw_update_task_handle = NULL;
-}
-
-static char* parse_http_multipart_post(const char* header, char* boundary, char* fieldName, char* fileName)
-{
-    char* found = NULL, *start, *end = NULL;
-    size_t sz;
-    const char* boundaryStr = "------WebKitFormBoundary";
-    const char* contentDisp = "Content-Disposition: form-data;";
-    const char* nameStr = "name=\"";
-    const char* filenameStr = "filename=\"";
-    /* Content-Type: application/octet-stream */
-    /* Content-Type: application/x-ms-manifest */
-    const char* streamStr = "\r\n\r\n";
-
-    /* get boundary */
-    start = strstr(header, boundaryStr);
-    if (start != NULL) {
-        end = strstr(start, "\r\n");
-        if (end != NULL) {
-            sz = end-start;
-            if (sz > 64-1)
-                sz = 64-1;
-            memcpy(boundary, start, sz);
-            boundary[sz] = '\0'; /* null term */
-        }
+    set |= rc;
+    /* -1 in set for a parameter that is not a number */
+    if (set < 0 || (set && wifi_power_set_policy(&policy) != CY_RSLT_SUCCESS)) {
+        snprintf(msg, sizeof(msg), "Invalid policy: listen 1 to 255, pm2 "
+            "10 to 2000 ms, deepsleep needs WIFI_POWER_DEEPSLEEP\r\n");
+        result = https_write_payload(stream, msg, strlen(msg));
+        return HTTPS_REQUEST_HANDLE_ERROR;
     }
+    wifi_power_report(msg, sizeof(msg));
+    result = https_write_payload(stream, msg, strlen(msg));
+    return (CY_RSLT_SUCCESS == result) ?
+        HTTPS_REQUEST_HANDLE_SUCCESS : HTTPS_REQUEST_HANDLE_ERROR;
+}
+#endif
 
-    if (end != NULL) {
-        /* find Content-Disposition */
-        start = strstr(end, contentDisp);
-        if (start != NULL) {
-            start += strlen(contentDisp);
-            /* find name=" " */
-            start = strstr(start, nameStr);
-            if (start != NULL) {
-                start += strlen(nameStr);
-                end = strstr(start, "\"");
-                if (end != NULL) {
-                    sz = end-start;
-                    if (sz > 64-1)
-                        sz = 64-1;
-                    memcpy(fieldName, start, sz);
-                    fieldName[sz] = '\0'; /* null term */
-                }
-            }
-        }
-    }
+/* JSON status API resources, see api_resource_handler */
+#define API_TPM         (0)
+#define API_FW_STATUS   (1)
+#define API_FW_PROGRESS (2)
 
-    if (end != NULL) {
-        /* find filename */
-        start = strstr(end, filenameStr);
-        if (start != NULL) {
-            start += strlen(filenameStr);
-            end = strstr(start, "\"");
-            if (end != NULL) {
-                sz = end-start;
-                if (sz > 64-1)
-                    sz = 64-1;
-                memcpy(fileName, start, sz);
-                fileName[sz] = '\0'; /* null term */
-            }
-        }
+/* Rate of the firmware data to the TPM and the time left, from the
+ * counters of the update task (no TPM command) */
+static void fw_progress(const fw_info_t* fwInfo, uint32_t* bps, int32_t* etaS)
+{
+    uint32_t ms = (uint32_t)(xTaskGetTickCount() - fwInfo->dataTick) *
+        portTICK_PERIOD_MS;
+    size_t written = fwInfo->firmwareSz;
+
+    *bps = 0;
+    *etaS = -1;
+    if (fwInfo->state != FW_STATE_FIRMWARE_DATA_CHUNK || ms == 0 ||
+            written == 0) {
+        return;
     }
-
-    if (end != NULL) {
-        /* locate start of data stream and return pointer to it */
-        found = strstr(end, streamStr);
-        if (found != NULL) {
-            found += strlen(streamStr);
-        }
+    *bps = (uint32_t)((uint64_t)written * 1000 / ms);
+    if (*bps > 0 && fwInfo->totalSz > written) {
+        *etaS = (int32_t)((fwInfo->totalSz - written + *bps - 1) / *bps);
     }
-    return found;
 }
 
 /*******************************************************************************
- * Function Name: dynamic_resource_handler
+ * Function Name: api_resource_handler
  *******************************************************************************
  * Summary:
- *  Handles HTTPS GET, POST, and PUT requests from the client.
- *  HTTPS GET sends the current CYBSP_USER_LED status as a response to the client.
- *  HTTPS POST toggles the CYBSP_USER_LED and then sends its current state as a
- *  response to the client.
- *  HTTPS PUT sends an error message as a response to the client if the resource
- *  registration is unsuccessful.
+ *  Handles HTTPS GET requests for the JSON status API used for machine
+ *  polling instead of the web page:
+ *  /api/tpm returns the cached TPM capabilities (read again after a firmware
+ *  update or a "Refresh TPM" request).
+ *  /api/fw/status returns the state and progress of the running or last
+ *  firmware update.
+ *  /fw/progress returns the same progress with the rate to the TPM and the
+ *  time left as one Server-Sent Event, with the time for the browser to
+ *  reconnect, so an EventSource on the page follows the update.
  *
  * Parameters:
  *  url_path - Pointer to the HTTPS URL path.
  *  url_parameters - Pointer to the HTTPS URL query string.
  *  stream - Pointer to the HTTPS response stream.
- *  arg - Pointer to the argument passed during HTTPS resource registration.
+ *  arg - API_TPM, API_FW_STATUS or API_FW_PROGRESS.
  *  https_message_body - Pointer to the HTTPS data from the client.
  *
  * Return:
@@ -447,346 +3137,42 @@ static char* parse_http_multipart_post(const char* header, char* boundary, char*
  *  was handled successfully. Otherwise, it returns HTTPS_REQUEST_HANDLE_ERROR.
  *
  *******************************************************************************/
-int32_t dynamic_resource_handler(const char* url_path,
-                                 const char* url_parameters,
-                                 cy_http_response_stream_t* stream,
-                                 void* arg,
-                                 cy_http_message_body_t* https_message_body)
+int32_t api_resource_handler(const char* url_path,
+                             const char* url_parameters,
+                             cy_http_response_stream_t* stream,
+                             void* arg,
+                             cy_http_message_body_t* https_message_body)
 {
-    cy_rslt_t result = CY_RSLT_SUCCESS;
-    int32_t status = HTTPS_REQUEST_HANDLE_SUCCESS;
-    char err_buf[MAX_STATUS_LENGTH];
-    const char* msg;
-    size_t offset = 0;
-
-    err_buf[0] = '\0'; /* empty string */
-    cyhal_gpio_write(CYBSP_USER_LED, CYBSP_LED_STATE_ON);
-
-    switch (https_message_body->request_type)
-    {
-        case CY_HTTP_REQUEST_GET:
-            APP_INFO(("Received HTTPS GET request.\n"));
-
-            /* Send the HTTPS response. */
-            msg = HTTPS_STARTUP_HEADER;
-            result = cy_http_server_response_stream_write_payload(stream,
-                msg, strlen(msg));
-            if (CY_RSLT_SUCCESS == result) {
-                msg = TPM2_IFX_GetInfo(NULL);
-                result = cy_http_server_response_stream_write_payload(stream,
-                    msg, strlen(msg));
-            }
-            if (CY_RSLT_SUCCESS == result) {
-                msg = HTTPS_STARTUP_FOOTER;
-                result = cy_http_server_response_stream_write_payload(stream,
-                    msg, strlen(msg));
-            }
-            if (CY_RSLT_SUCCESS != result) {
-                ERR_INFO(("Failed to send the HTTPS GET response.\n"));
-            }
-            break;
-
-        case CY_HTTP_REQUEST_POST:
-            APP_INFO(("Received HTTPS POST request.\n"));
-
-        #if 0
-            printf("https_message_body->data_length %d, remain %lu\r\n",
-                https_message_body->data_length,
-                https_message_body->data_remaining
-            );
-            #if 0
-            if (mFwInfo.state == FW_STATE_INIT && https_message_body->data_length > 0) {
-                int i;
-                printf("HTTP Data:\r\n");
-                for (i=0; i<https_message_body->data_length; i++) {
-                    printf("%02x ", https_message_body->data[i]);
-                }
-                printf("\r\n");
-            }
-            #endif
-        #endif
-
-            /* State Machine */
-            switch (mFwInfo.state) {
-                case FW_STATE_INIT:
-                    cyhal_gpio_write(CYBSP_USER_LED2, CYBSP_LED_STATE_ON);
-
-                    /* parser manifest file */
-                    memset(&mFwInfo, 0, sizeof(mFwInfo));
-                    msg = parse_http_multipart_post((char*)https_message_body->data,
-                        mFwInfo.boundary, mFwInfo.fieldName, mFwInfo.fileName);
-                    if (msg != NULL) {
-                        printf("POST: Field: %s, File %s, Boundary %s\n",
-                            mFwInfo.fieldName, mFwInfo.fileName, mFwInfo.boundary);
-                        if (strcmp(mFwInfo.fieldName, "manifest") == 0) {
-                            offset = msg - (char*)https_message_body->data;
-                            if (offset > https_message_body->data_length)
-                                offset = https_message_body->data_length;
-                            mFwInfo.manifestSz = https_message_body->data_length - offset;
-                            if (mFwInfo.manifestSz > sizeof(mFwInfo.manifest))
-                                mFwInfo.manifestSz = sizeof(mFwInfo.manifest);
-                            memcpy(mFwInfo.manifest, msg, mFwInfo.manifestSz);
-                            mFwInfo.state = FW_STATE_MANIFEST_START;
-                            break;
-                        }
-                    }
-
-                    snprintf(err_buf, sizeof(err_buf),
-                        "POST manifest failed! Field: %s, File %s, Boundary %s\r\n",
-                        mFwInfo.fieldName, mFwInfo.fileName, mFwInfo.boundary);
-                    puts(err_buf);
-                    result = cy_http_server_response_stream_write_payload(stream, err_buf, strlen(err_buf));
-                    mFwInfo.state = FW_STATE_INIT;
-                    return HTTPS_REQUEST_HANDLE_ERROR;
-
-                case FW_STATE_MANIFEST_START:
-                    /* find end of boundary */
-                    msg = memmem(https_message_body->data, https_message_body->data_length,
-                        mFwInfo.boundary, strlen(mFwInfo.boundary));
-                    if (msg != NULL) {
-                        /* found end of stream */
-                        msg -= 2; /* backup \r\n */
-                        offset = msg - (char*)https_message_body->data;
-                        if (offset > https_message_body->data_length)
-                            offset = https_message_body->data_length;
-                        if (mFwInfo.manifestSz + offset < sizeof(mFwInfo.manifest)) {
-                            memcpy(&mFwInfo.manifest[mFwInfo.manifestSz], https_message_body->data, offset);
-                            mFwInfo.manifestSz += offset;
-
-                            /* advance state and fall though state machine below */
-                            mFwInfo.state = FW_STATE_MANIFEST_DONE;
-                        }
-                        else {
-                            snprintf(err_buf, sizeof(err_buf),
-                                "POST manifest end overrun! Manifest Sz %d, offset %d\r\n",
-                                mFwInfo.manifestSz, offset);
-                            puts(err_buf);
-                            result = cy_http_server_response_stream_write_payload(stream, err_buf, strlen(err_buf));
-                            mFwInfo.state = FW_STATE_INIT;
-                            return HTTPS_REQUEST_HANDLE_ERROR;
-                        }
-                    }
-                    else {
-                        /* copy all data */
-                        if (mFwInfo.manifestSz + https_message_body->data_length < sizeof(mFwInfo.manifest)) {
-                            memcpy(&mFwInfo.manifest[mFwInfo.manifestSz], https_message_body->data, https_message_body->data_length);
-                            mFwInfo.manifestSz += https_message_body->data_length;
-                        }
-                        else {
-                            snprintf(err_buf, sizeof(err_buf),
-                                "POST manifest middle overrun! Manifest Sz %d, Data %d\r\n",
-                                mFwInfo.manifestSz, https_message_body->data_length);
-                            puts(err_buf);
-                            result = cy_http_server_response_stream_write_payload(stream, err_buf, strlen(err_buf));
-                            mFwInfo.state = FW_STATE_INIT;
-                            return HTTPS_REQUEST_HANDLE_ERROR;
-                        }
-                        break;
-                    }
-                    /* fall-through */
-
-                case FW_STATE_MANIFEST_DONE:
-                    printf("Manifest data received: %d bytes\r\n", mFwInfo.manifestSz);
-
-                    /* get the current thread for fw data notifications */
-                    mFwInfo.notifyHandle = xTaskGetCurrentTaskHandle();
-
-                    /* start thread */
-                    printf("Starting firmware update task\r\n");
-                    xTaskCreate(fw_update_task, "FW Update", FW_UPDATE_TASK_STACK_SIZE,
-                        &mFwInfo, FW_UPDATE_TASK_PRIORITY, &fw_update_task_handle);
-                    /* wait for task to mark state as "ready" */
-                    while (mFwInfo.threadState != FW_STATE_THREAD_READY &&
-                           mFwInfo.threadState != FW_STATE_THREAD_FAILED) {
-                        vTaskDelay(1);
-                    }
-                    if (mFwInfo.threadState != FW_STATE_THREAD_READY) {
-                        snprintf(err_buf, sizeof(err_buf), "Update failed 0x%x: %s",
-                            mFwInfo.threadRc, TPM2_GetRCString(mFwInfo.threadRc));
-                        puts(err_buf);
-                        result = cy_http_server_response_stream_write_payload(stream, err_buf, strlen(err_buf));
-                        mFwInfo.state = FW_STATE_INIT;
-                        return HTTPS_REQUEST_HANDLE_ERROR;
-                    }
-
-                    mFwInfo.state = FW_STATE_FIRMWARE_DATA_START;
-                    /* fall-through */
-
-                case FW_STATE_FIRMWARE_DATA_START:
-                    /* parse for firmware file */
-                    memset(mFwInfo.boundary, 0, sizeof(mFwInfo.boundary));
-                    memset(mFwInfo.fieldName, 0, sizeof(mFwInfo.fieldName));
-                    memset(mFwInfo.fileName, 0, sizeof(mFwInfo.fileName));
-                    msg = parse_http_multipart_post((char*)&https_message_body->data[offset],
-                        mFwInfo.boundary, mFwInfo.fieldName, mFwInfo.fileName);
-                    if (msg != NULL) {
-                        printf("POST: Field: %s, File %s, Boundary %s\n",
-                            mFwInfo.fieldName, mFwInfo.fileName, mFwInfo.boundary);
-                        if (strcmp(mFwInfo.fieldName, "data") == 0) {
-                            /* copy start of firmware data info first chunk */
-                            offset = (size_t)msg - (size_t)https_message_body->data;
-                            mFwInfo.chunk.sz = https_message_body->data_length - offset;
-                            if (mFwInfo.chunk.sz > sizeof(mFwInfo.chunk.buf)) {
-                                mFwInfo.chunk.sz = sizeof(mFwInfo.chunk.buf);
-                                memcpy(mFwInfo.chunk.buf, &https_message_body->data[offset], mFwInfo.chunk.sz);
-                                if (mFwInfo.chunk.sz == sizeof(mFwInfo.chunk.buf)) {
-                                    xTaskNotifyGive(fw_update_task_handle);
-                                    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
-                                    offset += mFwInfo.chunk.sz;
-                                }
-                                /* copy any remainder */
-                                mFwInfo.chunk.sz = https_message_body->data_length - offset;
-                                memcpy(mFwInfo.chunk.buf, &https_message_body->data[offset], mFwInfo.chunk.sz);
-                            }
-                            mFwInfo.state = FW_STATE_FIRMWARE_DATA_CHUNK;
-                            break;
-                        }
-                    }
-
-                    snprintf(err_buf, sizeof(err_buf),
-                        "POST firmware data failed! Field: %s, File %s, Boundary %s\r\n",
-                        mFwInfo.fieldName, mFwInfo.fileName, mFwInfo.boundary);
-                    puts(err_buf);
-                    result = cy_http_server_response_stream_write_payload(stream, err_buf, strlen(err_buf));
-                    mFwInfo.state = FW_STATE_INIT;
-                    return HTTPS_REQUEST_HANDLE_ERROR;
-
-                case FW_STATE_FIRMWARE_DATA_CHUNK:
-                    /* firmware data */
-                    /* try and fill chunk */
-                    offset = https_message_body->data_length;
-                    if (offset > sizeof(mFwInfo.chunk.buf) - mFwInfo.chunk.sz)
-                        offset = sizeof(mFwInfo.chunk.buf) - mFwInfo.chunk.sz;
-                    memcpy(&mFwInfo.chunk.buf[mFwInfo.chunk.sz], https_message_body->data, offset);
-                    mFwInfo.chunk.sz += offset;
-
-                    /* find end of boundary */
-                    msg = memmem(mFwInfo.chunk.buf, mFwInfo.chunk.sz,
-                        mFwInfo.boundary, strlen(mFwInfo.boundary));
-                    if (msg != NULL) {
-                        /* found end of stream */
-                        msg -= 2; /* backup \r\n */
-                        mFwInfo.chunk.sz = (size_t)msg - (size_t)mFwInfo.chunk.buf;
-
-                        /* sent last chunk */
-                        xTaskNotifyGive(fw_update_task_handle);
-                        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
-                        mFwInfo.state = FW_STATE_FIRMWARE_DONE;
-                    }
-                    else {
-                        if (mFwInfo.chunk.sz == sizeof(mFwInfo.chunk.buf)) {
-                            xTaskNotifyGive(fw_update_task_handle);
-                            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
-                            mFwInfo.chunk.sz = 0;
-                        }
-                        else {
-                            break; /* keep reading data */
-                        }
-                    }
-
-                    /* copy remainder */
-                    do {
-                        mFwInfo.chunk.sz = https_message_body->data_length - offset;
-                        if (mFwInfo.chunk.sz > sizeof(mFwInfo.chunk.buf))
-                            mFwInfo.chunk.sz = sizeof(mFwInfo.chunk.buf);
-                        memcpy(mFwInfo.chunk.buf, &https_message_body->data[offset], mFwInfo.chunk.sz);
-                        offset += mFwInfo.chunk.sz;
-                        if (mFwInfo.chunk.sz == sizeof(mFwInfo.chunk.buf)) {
-                            xTaskNotifyGive(fw_update_task_handle);
-                            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
-                            mFwInfo.chunk.sz = 0;
-                        }
-                        else {
-                            /* leave remainder */
-                            break;
-                        }
-                    } while (offset < https_message_body->data_length);
-
-                    if (mFwInfo.state != FW_STATE_FIRMWARE_DONE) {
-                        break;
-                    }
-                    /* fall-through */
-
-                case FW_STATE_FIRMWARE_DONE:
-                    printf("Firmware data received: %d bytes\n", mFwInfo.firmwareSz);
-                    /* send last 0 byte chunk to finalize */
-                    mFwInfo.chunk.sz = 0;
-                    xTaskNotifyGive(fw_update_task_handle);
-                    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
-
-                    /* wait for task to complete */
-                    while (mFwInfo.threadState != FW_STATE_THREAD_DONE &&
-                           mFwInfo.threadState != FW_STATE_THREAD_FAILED) {
-                        vTaskDelay(1);
-                    }
-                    if (mFwInfo.threadRc != 0) {
-                        break;
-                    }
-                    mFwInfo.state = FW_STATE_FIRMWARE_REST;
-                    /* fall-through */
-                case FW_STATE_FIRMWARE_REST:
-                    cyhal_gpio_write(CYBSP_USER_LED2, CYBSP_LED_STATE_OFF);
-                    cyhal_gpio_write(CYBSP_LED_RGB_GREEN, CYBSP_LED_STATE_ON);
-
-                    printf("Reset device\n");
-                    break;
-            }
-
-            if (https_message_body->data_remaining == 0) {
-                /* Send the HTTPS response. */
-                msg = HTTPS_STARTUP_HEADER;
-                result = cy_http_server_response_stream_write_payload(stream,
-                    msg, strlen(msg));
-                if (CY_RSLT_SUCCESS == result) {
-                    if (strlen(err_buf) == 0) {
-                        snprintf(err_buf, sizeof(err_buf),
-                            "Update result 0x%x: %s",
-                            mFwInfo.threadRc, TPM2_GetRCString(mFwInfo.threadRc));
-                    }
-                    msg = err_buf;
-                    result = cy_http_server_response_stream_write_payload(stream,
-                        msg, strlen(msg));
-                }
-                if (CY_RSLT_SUCCESS == result) {
-                    msg = HTTPS_STARTUP_FOOTER;
-                    result = cy_http_server_response_stream_write_payload(stream,
-                        msg, strlen(msg));
-                }
-                if (CY_RSLT_SUCCESS != result) {
-                    ERR_INFO(("Failed to send the HTTPS POST response.\n"));
-                }
-
-                mFwInfo.state = FW_STATE_INIT; /* reset state */
-            }
-            break;
-
-        case CY_HTTP_REQUEST_PUT:
+    cy_rslt_t result;
+    https_tmpl_ctx_t t;
+    const http_tmpl_t* tmpl;
 
-            /* Send the HTTPS error response. */
-            const char* putErrStr = "HTTP PUT not supported";
-            result = cy_http_server_response_stream_write_payload(stream,
-                putErrStr, strlen(putErrStr));
-            status = HTTPS_REQUEST_HANDLE_ERROR;
-            if (CY_RSLT_SUCCESS != result)
-            {
-                ERR_INFO(("Failed to send the HTTPS PUT error response.\n"));
-            }
-            break;
+    (void)url_path;
+    (void)url_parameters;
 
-        default:
-            ERR_INFO(("Received invalid HTTP request method. Supported HTTP methods are GET, POST, and PUT.\n"));
-            break;
+    memset(&t, 0, sizeof(t));
+    t.json = 1;
+    if (https_message_body->request_type != CY_HTTP_REQUEST_GET) {
+        tmpl = &api_use_get_tmpl;
     }
-
-    if (CY_RSLT_SUCCESS != result)
-    {
-        status = HTTPS_REQUEST_HANDLE_ERROR;
+    else if ((uintptr_t)arg == API_TPM) {
+        t.rc = TPM2_IFX_GetCaps(&t.caps);
+        TPM2_IFX_GetBusInfo(&t.busHz, &t.busRttUs, &t.busBps);
+        tmpl = (t.rc == TPM_RC_SUCCESS) ? &api_tpm_tmpl : &api_tpm_error_tmpl;
+    }
+    else if ((uintptr_t)arg == API_FW_STATUS) {
+        t.fwInfo = &mFwInfo;
+        tmpl = &api_fw_status_tmpl;
+    }
+    else {
+        t.fwInfo = &mFwInfo;
+        fw_progress(&mFwInfo, &t.fwBps, &t.fwEtaS);
+        tmpl = &fw_progress_tmpl;
     }
 
-    print_heap_usage("At the end of GET/POST/PUT request handler");
-    cyhal_gpio_write(CYBSP_USER_LED, CYBSP_LED_STATE_OFF);
-
-    return status;
+    result = https_render(stream, tmpl, https_tmpl_var, &t);
+    return (CY_RSLT_SUCCESS == result) ?
+        HTTPS_REQUEST_HANDLE_SUCCESS : HTTPS_REQUEST_HANDLE_ERROR;
 }
 
 /*******************************************************************************
@@ -817,24 +3203,19 @@ int32_t https_put_resource_handler(const char *url_path,
 {
     cy_rslt_t result = CY_RSLT_SUCCESS;
     int32_t status = HTTPS_REQUEST_HANDLE_SUCCESS;
-    uint32_t index = 0;
+    const char* value;
+    size_t valueSz;
+
+    (void)arg;
 
     if (CY_HTTP_REQUEST_GET == https_message_body->request_type)
     {
         APP_INFO(("Received HTTPS GET request.\n"));
 
-        while (index < MAX_NUMBER_OF_HTTP_SERVER_RESOURCES)
+        if (url_db_get(url_path, strlen(url_path), &value, &valueSz) ==
+                URL_DB_SUCCESS)
         {
-            if (strcmp(url_resources_db[index].resource_name, (char *)arg) == 0)
-            {
-                result = cy_http_server_response_stream_write_payload(stream,
-                                               url_resources_db[index].value,
-                                             url_resources_db[index].length);
-                break;
-            }
-
-            /* Get next entry. */
-            index++;
+            result = https_write_payload(stream, value, valueSz);
         }
     }
 
@@ -855,94 +3236,81 @@ int32_t https_put_resource_handler(const char *url_path,
  *  request is received from the client.
  *
  * Parameters:
- *  register_resource_name: Pointer to the resource name to be registered
- *   with the HTTPS server.
+ *  request: HTTPS PUT request body "/<name>=<value>", not null terminated.
+ *  requestSz: Length of the request body.
  *
  * Return:
- *  None
+ *  const char* - NULL on success, otherwise the error message for the client.
  *
  *******************************************************************************/
-void register_https_resource(char *register_resource_name)
+static const char* register_https_resource(const char* request,
+    size_t requestSz)
 {
     cy_rslt_t result = CY_RSLT_SUCCESS;
-    char *url_resource_data = NULL;
-    uint32_t index = 0;
-
-    APP_INFO(("New resource to create: %s\n", register_resource_name));
+    const char* sep;
+    const char* name = NULL;
+    const char* value;
+    size_t nameSz, valueSz;
+    int rc;
 
-    /* Configure dynamic resource handler. */
-    https_put_resource.resource_handler = https_put_resource_handler;
-    https_put_resource.arg = NULL;
+    /* The new resources share one handler, which looks them up by URL. */
+    https_resource_init(&https_put_resource, https_put_resource_handler, NULL);
+#ifdef HTTP_LATENCY_STATS
+    https_put_resource.latency = &https_latency[HTTPS_LATENCY_PUT];
+#endif
 
     /* Split the URL resource name and data from the HTTPS PUT request. */
-    strtok_r(register_resource_name, "=", &url_resource_data);
-    APP_INFO(("New URL: %s, Response text: %s\n", register_resource_name, url_resource_data));
+    sep = (request != NULL) ? memchr(request, '=', requestSz) : NULL;
+    if (sep == NULL || sep == request || request[0] != '/') {
+        return "HTTP PUT body must be /<name>=<value>\r\n";
+    }
+    nameSz = sep - request;
+    APP_INFO(("New URL: %.*s, Response text: %.*s\n", (int)nameSz, request,
+        (int)(requestSz - nameSz - 1), sep + 1));
+
+    /* Leave room for the new resource with the HTTPS server. */
+    if (number_of_resources_registered >= MAX_NUMBER_OF_HTTP_SERVER_RESOURCES &&
+            url_db_get(request, nameSz, &value, &valueSz) != URL_DB_SUCCESS) {
+        rc = URL_DB_FULL;
+    }
+    else {
+        rc = url_db_put(request, nameSz, sep + 1, requestSz - nameSz - 1,
+            &name);
+    }
 
-    /* Register the resource if it does not exist in the URL database or
-     * update the resource data if the requested resource already
-     * exists in the URL database.
-     */
-    while (index < MAX_NUMBER_OF_HTTP_SERVER_RESOURCES)
+    if (rc == URL_DB_SUCCESS)
     {
-        if ((NULL != url_resources_db[index].resource_name) &&
-             strcmp(url_resources_db[index].resource_name, register_resource_name) == 0)
-        {
-            APP_INFO(("Updating the existing resource: %s\n\n", register_resource_name));
-            url_resources_db[index].length = strlen(url_resource_data);
-            url_resources_db[index].value = (char *)realloc(url_resources_db[index].value, (url_resources_db[index].length + 1));
-            memset(url_resources_db[index].value, 0, (url_resources_db[index].length + 1));
-            memcpy(url_resources_db[index].value, url_resource_data, url_resources_db[index].length);
-            https_put_resource.arg = url_resources_db[index].resource_name;
-            break;
-        }
-        else if (NULL == url_resources_db[index].resource_name)
-        {
-            APP_INFO(("Registering the new resource: %s\n\n", register_resource_name));
-            url_resources_db[index].value = (char *)calloc(strlen(url_resource_data), sizeof(char));
-            url_resources_db[index].resource_name = (char *)calloc(strlen(register_resource_name), sizeof(char));
-
-            if ((NULL == url_resources_db[index].resource_name) ||
-                (NULL == url_resources_db[index].value))
-            {
-                 ERR_INFO(("Failed to allocate memory for URL resources.\n"));
-                 CY_ASSERT(0);
-            }
-
-            /* Add the resource name, data, and data length into URL database. */
-            url_resources_db[index].length = strlen(url_resource_data);
-            memcpy(url_resources_db[index].resource_name, register_resource_name,
-                                                 strlen(register_resource_name));
-            memcpy(url_resources_db[index].value, url_resource_data,
-                                                 url_resources_db[index].length);
-            https_put_resource.arg = url_resources_db[index].resource_name;
-
-            /* Register the new/updated resource with HTTPS server. */
-            result = cy_http_server_register_resource(https_server,
-                                                      (uint8_t*)url_resources_db[index].resource_name,
-                                                      (uint8_t*)"text/html",
-                                                      CY_DYNAMIC_URL_CONTENT,
-                                                      &https_put_resource);
-            PRINT_AND_ASSERT(result, "Failed to register a new resource.\n");
-
-            /* Update the resource count. */
-            number_of_resources_registered++;
-            break;
-        }
-        else
-        {
-            /* Get next resource. */
-            index++;
-        }
+        APP_INFO(("Updated the existing resource: %s\n\n", name));
     }
-
-    if (index >= MAX_NUMBER_OF_HTTP_SERVER_RESOURCES)
+    else if (rc == URL_DB_ADDED)
+    {
+        APP_INFO(("Registering the new resource: %s\n\n", name));
+
+        /* Register the new resource with HTTPS server. */
+        result = cy_http_server_register_resource(https_server,
+                                                  (uint8_t*)name,
+                                                  (uint8_t*)"text/html",
+                                                  CY_DYNAMIC_URL_CONTENT,
+                                                  &https_put_resource.conn);
+        PRINT_AND_ASSERT(result, "Failed to register a new resource.\n");
+
+        /* Update the resource count. */
+        number_of_resources_registered++;
+    }
+    else if (rc == URL_DB_FULL)
     {
         ERR_INFO(("Requested resource not registered/updated. Reached Maximum "
                   "allowed number of resource registration: %d\n", MAX_NUMBER_OF_HTTP_SERVER_RESOURCES));
+        return "Maximum number of resources registered\r\n";
+    }
+    else
+    {
+        ERR_INFO(("Requested resource not registered/updated. URL database "
+                  "full (%d)\n", rc));
+        return "No space left for the resource\r\n";
     }
 
-    /* Clear the request buffer. */
-    //memset(resource_name, 0, sizeof(resource_name));
+    return NULL;
 }
 
 /*******************************************************************************
@@ -975,16 +3343,23 @@ static cy_rslt_t configure_https_server(void)
      * To make the browser trust the connection with this HTTP server, user
      * needs to load the server certificate into the browser.
      */
+#ifdef SERVER_KEYS_DER
+    /* DER encoded at build time (generate_secure_keys.py), no PEM decoding */
+    security_config.certificate                = (uint8_t *)keySERVER_CERTIFICATE_DER;
+    security_config.certificate_length         = keySERVER_CERTIFICATE_DER_SZ;
+    security_config.private_key                = (uint8_t *)keySERVER_PRIVATE_KEY_DER;
+    security_config.key_length                 = keySERVER_PRIVATE_KEY_DER_SZ;
+#else
     security_config.certificate                = (uint8_t *)keySERVER_CERTIFICATE_PEM;
-    security_config.certificate_length         = strlen(keySERVER_CERTIFICATE_PEM);
+    security_config.certificate_length         = sizeof(keySERVER_CERTIFICATE_PEM) - 1;
     security_config.private_key                = (uint8_t *)keySERVER_PRIVATE_KEY_PEM;
-    security_config.key_length                 = strlen(keySERVER_PRIVATE_KEY_PEM);
+    security_config.key_length                 = sizeof(keySERVER_PRIVATE_KEY_PEM) - 1;
+#endif
     security_config.root_ca_certificate        = NULL; //(uint8_t *)keyCLIENT_ROOTCA_PEM;
     security_config.root_ca_certificate_length = 0; //strlen(keyCLIENT_ROOTCA_PEM);
 #endif
 
-    /* IP address of server. */
-    https_ip_address.ip_address.ip.v4 = ip_addr.ip.v4;
+    /* IP address of server, set in https_server_task once joined. */
     https_ip_address.ip_address.version = CY_SOCKET_IP_VER_V4;
 
     /* Add IP address information to network interface object. */
@@ -995,6 +3370,8 @@ static cy_rslt_t configure_https_server(void)
     result = cy_http_server_network_init();
 
     /* Allocate memory needed for secure HTTP server. */
+    APP_INFO(("HTTPS server connections: %d (%d bytes each)\n",
+        MAX_SOCKETS, HTTPS_CONN_SZ));
 #ifdef HTTPS_PORT
     result = cy_http_server_create(&nw_interface, HTTPS_PORT, MAX_SOCKETS, &security_config, &https_server);
 #else
@@ -1002,18 +3379,251 @@ static cy_rslt_t configure_https_server(void)
 #endif
     PRINT_AND_ASSERT(result, "Failed to allocate memory for the HTTPS server.\n");
 
+    /* The page, its script and the logo are complete responses generated
+     * at build time (see generate_web_assets.py), sent as they are. */
+    https_page_resource.data = web_asset_index_html;
+    https_page_resource.length = WEB_ASSET_INDEX_HTML_SZ;
+    https_logo_resource.data = web_asset_logo_png;
+    https_logo_resource.length = WEB_ASSET_LOGO_PNG_SZ;
+    https_progress_js_resource.data = web_asset_progress_js;
+    https_progress_js_resource.length = WEB_ASSET_PROGRESS_JS_SZ;
+
     /* Configure dynamic resource handler. */
-    https_get_post_resource.resource_handler = dynamic_resource_handler;
-    https_get_post_resource.arg = NULL;
+    https_resource_init(&https_get_post_resource, dynamic_resource_handler,
+        NULL);
+#ifdef HTTP_LATENCY_STATS
+    https_get_post_resource.latency = &https_latency[HTTPS_LATENCY_TPM];
+#endif
 
     /* Register all the resources with the secure HTTP server. */
     result = cy_http_server_register_resource(https_server,
-                                              (uint8_t*)"/",
+                                              (uint8_t*)WEB_ASSET_INDEX_HTML_URL,
                                               (uint8_t*)"text/html",
-                                              CY_DYNAMIC_URL_CONTENT,
-                                              &https_get_post_resource);
+                                              CY_RAW_STATIC_URL_CONTENT,
+                                              &https_page_resource);
     /* Update the resource count. */
     number_of_resources_registered++;
+    if (CY_RSLT_SUCCESS == result) {
+        result = cy_http_server_register_resource(https_server,
+                                                  (uint8_t*)WEB_ASSET_LOGO_PNG_URL,
+                                                  (uint8_t*)"image/png",
+                                                  CY_RAW_STATIC_URL_CONTENT,
+                                                  &https_logo_resource);
+        number_of_resources_registered++;
+    }
+    if (CY_RSLT_SUCCESS == result) {
+        result = cy_http_server_register_resource(https_server,
+                                                  (uint8_t*)WEB_ASSET_PROGRESS_JS_URL,
+                                                  (uint8_t*)"text/javascript",
+                                                  CY_RAW_STATIC_URL_CONTENT,
+                                                  &https_progress_js_resource);
+        number_of_resources_registered++;
+    }
+    /* TPM status (GET) and firmware update form (POST) */
+    if (CY_RSLT_SUCCESS == result) {
+        result = cy_http_server_register_resource(https_server,
+                                                  (uint8_t*)"/tpm",
+                                                  (uint8_t*)"text/plain",
+                                                  CY_DYNAMIC_URL_CONTENT,
+                                                  &https_get_post_resource.conn);
+        number_of_resources_registered++;
+    }
+
+    /* JSON status API */
+    https_resource_init(&api_tpm_resource, api_resource_handler,
+        (void*)(uintptr_t)API_TPM);
+    https_resource_init(&api_fw_status_resource, api_resource_handler,
+        (void*)(uintptr_t)API_FW_STATUS);
+    if (CY_RSLT_SUCCESS == result) {
+        result = cy_http_server_register_resource(https_server,
+                                                  (uint8_t*)"/api/tpm",
+                                                  (uint8_t*)"application/json",
+                                                  CY_DYNAMIC_URL_CONTENT,
+                                                  &api_tpm_resource.conn);
+        number_of_resources_registered++;
+    }
+    if (CY_RSLT_SUCCESS == result) {
+        result = cy_http_server_register_resource(https_server,
+                                                  (uint8_t*)"/api/fw/status",
+                                                  (uint8_t*)"application/json",
+                                                  CY_DYNAMIC_URL_CONTENT,
+                                                  &api_fw_status_resource.conn);
+        number_of_resources_registered++;
+    }
+    /* update progress as Server-Sent Events */
+    https_resource_init(&fw_progress_resource, api_resource_handler,
+        (void*)(uintptr_t)API_FW_PROGRESS);
+    if (CY_RSLT_SUCCESS == result) {
+        result = cy_http_server_register_resource(https_server,
+                                                  (uint8_t*)"/fw/progress",
+                                                  (uint8_t*)"text/event-stream",
+                                                  CY_DYNAMIC_URL_CONTENT,
+                                                  &fw_progress_resource.conn);
+        number_of_resources_registered++;
+    }
+
+    /* Raw firmware upload resources. */
+    https_resource_init(&fw_manifest_resource, fw_raw_resource_handler,
+        (void*)(uintptr_t)FW_PART_MANIFEST);
+    https_resource_init(&fw_data_resource, fw_raw_resource_handler,
+        (void*)(uintptr_t)FW_PART_DATA);
+    if (CY_RSLT_SUCCESS == result) {
+        result = cy_http_server_register_resource(https_server,
+                                                  (uint8_t*)"/fw/manifest",
+                                                  (uint8_t*)"text/plain",
+                                                  CY_DYNAMIC_URL_CONTENT,
+                                                  &fw_manifest_resource.conn);
+        number_of_resources_registered++;
+    }
+    if (CY_RSLT_SUCCESS == result) {
+        result = cy_http_server_register_resource(https_server,
+                                                  (uint8_t*)"/fw/data",
+                                                  (uint8_t*)"text/plain",
+                                                  CY_DYNAMIC_URL_CONTENT,
+                                                  &fw_data_resource.conn);
+        number_of_resources_registered++;
+    }
+#ifdef FW_UPDATE_STATS
+    https_resource_init(&fw_stats_resource, fw_stats_resource_handler, NULL);
+    if (CY_RSLT_SUCCESS == result) {
+        result = cy_http_server_register_resource(https_server,
+                                                  (uint8_t*)"/stats/fwupdate",
+                                                  (uint8_t*)"text/plain",
+                                                  CY_DYNAMIC_URL_CONTENT,
+                                                  &fw_stats_resource.conn);
+        number_of_resources_registered++;
+    }
+#endif
+#ifdef TLS_CRYPTO_CB
+    https_resource_init(&tls_stats_resource, tls_stats_resource_handler, NULL);
+    if (CY_RSLT_SUCCESS == result) {
+        result = cy_http_server_register_resource(https_server,
+                                                  (uint8_t*)"/stats/tls",
+                                                  (uint8_t*)"text/plain",
+                                                  CY_DYNAMIC_URL_CONTENT,
+                                                  &tls_stats_resource.conn);
+        number_of_resources_registered++;
+    }
+#endif
+#ifdef TLS_HEAP_POOL
+    https_resource_init(&tls_heap_resource, tls_heap_resource_handler, NULL);
+    if (CY_RSLT_SUCCESS == result) {
+        result = cy_http_server_register_resource(https_server,
+                                                  (uint8_t*)"/stats/tls/heap",
+                                                  (uint8_t*)"text/plain",
+                                                  CY_DYNAMIC_URL_CONTENT,
+                                                  &tls_heap_resource.conn);
+        number_of_resources_registered++;
+    }
+#endif
+#ifdef TPM_WAIT_RTOS
+    https_resource_init(&tpm_stats_resource, tpm_stats_resource_handler, NULL);
+    if (CY_RSLT_SUCCESS == result) {
+        result = cy_http_server_register_resource(https_server,
+                                                  (uint8_t*)"/stats/tpm",
+                                                  (uint8_t*)"text/plain",
+                                                  CY_DYNAMIC_URL_CONTENT,
+                                                  &tpm_stats_resource.conn);
+        number_of_resources_registered++;
+    }
+#endif
+    https_resource_init(&boot_stats_resource, boot_stats_resource_handler, NULL);
+    if (CY_RSLT_SUCCESS == result) {
+        result = cy_http_server_register_resource(https_server,
+                                                  (uint8_t*)"/stats/boot",
+                                                  (uint8_t*)"text/plain",
+                                                  CY_DYNAMIC_URL_CONTENT,
+                                                  &boot_stats_resource.conn);
+        number_of_resources_registered++;
+    }
+#ifdef MEM_STATS
+    https_resource_init(&mem_stats_resource, mem_stats_resource_handler, NULL);
+    if (CY_RSLT_SUCCESS == result) {
+        result = cy_http_server_register_resource(https_server,
+                                                  (uint8_t*)"/stats/mem",
+                                                  (uint8_t*)"text/plain",
+                                                  CY_DYNAMIC_URL_CONTENT,
+                                                  &mem_stats_resource.conn);
+        number_of_resources_registered++;
+    }
+#endif
+#ifdef HTTP_LATENCY_STATS
+    https_resource_init(&http_stats_resource, http_stats_resource_handler, NULL);
+    if (CY_RSLT_SUCCESS == result) {
+        result = cy_http_server_register_resource(https_server,
+                                                  (uint8_t*)"/stats/http",
+                                                  (uint8_t*)"text/plain",
+                                                  CY_DYNAMIC_URL_CONTENT,
+                                                  &http_stats_resource.conn);
+        number_of_resources_registered++;
+    }
+#endif
+#ifdef CPU_STATS
+    https_resource_init(&cpu_stats_resource, cpu_stats_resource_handler, NULL);
+    if (CY_RSLT_SUCCESS == result) {
+        result = cy_http_server_register_resource(https_server,
+                                                  (uint8_t*)"/stats/cpu",
+                                                  (uint8_t*)"text/plain",
+                                                  CY_DYNAMIC_URL_CONTENT,
+                                                  &cpu_stats_resource.conn);
+        number_of_resources_registered++;
+    }
+#endif
+#ifdef BENCH
+    https_resource_init(&bench_resource, bench_resource_handler, NULL);
+    if (CY_RSLT_SUCCESS == result) {
+        result = cy_http_server_register_resource(https_server,
+                                                  (uint8_t*)"/bench",
+                                                  (uint8_t*)"application/json",
+                                                  CY_DYNAMIC_URL_CONTENT,
+                                                  &bench_resource.conn);
+        number_of_resources_registered++;
+    }
+#endif
+#ifdef WIFI_POWER
+    https_resource_init(&power_resource, power_resource_handler, NULL);
+    if (CY_RSLT_SUCCESS == result) {
+        result = cy_http_server_register_resource(https_server,
+                                                  (uint8_t*)"/stats/power",
+                                                  (uint8_t*)"text/plain",
+                                                  CY_DYNAMIC_URL_CONTENT,
+                                                  &power_resource.conn);
+        number_of_resources_registered++;
+    }
+#endif
+#ifdef FW_STAGE
+    /* Firmware staging area in the QSPI flash */
+    https_resource_init(&fw_stage_resource, fw_stage_resource_handler,
+        (void*)(uintptr_t)FW_PART_NONE);
+    https_resource_init(&fw_stage_manifest_resource, fw_stage_resource_handler,
+        (void*)(uintptr_t)FW_PART_MANIFEST);
+    https_resource_init(&fw_stage_data_resource, fw_stage_resource_handler,
+        (void*)(uintptr_t)FW_PART_DATA);
+    if (CY_RSLT_SUCCESS == result) {
+        result = cy_http_server_register_resource(https_server,
+                                                  (uint8_t*)"/fw/stage",
+                                                  (uint8_t*)"text/plain",
+                                                  CY_DYNAMIC_URL_CONTENT,
+                                                  &fw_stage_resource.conn);
+        number_of_resources_registered++;
+    }
+    if (CY_RSLT_SUCCESS == result) {
+        result = cy_http_server_register_resource(https_server,
+                                                  (uint8_t*)"/fw/stage/manifest",
+                                                  (uint8_t*)"text/plain",
+                                                  CY_DYNAMIC_URL_CONTENT,
+                                                  &fw_stage_manifest_resource.conn);
+        number_of_resources_registered++;
+    }
+    if (CY_RSLT_SUCCESS == result) {
+        result = cy_http_server_register_resource(https_server,
+                                                  (uint8_t*)"/fw/stage/data",
+                                                  (uint8_t*)"text/plain",
+                                                  CY_DYNAMIC_URL_CONTENT,
+                                                  &fw_stage_data_resource.conn);
+        number_of_resources_registered++;
+    }
+#endif
 
     return result;
 }
@@ -1042,25 +3652,92 @@ void https_server_task(void *arg)
 
     (void)arg;
 
+#ifdef PARALLEL_BOOT
+    /* Joins the Wi-Fi Access Point on its own task. The HTTPS server is
+     * set up once the network stack is up, while joining. */
+    if (xTaskCreate(wifi_boot_task, "Wi-Fi Boot", WIFI_BOOT_TASK_STACK_SIZE,
+            NULL, WIFI_BOOT_TASK_PRIORITY, NULL) != pdPASS) {
+        result = CY_RSLT_TYPE_ERROR;
+    }
+    PRINT_AND_ASSERT(result, "Failed to start the Wi-Fi task.\n");
+    result = boot_wait(BOOT_EVENT_NET);
+    PRINT_AND_ASSERT(result, "Wi-Fi initialization failed.\n");
+#else
     /* Connects to the Wi-Fi Access Point. */
     result = wifi_connect();
     PRINT_AND_ASSERT(result, "Wi-Fi connection failed.\n");
-
-#if LWIP_MDNS_RESPONDER
-    /* Resolves the HTTPS server name to an IP address. */
-    result = mdns_responder_start();
-    PRINT_AND_ASSERT(result, "Failed to start MDNS responder.\n");
 #endif
 
+    https_conns_lock = xSemaphoreCreateMutexStatic(&https_conns_lock_buf);
+
     /* Configure the HTTPS server with all the security parameters and
      * register a default dynamic URL handler.
      */
     result = configure_https_server();
     PRINT_AND_ASSERT(result, "Failed to configure the HTTPS server.\n");
+    boot_mark("HTTPS server configured");
+
+    result = boot_wait(BOOT_EVENT_WIFI);
+    PRINT_AND_ASSERT(result, "Wi-Fi connection failed.\n");
+    https_ip_address.ip_address.ip.v4 = ip_addr.ip.v4;
+
+#if LWIP_MDNS_RESPONDER
+    /* Resolves the HTTPS server name to an IP address. */
+    result = mdns_responder_start();
+    PRINT_AND_ASSERT(result, "Failed to start MDNS responder.\n");
+#endif
+
+    /* The firmware update and TLS signing use the TPM */
+    boot_wait(BOOT_EVENT_TPM);
+
+    /* Start the firmware update task. */
+    result = fw_update_task_init();
+    PRINT_AND_ASSERT(result, "Failed to start the firmware update task.\n");
+
+#ifdef FW_STAGE
+    /* Firmware staging area in the QSPI flash, not fatal: the uploads
+     * straight to the TPM work without it */
+    result = fw_stage_init();
+    if (CY_RSLT_SUCCESS != result) {
+        ERR_INFO(("Firmware staging area disabled 0x%lx\n",
+            (unsigned long)result));
+    }
+#endif
+
+#ifdef TLS_CRYPTO_CB
+    /* TLS server key signing and handshake statistics, before the server
+     * accepts connections. */
+    result = (tls_crypto_init(&mDev) == 0) ? CY_RSLT_SUCCESS :
+        CY_RSLT_TYPE_ERROR;
+    PRINT_AND_ASSERT(result, "Failed to register the TLS crypto callback.\n");
+#endif
+
+#ifdef WIFI_POWER
+    /* Performance mode until the server is idle, not fatal if the WLAN
+     * interface is not found */
+    result = wifi_power_init();
+    if (CY_RSLT_SUCCESS != result) {
+        ERR_INFO(("Wi-Fi power-save policy disabled 0x%lx\n",
+            (unsigned long)result));
+    }
+#endif
 
     /* Start the HTTPS server. */
     result = cy_http_server_start(https_server);
     PRINT_AND_ASSERT(result, "Failed to start the HTTPS server.\n");
+    boot_mark("HTTPS server started");
+
+#ifdef WIFI_LINK
+    /* Reconnects after a link loss, without a reboot. */
+    result = wifi_link_monitor_start();
+    PRINT_AND_ASSERT(result, "Failed to start the Wi-Fi link monitor.\n");
+#endif
+
+#ifdef BENCH
+    /* Benchmark task, runs on /bench?run (or at boot, BENCH_AT_BOOT) */
+    result = bench_init(&mDev);
+    PRINT_AND_ASSERT(result, "Failed to start the benchmark task.\n");
+#endif
 
 #ifdef HTTPS_PORT
     APP_INFO(("HTTPS server has successfully started. The server is running at "
@@ -1073,17 +3750,108 @@ void https_server_task(void *arg)
     /* continue running HTTP server (handled through callbacks) */
     while(true)
     {
-        vTaskDelay(10000/portTICK_PERIOD_MS);
+        vTaskDelay(1000/portTICK_PERIOD_MS);
+        https_conn_sweep();
+#ifdef WIFI_POWER
+        /* a firmware update keeps the performance mode */
+        wifi_power_poll(!fw_update_idle(&mFwInfo));
+#endif
+#if LWIP_MDNS_RESPONDER
+        mdns_txt_refresh();
+#endif
     }
 }
 
 #if LWIP_MDNS_RESPONDER
+/* TPM status in the TXT record of the DNS-SD service, so a browse finds the
+ * firmware of every board without a TLS connection to each. The server task
+ * updates it, the TXT callback runs on the lwIP thread and only formats it
+ * (it must not wait for the TPM). Both hold the lwIP core lock. */
+typedef struct {
+    int      valid;       /* the TPM capabilities were read */
+    uint16_t fwVerMajor;
+    uint16_t fwVerMinor;
+    uint32_t fwVerVendor;
+    uint8_t  opMode;
+    const char* update;   /* firmware update state */
+} mdns_txt_t;
+static mdns_txt_t mMdnsTxt;
+static s8_t mMdnsService = -1;
+
+/* coarse update state, the TXT record changes (and is announced) only when
+ * an update starts or ends, not for every step of it */
+static const char* mdns_update_state(const fw_info_t* fwInfo)
+{
+    if (fwInfo->state == FW_STATE_FIRMWARE_REST)
+        return "done";
+    if (fwInfo->state != FW_STATE_INIT)
+        return "updating";
+    return (fwInfo->threadRc != 0) ? "failed" : "idle";
+}
+
+/* service_get_txt_fn_t: "key=value" items of the TXT record */
+static void mdns_txt_cb(struct mdns_service *service, void *txt_userdata)
+{
+    char item[32];
+    int len;
+    (void)txt_userdata;
+
+    mdns_resp_add_service_txtitem(service, "txtvers=1", 9);
+    mdns_resp_add_service_txtitem(service, "path=/", 6);
+    if (mMdnsTxt.valid) {
+        len = snprintf(item, sizeof(item), "fw=%u.%u",
+            (unsigned)mMdnsTxt.fwVerMajor, (unsigned)mMdnsTxt.fwVerMinor);
+        mdns_resp_add_service_txtitem(service, item, (u8_t)len);
+        len = snprintf(item, sizeof(item), "fwvendor=0x%lx",
+            (unsigned long)mMdnsTxt.fwVerVendor);
+        mdns_resp_add_service_txtitem(service, item, (u8_t)len);
+        len = snprintf(item, sizeof(item), "opmode=0x%02x",
+            (unsigned)mMdnsTxt.opMode);
+        mdns_resp_add_service_txtitem(service, item, (u8_t)len);
+    }
+    len = snprintf(item, sizeof(item), "update=%s", mMdnsTxt.update);
+    mdns_resp_add_service_txtitem(service, item, (u8_t)len);
+}
+
+/* Called by the server task once a second. Reads the TPM status (the
+ * cached capabilities, read again only after an update) and announces the
+ * service when its TXT record changes. */
+static void mdns_txt_refresh(void)
+{
+    mdns_txt_t txt;
+    WOLFTPM2_CAPS caps;
+
+    if (mMdnsService < 0) {
+        return;
+    }
+    memcpy(&txt, &mMdnsTxt, sizeof(txt));
+    txt.update = mdns_update_state(&mFwInfo);
+    /* the TPM is not read while the update task uses it */
+    if (fw_update_idle(&mFwInfo)) {
+        txt.valid = (TPM2_IFX_GetCaps(&caps) == TPM_RC_SUCCESS);
+        txt.fwVerMajor = txt.valid ? caps.fwVerMajor : 0;
+        txt.fwVerMinor = txt.valid ? caps.fwVerMinor : 0;
+        txt.fwVerVendor = txt.valid ? caps.fwVerVendor : 0;
+        txt.opMode = txt.valid ? caps.opMode : 0;
+    }
+    if (memcmp(&txt, &mMdnsTxt, sizeof(txt)) != 0) {
+        LOCK_TCPIP_CORE();
+        mMdnsTxt = txt;
+        /* RFC 6762 section 8.4: announce a changed record */
+        mdns_resp_announce(cy_network_get_nw_interface(
+            CY_NETWORK_WIFI_STA_INTERFACE, 0));
+        UNLOCK_TCPIP_CORE();
+    }
+}
+
 /********************************************************************************
  * Function Name: mdns_responder_start
  ********************************************************************************
  * Summary:
  * Starts the mDNS responder using lwIP network stack APIs. It resolves the IP address
- * for a given hostname and sends the DNS response to the DNS client.
+ * for a given hostname and sends the DNS response to the DNS client. The server is
+ * advertised as a DNS-SD service (MDNS_SERVICE_TYPE) with the TPM status in its
+ * TXT record.
  *
  * Parameters:
  *  void
@@ -1101,6 +3869,10 @@ cy_rslt_t mdns_responder_start(void)
      */
     struct netif *net = cy_network_get_nw_interface(CY_NETWORK_WIFI_STA_INTERFACE, 0);
 
+    /* the TPM may not be ready yet, the first refresh reads it */
+    mMdnsTxt.update = mdns_update_state(&mFwInfo);
+
+    LOCK_TCPIP_CORE();
     mdns_resp_init();
 
     if (ERR_OK != mdns_resp_add_netif(net, HTTPS_SERVER_NAME, MDNS_TTL_SECONDS))
@@ -1108,6 +3880,19 @@ cy_rslt_t mdns_responder_start(void)
         ERR_INFO(("Failed to start the MDNS responder.\n"));
         result = CY_RSLT_TYPE_ERROR;
     }
+    else
+    {
+        /* probed and announced with the hostname */
+        mMdnsService = mdns_resp_add_service(net, HTTPS_SERVER_NAME,
+            MDNS_SERVICE_TYPE, DNSSD_PROTO_TCP, MDNS_SERVICE_PORT,
+            MDNS_TTL_SECONDS, mdns_txt_cb, NULL);
+        if (mMdnsService < 0)
+        {
+            ERR_INFO(("Failed to add the MDNS service.\n"));
+            result = CY_RSLT_TYPE_ERROR;
+        }
+    }
+    UNLOCK_TCPIP_CORE();
 
     return result;
 }
@@ -1136,6 +3921,8 @@ cy_rslt_t wifi_connect(void)
     cy_wcm_config_t wcm_config = {.interface = CY_WCM_INTERFACE_TYPE_STA};
 
     result = cy_wcm_init(&wcm_config);
+    boot_mark("Wi-Fi initialized");
+    boot_done(BOOT_EVENT_NET, result);
 
     if (CY_RSLT_SUCCESS == result)
     {
@@ -1151,7 +3938,13 @@ cy_rslt_t wifi_connect(void)
          */
         for (retry_count = 0; retry_count < MAX_WIFI_RETRY_COUNT; retry_count++)
         {
+        #ifdef WIFI_LINK
+             /* the first try joins the last AP directly */
+             result = wifi_link_connect(&connect_param, &ip_addr,
+                 retry_count == 0);
+        #else
              result = cy_wcm_connect_ap(&connect_param, &ip_addr);
+        #endif
 
              if (CY_RSLT_SUCCESS == result)
              {
@@ -1166,15 +3959,84 @@ cy_rslt_t wifi_connect(void)
                      APP_INFO(("Assigned IP address: %s\n", ip6addr_ntoa((const ip6_addr_t *)&ip_addr.ip.v6)));
                  }
 
+                 boot_mark("Wi-Fi joined");
                  break;
              }
 
              ERR_INFO(("Failed to join Wi-Fi network. Retrying...\n"));
         }
     }
+    boot_done(BOOT_EVENT_WIFI, result);
+
+    return result;
+}
+
+#ifdef WIFI_LINK
+/********************************************************************************
+ * Function Name: https_server_ip_update
+ ********************************************************************************
+ * Summary:
+ *  Takes the address of a new association (Wi-Fi link monitor). When it
+ *  changed, the server is restarted so it listens on the new address.
+ *
+ * Parameters:
+ *  addr - The station address.
+ *
+ * Return:
+ *  cy_rslt_t: CY_RSLT_SUCCESS if the server listens on the address.
+ *
+ *******************************************************************************/
+cy_rslt_t https_server_ip_update(const cy_wcm_ip_address_t* addr)
+{
+    cy_rslt_t result;
+
+    if (addr->version != CY_WCM_IP_VER_V4 ||
+            (ip_addr.version == addr->version &&
+             ip_addr.ip.v4 == addr->ip.v4)) {
+        return CY_RSLT_SUCCESS;
+    }
+    ip_addr = *addr;
+    APP_INFO(("Assigned IP address: %s\n",
+        ip4addr_ntoa((const ip4_addr_t *)&ip_addr.ip.v4)));
 
+    result = cy_http_server_stop(https_server);
+    https_ip_address.ip_address.ip.v4 = ip_addr.ip.v4;
+    if (CY_RSLT_SUCCESS == result) {
+        result = cy_http_server_start(https_server);
+    }
+    if (CY_RSLT_SUCCESS != result) {
+        ERR_INFO(("Failed to restart the HTTPS server 0x%lx\n",
+            (unsigned long)result));
+    }
     return result;
 }
+#endif
+
+#ifdef PARALLEL_BOOT
+/********************************************************************************
+ * Function Name: wifi_boot_task
+ ********************************************************************************
+ * Summary:
+ *  Runs wifi_connect at boot, in parallel with the TPM and HTTPS server
+ *  bring-up. The result is signaled with BOOT_EVENT_NET and BOOT_EVENT_WIFI.
+ *
+ * Parameters:
+ *  arg - Unused.
+ *
+ * Return:
+ *  None.
+ *
+ *******************************************************************************/
+static void wifi_boot_task(void *arg)
+{
+    (void)arg;
+    wifi_connect();
+#ifdef MEM_STATS
+    mem_stats_task_exit();
+#endif
+    vTaskDelete(NULL);
+}
+#endif
 
 
 /* [] END OF FILE */
@@ -95,7 +95,67 @@
     /* plain HTTP mode (no TLS) for debugging */
     #define HTTP_PORT                            (80)
 #endif
-#define MAX_SOCKETS                              (2)
+
+/* DNS-SD service of the server (_https._tcp.local) */
+#ifdef HTTPS_PORT
+    #define MDNS_SERVICE_TYPE                    "_https"
+    #define MDNS_SERVICE_PORT                    HTTPS_PORT
+#else
+    #define MDNS_SERVICE_TYPE                    "_http"
+    #define MDNS_SERVICE_PORT                    HTTP_PORT
+#endif
+
+/* Responses are written as TLS records that fit in one TCP segment
+ * (HTTP_SERVER_MTU_SIZE): the record header, explicit IV or nonce, MAC or
+ * AEAD tag and padding take at most HTTPS_TLS_RECORD_OVERHEAD bytes. */
+#define HTTPS_TLS_SEGMENT_SZ                     (1460)
+#define HTTPS_TLS_RECORD_OVERHEAD                (96)
+#define HTTPS_TLS_RECORD_SZ                      (HTTPS_TLS_SEGMENT_SZ - \
+                                                  HTTPS_TLS_RECORD_OVERHEAD)
+
+/* The number of HTTPS connections (MAX_SOCKETS) is sized from a memory
+ * budget. Each connection holds the wolfSSL session and handshake state,
+ * the TLS input buffer (up to a full 16 KB record from the client, unless
+ * it negotiates max_fragment_length), the output buffer (one segment, see
+ * HTTPS_TLS_RECORD_SZ) and the lwIP socket and TCP PCB. It is also limited
+ * by the TCP PCBs (MEMP_NUM_TCP_PCB in lwipopts.h), keeping some free for
+ * connections closing. */
+#ifndef HTTPS_CONN_BUDGET_SZ
+#define HTTPS_CONN_BUDGET_SZ                     (128 * 1024)
+#endif
+#ifdef HTTPS_PORT
+    #define HTTPS_CONN_SESSION_SZ                (8 * 1024)
+    #define HTTPS_CONN_TLS_IN_SZ                 (16 * 1024 + 512)
+    #define HTTPS_CONN_TLS_OUT_SZ                (HTTPS_TLS_SEGMENT_SZ + 512)
+#else
+    #define HTTPS_CONN_SESSION_SZ                (0)
+    #define HTTPS_CONN_TLS_IN_SZ                 (0)
+    #define HTTPS_CONN_TLS_OUT_SZ                (0)
+#endif
+#define HTTPS_CONN_SOCKET_SZ                     (512)
+#define HTTPS_CONN_SZ                            (HTTPS_CONN_SESSION_SZ + \
+                                                  HTTPS_CONN_TLS_IN_SZ + \
+                                                  HTTPS_CONN_TLS_OUT_SZ + \
+                                                  HTTPS_CONN_SOCKET_SZ)
+#define HTTPS_CONN_PCB_RESERVE                   (2)
+#define MAX_SOCKETS                              \
+    ((HTTPS_CONN_BUDGET_SZ / HTTPS_CONN_SZ) < \
+        (MEMP_NUM_TCP_PCB - HTTPS_CONN_PCB_RESERVE) ? \
+     (HTTPS_CONN_BUDGET_SZ / HTTPS_CONN_SZ) : \
+        (MEMP_NUM_TCP_PCB - HTTPS_CONN_PCB_RESERVE))
+
+/* Connections are kept open between requests, so polling clients pay for
+ * the TLS handshake once. A connection is closed after this many requests,
+ * or when idle for this long, to free its socket for other clients. */
+#define HTTPS_KEEPALIVE_MAX_REQUESTS             (100)
+#define HTTPS_KEEPALIVE_IDLE_MS                  (30000)
+
+/* While a firmware upload is received, the other connections are closed
+ * when idle for this long, see https_conn_bulk_begin. */
+#ifndef HTTPS_BULK_IDLE_MS
+#define HTTPS_BULK_IDLE_MS                       (2000)
+#endif
+
 #define REGISTER_RESOURCE_QUEUE_LENGTH           (1)
 #define NEW_RESOURCE_NAME_LENGTH                 (30)
 #define HTTPS_REQUEST_HANDLE_SUCCESS             (0)
@@ -110,6 +170,9 @@
 void https_server_task(void *arg);
 cy_rslt_t wifi_connect(void);
 cy_rslt_t mdns_responder_start(void);
+#ifdef WIFI_LINK
+cy_rslt_t https_server_ip_update(const cy_wcm_ip_address_t* addr);
+#endif
 
 #endif /* SECURE_HTTP_SERVER_H_ */
 
@@ -0,0 +1,166 @@
+/******************************************************************************
+* File Name: secure_keys_der.c
+*
+* Description: DER encoded certificates and keys of secure_keys.h.
+*
+* Generated by generate_secure_keys.py from secure_keys.h, do not edit.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include "secure_keys_der.h"
+
+/* keySERVER_CERTIFICATE_PEM */
+const uint8_t keySERVER_CERTIFICATE_DER[keySERVER_CERTIFICATE_DER_SZ] = {
+    0x30, 0x82, 0x02, 0x32, 0x30, 0x82, 0x01, 0xd8, 0xa0, 0x03, 0x02, 0x01,
+    0x02, 0x02, 0x14, 0x0f, 0xbf, 0x22, 0x70, 0x9a, 0xde, 0xd3, 0x54, 0x5b,
+    0x11, 0x20, 0x25, 0x48, 0x41, 0x8a, 0x74, 0x55, 0xc5, 0x00, 0xe5, 0x30,
+    0x0a, 0x06, 0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x04, 0x03, 0x02, 0x30,
+    0x77, 0x31, 0x0b, 0x30, 0x09, 0x06, 0x03, 0x55, 0x04, 0x06, 0x13, 0x02,
+    0x55, 0x53, 0x31, 0x10, 0x30, 0x0e, 0x06, 0x03, 0x55, 0x04, 0x08, 0x0c,
+    0x07, 0x4d, 0x6f, 0x6e, 0x74, 0x61, 0x6e, 0x61, 0x31, 0x10, 0x30, 0x0e,
+    0x06, 0x03, 0x55, 0x04, 0x07, 0x0c, 0x07, 0x42, 0x6f, 0x7a, 0x65, 0x6d,
+    0x61, 0x6e, 0x31, 0x0b, 0x30, 0x09, 0x06, 0x03, 0x55, 0x04, 0x0a, 0x0c,
+    0x02, 0x43, 0x59, 0x31, 0x14, 0x30, 0x12, 0x06, 0x03, 0x55, 0x04, 0x0b,
+    0x0c, 0x0b, 0x45, 0x6e, 0x67, 0x69, 0x6e, 0x65, 0x65, 0x72, 0x69, 0x6e,
+    0x67, 0x31, 0x21, 0x30, 0x1f, 0x06, 0x03, 0x55, 0x04, 0x03, 0x0c, 0x18,
+    0x6d, 0x79, 0x73, 0x65, 0x63, 0x75, 0x72, 0x65, 0x68, 0x74, 0x74, 0x70,
+    0x73, 0x65, 0x72, 0x76, 0x65, 0x72, 0x2e, 0x6c, 0x6f, 0x63, 0x61, 0x6c,
+    0x30, 0x1e, 0x17, 0x0d, 0x32, 0x34, 0x30, 0x33, 0x32, 0x31, 0x30, 0x30,
+    0x34, 0x39, 0x35, 0x36, 0x5a, 0x17, 0x0d, 0x32, 0x36, 0x31, 0x32, 0x31,
+    0x36, 0x30, 0x30, 0x34, 0x39, 0x35, 0x36, 0x5a, 0x30, 0x77, 0x31, 0x0b,
+    0x30, 0x09, 0x06, 0x03, 0x55, 0x04, 0x06, 0x13, 0x02, 0x55, 0x53, 0x31,
+    0x10, 0x30, 0x0e, 0x06, 0x03, 0x55, 0x04, 0x08, 0x0c, 0x07, 0x4d, 0x6f,
+    0x6e, 0x74, 0x61, 0x6e, 0x61, 0x31, 0x10, 0x30, 0x0e, 0x06, 0x03, 0x55,
+    0x04, 0x07, 0x0c, 0x07, 0x42, 0x6f, 0x7a, 0x65, 0x6d, 0x61, 0x6e, 0x31,
+    0x0b, 0x30, 0x09, 0x06, 0x03, 0x55, 0x04, 0x0a, 0x0c, 0x02, 0x43, 0x59,
+    0x31, 0x14, 0x30, 0x12, 0x06, 0x03, 0x55, 0x04, 0x0b, 0x0c, 0x0b, 0x45,
+    0x6e, 0x67, 0x69, 0x6e, 0x65, 0x65, 0x72, 0x69, 0x6e, 0x67, 0x31, 0x21,
+    0x30, 0x1f, 0x06, 0x03, 0x55, 0x04, 0x03, 0x0c, 0x18, 0x6d, 0x79, 0x73,
+    0x65, 0x63, 0x75, 0x72, 0x65, 0x68, 0x74, 0x74, 0x70, 0x73, 0x65, 0x72,
+    0x76, 0x65, 0x72, 0x2e, 0x6c, 0x6f, 0x63, 0x61, 0x6c, 0x30, 0x59, 0x30,
+    0x13, 0x06, 0x07, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x02, 0x01, 0x06, 0x08,
+    0x2a, 0x86, 0x48, 0xce, 0x3d, 0x03, 0x01, 0x07, 0x03, 0x42, 0x00, 0x04,
+    0x1c, 0x85, 0x65, 0x1f, 0x0f, 0x6f, 0x08, 0x79, 0xc6, 0x8b, 0x88, 0x8b,
+    0x6d, 0x00, 0x5d, 0xf0, 0xf1, 0x90, 0x5e, 0x3a, 0x25, 0x4b, 0x67, 0x0f,
+    0xa9, 0xc1, 0xbc, 0x9a, 0x4f, 0xa8, 0xcc, 0x7b, 0x42, 0xf8, 0x4d, 0x76,
+    0x69, 0xf3, 0x34, 0xb3, 0x5a, 0x61, 0x5a, 0xd0, 0x13, 0x26, 0x7f, 0x72,
+    0xd5, 0x8c, 0x3c, 0xf9, 0x4c, 0x01, 0x6a, 0x92, 0x6e, 0xa7, 0x51, 0x33,
+    0x3a, 0x57, 0x8c, 0xcb, 0xa3, 0x42, 0x30, 0x40, 0x30, 0x1d, 0x06, 0x03,
+    0x55, 0x1d, 0x0e, 0x04, 0x16, 0x04, 0x14, 0x84, 0x8d, 0xfc, 0x19, 0xea,
+    0x50, 0x52, 0x6c, 0x9f, 0xaf, 0xc5, 0xca, 0x26, 0xcf, 0xb9, 0x29, 0xda,
+    0xd5, 0x91, 0x72, 0x30, 0x1f, 0x06, 0x03, 0x55, 0x1d, 0x23, 0x04, 0x18,
+    0x30, 0x16, 0x80, 0x14, 0x26, 0x60, 0xdd, 0x73, 0xe3, 0x1a, 0x05, 0x8f,
+    0xf9, 0x0f, 0x00, 0xb1, 0x5b, 0x02, 0xf7, 0x0a, 0xe5, 0x98, 0x0f, 0x2b,
+    0x30, 0x0a, 0x06, 0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x04, 0x03, 0x02,
+    0x03, 0x48, 0x00, 0x30, 0x45, 0x02, 0x20, 0x6f, 0x2a, 0x68, 0x04, 0x8f,
+    0xa0, 0x2c, 0x10, 0x3b, 0xb0, 0x6d, 0xfb, 0xc0, 0x70, 0xa9, 0xb8, 0x43,
+    0x36, 0x5c, 0x6c, 0x17, 0xd2, 0x93, 0x09, 0xc4, 0x18, 0x5c, 0x06, 0x92,
+    0x94, 0x07, 0x53, 0x02, 0x21, 0x00, 0xbc, 0xd0, 0xb6, 0x64, 0x24, 0x01,
+    0x90, 0xe3, 0xda, 0x23, 0x2e, 0xf4, 0xb0, 0xde, 0x1c, 0x9a, 0x0f, 0x6c,
+    0x74, 0x22, 0x6a, 0x98, 0x6b, 0x6e, 0xc0, 0xca, 0x6c, 0x47, 0xc7, 0xc0,
+    0x89, 0x62,
+};
+
+/* keySERVER_PRIVATE_KEY_PEM */
+const uint8_t keySERVER_PRIVATE_KEY_DER[keySERVER_PRIVATE_KEY_DER_SZ] = {
+    0x30, 0x77, 0x02, 0x01, 0x01, 0x04, 0x20, 0x22, 0x17, 0x26, 0xf4, 0x9f,
+    0x70, 0x7d, 0x64, 0x1e, 0x68, 0xe6, 0xec, 0x49, 0x63, 0x46, 0xc2, 0xfa,
+    0x91, 0x3c, 0xbe, 0xa3, 0x84, 0xdb, 0x3d, 0x12, 0x48, 0x09, 0xdc, 0x6a,
+    0xaf, 0x2e, 0xac, 0xa0, 0x0a, 0x06, 0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d,
+    0x03, 0x01, 0x07, 0xa1, 0x44, 0x03, 0x42, 0x00, 0x04, 0x1c, 0x85, 0x65,
+    0x1f, 0x0f, 0x6f, 0x08, 0x79, 0xc6, 0x8b, 0x88, 0x8b, 0x6d, 0x00, 0x5d,
+    0xf0, 0xf1, 0x90, 0x5e, 0x3a, 0x25, 0x4b, 0x67, 0x0f, 0xa9, 0xc1, 0xbc,
+    0x9a, 0x4f, 0xa8, 0xcc, 0x7b, 0x42, 0xf8, 0x4d, 0x76, 0x69, 0xf3, 0x34,
+    0xb3, 0x5a, 0x61, 0x5a, 0xd0, 0x13, 0x26, 0x7f, 0x72, 0xd5, 0x8c, 0x3c,
+    0xf9, 0x4c, 0x01, 0x6a, 0x92, 0x6e, 0xa7, 0x51, 0x33, 0x3a, 0x57, 0x8c,
+    0xcb,
+};
+
+/* keyCLIENT_ROOTCA_PEM */
+const uint8_t keyCLIENT_ROOTCA_DER[keyCLIENT_ROOTCA_DER_SZ] = {
+    0x30, 0x82, 0x02, 0x42, 0x30, 0x82, 0x01, 0xe9, 0xa0, 0x03, 0x02, 0x01,
+    0x02, 0x02, 0x14, 0x6b, 0x0e, 0x1b, 0xa7, 0x56, 0x9f, 0x0c, 0xeb, 0x6d,
+    0x31, 0xe5, 0x25, 0xb8, 0x4c, 0x43, 0x12, 0x4c, 0x7a, 0xe5, 0xd3, 0x30,
+    0x0a, 0x06, 0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x04, 0x03, 0x02, 0x30,
+    0x77, 0x31, 0x0b, 0x30, 0x09, 0x06, 0x03, 0x55, 0x04, 0x06, 0x13, 0x02,
+    0x55, 0x53, 0x31, 0x10, 0x30, 0x0e, 0x06, 0x03, 0x55, 0x04, 0x08, 0x0c,
+    0x07, 0x4d, 0x6f, 0x6e, 0x74, 0x61, 0x6e, 0x61, 0x31, 0x10, 0x30, 0x0e,
+    0x06, 0x03, 0x55, 0x04, 0x07, 0x0c, 0x07, 0x42, 0x6f, 0x7a, 0x65, 0x6d,
+    0x61, 0x6e, 0x31, 0x0b, 0x30, 0x09, 0x06, 0x03, 0x55, 0x04, 0x0a, 0x0c,
+    0x02, 0x43, 0x59, 0x31, 0x14, 0x30, 0x12, 0x06, 0x03, 0x55, 0x04, 0x0b,
+    0x0c, 0x0b, 0x45, 0x6e, 0x67, 0x69, 0x6e, 0x65, 0x65, 0x72, 0x69, 0x6e,
+    0x67, 0x31, 0x21, 0x30, 0x1f, 0x06, 0x03, 0x55, 0x04, 0x03, 0x0c, 0x18,
+    0x6d, 0x79, 0x73, 0x65, 0x63, 0x75, 0x72, 0x65, 0x68, 0x74, 0x74, 0x70,
+    0x73, 0x65, 0x72, 0x76, 0x65, 0x72, 0x2e, 0x6c, 0x6f, 0x63, 0x61, 0x6c,
+    0x30, 0x1e, 0x17, 0x0d, 0x32, 0x34, 0x30, 0x33, 0x32, 0x31, 0x30, 0x30,
+    0x34, 0x39, 0x35, 0x36, 0x5a, 0x17, 0x0d, 0x32, 0x34, 0x30, 0x34, 0x32,
+    0x30, 0x30, 0x30, 0x34, 0x39, 0x35, 0x36, 0x5a, 0x30, 0x77, 0x31, 0x0b,
+    0x30, 0x09, 0x06, 0x03, 0x55, 0x04, 0x06, 0x13, 0x02, 0x55, 0x53, 0x31,
+    0x10, 0x30, 0x0e, 0x06, 0x03, 0x55, 0x04, 0x08, 0x0c, 0x07, 0x4d, 0x6f,
+    0x6e, 0x74, 0x61, 0x6e, 0x61, 0x31, 0x10, 0x30, 0x0e, 0x06, 0x03, 0x55,
+    0x04, 0x07, 0x0c, 0x07, 0x42, 0x6f, 0x7a, 0x65, 0x6d, 0x61, 0x6e, 0x31,
+    0x0b, 0x30, 0x09, 0x06, 0x03, 0x55, 0x04, 0x0a, 0x0c, 0x02, 0x43, 0x59,
+    0x31, 0x14, 0x30, 0x12, 0x06, 0x03, 0x55, 0x04, 0x0b, 0x0c, 0x0b, 0x45,
+    0x6e, 0x67, 0x69, 0x6e, 0x65, 0x65, 0x72, 0x69, 0x6e, 0x67, 0x31, 0x21,
+    0x30, 0x1f, 0x06, 0x03, 0x55, 0x04, 0x03, 0x0c, 0x18, 0x6d, 0x79, 0x73,
+    0x65, 0x63, 0x75, 0x72, 0x65, 0x68, 0x74, 0x74, 0x70, 0x73, 0x65, 0x72,
+    0x76, 0x65, 0x72, 0x2e, 0x6c, 0x6f, 0x63, 0x61, 0x6c, 0x30, 0x59, 0x30,
+    0x13, 0x06, 0x07, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x02, 0x01, 0x06, 0x08,
+    0x2a, 0x86, 0x48, 0xce, 0x3d, 0x03, 0x01, 0x07, 0x03, 0x42, 0x00, 0x04,
+    0xc3, 0x8b, 0xed, 0x40, 0x58, 0xb4, 0x39, 0x49, 0x98, 0xeb, 0x83, 0x62,
+    0x63, 0x14, 0xfa, 0x0e, 0x6f, 0x74, 0x52, 0x34, 0x66, 0xe7, 0xc7, 0xa0,
+    0x7c, 0xf4, 0xf6, 0x3c, 0x6a, 0x52, 0x34, 0x55, 0x0c, 0x8d, 0x52, 0x9e,
+    0x8b, 0x6a, 0x8b, 0x0f, 0xb5, 0x18, 0x76, 0x02, 0x30, 0x70, 0x6f, 0x78,
+    0x84, 0x20, 0x31, 0x7a, 0xc2, 0x4c, 0xe1, 0xce, 0x7f, 0x2f, 0xc3, 0xc9,
+    0xe0, 0x69, 0x9f, 0x17, 0xa3, 0x53, 0x30, 0x51, 0x30, 0x1d, 0x06, 0x03,
+    0x55, 0x1d, 0x0e, 0x04, 0x16, 0x04, 0x14, 0x26, 0x60, 0xdd, 0x73, 0xe3,
+    0x1a, 0x05, 0x8f, 0xf9, 0x0f, 0x00, 0xb1, 0x5b, 0x02, 0xf7, 0x0a, 0xe5,
+    0x98, 0x0f, 0x2b, 0x30, 0x1f, 0x06, 0x03, 0x55, 0x1d, 0x23, 0x04, 0x18,
+    0x30, 0x16, 0x80, 0x14, 0x26, 0x60, 0xdd, 0x73, 0xe3, 0x1a, 0x05, 0x8f,
+    0xf9, 0x0f, 0x00, 0xb1, 0x5b, 0x02, 0xf7, 0x0a, 0xe5, 0x98, 0x0f, 0x2b,
+    0x30, 0x0f, 0x06, 0x03, 0x55, 0x1d, 0x13, 0x01, 0x01, 0xff, 0x04, 0x05,
+    0x30, 0x03, 0x01, 0x01, 0xff, 0x30, 0x0a, 0x06, 0x08, 0x2a, 0x86, 0x48,
+    0xce, 0x3d, 0x04, 0x03, 0x02, 0x03, 0x47, 0x00, 0x30, 0x44, 0x02, 0x20,
+    0x16, 0x6d, 0xec, 0x17, 0x17, 0xcd, 0x5d, 0x75, 0x0a, 0xea, 0xd9, 0xae,
+    0x3d, 0x82, 0x51, 0xb0, 0x73, 0xea, 0xae, 0x14, 0x2f, 0xde, 0x8b, 0x27,
+    0x79, 0x60, 0xfe, 0x16, 0xff, 0xc4, 0x04, 0x4b, 0x02, 0x20, 0x46, 0xd9,
+    0xa2, 0xb7, 0x5f, 0x67, 0xb8, 0xbb, 0x17, 0x19, 0xd6, 0x12, 0x55, 0x20,
+    0x44, 0xab, 0x88, 0xc6, 0x40, 0x1a, 0x01, 0xbc, 0x93, 0x5f, 0x52, 0x86,
+    0xbb, 0xc6, 0x64, 0x48, 0xd8, 0xc6,
+};
+
+/* [] END OF FILE */
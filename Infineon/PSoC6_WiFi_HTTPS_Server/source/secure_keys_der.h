@@ -0,0 +1,73 @@
+/******************************************************************************
+* File Name: secure_keys_der.h
+*
+* Description: DER encoded certificates and keys of secure_keys.h.
+*
+* Generated by generate_secure_keys.py from secure_keys.h, do not edit.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef SECURE_KEYS_DER_H_
+#define SECURE_KEYS_DER_H_
+
+#include <stdint.h>
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* keySERVER_CERTIFICATE_PEM: CERTIFICATE */
+#define keySERVER_CERTIFICATE_DER_SZ (566)
+
+/* keySERVER_PRIVATE_KEY_PEM: EC PRIVATE KEY */
+#define keySERVER_PRIVATE_KEY_DER_SZ (121)
+
+/* keyCLIENT_ROOTCA_PEM: CERTIFICATE */
+#define keyCLIENT_ROOTCA_DER_SZ (582)
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+extern const uint8_t keySERVER_CERTIFICATE_DER[keySERVER_CERTIFICATE_DER_SZ];
+extern const uint8_t keySERVER_PRIVATE_KEY_DER[keySERVER_PRIVATE_KEY_DER_SZ];
+extern const uint8_t keyCLIENT_ROOTCA_DER[keyCLIENT_ROOTCA_DER_SZ];
+
+#endif /* SECURE_KEYS_DER_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,350 @@
+/******************************************************************************
+* File Name: tls_crypto.c
+*
+* Description: This file contains the wolfCrypt callback device used by the
+*              TLS server. The secure-sockets layer owns the wolfSSL context,
+*              so the server key operations are reached through
+*              WOLF_CRYPTO_CB_FIND: it counts the handshakes and signs with
+*              the TLS server key in software or in the TPM.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+
+#include "tls_crypto.h"
+
+#ifdef TLS_CRYPTO_CB
+
+#include <wolfssl/wolfcrypt/settings.h>
+#include <wolfssl/wolfcrypt/ecc.h>
+#include <wolfssl/wolfcrypt/cryptocb.h>
+#include <wolfssl/wolfcrypt/error-crypt.h>
+
+#include "perf_stats.h"
+#include "tpm_dev.h"
+#ifdef SERVER_KEYS_DER
+#include "secure_keys_der.h"
+#else
+#include "secure_keys.h"
+#endif
+
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static WOLFTPM2_DEV* mTpmDev;
+static WOLFTPM2_KEY mTlsTpmKey;
+static int mTlsTpmKeyLoaded;
+static int mTlsPolicy = TLS_KEY_POLICY;
+
+/* Server key operations: every TLS v1.3 handshake runs ECDHE, only a full
+ * one signs the CertificateVerify with the server key */
+static uint32_t mEcdhCount;
+static perf_hist_t mSignSw;
+static perf_hist_t mSignTpm;
+static uint32_t mSignFallback;   /* TPM busy or failed, signed in software */
+
+
+/*******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+static const char* tls_crypto_policy_str(int policy)
+{
+    switch (policy) {
+        case TLS_KEY_POLICY_TPM:
+            return "tpm";
+        case TLS_KEY_POLICY_TPM_FALLBACK:
+            return "tpm-fallback";
+        default:
+            return "sw";
+    }
+}
+
+/* Public key operations of keys with INVALID_DEVID are offered to this
+ * device. The hashes, ciphers and RNG of the records stay off the
+ * callback, and so does the software sign the callback runs itself (its
+ * key is on TLS_CRYPTO_SW_DEVID meanwhile). */
+static int tls_crypto_find_cb(int devId, int algoType)
+{
+    if (devId == INVALID_DEVID && algoType == WC_ALGO_TYPE_PK)
+        return TLS_CRYPTO_DEVID;
+    return devId;
+}
+
+#if TLS_KEY_POLICY != TLS_KEY_POLICY_SW
+/* Reads the TLS server key from its persistent handle, importing the key
+ * from secure_keys.h on the first boot so it matches the certificate */
+static int tls_crypto_load_tpm_key(WOLFTPM2_DEV* dev)
+{
+    int rc;
+    WOLFTPM2_KEY srk;
+    WOLFTPM2_KEYBLOB blob;
+
+    rc = wolfTPM2_ReadPublicKey(dev, &mTlsTpmKey, TLS_TPM_KEY_HANDLE);
+    if (rc == TPM_RC_SUCCESS)
+        return rc;
+
+    printf("Importing the TLS server key into the TPM (0x%x)\n",
+        TLS_TPM_KEY_HANDLE);
+    memset(&srk, 0, sizeof(srk));
+    memset(&blob, 0, sizeof(blob));
+    rc = wolfTPM2_CreateSRK(dev, &srk, TPM_ALG_ECC, NULL, 0);
+    if (rc == TPM_RC_SUCCESS) {
+    #ifdef SERVER_KEYS_DER
+        rc = wolfTPM2_ImportPrivateKeyBuffer(dev, &srk, TPM_ALG_ECC, &blob,
+            ENCODING_TYPE_ASN1, (const char*)keySERVER_PRIVATE_KEY_DER,
+            keySERVER_PRIVATE_KEY_DER_SZ, NULL,
+            TPMA_OBJECT_sign | TPMA_OBJECT_userWithAuth | TPMA_OBJECT_noDA,
+            NULL, 0);
+    #else
+        rc = wolfTPM2_ImportPrivateKeyBuffer(dev, &srk, TPM_ALG_ECC, &blob,
+            ENCODING_TYPE_PEM, keySERVER_PRIVATE_KEY_PEM,
+            sizeof(keySERVER_PRIVATE_KEY_PEM) - 1, NULL,
+            TPMA_OBJECT_sign | TPMA_OBJECT_userWithAuth | TPMA_OBJECT_noDA,
+            NULL, 0);
+    #endif
+    }
+    if (rc == TPM_RC_SUCCESS) {
+        rc = wolfTPM2_LoadKey(dev, &blob, &srk.handle);
+    }
+    if (rc == TPM_RC_SUCCESS) {
+        rc = wolfTPM2_NVStoreKey(dev, TPM_RH_OWNER, (WOLFTPM2_KEY*)&blob,
+            TLS_TPM_KEY_HANDLE);
+        if (rc != TPM_RC_SUCCESS)
+            wolfTPM2_UnloadHandle(dev, &blob.handle);
+    }
+    wolfTPM2_UnloadHandle(dev, &srk.handle);
+    if (rc == TPM_RC_SUCCESS) {
+        rc = wolfTPM2_ReadPublicKey(dev, &mTlsTpmKey, TLS_TPM_KEY_HANDLE);
+    }
+    return rc;
+}
+
+/* the TPM key signs only for the key of the server certificate */
+static int tls_crypto_is_tpm_key(ecc_key* key)
+{
+    byte qx[MAX_ECC_BYTES], qy[MAX_ECC_BYTES];
+    word32 qxSz = sizeof(qx), qySz = sizeof(qy);
+    const TPM2B_ECC_PARAMETER* x = &mTlsTpmKey.pub.publicArea.unique.ecc.x;
+
+    if (!mTlsTpmKeyLoaded ||
+            wc_ecc_export_public_raw(key, qx, &qxSz, qy, &qySz) != 0)
+        return 0;
+    return (qxSz == x->size && memcmp(qx, x->buffer, qxSz) == 0);
+}
+
+static int tls_crypto_tpm_sign(const byte* in, word32 inlen, byte* out,
+    word32* outlen)
+{
+    int rc;
+    byte sig[2 * MAX_ECC_BYTES];
+    int sigSz = (int)sizeof(sig);
+    word32 keySz = mTlsTpmKey.pub.publicArea.unique.ecc.x.size;
+
+    /* ECDSA signs the leftmost key size bytes of a longer hash */
+    if (inlen > keySz)
+        inlen = keySz;
+    TPM2_IFX_DevLock(0);
+    rc = wolfTPM2_SignHash(mTpmDev, &mTlsTpmKey, in, (int)inlen, sig, &sigSz);
+    TPM2_IFX_DevUnlock();
+    if (rc == TPM_RC_SUCCESS) {
+        rc = wc_ecc_rs_raw_to_sig(sig, sigSz / 2, sig + sigSz / 2, sigSz / 2,
+            out, outlen);
+    }
+    return rc;
+}
+#endif /* TLS_KEY_POLICY != TLS_KEY_POLICY_SW */
+
+static int tls_crypto_ecc_sign(wc_CryptoInfo* info)
+{
+    int rc = CRYPTOCB_UNAVAILABLE;
+    uint32_t start = perf_cycles();
+
+#if TLS_KEY_POLICY != TLS_KEY_POLICY_SW
+    if (mTlsPolicy != TLS_KEY_POLICY_SW &&
+            tls_crypto_is_tpm_key(info->pk.eccsign.key)) {
+        if (TPM2_IFX_GetOwner() != TPM_OWNER_NONE) {
+            /* firmware update or benchmark running */
+            rc = WC_HW_E;
+        }
+        else {
+            rc = tls_crypto_tpm_sign(info->pk.eccsign.in,
+                info->pk.eccsign.inlen, info->pk.eccsign.out,
+                info->pk.eccsign.outlen);
+            if (rc == TPM_RC_SUCCESS) {
+                perf_hist_add(&mSignTpm, perf_cycles() - start);
+                return rc;
+            }
+            printf("TLS TPM sign failed 0x%x: %s\n", rc, TPM2_GetRCString(rc));
+            rc = WC_HW_E;
+        }
+        if (mTlsPolicy == TLS_KEY_POLICY_TPM)
+            return rc;
+        mSignFallback++;
+        start = perf_cycles();
+    }
+#endif
+
+    rc = wc_ecc_sign_hash(info->pk.eccsign.in, info->pk.eccsign.inlen,
+        info->pk.eccsign.out, info->pk.eccsign.outlen, info->pk.eccsign.rng,
+        info->pk.eccsign.key);
+    if (rc == 0)
+        perf_hist_add(&mSignSw, perf_cycles() - start);
+    return rc;
+}
+
+static int tls_crypto_cb(int devId, wc_CryptoInfo* info, void* ctx)
+{
+    int rc = CRYPTOCB_UNAVAILABLE;
+    (void)devId;
+    (void)ctx;
+
+    if (info->algo_type != WC_ALGO_TYPE_PK)
+        return rc;
+
+    if (info->pk.type == WC_PK_TYPE_ECDH) {
+        mEcdhCount++;
+    }
+    else if (info->pk.type == WC_PK_TYPE_ECDSA_SIGN) {
+        /* the key belongs to the calling task, its device id marks the
+         * nested software sign */
+        ecc_key* key = info->pk.eccsign.key;
+        int keyDevId = key->devId;
+
+        key->devId = TLS_CRYPTO_SW_DEVID;
+        rc = tls_crypto_ecc_sign(info);
+        key->devId = keyDevId;
+    }
+    return rc;
+}
+
+static char* tls_crypto_report_sign(char* out, size_t outSz,
+    const char* name, const perf_hist_t* hist)
+{
+    snprintf(out, outSz,
+        "Sign %s: %lu, avg %lu us, p50 %lu us, p99 %lu us, max %lu us\r\n",
+        name, (unsigned long)hist->count,
+        (unsigned long)(hist->count ?
+            perf_cycles_to_us(hist->sum) / hist->count : 0),
+        (unsigned long)perf_cycles_to_us(perf_hist_percentile(hist, 50)),
+        (unsigned long)perf_cycles_to_us(perf_hist_percentile(hist, 99)),
+        (unsigned long)perf_cycles_to_us(hist->max));
+    return out + strlen(out);
+}
+
+
+/*******************************************************************************
+ * Public Functions
+ ******************************************************************************/
+/* Registers the callback device. With a TPM policy, also loads (or on the
+ * first boot imports) the TLS server key in the TPM, dev is TPM device 0. */
+int tls_crypto_init(WOLFTPM2_DEV* dev)
+{
+    int rc;
+
+    mTpmDev = dev;
+#if TLS_KEY_POLICY != TLS_KEY_POLICY_SW
+    TPM2_IFX_DevLock(0);
+    rc = tls_crypto_load_tpm_key(dev);
+    TPM2_IFX_DevUnlock();
+    if (rc == TPM_RC_SUCCESS) {
+        mTlsTpmKeyLoaded = 1;
+    }
+    else {
+        printf("TLS server key not in the TPM 0x%x: %s, signing in software\n",
+            rc, TPM2_GetRCString(rc));
+        mTlsPolicy = TLS_KEY_POLICY_SW;
+    }
+#endif
+
+    rc = wc_CryptoCb_RegisterDevice(TLS_CRYPTO_DEVID, tls_crypto_cb, NULL);
+    if (rc == 0) {
+        wc_CryptoCb_SetDeviceFindCb(tls_crypto_find_cb);
+    }
+    printf("TLS server key policy: %s\n", tls_crypto_policy_str(mTlsPolicy));
+    return rc;
+}
+
+/* Selects the signing policy for the next handshakes, the TPM policies
+ * need the TPM key loaded */
+int tls_crypto_set_policy(int policy)
+{
+    if (policy < TLS_KEY_POLICY_SW || policy > TLS_KEY_POLICY_TPM_FALLBACK)
+        return BAD_FUNC_ARG;
+    if (policy != TLS_KEY_POLICY_SW && !mTlsTpmKeyLoaded)
+        return BAD_FUNC_ARG;
+    mTlsPolicy = policy;
+    return 0;
+}
+
+int tls_crypto_get_policy(void)
+{
+    return mTlsPolicy;
+}
+
+/* The handshakes since boot: a full one (resumption miss) signs with the
+ * server key, a resumed one (hit) only runs ECDHE. TLS v1.2 session ID
+ * resumption runs no key operation and is not counted. */
+const char* tls_crypto_report(char* out, size_t outSz)
+{
+    char* p = out;
+    uint32_t sign = mSignSw.count + mSignTpm.count;
+    uint32_t resumed = (mEcdhCount > sign) ? mEcdhCount - sign : 0;
+
+    snprintf(p, outSz,
+        "TLS handshakes: %lu\r\n"
+        "Full (resumption miss): %lu\r\n"
+        "Resumed (resumption hit): %lu\r\n"
+        "Key policy: %s%s\r\n",
+        (unsigned long)(sign + resumed), (unsigned long)sign,
+        (unsigned long)resumed, tls_crypto_policy_str(mTlsPolicy),
+        mTlsTpmKeyLoaded ? " (TPM key loaded)" : "");
+    p += strlen(p);
+    p = tls_crypto_report_sign(p, outSz - (size_t)(p - out), "TPM",
+        &mSignTpm);
+    p = tls_crypto_report_sign(p, outSz - (size_t)(p - out), "software",
+        &mSignSw);
+    snprintf(p, outSz - (size_t)(p - out), "Sign fallback: %lu\r\n",
+        (unsigned long)mSignFallback);
+    return out;
+}
+
+#endif /* TLS_CRYPTO_CB */
+
+/* [] END OF FILE */
@@ -0,0 +1,91 @@
+/******************************************************************************
+* File Name: tls_crypto.h
+*
+* Description: This file contains the wolfCrypt callback device used by the
+* TLS server: the handshake statistics and the TLS server key signing policy
+* (software or TPM).
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef TLS_CRYPTO_H_
+#define TLS_CRYPTO_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <wolftpm/tpm2_wrap.h>
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* TLS server key signing policy (TLS_KEY_POLICY) */
+#define TLS_KEY_POLICY_SW           (0) /* software, key from secure_keys.h */
+#define TLS_KEY_POLICY_TPM          (1) /* TPM only */
+#define TLS_KEY_POLICY_TPM_FALLBACK (2) /* TPM, software while TPM is busy */
+
+/* The callback device is used for the handshake statistics and to sign
+ * with the TPM. Keep in sync with WOLF_CRYPTO_CB_FIND in user_settings.h. */
+#if defined(TLS_SESSION_STATS) || defined(TLS_KEY_POLICY)
+    #define TLS_CRYPTO_CB
+#endif
+
+#ifndef TLS_KEY_POLICY
+#define TLS_KEY_POLICY              TLS_KEY_POLICY_SW
+#endif
+
+/* Persistent handle of the TLS server key in the TPM (owner hierarchy) */
+#ifndef TLS_TPM_KEY_HANDLE
+#define TLS_TPM_KEY_HANDLE          (0x81000200)
+#endif
+
+/* wolfCrypt callback device id, and an unregistered one that runs the
+ * operations of a key in software */
+#define TLS_CRYPTO_DEVID            (0x544C5343) /* "TLSC" */
+#define TLS_CRYPTO_SW_DEVID         (0x544C5357) /* "TLSW" */
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+int tls_crypto_init(WOLFTPM2_DEV* dev);
+int tls_crypto_set_policy(int policy);
+int tls_crypto_get_policy(void);
+const char* tls_crypto_report(char* out, size_t outSz);
+
+#endif /* TLS_CRYPTO_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,326 @@
+/******************************************************************************
+* File Name: tls_heap.c
+*
+* Description: This file contains the fixed-block memory pool used for the
+*              wolfSSL and wolfCrypt allocations (wolfSSL_SetAllocators).
+*              Each bucket is a free list of equal blocks in a static arena,
+*              so allocating and freeing are O(1) and TLS handshakes do not
+*              fragment the newlib heap that lwIP pbufs and the firmware
+*              update buffers use. The allocation profile (peak blocks in
+*              use per bucket and per request size) is kept to size the
+*              buckets.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+/* MAX_SOCKETS, the TLS input buffers of the pool */
+#include "lwip/opt.h"
+#include "secure_http_server.h"
+#include "tls_heap.h"
+
+#ifdef TLS_HEAP_POOL
+
+#include <wolfssl/wolfcrypt/settings.h>
+#include <wolfssl/wolfcrypt/memory.h>
+
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* every block starts with its header, keeping the memory 8 byte aligned */
+#define TLS_HEAP_HDR_SZ             (8)
+#define TLS_HEAP_FROM_HEAP          (0xFF)
+
+#define TLS_HEAP_BUCKET_BYTES(size, count) \
+    + (((size) + TLS_HEAP_HDR_SZ) * (count))
+#define TLS_HEAP_BUCKET_CFG(size, count) { (size), (count) },
+
+#define TLS_HEAP_ARENA_SZ           (0 TLS_HEAP_BUCKETS(TLS_HEAP_BUCKET_BYTES))
+#define TLS_HEAP_NBUCKETS \
+    (sizeof(mBucketCfg) / sizeof(mBucketCfg[0]))
+
+
+/*******************************************************************************
+ * Data Types
+ ******************************************************************************/
+typedef struct {
+    uint32_t bucket;    /* index, or TLS_HEAP_FROM_HEAP */
+    uint32_t size;      /* requested */
+} tls_heap_hdr_t;
+
+typedef struct tls_heap_block {
+    struct tls_heap_block* next;
+} tls_heap_block_t;
+
+typedef struct {
+    uint32_t size;
+    uint32_t count;
+} tls_heap_cfg_t;
+
+typedef struct {
+    tls_heap_block_t* free;
+    uint16_t used;
+    uint16_t peak;
+    uint32_t spill;     /* taken while the smaller buckets were full */
+} tls_heap_bucket_t;
+
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static const tls_heap_cfg_t mBucketCfg[] = {
+    TLS_HEAP_BUCKETS(TLS_HEAP_BUCKET_CFG)
+};
+static tls_heap_bucket_t mBucket[TLS_HEAP_NBUCKETS];
+static uint64_t mArena[(TLS_HEAP_ARENA_SZ + 7) / 8];
+
+static uint32_t mFallback;      /* allocations from the newlib heap */
+static uint32_t mFailed;
+static uint32_t mHeapUsed, mHeapPeak;
+
+/* allocation profile: blocks in use by request size (power of two) */
+static uint16_t mClassUsed[TLS_HEAP_SIZE_CLASSES];
+static uint16_t mClassPeak[TLS_HEAP_SIZE_CLASSES];
+
+
+/*******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+/* the pool is used before the scheduler starts (TPM init) */
+static void tls_heap_lock(void)
+{
+    if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED)
+        taskENTER_CRITICAL();
+}
+static void tls_heap_unlock(void)
+{
+    if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED)
+        taskEXIT_CRITICAL();
+}
+
+static uint32_t tls_heap_class(size_t size)
+{
+    uint32_t c = 0;
+    while (c + 1 < TLS_HEAP_SIZE_CLASSES && ((size_t)1 << c) < size)
+        c++;
+    return c;
+}
+
+static void* tls_heap_malloc(size_t size)
+{
+    tls_heap_hdr_t* hdr = NULL;
+    uint32_t i, c = tls_heap_class(size);
+    int spill = 0;
+
+    tls_heap_lock();
+    for (i = 0; i < TLS_HEAP_NBUCKETS; i++) {
+        tls_heap_bucket_t* b = &mBucket[i];
+        if (size > mBucketCfg[i].size)
+            continue;
+        if (b->free == NULL) {
+            spill = 1;
+            continue;
+        }
+        hdr = (tls_heap_hdr_t*)b->free;
+        b->free = b->free->next;
+        if (++b->used > b->peak)
+            b->peak = b->used;
+        if (spill)
+            b->spill++;
+        hdr->bucket = i;
+        break;
+    }
+    if (hdr != NULL) {
+        hdr->size = (uint32_t)size;
+        if (++mClassUsed[c] > mClassPeak[c])
+            mClassPeak[c] = mClassUsed[c];
+    }
+    tls_heap_unlock();
+
+#if TLS_HEAP_FALLBACK
+    if (hdr == NULL) {
+        hdr = (tls_heap_hdr_t*)malloc(TLS_HEAP_HDR_SZ + size);
+        tls_heap_lock();
+        if (hdr != NULL) {
+            hdr->bucket = TLS_HEAP_FROM_HEAP;
+            hdr->size = (uint32_t)size;
+            mFallback++;
+            mHeapUsed += (uint32_t)size;
+            if (mHeapUsed > mHeapPeak)
+                mHeapPeak = mHeapUsed;
+            if (++mClassUsed[c] > mClassPeak[c])
+                mClassPeak[c] = mClassUsed[c];
+        }
+        tls_heap_unlock();
+    }
+#endif
+    if (hdr == NULL) {
+        tls_heap_lock();
+        mFailed++;
+        tls_heap_unlock();
+        return NULL;
+    }
+    return (uint8_t*)hdr + TLS_HEAP_HDR_SZ;
+}
+
+static void tls_heap_free(void* ptr)
+{
+    tls_heap_hdr_t* hdr;
+    tls_heap_bucket_t* b;
+    uint32_t c;
+
+    if (ptr == NULL)
+        return;
+    hdr = (tls_heap_hdr_t*)((uint8_t*)ptr - TLS_HEAP_HDR_SZ);
+    c = tls_heap_class(hdr->size);
+
+    tls_heap_lock();
+    mClassUsed[c]--;
+    if (hdr->bucket == TLS_HEAP_FROM_HEAP) {
+        mHeapUsed -= hdr->size;
+        tls_heap_unlock();
+        free(hdr);
+        return;
+    }
+    /* the free list link overwrites the header */
+    b = &mBucket[hdr->bucket];
+    ((tls_heap_block_t*)hdr)->next = b->free;
+    b->free = (tls_heap_block_t*)hdr;
+    b->used--;
+    tls_heap_unlock();
+}
+
+static void* tls_heap_realloc(void* ptr, size_t size)
+{
+    tls_heap_hdr_t* hdr;
+    void* newPtr;
+
+    if (ptr == NULL)
+        return tls_heap_malloc(size);
+    if (size == 0) {
+        tls_heap_free(ptr);
+        return NULL;
+    }
+    hdr = (tls_heap_hdr_t*)((uint8_t*)ptr - TLS_HEAP_HDR_SZ);
+    /* keep a pool block it still fits */
+    if (hdr->bucket != TLS_HEAP_FROM_HEAP &&
+            size <= mBucketCfg[hdr->bucket].size) {
+        uint32_t from = tls_heap_class(hdr->size), to = tls_heap_class(size);
+        tls_heap_lock();
+        mClassUsed[from]--;
+        if (++mClassUsed[to] > mClassPeak[to])
+            mClassPeak[to] = mClassUsed[to];
+        hdr->size = (uint32_t)size;
+        tls_heap_unlock();
+        return ptr;
+    }
+    newPtr = tls_heap_malloc(size);
+    if (newPtr != NULL) {
+        memcpy(newPtr, ptr, (hdr->size < size) ? hdr->size : size);
+        tls_heap_free(ptr);
+    }
+    return newPtr;
+}
+
+
+/*******************************************************************************
+ * Public Functions
+ ******************************************************************************/
+/* Builds the free lists and sets the wolfSSL allocators, call before the
+ * first wolfSSL or wolfCrypt allocation (before the TPM init) */
+int tls_heap_init(void)
+{
+    uint8_t* p = (uint8_t*)mArena;
+    uint32_t i, n;
+
+    for (i = 0; i < TLS_HEAP_NBUCKETS; i++) {
+        mBucket[i].free = NULL;
+        for (n = 0; n < mBucketCfg[i].count; n++) {
+            ((tls_heap_block_t*)p)->next = mBucket[i].free;
+            mBucket[i].free = (tls_heap_block_t*)p;
+            p += TLS_HEAP_HDR_SZ + mBucketCfg[i].size;
+        }
+    }
+    return wolfSSL_SetAllocators(tls_heap_malloc, tls_heap_free,
+        tls_heap_realloc);
+}
+
+/* Blocks in use and peaks per bucket, the newlib heap fallback and the
+ * peak allocations per request size */
+const char* tls_heap_report(char* out, size_t outSz)
+{
+    size_t len;
+    uint32_t i;
+
+    snprintf(out, outSz, "TLS heap pool: %lu bytes\r\n",
+        (unsigned long)sizeof(mArena));
+    for (i = 0; i < TLS_HEAP_NBUCKETS; i++) {
+        len = strlen(out);
+        snprintf(out + len, outSz - len,
+            "%6lu: %u/%lu in use, peak %u, spill %lu\r\n",
+            (unsigned long)mBucketCfg[i].size, mBucket[i].used,
+            (unsigned long)mBucketCfg[i].count, mBucket[i].peak,
+            (unsigned long)mBucket[i].spill);
+    }
+    len = strlen(out);
+    snprintf(out + len, outSz - len,
+        "Heap fallback: %lu (%lu bytes in use, peak %lu), failed %lu\r\n"
+        "Peak by size:",
+        (unsigned long)mFallback, (unsigned long)mHeapUsed,
+        (unsigned long)mHeapPeak, (unsigned long)mFailed);
+    for (i = 0; i < TLS_HEAP_SIZE_CLASSES; i++) {
+        if (mClassPeak[i] == 0)
+            continue;
+        len = strlen(out);
+        snprintf(out + len, outSz - len, " <=%lu:%u",
+            (unsigned long)(1UL << i), mClassPeak[i]);
+    }
+    len = strlen(out);
+    snprintf(out + len, outSz - len, "\r\n");
+    return out;
+}
+
+#endif /* TLS_HEAP_POOL */
+
+/* [] END OF FILE */
@@ -0,0 +1,90 @@
+/******************************************************************************
+* File Name: tls_heap.h
+*
+* Description: This file contains the fixed-block memory pool used for the
+* wolfSSL and wolfCrypt allocations, keeping the TLS handshakes off the
+* newlib heap shared with lwIP and the application.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef TLS_HEAP_H_
+#define TLS_HEAP_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Pool buckets as X(block size, block count), in increasing block size. An
+ * allocation takes a block of the smallest bucket it fits with one free,
+ * or the newlib heap with TLS_HEAP_FALLBACK. The largest bucket holds a
+ * TLS input buffer (a full 16 KB record) for each connection (MAX_SOCKETS,
+ * secure_http_server.h). Tune the counts from the peaks reported by
+ * tls_heap_report. */
+#ifndef TLS_HEAP_BUCKETS
+#define TLS_HEAP_BUCKETS(X) \
+    X(64, 48) \
+    X(128, 32) \
+    X(256, 32) \
+    X(512, 16) \
+    X(1024, 12) \
+    X(2048, 8) \
+    X(4096, 4) \
+    X(8192, 1) \
+    X(16896, MAX_SOCKETS)
+#endif
+
+/* Allocations that find no free block use the newlib heap (counted as
+ * fallbacks) rather than failing the handshake */
+#ifndef TLS_HEAP_FALLBACK
+#define TLS_HEAP_FALLBACK           (1)
+#endif
+
+/* Request size classes of the allocation profile, powers of two */
+#define TLS_HEAP_SIZE_CLASSES       (16)
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+int tls_heap_init(void);
+const char* tls_heap_report(char* out, size_t outSz);
+
+#endif /* TLS_HEAP_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,107 @@
+/******************************************************************************
+* File Name: tpm_dev.h
+*
+* Description: This file contains the TPM device contexts: one per TPM on
+* the bus, each with its own wolfTPM device and cached information.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef TPM_DEV_H_
+#define TPM_DEV_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <wolftpm/tpm2_wrap.h>
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Number of TPMs. Device 0 is the one the server uses (TLS key, /tpm,
+ * benchmark), a firmware update is streamed to all of them. */
+#ifndef TPM_DEV_COUNT
+#define TPM_DEV_COUNT               (1)
+#endif
+
+/* I2C addresses of devices 1 to TPM_DEV_COUNT - 1 on the TPM bus, device 0
+ * is at TPM_IO_ASYNC_I2C_ADDR (the wolfTPM HAL address) */
+#ifndef TPM_DEV_I2C_ADDRS
+#define TPM_DEV_I2C_ADDRS           0x2F, 0x30, 0x31
+#endif
+
+#if TPM_DEV_COUNT < 1 || TPM_DEV_COUNT > 8
+    #error TPM_DEV_COUNT must be 1 to 8
+#endif
+#if TPM_DEV_COUNT > 1
+    #if !defined(WOLFTPM_I2C) || !defined(TPM_IO_ASYNC)
+        #error TPM_DEV_COUNT > 1 needs WOLFTPM_I2C and TPM_IO_ASYNC
+    #endif
+    #ifdef TPM_WAIT_PIRQ
+        #error TPM_DEV_COUNT > 1 does not support TPM_WAIT_PIRQ (one PIRQ# line)
+    #endif
+#endif
+
+/*******************************************************************************
+* Data Types
+*******************************************************************************/
+/* Owner of the TPMs for a run of commands that must not be interleaved
+ * with another one (TPM2_IFX_OwnerTake). TLS server keys in the TPM are
+ * signed in software while the TPMs have an owner. */
+typedef enum {
+    TPM_OWNER_NONE = 0,
+    TPM_OWNER_FW_UPDATE,
+    TPM_OWNER_BENCH
+} tpm_owner_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+WOLFTPM2_DEV* TPM2_IFX_GetDev(int idx);
+int TPM2_IFX_DevAddr(int idx);
+int TPM2_IFX_DevInit(int idx);
+void TPM2_IFX_DevLock(int idx);
+void TPM2_IFX_DevUnlock(void);
+tpm_owner_t TPM2_IFX_OwnerTake(tpm_owner_t owner);
+void TPM2_IFX_OwnerGive(tpm_owner_t owner);
+tpm_owner_t TPM2_IFX_GetOwner(void);
+void TPM2_IFX_DevGetInfo(int idx, char* info, size_t infoSz, int* opMode);
+int TPM2_IFX_DevGetCaps(int idx, WOLFTPM2_CAPS* caps);
+void TPM2_IFX_DevRefreshInfo(int idx);
+
+#endif /* TPM_DEV_H_ */
+
+/* [] END OF FILE */
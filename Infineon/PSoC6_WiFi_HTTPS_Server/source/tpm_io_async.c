@@ -0,0 +1,239 @@
+/******************************************************************************
+* File Name: tpm_io_async.c
+*
+* Description: This file contains the interrupt driven TPM I2C/SPI transport
+*              for wolfTPM. Transfers are started with the cyhal async API
+*              (interrupt driven I2C, DMA for SPI) and the calling task
+*              waits on a semaphore given from the transfer complete
+*              interrupt, so the TLS and lwIP tasks keep the CPU while the
+*              bus is busy. Before the scheduler starts the blocking wolfTPM
+*              HAL (TPM2_IoCb) is used.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <string.h>
+
+#include "cyhal.h"
+#include "cybsp.h"
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+
+#include "tpm_io_async.h"
+
+#ifdef TPM_IO_ASYNC
+
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static SemaphoreHandle_t mXferDone;
+static StaticSemaphore_t mXferDoneBuf;
+static volatile int mXferError;
+
+#ifdef WOLFTPM_I2C
+/* register address and data of a write, valid until the transfer ends */
+static uint8_t mI2CTx[1 + MAX_COMMAND_SIZE];
+#endif
+
+
+/*******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+static void TPM2_IFX_AsyncXferDone(int error)
+{
+    BaseType_t woken = pdFALSE;
+
+    mXferError = error;
+    xSemaphoreGiveFromISR(mXferDone, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+/* waits for the transfer complete interrupt */
+static int TPM2_IFX_AsyncXferWait(void)
+{
+    if (xSemaphoreTake(mXferDone, pdMS_TO_TICKS(TPM_IO_ASYNC_TIMEOUT_MS)) !=
+            pdTRUE) {
+        return TPM_RC_FAILURE;
+    }
+    return mXferError ? TPM_RC_FAILURE : TPM_RC_SUCCESS;
+}
+
+#ifdef WOLFTPM_I2C
+static void TPM2_IFX_I2CEvent(void* arg, cyhal_i2c_event_t event)
+{
+    (void)arg;
+    TPM2_IFX_AsyncXferDone((event & CYHAL_I2C_MASTER_ERR_EVENT) != 0);
+}
+
+static int TPM2_IFX_I2CXfer(cyhal_i2c_t* i2c, uint8_t i2cAddr,
+    const uint8_t* tx, size_t txSz, uint8_t* rx, size_t rxSz)
+{
+    int rc = TPM_RC_FAILURE;
+    int tries = TPM_IO_ASYNC_I2C_TRIES;
+
+    do {
+        /* the TPM may NACK while busy, try again after a tick */
+        if (rc != TPM_RC_SUCCESS && tries != TPM_IO_ASYNC_I2C_TRIES) {
+            cyhal_i2c_abort_async(i2c);
+            vTaskDelay(1);
+        }
+        xSemaphoreTake(mXferDone, 0);
+        if (cyhal_i2c_master_transfer_async(i2c, i2cAddr,
+                tx, txSz, rx, rxSz) == CY_RSLT_SUCCESS) {
+            rc = TPM2_IFX_AsyncXferWait();
+        }
+        else {
+            rc = TPM_RC_FAILURE;
+        }
+    } while (rc != TPM_RC_SUCCESS && --tries > 0);
+    return rc;
+}
+#else
+static void TPM2_IFX_SPIEvent(void* arg, cyhal_spi_event_t event)
+{
+    (void)arg;
+    if (event & CYHAL_SPI_IRQ_DONE)
+        TPM2_IFX_AsyncXferDone(0);
+}
+#endif
+
+
+/*******************************************************************************
+ * Public Functions
+ ******************************************************************************/
+/* Registers the transfer complete interrupt of the TPM bus (mI2C/mSPI),
+ * call after it is configured */
+int TPM2_IFX_AsyncIoInit(void* bus)
+{
+    mXferDone = xSemaphoreCreateBinaryStatic(&mXferDoneBuf);
+#ifdef WOLFTPM_I2C
+    cyhal_i2c_register_callback((cyhal_i2c_t*)bus, TPM2_IFX_I2CEvent, NULL);
+    cyhal_i2c_enable_event((cyhal_i2c_t*)bus,
+        (cyhal_i2c_event_t)(CYHAL_I2C_MASTER_WR_CMPLT_EVENT |
+            CYHAL_I2C_MASTER_RD_CMPLT_EVENT | CYHAL_I2C_MASTER_ERR_EVENT),
+        TPM_IO_ASYNC_INTR_PRIORITY, true);
+#else
+    if (cyhal_spi_set_async_mode((cyhal_spi_t*)bus, CYHAL_ASYNC_DMA,
+            CYHAL_DMA_PRIORITY_DEFAULT) != CY_RSLT_SUCCESS) {
+        return TPM_RC_FAILURE;
+    }
+    cyhal_spi_register_callback((cyhal_spi_t*)bus, TPM2_IFX_SPIEvent, NULL);
+    cyhal_spi_enable_event((cyhal_spi_t*)bus, CYHAL_SPI_IRQ_DONE,
+        TPM_IO_ASYNC_INTR_PRIORITY, true);
+#endif
+    return TPM_RC_SUCCESS;
+}
+
+#ifdef WOLFTPM_ADV_IO
+/* I2C: a read writes the register address (with stop) and reads the data,
+ * a write sends the address and data in one transfer */
+static int TPM2_IFX_I2CIo(cyhal_i2c_t* i2c, uint8_t i2cAddr, INT32 isRead,
+    UINT32 addr, BYTE* buf, UINT16 size)
+{
+    int rc;
+
+    if (size > MAX_COMMAND_SIZE) {
+        return BAD_FUNC_ARG;
+    }
+
+    mI2CTx[0] = (uint8_t)(addr & 0xFF);
+    if (isRead) {
+        rc = TPM2_IFX_I2CXfer(i2c, i2cAddr, mI2CTx, 1, NULL, 0);
+        if (rc == TPM_RC_SUCCESS) {
+            rc = TPM2_IFX_I2CXfer(i2c, i2cAddr, NULL, 0, buf, size);
+        }
+    }
+    else {
+        XMEMCPY(&mI2CTx[1], buf, size);
+        rc = TPM2_IFX_I2CXfer(i2c, i2cAddr, mI2CTx, 1 + size, NULL, 0);
+    }
+    return rc;
+}
+
+int TPM2_IFX_AsyncIoCb(TPM2_CTX* ctx, INT32 isRead, UINT32 addr,
+    BYTE* buf, UINT16 size, void* userCtx)
+{
+    if (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) {
+        return TPM2_IoCb(ctx, isRead, addr, buf, size, userCtx);
+    }
+    return TPM2_IFX_I2CIo((cyhal_i2c_t*)userCtx, TPM_IO_ASYNC_I2C_ADDR,
+        isRead, addr, buf, size);
+}
+
+/* A TPM at another address (userCtx is a tpm_io_i2c_dev_t). The polled
+ * wolfTPM HAL only knows TPM_IO_ASYNC_I2C_ADDR, so these run once the
+ * scheduler has started. */
+int TPM2_IFX_AsyncIoDevCb(TPM2_CTX* ctx, INT32 isRead, UINT32 addr,
+    BYTE* buf, UINT16 size, void* userCtx)
+{
+    const tpm_io_i2c_dev_t* dev = (const tpm_io_i2c_dev_t*)userCtx;
+
+    (void)ctx;
+    if (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) {
+        return TPM_RC_FAILURE;
+    }
+    return TPM2_IFX_I2CIo(dev->i2c, dev->addr, isRead, addr, buf, size);
+}
+#else
+/* SPI: one full duplex transfer of the TIS frame */
+int TPM2_IFX_AsyncIoCb(TPM2_CTX* ctx, const BYTE* txBuf, BYTE* rxBuf,
+    UINT16 xferSz, void* userCtx)
+{
+    int rc = TPM_RC_FAILURE;
+    cyhal_spi_t* spi = (cyhal_spi_t*)userCtx;
+
+    if (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) {
+        return TPM2_IoCb(ctx, txBuf, rxBuf, xferSz, userCtx);
+    }
+
+    xSemaphoreTake(mXferDone, 0);
+    if (cyhal_spi_transfer_async(spi, txBuf, xferSz, rxBuf, xferSz) ==
+            CY_RSLT_SUCCESS) {
+        rc = TPM2_IFX_AsyncXferWait();
+        if (rc != TPM_RC_SUCCESS)
+            cyhal_spi_abort_async(spi);
+    }
+    return rc;
+}
+#endif /* WOLFTPM_ADV_IO */
+
+#endif /* TPM_IO_ASYNC */
+
+/* [] END OF FILE */
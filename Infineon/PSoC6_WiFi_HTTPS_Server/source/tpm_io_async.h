@@ -0,0 +1,99 @@
+/******************************************************************************
+* File Name: tpm_io_async.h
+*
+* Description: This file contains the interrupt driven TPM I2C/SPI transport
+* for wolfTPM, suspending the calling task while a transfer runs.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef TPM_IO_ASYNC_H_
+#define TPM_IO_ASYNC_H_
+
+#include "cyhal.h"
+
+#include <wolftpm/tpm2_wrap.h>
+#include <hal/tpm_io.h>
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* TPM I2C address (SLB9673) */
+#ifndef TPM_IO_ASYNC_I2C_ADDR
+#define TPM_IO_ASYNC_I2C_ADDR       (0x2E)
+#endif
+
+/* The TPM NACKs its address while busy, retries with a 1 ms (tick) wait */
+#ifndef TPM_IO_ASYNC_I2C_TRIES
+#define TPM_IO_ASYNC_I2C_TRIES      (10)
+#endif
+
+/* Transfer complete interrupt priority, must allow FreeRTOS API calls
+ * (configMAX_API_CALL_INTERRUPT_PRIORITY) */
+#define TPM_IO_ASYNC_INTR_PRIORITY  (7)
+
+/* A transfer not complete in this time is aborted */
+#define TPM_IO_ASYNC_TIMEOUT_MS     (100)
+
+/*******************************************************************************
+* Data Types
+*******************************************************************************/
+#ifdef WOLFTPM_ADV_IO
+/* HAL IO context of a TPM at its own address on the bus (TPM_DEV_COUNT) */
+typedef struct {
+    cyhal_i2c_t* i2c;
+    uint8_t      addr;
+} tpm_io_i2c_dev_t;
+#endif
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+int TPM2_IFX_AsyncIoInit(void* bus);
+#ifdef WOLFTPM_ADV_IO
+int TPM2_IFX_AsyncIoCb(TPM2_CTX* ctx, INT32 isRead, UINT32 addr,
+    BYTE* buf, UINT16 size, void* userCtx);
+int TPM2_IFX_AsyncIoDevCb(TPM2_CTX* ctx, INT32 isRead, UINT32 addr,
+    BYTE* buf, UINT16 size, void* userCtx);
+#else
+int TPM2_IFX_AsyncIoCb(TPM2_CTX* ctx, const BYTE* txBuf, BYTE* rxBuf,
+    UINT16 xferSz, void* userCtx);
+#endif
+
+#endif /* TPM_IO_ASYNC_H_ */
+
+/* [] END OF FILE */
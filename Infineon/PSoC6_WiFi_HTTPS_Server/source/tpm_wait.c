@@ -0,0 +1,403 @@
+/******************************************************************************
+* File Name: tpm_wait.c
+*
+* Description: This file contains the RTOS aware TPM wait. wolfTPM calls
+*              XTPM_WAIT between TPM status polls and XSLEEP_MS for fixed
+*              delays. Once the scheduler runs the task sleeps instead of
+*              spinning: the first polls of a command on a microsecond
+*              hardware timer, then a tick at a time (or until the TPM
+*              interrupt line with TPM_WAIT_PIRQ). The bus transfers are
+*              watched to count the waits of each TPM command.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+
+#include "cyhal.h"
+#include "cybsp.h"
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+
+#include "perf_stats.h"
+#include "tpm_wait.h"
+
+#ifdef TPM_WAIT_RTOS
+
+#if defined(TPM_WAIT_PIRQ) && !defined(WOLFTPM_ADV_IO)
+    #error TPM_WAIT_PIRQ is only supported on the I2C (WOLFTPM_ADV_IO) interface
+#endif
+
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* TIS registers (offset in the locality) and status bits */
+#define TPM_WAIT_REG(addr)          ((addr) & 0xFFFu)
+#define TPM_WAIT_REG_INT_ENABLE     (0x008u)
+#define TPM_WAIT_REG_INT_STATUS     (0x010u)
+#define TPM_WAIT_REG_STS            (0x018u)
+#define TPM_WAIT_REG_DATA_FIFO      (0x024u)
+#define TPM_WAIT_STS_COMMAND_READY  (0x40u)
+
+/* command header: tag (2), size (4), command code (4) */
+#define TPM_WAIT_CMD_HDR_SZ         (10)
+
+/* interrupt enable: global, command ready, locality change, sts valid,
+ * data available */
+#define TPM_WAIT_INT_ENABLE         (0x80000087u)
+
+
+/*******************************************************************************
+ * Data Types
+ ******************************************************************************/
+typedef struct {
+    uint32_t cc;
+    uint32_t count;
+    uint32_t waits;
+    uint32_t waitsMax;
+    uint64_t cycles;
+} tpm_wait_cmd_t;
+
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static SemaphoreHandle_t mWake;
+static StaticSemaphore_t mWakeBuf;
+static TPM2HalIoCb mIoCb;
+static void* mIoCtx;
+#ifdef TPM_WAIT_PIRQ
+static cyhal_gpio_callback_data_t mPirqCb;
+#else
+static cyhal_timer_t mTimer;
+#endif
+
+/* command on the bus: from its first FIFO write to the command ready
+ * write that ends it */
+static int      mCmdActive;
+static uint32_t mCmdCode;
+static uint32_t mCmdWaits;
+static uint32_t mCmdStart;
+
+/* the last entry counts the rest */
+static tpm_wait_cmd_t mCmdStats[TPM_WAIT_CMDS + 1];
+static uint32_t mWaitSpin;
+static uint32_t mWaitTimer;
+static uint32_t mWaitTick;
+static uint32_t mWaitIrq;
+
+
+/*******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+static void tpm_wait_cmd_done(void)
+{
+    tpm_wait_cmd_t* st;
+    uint32_t cycles = perf_cycles() - mCmdStart;
+    int i;
+
+    for (i = 0; i < TPM_WAIT_CMDS; i++) {
+        if (mCmdStats[i].count == 0 || mCmdStats[i].cc == mCmdCode) {
+            break;
+        }
+    }
+    st = &mCmdStats[i];
+    st->cc = (i < TPM_WAIT_CMDS) ? mCmdCode : 0;
+    st->count++;
+    st->waits += mCmdWaits;
+    if (mCmdWaits > st->waitsMax) {
+        st->waitsMax = mCmdWaits;
+    }
+    st->cycles += cycles;
+
+#ifdef TPM_WAIT_LOG
+    printf("TPM 0x%lx: %lu waits, %lu us\r\n", (unsigned long)mCmdCode,
+        (unsigned long)mCmdWaits, (unsigned long)perf_cycles_to_us(cycles));
+#endif
+}
+
+static void tpm_wait_track(INT32 isRead, UINT32 addr, const BYTE* buf,
+    UINT16 size)
+{
+    if (isRead) {
+        return;
+    }
+    if (TPM_WAIT_REG(addr) == TPM_WAIT_REG_DATA_FIFO && !mCmdActive) {
+        mCmdActive = 1;
+        mCmdCode = (size >= TPM_WAIT_CMD_HDR_SZ) ?
+            ((uint32_t)buf[6] << 24 | (uint32_t)buf[7] << 16 |
+             (uint32_t)buf[8] << 8 | buf[9]) : 0;
+        mCmdStart = perf_cycles();
+    }
+    else if (TPM_WAIT_REG(addr) == TPM_WAIT_REG_STS && mCmdActive &&
+            size > 0 && (buf[0] & TPM_WAIT_STS_COMMAND_READY)) {
+        tpm_wait_cmd_done();
+        mCmdActive = 0;
+        /* the ready waits before the next command count for that one */
+        mCmdWaits = 0;
+    }
+}
+
+#ifdef TPM_WAIT_PIRQ
+static void tpm_wait_pirq_isr(void* arg, cyhal_gpio_event_t event)
+{
+    BaseType_t woken = pdFALSE;
+
+    (void)arg;
+    (void)event;
+    xSemaphoreGiveFromISR(mWake, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+/* TIS register access through the HAL IO callback, bypassing tracking */
+static int tpm_wait_reg(INT32 isRead, UINT32 reg, uint32_t* val)
+{
+    BYTE buf[sizeof(uint32_t)];
+    int rc;
+
+    if (!isRead) {
+        buf[0] = (BYTE)(*val);       buf[1] = (BYTE)(*val >> 8);
+        buf[2] = (BYTE)(*val >> 16); buf[3] = (BYTE)(*val >> 24);
+    }
+    rc = mIoCb(TPM2_GetActiveCtx(), isRead, reg, buf, sizeof(buf), mIoCtx);
+    if (isRead) {
+        *val = (uint32_t)buf[0] | (uint32_t)buf[1] << 8 |
+               (uint32_t)buf[2] << 16 | (uint32_t)buf[3] << 24;
+    }
+    return rc;
+}
+#else
+static void tpm_wait_timer_isr(void* arg, cyhal_timer_event_t event)
+{
+    BaseType_t woken = pdFALSE;
+
+    (void)arg;
+    (void)event;
+    xSemaphoreGiveFromISR(mWake, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+#endif
+
+
+/*******************************************************************************
+ * Public Functions
+ ******************************************************************************/
+/* Sets up the wake source, after the TPM bus is configured. ioCb/ioCtx is
+ * the HAL IO callback (register access for TPM_WAIT_PIRQ). */
+int tpm_wait_init(TPM2HalIoCb ioCb, void* ioCtx)
+{
+    cy_rslt_t result;
+
+    mIoCb = ioCb;
+    mIoCtx = ioCtx;
+    mWake = xSemaphoreCreateBinaryStatic(&mWakeBuf);
+
+#ifdef TPM_WAIT_PIRQ
+    /* PIRQ# is open drain, low while an enabled TPM interrupt is pending */
+    result = cyhal_gpio_init(TPM_WAIT_PIRQ_PIN, CYHAL_GPIO_DIR_INPUT,
+        CYHAL_GPIO_DRIVE_PULLUP, 1);
+    if (result == CY_RSLT_SUCCESS) {
+        mPirqCb.callback = tpm_wait_pirq_isr;
+        mPirqCb.callback_arg = NULL;
+        cyhal_gpio_register_callback(TPM_WAIT_PIRQ_PIN, &mPirqCb);
+        cyhal_gpio_enable_event(TPM_WAIT_PIRQ_PIN, CYHAL_GPIO_IRQ_FALL,
+            TPM_WAIT_INTR_PRIORITY, true);
+    }
+#else
+    {
+        const cyhal_timer_cfg_t cfg = {
+            .compare_value = 0,
+            .period = TPM_WAIT_US - 1,
+            .direction = CYHAL_TIMER_DIR_UP,
+            .is_compare = false,
+            .is_continuous = false,
+            .value = 0
+        };
+        result = cyhal_timer_init(&mTimer, NC, NULL);
+        if (result == CY_RSLT_SUCCESS) {
+            result = cyhal_timer_configure(&mTimer, &cfg);
+        }
+        if (result == CY_RSLT_SUCCESS) {
+            result = cyhal_timer_set_frequency(&mTimer, 1000000);
+        }
+        if (result == CY_RSLT_SUCCESS) {
+            cyhal_timer_register_callback(&mTimer, tpm_wait_timer_isr, NULL);
+            cyhal_timer_enable_event(&mTimer, CYHAL_TIMER_IRQ_TERMINAL_COUNT,
+                TPM_WAIT_INTR_PRIORITY, true);
+        }
+    }
+#endif
+    if (result != CY_RSLT_SUCCESS) {
+        /* waits spin as before */
+        mWake = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+#ifdef TPM_WAIT_PIRQ
+/* Enables the TPM interrupts on PIRQ#, after wolfTPM2_Init (locality
+ * requested) */
+int tpm_wait_pirq_enable(void)
+{
+    uint32_t val = TPM_WAIT_INT_ENABLE;
+    return tpm_wait_reg(0, TPM_WAIT_REG_INT_ENABLE, &val);
+}
+#endif
+
+/* XTPM_WAIT: between TPM status polls */
+void tpm_wait(void)
+{
+    mCmdWaits++;
+
+    if (mWake == NULL ||
+            xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) {
+        mWaitSpin++;
+        if (mCmdWaits <= TPM_WAIT_TIMER_TRIES) {
+            Cy_SysLib_DelayUs(TPM_WAIT_US);
+        }
+        else {
+            Cy_SysLib_Delay(1);
+        }
+        return;
+    }
+
+#ifdef TPM_WAIT_PIRQ
+    if (xSemaphoreTake(mWake, 1) == pdTRUE) {
+        uint32_t status;
+        mWaitIrq++;
+        /* write the pending bits back to clear them and release PIRQ# */
+        if (tpm_wait_reg(1, TPM_WAIT_REG_INT_STATUS, &status) == 0 &&
+                status != 0) {
+            tpm_wait_reg(0, TPM_WAIT_REG_INT_STATUS, &status);
+        }
+    }
+    else {
+        mWaitTick++;
+    }
+#else
+    if (mCmdWaits <= TPM_WAIT_TIMER_TRIES) {
+        mWaitTimer++;
+        cyhal_timer_reset(&mTimer);
+        cyhal_timer_start(&mTimer);
+        /* the tick timeout only covers a lost interrupt */
+        xSemaphoreTake(mWake, 2);
+    }
+    else {
+        mWaitTick++;
+        vTaskDelay(1);
+    }
+#endif
+}
+
+/* XSLEEP_MS */
+void tpm_sleep_ms(uint32_t ms)
+{
+    if (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) {
+        Cy_SysLib_Delay(ms);
+    }
+    else {
+        vTaskDelay(pdMS_TO_TICKS(ms) ? pdMS_TO_TICKS(ms) : 1);
+    }
+}
+
+/* Called by the HAL IO callback for every bus transfer */
+#ifdef WOLFTPM_ADV_IO
+void tpm_wait_io(INT32 isRead, UINT32 addr, const BYTE* buf, UINT16 size)
+{
+    tpm_wait_track(isRead, addr, buf, size);
+}
+#else
+void tpm_wait_io(const BYTE* txBuf, UINT16 xferSz)
+{
+    /* SPI TIS header: read bit and size, 24-bit address, then the data */
+    if (xferSz > 4) {
+        tpm_wait_track(txBuf[0] & 0x80,
+            (UINT32)txBuf[1] << 16 | (UINT32)txBuf[2] << 8 | txBuf[3],
+            &txBuf[4], xferSz - 4);
+    }
+}
+#endif
+
+const char* tpm_wait_report(char* buf, size_t bufSz)
+{
+    size_t pos;
+    int i, len;
+
+    len = snprintf(buf, bufSz,
+        "TPM waits: spin %lu, timer %lu, tick %lu, interrupt %lu\r\n",
+        (unsigned long)mWaitSpin, (unsigned long)mWaitTimer,
+        (unsigned long)mWaitTick, (unsigned long)mWaitIrq);
+    pos = (len > 0 && (size_t)len < bufSz) ? (size_t)len : 0;
+
+    for (i = 0; i <= TPM_WAIT_CMDS && pos < bufSz; i++) {
+        const tpm_wait_cmd_t* st = &mCmdStats[i];
+        if (st->count == 0) {
+            continue;
+        }
+        if (i < TPM_WAIT_CMDS) {
+            len = snprintf(buf + pos, bufSz - pos, "TPM command 0x%lx: ",
+                (unsigned long)st->cc);
+        }
+        else {
+            len = snprintf(buf + pos, bufSz - pos, "TPM other commands: ");
+        }
+        if (len > 0) {
+            pos += len;
+        }
+        if (pos >= bufSz) {
+            break;
+        }
+        len = snprintf(buf + pos, bufSz - pos,
+            "%lu, waits avg %lu max %lu, avg %lu us\r\n",
+            (unsigned long)st->count, (unsigned long)(st->waits / st->count),
+            (unsigned long)st->waitsMax,
+            (unsigned long)perf_cycles_to_us(st->cycles / st->count));
+        if (len > 0) {
+            pos += len;
+        }
+    }
+    return buf;
+}
+
+#endif /* TPM_WAIT_RTOS */
+
+/* [] END OF FILE */
@@ -0,0 +1,96 @@
+/******************************************************************************
+* File Name: tpm_wait.h
+*
+* Description: This file contains the RTOS aware TPM wait (XTPM_WAIT and
+* XSLEEP_MS of wolfTPM) and the per command TPM wait statistics.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef TPM_WAIT_H_
+#define TPM_WAIT_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <wolftpm/tpm2_wrap.h>
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* The first TPM_WAIT_TIMER_TRIES waits of a command are TPM_WAIT_US long
+ * (hardware timer), later ones one tick (vTaskDelay). Most status changes
+ * of the SLB9673 take well under a millisecond. */
+#ifndef TPM_WAIT_US
+#define TPM_WAIT_US                 (100)
+#endif
+#ifndef TPM_WAIT_TIMER_TRIES
+#define TPM_WAIT_TIMER_TRIES        (20)
+#endif
+
+/* Wake on the TPM interrupt line (PIRQ#) instead of the timer */
+//#define TPM_WAIT_PIRQ
+#ifndef TPM_WAIT_PIRQ_PIN
+#define TPM_WAIT_PIRQ_PIN           (CYBSP_MIKROBUS_INT)
+#endif
+
+#define TPM_WAIT_INTR_PRIORITY      (7)
+
+/* command codes with their own statistics, the rest are counted as other */
+#define TPM_WAIT_CMDS               (12)
+
+/* print the waits of each command */
+//#define TPM_WAIT_LOG
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+int tpm_wait_init(TPM2HalIoCb ioCb, void* ioCtx);
+#ifdef TPM_WAIT_PIRQ
+int tpm_wait_pirq_enable(void);
+#endif
+void tpm_wait(void);
+void tpm_sleep_ms(uint32_t ms);
+#ifdef WOLFTPM_ADV_IO
+void tpm_wait_io(INT32 isRead, UINT32 addr, const BYTE* buf, UINT16 size);
+#else
+void tpm_wait_io(const BYTE* txBuf, UINT16 xferSz);
+#endif
+const char* tpm_wait_report(char* buf, size_t bufSz);
+
+#endif /* TPM_WAIT_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,307 @@
+/******************************************************************************
+* File Name: url_db.c
+*
+* Description: This file contains the URL resource database holding the
+* resources created with HTTPS PUT requests. It is an open-addressing hash
+* table (FNV-1a hashes, linear probing) over a static arena, so adding and
+* updating resources takes no heap.
+*
+* The arena holds the names at its end, growing down, and length-prefixed
+* value records at its start, growing up. Names never move once added, as
+* they are registered with the HTTPS server. A value that outgrows its record
+* gets a new one; the space of replaced records is reclaimed by moving the
+* records down when the arena runs out.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <string.h>
+
+#include "url_db.h"
+
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define URL_DB_FNV_OFFSET   (2166136261UL)
+#define URL_DB_FNV_PRIME    (16777619UL)
+
+/* record slot of a replaced value */
+#define URL_DB_DEAD         (0xFFFF)
+
+/* value records are kept 4 byte aligned */
+#define URL_DB_ALIGN(sz)    (((sz) + 3) & ~(size_t)3)
+
+
+/*******************************************************************************
+ * Data Types
+ ******************************************************************************/
+typedef struct {
+    uint32_t hash;      /* FNV-1a of the name, 0 marks a free slot */
+    uint16_t name;      /* arena offset of the name (null terminated) */
+    uint16_t nameSz;
+    uint16_t value;     /* arena offset of the value record */
+} url_db_entry_t;
+
+/* value record header, followed by cap bytes holding the value and its
+ * null terminator */
+typedef struct {
+    uint16_t slot;      /* table slot owning the record or URL_DB_DEAD */
+    uint16_t cap;
+    uint16_t len;
+    uint16_t reserved;
+} url_db_rec_t;
+
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static url_db_entry_t mTable[URL_DB_TABLE_SZ];
+static uint32_t mArena[URL_DB_ARENA_SZ / sizeof(uint32_t)];
+static uint32_t mCount;
+static uint32_t mValueEnd;                  /* end of the value records */
+static uint32_t mNameStart = sizeof(mArena); /* start of the names */
+static uint32_t mDeadSz;                    /* bytes in replaced records */
+
+
+/*******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+#define URL_DB_PTR(off)     ((uint8_t*)mArena + (off))
+#define URL_DB_REC(off)     ((url_db_rec_t*)URL_DB_PTR(off))
+
+static uint32_t url_db_hash(const char* name, size_t nameSz)
+{
+    uint32_t hash = URL_DB_FNV_OFFSET;
+    size_t i;
+
+    for (i = 0; i < nameSz; i++) {
+        hash ^= (uint8_t)name[i];
+        hash *= URL_DB_FNV_PRIME;
+    }
+    return (hash != 0) ? hash : 1; /* 0 is a free slot */
+}
+
+/* Returns the slot of the name, or the free slot to add it at */
+static uint32_t url_db_find(uint32_t hash, const char* name, size_t nameSz)
+{
+    uint32_t slot = hash & (URL_DB_TABLE_SZ - 1);
+
+    /* terminates, the table is never more than half full */
+    while (mTable[slot].hash != 0) {
+        if (mTable[slot].hash == hash && mTable[slot].nameSz == nameSz &&
+                memcmp(URL_DB_PTR(mTable[slot].name), name, nameSz) == 0) {
+            break;
+        }
+        slot = (slot + 1) & (URL_DB_TABLE_SZ - 1);
+    }
+    return slot;
+}
+
+/* move the live value records down over the replaced ones */
+static void url_db_compact(void)
+{
+    uint32_t off = 0, dst = 0, sz;
+    url_db_rec_t* rec;
+
+    while (off < mValueEnd) {
+        rec = URL_DB_REC(off);
+        sz = sizeof(url_db_rec_t) + rec->cap;
+        if (rec->slot != URL_DB_DEAD) {
+            if (dst != off) {
+                memmove(URL_DB_PTR(dst), rec, sz);
+            }
+            mTable[URL_DB_REC(dst)->slot].value = dst;
+            dst += sz;
+        }
+        off += sz;
+    }
+    mValueEnd = dst;
+    mDeadSz = 0;
+}
+
+/* Adds a value record for slot, reclaiming the replaced records if needed.
+ * The caller checked there is room. */
+static uint32_t url_db_alloc(uint32_t slot, const char* value, size_t valueSz)
+{
+    uint32_t cap = URL_DB_ALIGN(valueSz + 1);
+    uint32_t off;
+    url_db_rec_t* rec;
+
+    if (mNameStart - mValueEnd < sizeof(url_db_rec_t) + cap) {
+        url_db_compact();
+    }
+    off = mValueEnd;
+    rec = URL_DB_REC(off);
+    rec->slot = slot;
+    rec->cap = cap;
+    rec->len = valueSz;
+    rec->reserved = 0;
+    memcpy(rec + 1, value, valueSz);
+    ((uint8_t*)(rec + 1))[valueSz] = '\0';
+    mValueEnd += sizeof(url_db_rec_t) + cap;
+    return off;
+}
+
+
+/*******************************************************************************
+ * Function Name: url_db_put
+ *******************************************************************************
+ * Summary:
+ *  Adds a resource or replaces the value of an existing one.
+ *
+ * Parameters:
+ *  name - Resource name (URL path), need not be null terminated.
+ *  nameSz - Length of the name.
+ *  value - Resource value.
+ *  valueSz - Length of the value.
+ *  storedName - Set to the null terminated copy of the name in the database,
+ *   which stays valid. May be NULL.
+ *
+ * Return:
+ *  int - URL_DB_ADDED or URL_DB_SUCCESS (updated), otherwise URL_DB_FULL,
+ *  URL_DB_NO_SPACE or URL_DB_BAD_ARG. A failed update keeps the old value.
+ *
+ *******************************************************************************/
+int url_db_put(const char* name, size_t nameSz, const char* value,
+    size_t valueSz, const char** storedName)
+{
+    uint32_t hash, slot, need, avail;
+    url_db_entry_t* entry;
+    url_db_rec_t* rec;
+
+    if (name == NULL || nameSz == 0 || (value == NULL && valueSz > 0) ||
+            valueSz + sizeof(url_db_rec_t) + 4 > sizeof(mArena)) {
+        return URL_DB_BAD_ARG;
+    }
+
+    hash = url_db_hash(name, nameSz);
+    slot = url_db_find(hash, name, nameSz);
+    entry = &mTable[slot];
+    need = sizeof(url_db_rec_t) + URL_DB_ALIGN(valueSz + 1);
+    avail = mNameStart - mValueEnd + mDeadSz;
+
+    if (entry->hash != 0) {
+        rec = URL_DB_REC(entry->value);
+        if (valueSz < rec->cap) {
+            /* fits in place */
+            memcpy(rec + 1, value, valueSz);
+            ((uint8_t*)(rec + 1))[valueSz] = '\0';
+            rec->len = valueSz;
+        }
+        else {
+            if (avail + sizeof(url_db_rec_t) + rec->cap < need) {
+                return URL_DB_NO_SPACE;
+            }
+            rec->slot = URL_DB_DEAD;
+            mDeadSz += sizeof(url_db_rec_t) + rec->cap;
+            entry->value = url_db_alloc(slot, value, valueSz);
+        }
+        if (storedName != NULL)
+            *storedName = (const char*)URL_DB_PTR(entry->name);
+        return URL_DB_SUCCESS;
+    }
+
+    if (mCount >= URL_DB_MAX_RESOURCES) {
+        return URL_DB_FULL;
+    }
+    if (nameSz > 0xFFFF || avail < need + nameSz + 1) {
+        return URL_DB_NO_SPACE;
+    }
+
+    /* the name goes below the others, reclaim first if it does not fit */
+    if (mNameStart - mValueEnd < nameSz + 1) {
+        url_db_compact();
+    }
+    mNameStart -= nameSz + 1;
+    memcpy(URL_DB_PTR(mNameStart), name, nameSz);
+    URL_DB_PTR(mNameStart)[nameSz] = '\0';
+
+    entry->name = mNameStart;
+    entry->nameSz = nameSz;
+    entry->value = url_db_alloc(slot, value, valueSz);
+    entry->hash = hash;
+    mCount++;
+
+    if (storedName != NULL)
+        *storedName = (const char*)URL_DB_PTR(entry->name);
+    return URL_DB_ADDED;
+}
+
+/*******************************************************************************
+ * Function Name: url_db_get
+ *******************************************************************************
+ * Summary:
+ *  Looks up the value of a resource. The value is null terminated and valid
+ *  until the next url_db_put.
+ *
+ * Parameters:
+ *  name - Resource name (URL path), need not be null terminated.
+ *  nameSz - Length of the name.
+ *  value - Set to the value.
+ *  valueSz - Set to the length of the value.
+ *
+ * Return:
+ *  int - URL_DB_SUCCESS if found, otherwise URL_DB_NOT_FOUND.
+ *
+ *******************************************************************************/
+int url_db_get(const char* name, size_t nameSz, const char** value,
+    size_t* valueSz)
+{
+    uint32_t slot;
+    url_db_rec_t* rec;
+
+    if (name == NULL || nameSz == 0) {
+        return URL_DB_NOT_FOUND;
+    }
+    slot = url_db_find(url_db_hash(name, nameSz), name, nameSz);
+    if (mTable[slot].hash == 0) {
+        return URL_DB_NOT_FOUND;
+    }
+    rec = URL_DB_REC(mTable[slot].value);
+    *value = (const char*)(rec + 1);
+    *valueSz = rec->len;
+    return URL_DB_SUCCESS;
+}
+
+/* Number of resources in the database */
+uint32_t url_db_count(void)
+{
+    return mCount;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,98 @@
+/******************************************************************************
+* File Name: url_db.h
+*
+* Description: This file contains the URL resource database holding the
+* resources created with HTTPS PUT requests.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef URL_DB_H_
+#define URL_DB_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Maximum number of resources */
+#ifndef URL_DB_MAX_RESOURCES
+#define URL_DB_MAX_RESOURCES        (16)
+#endif
+
+/* Hash table slots, a power of two. Keeping at least twice the resources
+ * keeps the probe sequences short. */
+#ifndef URL_DB_TABLE_SZ
+#define URL_DB_TABLE_SZ             (32)
+#endif
+
+/* Bytes of static storage for the resource names and values */
+#ifndef URL_DB_ARENA_SZ
+#define URL_DB_ARENA_SZ             (4096)
+#endif
+
+#if (URL_DB_TABLE_SZ & (URL_DB_TABLE_SZ - 1)) != 0
+    #error URL_DB_TABLE_SZ must be a power of two
+#endif
+#if URL_DB_TABLE_SZ < (2 * URL_DB_MAX_RESOURCES)
+    #error URL_DB_TABLE_SZ must be at least twice URL_DB_MAX_RESOURCES
+#endif
+#if URL_DB_ARENA_SZ > 0xFFFF
+    #error URL_DB_ARENA_SZ must fit in 16 bits
+#endif
+
+/* Return codes */
+#define URL_DB_SUCCESS              (0)
+#define URL_DB_ADDED                (1)  /* url_db_put added the resource */
+#define URL_DB_NOT_FOUND            (-1)
+#define URL_DB_FULL                 (-2)  /* no free resource */
+#define URL_DB_NO_SPACE             (-3)  /* arena full */
+#define URL_DB_BAD_ARG              (-4)
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+int url_db_put(const char* name, size_t nameSz, const char* value,
+    size_t valueSz, const char** storedName);
+int url_db_get(const char* name, size_t nameSz, const char** value,
+    size_t* valueSz);
+uint32_t url_db_count(void);
+
+#endif /* URL_DB_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,80 @@
+/******************************************************************************
+* File Name: web_assets.h
+*
+* Description: Precompressed static web page responses.
+*
+* Generated by generate_web_assets.py from the files in web/, do not edit.
+*
+* Related Document: See README.md
+*
+*******************************************************************************
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef WEB_ASSETS_H_
+#define WEB_ASSETS_H_
+
+#include <stdint.h>
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* logo.png: 1110 bytes */
+#define WEB_ASSET_LOGO_PNG_URL "/logo.png"
+#define WEB_ASSET_LOGO_PNG_ETAG "\"1ed8fc4b1864ffb9\""
+#define WEB_ASSET_LOGO_PNG_SZ (1254)
+
+/* progress.js: 1627 bytes, 677 gzip */
+#define WEB_ASSET_PROGRESS_JS_URL "/progress.js"
+#define WEB_ASSET_PROGRESS_JS_ETAG "\"870bc800c388c34c\""
+#define WEB_ASSET_PROGRESS_JS_SZ (850)
+
+/* index.html: 2175 bytes, 878 gzip */
+#define WEB_ASSET_INDEX_HTML_URL "/"
+#define WEB_ASSET_INDEX_HTML_ETAG "\"8a78ea2baa5dc808\""
+#define WEB_ASSET_INDEX_HTML_SZ (1022)
+
+/*******************************************************************************
+* Global Variables
+*******************************************************************************/
+/* complete HTTP responses, for CY_RAW_STATIC_URL_CONTENT resources */
+extern const uint8_t web_asset_logo_png[WEB_ASSET_LOGO_PNG_SZ];
+extern const uint8_t web_asset_progress_js[WEB_ASSET_PROGRESS_JS_SZ];
+extern const uint8_t web_asset_index_html[WEB_ASSET_INDEX_HTML_SZ];
+
+#endif /* WEB_ASSETS_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,359 @@
+/******************************************************************************
+* File Name: wifi_link.c
+*
+* Description: This file contains the Wi-Fi fast join and link monitor. The
+*              AP (BSSID, channel) and DHCP address of the last connection
+*              are kept in an internal flash row. The next join goes
+*              directly to that AP, reusing the address, and falls back to
+*              a full scan and DHCP. After a link loss the monitor task
+*              waits for the WCM to reconnect, joins again itself if it
+*              doesn't, and restarts the mDNS responder.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "cyhal.h"
+#include "cybsp.h"
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <event_groups.h>
+
+#include "cy_wcm.h"
+#include "cy_network_mw_core.h"
+#include "lwip/opt.h"
+#include "lwip/tcpip.h"
+
+#include "secure_http_server.h"
+#include "mdns.h"
+#include "wifi_link.h"
+#include "wifi_power.h"
+
+#ifdef WIFI_LINK
+
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define WIFI_LINK_PROFILE_MAGIC     (0x5746504Cu) /* WFPL */
+
+/* link monitor events, from the WCM callback */
+#define WIFI_LINK_EVENT_DOWN        (1u << 0)
+#define WIFI_LINK_EVENT_UP          (1u << 1)
+#define WIFI_LINK_EVENT_IP          (1u << 2)
+
+
+/*******************************************************************************
+ * Data Types
+ ******************************************************************************/
+/* last connection, in flash */
+typedef struct {
+    uint32_t     magic;
+    uint8_t      ssid[CY_WCM_MAX_SSID_LEN + 1];
+    cy_wcm_mac_t bssid;
+    uint8_t      channel;
+    uint8_t      band;
+    uint32_t     ip;
+    uint32_t     gateway;
+    uint32_t     netmask;
+    uint32_t     check;     /* FNV-1a of the fields above */
+} wifi_link_profile_t;
+
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+CY_ALIGN(CY_FLASH_SIZEOF_ROW)
+static const uint8_t mProfileRow[CY_FLASH_SIZEOF_ROW] = { 0 };
+static uint32_t mProfileBuf[CY_FLASH_SIZEOF_ROW / sizeof(uint32_t)];
+static cyhal_flash_t mFlash;
+static int mFlashInit;
+
+/* credentials of the first join, for the link monitor */
+static cy_wcm_connect_params_t mParams;
+#if WIFI_LINK_REUSE_LEASE
+static cy_wcm_ip_setting_t mStaticIp;
+#endif
+
+static EventGroupHandle_t mLinkEvents;
+static StaticEventGroup_t mLinkEventsBuf;
+static TaskHandle_t mLinkTask;
+static StaticTask_t mLinkTaskBuf;
+static StackType_t mLinkTaskStack[WIFI_LINK_TASK_STACK_SIZE];
+static uint32_t mReconnects;
+
+
+/*******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+static uint32_t wifi_link_profile_check(const wifi_link_profile_t* prof)
+{
+    const uint8_t* p = (const uint8_t*)prof;
+    uint32_t h = 2166136261u;
+    size_t i;
+
+    for (i = 0; i < offsetof(wifi_link_profile_t, check); i++) {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    return h;
+}
+
+/* Reads the profile, returns 1 if it is valid for the SSID */
+static int wifi_link_profile_read(wifi_link_profile_t* prof,
+    const uint8_t* ssid)
+{
+    const volatile uint8_t* row = mProfileRow;
+    uint8_t* p = (uint8_t*)prof;
+    size_t i;
+
+    /* the row is rewritten at run time, don't let the compiler assume the
+     * zero initializer */
+    for (i = 0; i < sizeof(*prof); i++) {
+        p[i] = row[i];
+    }
+    return (prof->magic == WIFI_LINK_PROFILE_MAGIC &&
+            prof->check == wifi_link_profile_check(prof) &&
+            strncmp((const char*)prof->ssid, (const char*)ssid,
+                sizeof(prof->ssid)) == 0);
+}
+
+/* Stores the current connection, the flash row is only written when it
+ * changed */
+static void wifi_link_profile_save(const cy_wcm_connect_params_t* params)
+{
+    cy_wcm_associated_ap_info_t ap;
+    cy_wcm_ip_address_t ip, gateway, netmask;
+    wifi_link_profile_t prof, cur;
+    cy_rslt_t result;
+
+    if (cy_wcm_get_associated_ap_info(&ap) != CY_RSLT_SUCCESS ||
+            cy_wcm_get_ip_addr(CY_WCM_INTERFACE_TYPE_STA, &ip) !=
+                CY_RSLT_SUCCESS ||
+            ip.version != CY_WCM_IP_VER_V4) {
+        return;
+    }
+    if (cy_wcm_get_gateway_ip_address(CY_WCM_INTERFACE_TYPE_STA, &gateway) !=
+                CY_RSLT_SUCCESS ||
+            cy_wcm_get_ip_netmask(CY_WCM_INTERFACE_TYPE_STA, &netmask) !=
+                CY_RSLT_SUCCESS) {
+        return;
+    }
+
+    memset(&prof, 0, sizeof(prof));
+    prof.magic = WIFI_LINK_PROFILE_MAGIC;
+    strncpy((char*)prof.ssid, (const char*)params->ap_credentials.SSID,
+        sizeof(prof.ssid) - 1);
+    memcpy(prof.bssid, ap.BSSID, sizeof(prof.bssid));
+    prof.channel = ap.channel;
+    prof.band = (ap.channel > 14) ? CY_WCM_WIFI_BAND_5GHZ :
+        CY_WCM_WIFI_BAND_2_4GHZ;
+    prof.ip = ip.ip.v4;
+    prof.gateway = gateway.ip.v4;
+    prof.netmask = netmask.ip.v4;
+    prof.check = wifi_link_profile_check(&prof);
+
+    if (wifi_link_profile_read(&cur, prof.ssid) &&
+            memcmp(&cur, &prof, sizeof(prof)) == 0) {
+        return;
+    }
+
+    result = CY_RSLT_SUCCESS;
+    if (!mFlashInit) {
+        result = cyhal_flash_init(&mFlash);
+        mFlashInit = (result == CY_RSLT_SUCCESS);
+    }
+    if (result == CY_RSLT_SUCCESS) {
+        memset(mProfileBuf, 0, sizeof(mProfileBuf));
+        memcpy(mProfileBuf, &prof, sizeof(prof));
+        result = cyhal_flash_write(&mFlash,
+            (uint32_t)(uintptr_t)mProfileRow, mProfileBuf);
+    }
+    if (result != CY_RSLT_SUCCESS) {
+        ERR_INFO(("Failed to store the Wi-Fi profile 0x%lx\n",
+            (unsigned long)result));
+    }
+}
+
+static void wifi_link_event_cb(cy_wcm_event_t event,
+    cy_wcm_event_data_t* event_data)
+{
+    (void)event_data;
+
+    switch (event) {
+        case CY_WCM_EVENT_DISCONNECTED:
+            xEventGroupSetBits(mLinkEvents, WIFI_LINK_EVENT_DOWN);
+            break;
+        case CY_WCM_EVENT_RECONNECTED:
+            xEventGroupSetBits(mLinkEvents, WIFI_LINK_EVENT_UP);
+            break;
+        case CY_WCM_EVENT_IP_CHANGED:
+            xEventGroupSetBits(mLinkEvents, WIFI_LINK_EVENT_IP);
+            break;
+        default:
+            break;
+    }
+}
+
+static void wifi_link_task(void* arg)
+{
+    EventBits_t bits;
+    cy_wcm_ip_address_t ip_addr;
+    uint32_t backoff;
+
+    (void)arg;
+
+    while (true) {
+        bits = xEventGroupWaitBits(mLinkEvents,
+            WIFI_LINK_EVENT_DOWN | WIFI_LINK_EVENT_IP, pdTRUE, pdFALSE,
+            portMAX_DELAY);
+
+        if (bits & WIFI_LINK_EVENT_DOWN) {
+            APP_INFO(("Wi-Fi link lost\n"));
+            /* the WCM retries the association for a while by itself */
+            bits = xEventGroupWaitBits(mLinkEvents, WIFI_LINK_EVENT_UP,
+                pdTRUE, pdFALSE, pdMS_TO_TICKS(WIFI_LINK_RECONNECT_WAIT_MS));
+            backoff = WIFI_LINK_RETRY_MIN_MS;
+            while (!(bits & WIFI_LINK_EVENT_UP) &&
+                    !cy_wcm_is_connected_to_ap()) {
+                if (wifi_link_connect(&mParams, &ip_addr, 1) ==
+                        CY_RSLT_SUCCESS) {
+                    break;
+                }
+                vTaskDelay(pdMS_TO_TICKS(backoff));
+                backoff = (backoff * 2 < WIFI_LINK_RETRY_MAX_MS) ?
+                    backoff * 2 : WIFI_LINK_RETRY_MAX_MS;
+            }
+            mReconnects++;
+            APP_INFO(("Wi-Fi link restored (%lu reconnects)\n",
+                (unsigned long)mReconnects));
+        }
+        /* the server listens on the address of the new association */
+        if (cy_wcm_get_ip_addr(CY_WCM_INTERFACE_TYPE_STA, &ip_addr) ==
+                CY_RSLT_SUCCESS) {
+            (void)https_server_ip_update(&ip_addr);
+        }
+        wifi_link_profile_save(&mParams);
+    #ifdef WIFI_POWER
+        /* the power save of the current mode, on the new association */
+        wifi_power_restore();
+    #endif
+
+    #if LWIP_MDNS_RESPONDER
+        /* probe and announce the name again on the new link */
+        LOCK_TCPIP_CORE();
+        mdns_resp_restart(cy_network_get_nw_interface(
+            CY_NETWORK_WIFI_STA_INTERFACE, 0));
+        UNLOCK_TCPIP_CORE();
+    #endif
+    }
+}
+
+
+/*******************************************************************************
+ * Public Functions
+ ******************************************************************************/
+/* Joins the AP in params. With fast set, it first joins the AP of the last
+ * connection directly (no scan), with its address when
+ * WIFI_LINK_REUSE_LEASE, then falls back to a full join. */
+cy_rslt_t wifi_link_connect(const cy_wcm_connect_params_t* params,
+    cy_wcm_ip_address_t* ip_addr, int fast)
+{
+    cy_rslt_t result = CY_RSLT_TYPE_ERROR;
+    cy_wcm_connect_params_t p;
+    wifi_link_profile_t prof;
+
+    if (params != &mParams) {
+        mParams = *params;
+    }
+
+    if (fast && wifi_link_profile_read(&prof, params->ap_credentials.SSID)) {
+        p = *params;
+        memcpy(p.BSSID, prof.bssid, sizeof(p.BSSID));
+        p.band = (cy_wcm_wifi_band_t)prof.band;
+    #if WIFI_LINK_REUSE_LEASE
+        if (prof.ip != 0) {
+            memset(&mStaticIp, 0, sizeof(mStaticIp));
+            mStaticIp.ip_address.version = CY_WCM_IP_VER_V4;
+            mStaticIp.ip_address.ip.v4 = prof.ip;
+            mStaticIp.gateway.version = CY_WCM_IP_VER_V4;
+            mStaticIp.gateway.ip.v4 = prof.gateway;
+            mStaticIp.netmask.version = CY_WCM_IP_VER_V4;
+            mStaticIp.netmask.ip.v4 = prof.netmask;
+            p.static_ip_settings = &mStaticIp;
+        }
+    #endif
+        APP_INFO(("Fast join: BSSID %02x:%02x:%02x:%02x:%02x:%02x, "
+            "channel %u\n", prof.bssid[0], prof.bssid[1], prof.bssid[2],
+            prof.bssid[3], prof.bssid[4], prof.bssid[5],
+            (unsigned)prof.channel));
+        result = cy_wcm_connect_ap(&p, ip_addr);
+        if (result != CY_RSLT_SUCCESS) {
+            APP_INFO(("Fast join failed 0x%lx, scanning\n",
+                (unsigned long)result));
+        }
+    }
+
+    if (result != CY_RSLT_SUCCESS) {
+        p = *params;
+        result = cy_wcm_connect_ap(&p, ip_addr);
+    }
+    if (result == CY_RSLT_SUCCESS) {
+        wifi_link_profile_save(params);
+    }
+    return result;
+}
+
+/* Starts the link monitor, after the first join */
+cy_rslt_t wifi_link_monitor_start(void)
+{
+    mLinkEvents = xEventGroupCreateStatic(&mLinkEventsBuf);
+    mLinkTask = xTaskCreateStatic(wifi_link_task, "Wi-Fi Link",
+        WIFI_LINK_TASK_STACK_SIZE, NULL, WIFI_LINK_TASK_PRIORITY,
+        mLinkTaskStack, &mLinkTaskBuf);
+    if (mLinkTask == NULL) {
+        return CY_RSLT_TYPE_ERROR;
+    }
+    return cy_wcm_register_event_callback(wifi_link_event_cb);
+}
+
+#endif /* WIFI_LINK */
+
+/* [] END OF FILE */
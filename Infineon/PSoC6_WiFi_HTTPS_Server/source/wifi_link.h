@@ -0,0 +1,80 @@
+/******************************************************************************
+* File Name: wifi_link.h
+*
+* Description: This file contains the Wi-Fi fast join (cached connection
+* profile) and the link monitor that reconnects after a link loss.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef WIFI_LINK_H_
+#define WIFI_LINK_H_
+
+#include "cy_wcm.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Fast join: the BSSID and band of the last AP, from a flash row, skip the
+ * scan. With WIFI_LINK_REUSE_LEASE the last DHCP address is used as a
+ * static address, without DHCP and without a conflict check. Only for a
+ * DHCP reservation of the board: without one the address can be given to
+ * another host once the lease expires. Off by default. */
+#ifndef WIFI_LINK_REUSE_LEASE
+#define WIFI_LINK_REUSE_LEASE           (0)
+#endif
+
+/* After a link loss, time given to the WCM to reconnect by itself before
+ * the link monitor joins again, and the retry backoff */
+#define WIFI_LINK_RECONNECT_WAIT_MS     (5000)
+#define WIFI_LINK_RETRY_MIN_MS          (1000)
+#define WIFI_LINK_RETRY_MAX_MS          (30000)
+
+/* stack depth in words (StackType_t) */
+#define WIFI_LINK_TASK_STACK_SIZE       (2 * 1024)
+#define WIFI_LINK_TASK_PRIORITY         (1)
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+cy_rslt_t wifi_link_connect(const cy_wcm_connect_params_t* params,
+    cy_wcm_ip_address_t* ip_addr, int fast);
+cy_rslt_t wifi_link_monitor_start(void);
+
+#endif /* WIFI_LINK_H_ */
+
+/* [] END OF FILE */
@@ -0,0 +1,331 @@
+/******************************************************************************
+* File Name: wifi_power.c
+*
+* Description: This file contains the Wi-Fi power-save policy. While the
+*              HTTPS server handles requests, or a firmware upload or update
+*              runs, the WLAN stays out of power save and MCU deep sleep is
+*              locked. After WIFI_POWER_IDLE_S seconds without either, the
+*              WLAN enters PM2 with the listen interval of the policy and,
+*              with WIFI_POWER_DEEPSLEEP, deep sleep is allowed. The first
+*              request after an idle period switches back and records the
+*              time from its handler entry to the first response byte.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "cyhal.h"
+#include "cybsp.h"
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+
+#include "cy_wcm.h"
+#include "whd_wifi_api.h"
+
+#include "secure_http_server.h"
+#include "perf_stats.h"
+#include "wifi_power.h"
+
+#ifdef WIFI_POWER
+
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static SemaphoreHandle_t mLock;
+static StaticSemaphore_t mLockBuf;
+static whd_interface_t mIfp;
+static wifi_power_policy_t mPolicy = {
+    WIFI_POWER_IDLE_S, WIFI_POWER_LISTEN_INTERVAL, WIFI_POWER_DEEPSLEEP,
+    WIFI_POWER_PM2_SLEEP_MS
+};
+
+static int mSaving;             /* WLAN in power save */
+static int mDeepSleepLocked;
+static uint32_t mActive;        /* requests in a resource handler */
+static TickType_t mLast;        /* end of the last request */
+
+/* time in each mode, in ticks */
+static TickType_t mModeStart;
+static uint64_t mPerfTicks;
+static uint64_t mSaveTicks;
+static uint32_t mSaveCount;     /* entries into power save */
+static uint32_t mErrors;        /* failed WHD calls */
+
+/* the first request after power save: handler entry to first byte */
+static int mWakeOpen;
+static uint32_t mWakeStart;     /* cycles */
+static perf_hist_t mWakeSwitch; /* leaving power save, us */
+static perf_hist_t mWakeFirstByte;
+
+
+/*******************************************************************************
+ * Local Functions
+ ******************************************************************************/
+static void wifi_power_mode_time(void)
+{
+    TickType_t now = xTaskGetTickCount();
+
+    if (mSaving)
+        mSaveTicks += now - mModeStart;
+    else
+        mPerfTicks += now - mModeStart;
+    mModeStart = now;
+}
+
+/* lock deep sleep in performance mode, or when the policy disallows it */
+static void wifi_power_deepsleep(void)
+{
+    int lock = (!mSaving || !mPolicy.deepsleep);
+
+    if (lock && !mDeepSleepLocked) {
+        cyhal_syspm_lock_deepsleep();
+    }
+    else if (!lock && mDeepSleepLocked) {
+        cyhal_syspm_unlock_deepsleep();
+    }
+    mDeepSleepLocked = lock;
+}
+
+/* sets the WLAN power save of the current mode. Call locked. */
+static void wifi_power_apply(void)
+{
+    whd_result_t rc = WHD_SUCCESS;
+
+    if (mIfp != NULL && mSaving) {
+        rc = whd_wifi_set_listen_interval(mIfp, mPolicy.listen_interval,
+            WHD_LISTEN_INTERVAL_TIME_UNIT_DTIM);
+        if (rc == WHD_SUCCESS) {
+            rc = whd_wifi_enable_powersave_with_throughput(mIfp,
+                mPolicy.pm2_sleep_ms);
+        }
+    }
+    else if (mIfp != NULL) {
+        rc = whd_wifi_disable_powersave(mIfp);
+    }
+    if (rc != WHD_SUCCESS) {
+        mErrors++;
+    }
+    wifi_power_deepsleep();
+}
+
+/* Call locked */
+static void wifi_power_enter_perf(void)
+{
+    wifi_power_mode_time();
+    mSaving = 0;
+    wifi_power_apply();
+}
+
+/* Call locked */
+static void wifi_power_enter_save(void)
+{
+    wifi_power_mode_time();
+    mSaving = 1;
+    mSaveCount++;
+    wifi_power_apply();
+}
+
+static void wifi_power_report_hist(char** p, size_t* left, const char* name,
+    const perf_hist_t* hist)
+{
+    int n = snprintf(*p, *left,
+        "  %-10s count %lu, p50 %lu us, p90 %lu us, max %lu us\r\n", name,
+        (unsigned long)hist->count,
+        (unsigned long)perf_hist_percentile(hist, 50),
+        (unsigned long)perf_hist_percentile(hist, 90),
+        (unsigned long)hist->max);
+    if (n > 0 && (size_t)n < *left) {
+        *p += n;
+        *left -= n;
+    }
+}
+
+
+/*******************************************************************************
+ * Public Functions
+ ******************************************************************************/
+/* Starts in performance mode, after the Wi-Fi join */
+cy_rslt_t wifi_power_init(void)
+{
+    cy_rslt_t result;
+
+    mLock = xSemaphoreCreateMutexStatic(&mLockBuf);
+    result = cy_wcm_get_whd_interface(CY_WCM_INTERFACE_TYPE_STA, &mIfp);
+    if (result != CY_RSLT_SUCCESS) {
+        mIfp = NULL;
+        return result;
+    }
+    mModeStart = mLast = xTaskGetTickCount();
+    wifi_power_enter_perf();
+    return CY_RSLT_SUCCESS;
+}
+
+/* Sets the policy. It leaves power save, which is entered again with the
+ * new listen interval and PM2 delay once idle. */
+cy_rslt_t wifi_power_set_policy(const wifi_power_policy_t* policy)
+{
+    if (policy->listen_interval == 0 || policy->pm2_sleep_ms < 10 ||
+            policy->pm2_sleep_ms > 2000) {
+        return CY_RSLT_TYPE_ERROR;
+    }
+#if !WIFI_POWER_DEEPSLEEP
+    if (policy->deepsleep) {
+        return CY_RSLT_TYPE_ERROR;
+    }
+#endif
+    xSemaphoreTake(mLock, portMAX_DELAY);
+    mPolicy = *policy;
+    if (mSaving) {
+        wifi_power_enter_perf();
+        mLast = xTaskGetTickCount();
+    }
+    wifi_power_deepsleep();
+    xSemaphoreGive(mLock);
+    return CY_RSLT_SUCCESS;
+}
+
+void wifi_power_get_policy(wifi_power_policy_t* policy)
+{
+    xSemaphoreTake(mLock, portMAX_DELAY);
+    *policy = mPolicy;
+    xSemaphoreGive(mLock);
+}
+
+/* A resource handler starts, leaves power save */
+void wifi_power_request_begin(void)
+{
+    uint32_t start;
+
+    xSemaphoreTake(mLock, portMAX_DELAY);
+    mActive++;
+    if (mSaving) {
+        start = perf_cycles();
+        wifi_power_enter_perf();
+        perf_hist_add(&mWakeSwitch, perf_cycles_to_us(perf_cycles() - start));
+        mWakeOpen = 1;
+        mWakeStart = start;
+    }
+    xSemaphoreGive(mLock);
+}
+
+void wifi_power_request_end(void)
+{
+    xSemaphoreTake(mLock, portMAX_DELAY);
+    if (mActive > 0)
+        mActive--;
+    mLast = xTaskGetTickCount();
+    mWakeOpen = 0; /* the request wrote no response */
+    xSemaphoreGive(mLock);
+}
+
+/* A response write of the running handler */
+void wifi_power_first_byte(void)
+{
+    if (!mWakeOpen)
+        return;
+    xSemaphoreTake(mLock, portMAX_DELAY);
+    if (mWakeOpen) {
+        perf_hist_add(&mWakeFirstByte,
+            perf_cycles_to_us(perf_cycles() - mWakeStart));
+        mWakeOpen = 0;
+    }
+    xSemaphoreGive(mLock);
+}
+
+/* Called every second by the HTTPS server task, busy while a firmware
+ * update holds the performance mode */
+void wifi_power_poll(int busy)
+{
+    TickType_t now = xTaskGetTickCount();
+
+    xSemaphoreTake(mLock, portMAX_DELAY);
+    if (busy) {
+        mLast = now;
+    }
+    if (!mSaving && mActive == 0 && mPolicy.idle_s > 0 &&
+            (now - mLast) >= pdMS_TO_TICKS(mPolicy.idle_s * 1000)) {
+        wifi_power_enter_save();
+    }
+    xSemaphoreGive(mLock);
+}
+
+/* The WLAN firmware settings after a reconnect, see wifi_link.c */
+void wifi_power_restore(void)
+{
+    xSemaphoreTake(mLock, portMAX_DELAY);
+    wifi_power_apply();
+    xSemaphoreGive(mLock);
+}
+
+const char* wifi_power_report(char* buf, size_t bufSz)
+{
+    char* p = buf;
+    size_t left = bufSz;
+    int n;
+
+    xSemaphoreTake(mLock, portMAX_DELAY);
+    wifi_power_mode_time();
+    n = snprintf(p, left,
+        "Wi-Fi power: %s, idle %lu s, listen interval %u DTIM, "
+        "PM2 sleep %u ms, deep sleep %s\r\n"
+        "  performance %lu s, power save %lu s (%lu times), errors %lu\r\n",
+        mSaving ? "power save" : "performance",
+        (unsigned long)mPolicy.idle_s, (unsigned)mPolicy.listen_interval,
+        (unsigned)mPolicy.pm2_sleep_ms,
+        mPolicy.deepsleep ? "allowed" : "locked",
+        (unsigned long)(mPerfTicks * portTICK_PERIOD_MS / 1000),
+        (unsigned long)(mSaveTicks * portTICK_PERIOD_MS / 1000),
+        (unsigned long)mSaveCount, (unsigned long)mErrors);
+    if (n > 0 && (size_t)n < left) {
+        p += n;
+        left -= n;
+    }
+    wifi_power_report_hist(&p, &left, "wake", &mWakeSwitch);
+    wifi_power_report_hist(&p, &left, "first byte", &mWakeFirstByte);
+    xSemaphoreGive(mLock);
+    return buf;
+}
+
+#endif /* WIFI_POWER */
+
+/* [] END OF FILE */
@@ -0,0 +1,109 @@
+/******************************************************************************
+* File Name: wifi_power.h
+*
+* Description: This file contains the Wi-Fi power-save policy: performance
+* mode while requests and firmware uploads run, WLAN power save and MCU deep
+* sleep once idle, and the wake latency.
+*
+* Related Document: See README.md
+*******************************************************************************
+* Copyright 2020-2023, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef WIFI_POWER_H_
+#define WIFI_POWER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "cy_result.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Seconds without a request, an open upload or a firmware update before
+ * power save, 0 stays in performance mode */
+#ifndef WIFI_POWER_IDLE_S
+#define WIFI_POWER_IDLE_S               (30)
+#endif
+
+/* In power save the radio wakes for every WIFI_POWER_LISTEN_INTERVAL DTIM
+ * beacons to receive buffered frames, a longer interval saves power and
+ * delays the first request by up to that many DTIM periods */
+#ifndef WIFI_POWER_LISTEN_INTERVAL
+#define WIFI_POWER_LISTEN_INTERVAL      (1)
+#endif
+
+/* PM2: the radio stays awake this long after traffic (10 to 2000 ms) */
+#ifndef WIFI_POWER_PM2_SLEEP_MS
+#define WIFI_POWER_PM2_SLEEP_MS         (200)
+#endif
+
+/* Allow MCU deep sleep in power save, it is locked in performance mode.
+ * The WLAN must wake the host through the SDIO host wake pin, which the
+ * Makefile disables on CY8CPROTO-062-4343W (CY_WIFI_HOST_WAKE_SW_FORCE). */
+#ifndef WIFI_POWER_DEEPSLEEP
+#define WIFI_POWER_DEEPSLEEP            (0)
+#endif
+#if WIFI_POWER_DEEPSLEEP && defined(CY_WIFI_HOST_WAKE_SW_FORCE) && \
+    (CY_WIFI_HOST_WAKE_SW_FORCE == 0)
+#error "WIFI_POWER_DEEPSLEEP needs the SDIO host wake (CY_WIFI_HOST_WAKE_SW_FORCE)"
+#endif
+
+/*******************************************************************************
+* Data Types
+*******************************************************************************/
+typedef struct {
+    uint32_t idle_s;            /* WIFI_POWER_IDLE_S */
+    uint8_t  listen_interval;   /* WIFI_POWER_LISTEN_INTERVAL */
+    uint8_t  deepsleep;         /* WIFI_POWER_DEEPSLEEP */
+    uint16_t pm2_sleep_ms;      /* WIFI_POWER_PM2_SLEEP_MS */
+} wifi_power_policy_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+cy_rslt_t wifi_power_init(void);
+cy_rslt_t wifi_power_set_policy(const wifi_power_policy_t* policy);
+void wifi_power_get_policy(wifi_power_policy_t* policy);
+void wifi_power_request_begin(void);
+void wifi_power_request_end(void);
+void wifi_power_first_byte(void);
+void wifi_power_poll(int busy);
+void wifi_power_restore(void);
+const char* wifi_power_report(char* buf, size_t bufSz);
+
+#endif /* WIFI_POWER_H_ */
+
+/* [] END OF FILE */
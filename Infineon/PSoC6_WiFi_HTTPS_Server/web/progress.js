@@ -0,0 +1,46 @@
+/* Update progress of the firmware update form, from /fw/progress. The
+ * stream is opened when the page loads and when the form is submitted,
+ * and closed once no update runs, so an open page does not keep the board
+ * from power save. */
+var fwProgress = null;
+var fwSubmitted = false;
+
+function fwProgressClose() {
+    if (fwProgress !== null) {
+        fwProgress.close();
+        fwProgress = null;
+    }
+}
+
+function fwProgressOpen() {
+    if (fwProgress !== null)
+        return;
+    fwProgress = new EventSource("/fw/progress");
+    fwProgress.addEventListener("progress", function (e) {
+        var p = JSON.parse(e.data), s = p.state;
+        if (p.total > 0 && p.state != "idle")
+            s += ", " + p.written + " of " + p.total + " bytes";
+        if (p.bytesPerSec > 0)
+            s += ", " + p.bytesPerSec + " bytes/sec";
+        if (p.etaS !== null)
+            s += ", " + p.etaS + " s left";
+        document.getElementById("fw_progress").textContent = s;
+        if (p.state == "idle" || p.state == "done") {
+            fwProgressClose();
+            /* The upload may not have reached the board yet, which then
+             * sets the long idle retry: ask again in a second instead. */
+            if (fwSubmitted)
+                setTimeout(fwProgressOpen, 1000);
+        }
+    });
+}
+
+document.getElementById("fw_form").addEventListener("submit", function () {
+    fwSubmitted = true;
+    fwProgressOpen();
+});
+/* the result of the upload is shown once the update has ended */
+document.getElementById("tpm_status").addEventListener("load", function () {
+    fwSubmitted = false;
+});
+fwProgressOpen();